@@ -0,0 +1,123 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "AdjacencyKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	FaceAdjacencyTable::FaceAdjacencyTable(double tolerance)
+		: m_inverseTolerance(1.0 / tolerance)
+	{
+		if (!(tolerance > 0.0))
+		{
+			throw std::invalid_argument("The tolerance must have a positive value.");
+		}
+	}
+
+	std::size_t FaceAdjacencyTable::AddFace(std::size_t cellIndex, const double* pkCoordinates, std::size_t vertexCount)
+	{
+		std::vector<std::array<std::int64_t, 3>> vertices(vertexCount);
+		for (std::size_t i = 0; i < vertexCount; ++i)
+		{
+			for (std::size_t j = 0; j < 3; ++j)
+			{
+				vertices[i][j] = (std::int64_t)std::llround(pkCoordinates[i * 3 + j] * m_inverseTolerance);
+			}
+		}
+		std::sort(vertices.begin(), vertices.end());
+
+		std::vector<std::int64_t> key;
+		key.reserve(vertexCount * 3);
+		for (const std::array<std::int64_t, 3>& rkVertex : vertices)
+		{
+			key.insert(key.end(), rkVertex.begin(), rkVertex.end());
+		}
+
+		std::pair<std::unordered_map<std::vector<std::int64_t>, std::size_t, KeyHash>::iterator, bool> insertion =
+			m_faceIds.emplace(std::move(key), m_faceCells.size());
+		std::size_t faceId = insertion.first->second;
+		if (insertion.second)
+		{
+			FaceCells faceCells;
+			faceCells.cells[0] = -1;
+			faceCells.cells[1] = -1;
+			faceCells.count = 0;
+			m_faceCells.push_back(faceCells);
+		}
+
+		FaceCells& rFaceCells = m_faceCells[faceId];
+		if (rFaceCells.count < 2)
+		{
+			rFaceCells.cells[rFaceCells.count] = (std::int64_t)cellIndex;
+		}
+		++rFaceCells.count;
+
+		if (m_cellFaces.size() <= cellIndex)
+		{
+			m_cellFaces.resize(cellIndex + 1);
+		}
+		m_cellFaces[cellIndex].push_back(faceId);
+		return faceId;
+	}
+
+	std::int64_t FaceAdjacencyTable::OtherCell(std::size_t faceId, std::size_t cellIndex) const
+	{
+		const FaceCells& rkFaceCells = m_faceCells[faceId];
+		if (rkFaceCells.count < 2)
+		{
+			return -1;
+		}
+		return rkFaceCells.cells[0] == (std::int64_t)cellIndex ? rkFaceCells.cells[1] : rkFaceCells.cells[0];
+	}
+
+	std::vector<std::size_t> FaceAdjacencyTable::AdjacentCells(std::size_t cellIndex) const
+	{
+		std::vector<std::size_t> adjacentCells;
+		if (cellIndex >= m_cellFaces.size())
+		{
+			return adjacentCells;
+		}
+
+		for (std::size_t faceId : m_cellFaces[cellIndex])
+		{
+			std::int64_t otherCell = OtherCell(faceId, cellIndex);
+			if (otherCell >= 0)
+			{
+				adjacentCells.push_back((std::size_t)otherCell);
+			}
+		}
+		std::sort(adjacentCells.begin(), adjacentCells.end());
+		adjacentCells.erase(std::unique(adjacentCells.begin(), adjacentCells.end()), adjacentCells.end());
+		return adjacentCells;
+	}
+
+	std::size_t FaceAdjacencyTable::KeyHash::operator()(const std::vector<std::int64_t>& rkKey) const
+	{
+		// FNV-1a over the quantized coordinates
+		std::uint64_t hash = 14695981039346656037ULL;
+		for (std::int64_t value : rkKey)
+		{
+			hash ^= (std::uint64_t)value;
+			hash *= 1099511628211ULL;
+		}
+		return (std::size_t)hash;
+	}
+}
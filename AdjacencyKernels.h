@@ -0,0 +1,66 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	// Face -> cells table of a cell complex, built in one pass over the faces of every cell.
+	// Coincident faces are identified by a geometric key: their vertex coordinates quantized to the
+	// tolerance and sorted, so the key does not depend on the vertex order or orientation.
+	class FaceAdjacencyTable
+	{
+	public:
+		explicit FaceAdjacencyTable(double tolerance);
+
+		// Registers a face of a cell from vertexCount x 3 coordinates and returns its face id.
+		// Faces shared by two cells get the same id.
+		std::size_t AddFace(std::size_t cellIndex, const double* pkCoordinates, std::size_t vertexCount);
+
+		std::size_t FaceCount() const { return m_faceCells.size(); }
+
+		// The number of cells bounded by the face: 1 for an exterior face, 2 for an interior one.
+		std::size_t CellCount(std::size_t faceId) const { return m_faceCells[faceId].count; }
+
+		// Returns the other cell bounded by the face, or -1 for an exterior face.
+		std::int64_t OtherCell(std::size_t faceId, std::size_t cellIndex) const;
+
+		// Returns the cells sharing at least one face with the cell, in ascending order.
+		std::vector<std::size_t> AdjacentCells(std::size_t cellIndex) const;
+
+	private:
+		struct FaceCells
+		{
+			std::int64_t cells[2];
+			std::size_t count;
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(const std::vector<std::int64_t>& rkKey) const;
+		};
+
+		double m_inverseTolerance;
+		std::vector<FaceCells> m_faceCells;
+		std::vector<std::vector<std::size_t>> m_cellFaces;
+		std::unordered_map<std::vector<std::int64_t>, std::size_t, KeyHash> m_faceIds;
+	};
+}
@@ -0,0 +1,335 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "BuildingModelKernels.h"
+#include "AdjacencyKernels.h"
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		const double Pi = 3.14159265358979323846;
+
+		std::vector<double> Reversed(const double* pkCoordinates, std::size_t vertexCount)
+		{
+			std::vector<double> coordinates(vertexCount * 3);
+			for (std::size_t j = 0; j < vertexCount; ++j)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					coordinates[j * 3 + k] = pkCoordinates[(vertexCount - 1 - j) * 3 + k];
+				}
+			}
+			return coordinates;
+		}
+
+		SurfaceType FaceType(const std::vector<double>& rkOutwardCoordinates)
+		{
+			double normal[3];
+			NewellNormal(rkOutwardCoordinates.data(), rkOutwardCoordinates.size() / 3, normal);
+			double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length <= 0.0)
+			{
+				return SURFACE_WALL;
+			}
+
+			return SurfaceTypeByUpAngle(std::acos(std::max(-1.0, std::min(1.0, normal[2] / length))) * 180.0 / Pi);
+		}
+
+		// The fallback windows of EnergyModel.ByCellComplex: the wall scaled about its vertex average to
+		// glazingRatio of its area, as a fan of triangles each scaled by 0.999 to stay inside it.
+		std::vector<std::vector<double>> ScaledWindows(const std::vector<double>& rkWall, double glazingRatio)
+		{
+			std::size_t vertexCount = rkWall.size() / 3;
+			std::vector<double> scaled(rkWall.size());
+			double centre[3] = { 0.0, 0.0, 0.0 };
+			for (std::size_t j = 0; j < vertexCount; ++j)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					centre[k] += rkWall[j * 3 + k] / (double)vertexCount;
+				}
+			}
+			double scale = std::sqrt(glazingRatio);
+			for (std::size_t j = 0; j < vertexCount; ++j)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					scaled[j * 3 + k] = centre[k] + scale * (rkWall[j * 3 + k] - centre[k]);
+				}
+			}
+
+			std::vector<std::vector<double>> windows;
+			for (std::size_t j = 1; j + 1 < vertexCount; ++j)
+			{
+				const std::size_t corners[3] = { 0, j, j + 1 };
+				double triangleCentre[3] = { 0.0, 0.0, 0.0 };
+				for (std::size_t corner : corners)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						triangleCentre[k] += scaled[corner * 3 + k] / 3.0;
+					}
+				}
+
+				std::vector<double> triangle;
+				for (std::size_t corner : corners)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						triangle.push_back(triangleCentre[k] + std::sqrt(0.999) * (scaled[corner * 3 + k] - triangleCentre[k]));
+					}
+				}
+				windows.push_back(triangle);
+			}
+			return windows;
+		}
+	}
+
+	SurfaceType SurfaceTypeByUpAngle(double angle)
+	{
+		if (angle < 5.0)
+		{
+			return SURFACE_ROOFCEILING;
+		}
+		if (angle > 175.0)
+		{
+			return SURFACE_FLOOR;
+		}
+		return SURFACE_WALL;
+	}
+
+	BoundaryCondition SurfaceBoundaryCondition(SurfaceType type, std::size_t cellCount, bool isUnderground)
+	{
+		if (cellCount > 1)
+		{
+			return BOUNDARY_SURFACE;
+		}
+		if (type == SURFACE_FLOOR || isUnderground)
+		{
+			return BOUNDARY_GROUND;
+		}
+		return BOUNDARY_OUTDOORS;
+	}
+
+	std::string StoryName(int storyIndex)
+	{
+		return "STORY_" + std::to_string(storyIndex + 1);
+	}
+
+	std::string SpaceName(int storyIndex, int spaceNumber)
+	{
+		return StoryName(storyIndex) + "_SPACE_" + std::to_string(spaceNumber);
+	}
+
+	std::string SurfaceName(const std::string& rkSpaceName, std::size_t surfaceNumber)
+	{
+		return rkSpaceName + "_SURFACE_" + std::to_string(surfaceNumber);
+	}
+
+	std::string SubSurfaceName(const std::string& rkSurfaceName, std::size_t subSurfaceNumber)
+	{
+		return rkSurfaceName + "_SUBSURFACE_" + std::to_string(subSurfaceNumber);
+	}
+
+	std::string ThermalZoneName(const std::string& rkSpaceName)
+	{
+		return rkSpaceName + "_THERMAL_ZONE";
+	}
+
+	BuildingModel BuildModel(const CellBuffer& rkCells, const BuildingModelParameters& rkParameters)
+	{
+		return BuildModel(rkCells, rkParameters, std::vector<double>(), std::vector<std::size_t>(), std::vector<std::size_t>());
+	}
+
+	BuildingModel BuildModel(
+		const CellBuffer& rkCells,
+		const BuildingModelParameters& rkParameters,
+		const std::vector<double>& rkApertureCoordinates,
+		const std::vector<std::size_t>& rkApertureVertexOffsets,
+		const std::vector<std::size_t>& rkApertureHostFaces)
+	{
+		TraceSpan span("BuildModel");
+		span.SetAttribute("cells", (std::int64_t)rkCells.CellCount());
+		if (rkParameters.glazingRatio < 0.0 || rkParameters.glazingRatio > 1.0)
+		{
+			throw std::invalid_argument("The glazing ratio must be between 0.0 and 1.0 (both inclusive).");
+		}
+
+		// Face id -> the apertures it hosts
+		std::size_t faceCount = rkCells.CellFaceOffsets().back();
+		std::vector<std::vector<std::size_t>> faceApertures(rkApertureHostFaces.empty() ? 0 : faceCount);
+		if (!rkApertureHostFaces.empty())
+		{
+			if (rkApertureVertexOffsets.size() != rkApertureHostFaces.size() + 1 ||
+				rkApertureVertexOffsets.front() != 0 ||
+				rkApertureVertexOffsets.back() * 3 != rkApertureCoordinates.size())
+			{
+				throw std::invalid_argument("The aperture vertex offsets do not match the aperture coordinates and host faces.");
+			}
+			for (std::size_t aperture = 0; aperture < rkApertureHostFaces.size(); ++aperture)
+			{
+				if (rkApertureHostFaces[aperture] >= faceCount || rkApertureVertexOffsets[aperture + 1] < rkApertureVertexOffsets[aperture])
+				{
+					throw std::invalid_argument("An aperture has an invalid host face or vertex range.");
+				}
+				faceApertures[rkApertureHostFaces[aperture]].push_back(aperture);
+			}
+		}
+
+		BuildingModel model;
+		model.name = rkParameters.buildingName;
+		model.northAxis = rkParameters.northAxis;
+		model.heatingTemp = rkParameters.heatingTemp;
+		model.coolingTemp = rkParameters.coolingTemp;
+
+		std::size_t cellCount = rkCells.CellCount();
+		std::vector<CellMetrics> metrics;
+		std::vector<unsigned char> undergroundFaces;
+		{
+			TraceSpan metricsSpan("ComputeCellMetrics");
+			metrics = ComputeCellMetrics(rkCells);
+			undergroundFaces = ComputeUndergroundFaces(rkCells);
+		}
+
+		FaceAdjacencyTable adjacency(rkParameters.tolerance);
+		std::vector<std::vector<std::size_t>> adjacencyIds(cellCount);
+		{
+			TraceSpan adjacencySpan("FaceAdjacency");
+			for (std::size_t cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+			{
+				for (std::size_t i = 0; i < rkCells.FaceCount(cellIndex); ++i)
+				{
+					std::size_t faceId = rkCells.FaceId(cellIndex, i);
+					adjacencyIds[cellIndex].push_back(adjacency.AddFace(cellIndex, rkCells.Coordinates(faceId), rkCells.VertexCount(faceId)));
+				}
+			}
+		}
+
+		TraceSpan surfacesSpan("AddSurfaces");
+
+		// Shared face id -> the surfaces created for it so far, to pair the two sides.
+		std::map<std::size_t, std::size_t> sharedSurfaces;
+		std::vector<int> storySpaceCounts(std::max<std::size_t>(rkParameters.floorLevels.size(), 1), 0);
+		for (std::size_t cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+		{
+			ModelSpace space;
+			space.storyIndex = StoryIndex(rkParameters.floorLevels, metrics[cellIndex].centroid[2]);
+			int spaceNumber = ++storySpaceCounts[space.storyIndex];
+			space.name = SpaceName(space.storyIndex, spaceNumber);
+			space.zoneName = ThermalZoneName(space.name);
+			space.volume = metrics[cellIndex].volume;
+			space.ceilingHeight = std::abs(metrics[cellIndex].maxPosition[2] - metrics[cellIndex].minPosition[2]);
+
+			std::vector<int> signs = ComputeOutwardSigns(rkCells, cellIndex);
+			for (std::size_t i = 0; i < rkCells.FaceCount(cellIndex); ++i)
+			{
+				std::size_t faceId = rkCells.FaceId(cellIndex, i);
+				const double* pkCoordinates = rkCells.Coordinates(faceId);
+				std::size_t vertexCount = rkCells.VertexCount(faceId);
+
+				ModelSurface surface;
+				surface.name = SurfaceName(space.name, i + 1);
+				surface.spaceIndex = model.spaces.size();
+				surface.adjacentSurface = -1;
+				surface.coordinates = signs[i] > 0
+					? std::vector<double>(pkCoordinates, pkCoordinates + vertexCount * 3)
+					: Reversed(pkCoordinates, vertexCount);
+				surface.type = FaceType(surface.coordinates);
+
+				std::size_t sharedFaceId = adjacencyIds[cellIndex][i];
+				surface.boundaryCondition = SurfaceBoundaryCondition(surface.type, adjacency.CellCount(sharedFaceId), undergroundFaces[faceId] != 0);
+				if (surface.boundaryCondition == BOUNDARY_SURFACE)
+				{
+					std::map<std::size_t, std::size_t>::iterator otherSide = sharedSurfaces.find(sharedFaceId);
+					if (otherSide == sharedSurfaces.end())
+					{
+						sharedSurfaces[sharedFaceId] = model.surfaces.size();
+					}
+					else
+					{
+						surface.adjacentSurface = (std::int64_t)otherSide->second;
+						model.surfaces[otherSide->second].adjacentSurface = (std::int64_t)model.surfaces.size();
+					}
+				}
+
+				if (surface.type == SURFACE_WALL && surface.boundaryCondition == BOUNDARY_OUTDOORS && rkParameters.glazingRatio == 0.0 && !faceApertures.empty())
+				{
+					double surfaceNormal[3];
+					NewellNormal(surface.coordinates.data(), vertexCount, surfaceNormal);
+					for (std::size_t aperture : faceApertures[faceId])
+					{
+						std::size_t apertureVertexCount = rkApertureVertexOffsets[aperture + 1] - rkApertureVertexOffsets[aperture];
+						const double* pkApertureCoordinates = &rkApertureCoordinates[rkApertureVertexOffsets[aperture] * 3];
+						double apertureNormal[3];
+						NewellNormal(pkApertureCoordinates, apertureVertexCount, apertureNormal);
+
+						// Skip small triangles
+						double area = 0.5 * std::sqrt(apertureNormal[0] * apertureNormal[0] + apertureNormal[1] * apertureNormal[1] + apertureNormal[2] * apertureNormal[2]);
+						if (area <= 0.1)
+						{
+							continue;
+						}
+
+						ModelSubSurface window;
+						window.name = SubSurfaceName(surface.name, surface.windows.size() + 1);
+						window.coordinates = apertureNormal[0] * surfaceNormal[0] + apertureNormal[1] * surfaceNormal[1] + apertureNormal[2] * surfaceNormal[2] < 0.0
+							? Reversed(pkApertureCoordinates, apertureVertexCount)
+							: std::vector<double>(pkApertureCoordinates, pkApertureCoordinates + apertureVertexCount * 3);
+						surface.windows.push_back(window);
+					}
+				}
+
+				if (surface.type == SURFACE_WALL && surface.boundaryCondition == BOUNDARY_OUTDOORS && rkParameters.glazingRatio > 0.0)
+				{
+					std::vector<double> layoutCoordinates;
+					std::vector<std::vector<double>> windows;
+					if (rkParameters.hasWindowLayout &&
+						LayoutWindows(surface.coordinates.data(), vertexCount, rkParameters.glazingRatio, rkParameters.windowLayout, layoutCoordinates))
+					{
+						for (std::size_t j = 0; j < layoutCoordinates.size(); j += 12)
+						{
+							windows.push_back(std::vector<double>(layoutCoordinates.begin() + j, layoutCoordinates.begin() + j + 12));
+						}
+					}
+					else
+					{
+						windows = ScaledWindows(surface.coordinates, rkParameters.glazingRatio);
+					}
+
+					for (std::size_t j = 0; j < windows.size(); ++j)
+					{
+						ModelSubSurface window;
+						window.name = SubSurfaceName(surface.name, j + 1);
+						window.coordinates = windows[j];
+						surface.windows.push_back(window);
+					}
+				}
+
+				space.surfaces.push_back(model.surfaces.size());
+				model.surfaces.push_back(surface);
+			}
+			model.spaces.push_back(space);
+		}
+		return model;
+	}
+}
@@ -0,0 +1,130 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "CellMetricsKernels.h"
+#include "WindowLayoutKernels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	enum SurfaceType
+	{
+		SURFACE_WALL,
+		SURFACE_FLOOR,
+		SURFACE_ROOFCEILING
+	};
+
+	enum BoundaryCondition
+	{
+		BOUNDARY_OUTDOORS,
+		BOUNDARY_GROUND,
+		BOUNDARY_SURFACE
+	};
+
+	struct ModelSubSurface
+	{
+		std::string name;
+		std::vector<double> coordinates;	// vertexCount x 3, wound like the parent surface
+	};
+
+	struct ModelSurface
+	{
+		std::string name;
+		SurfaceType type;
+		BoundaryCondition boundaryCondition;
+		std::size_t spaceIndex;
+		std::int64_t adjacentSurface;		// the matching surface of the adjacent space, or -1
+		std::vector<double> coordinates;	// vertexCount x 3, counterclockwise seen from outside the space
+		std::vector<ModelSubSurface> windows;
+	};
+
+	struct ModelSpace
+	{
+		std::string name;
+		std::string zoneName;
+		int storyIndex;
+		double volume;
+		double ceilingHeight;
+		std::vector<std::size_t> surfaces;
+	};
+
+	struct BuildingModelParameters
+	{
+		std::string buildingName;
+		std::vector<double> floorLevels;	// ascending
+		double northAxis;
+		double glazingRatio;				// 0 for no windows
+		bool hasWindowLayout;				// if false, windows are the scaled, triangulated walls
+		WindowLayoutParameters windowLayout;
+		double heatingTemp;
+		double coolingTemp;
+		double tolerance;					// for the shared-face matching
+	};
+
+	struct BuildingModel
+	{
+		std::string name;
+		double northAxis;
+		double heatingTemp;
+		double coolingTemp;
+		std::vector<ModelSpace> spaces;
+		std::vector<ModelSurface> surfaces;
+		std::vector<std::vector<double>> shadingSurfaces;
+	};
+
+	// The classification rules shared by BuildModel and EnergyModel.AddSurface. A face whose outward normal
+	// is within 5 degrees of up (angle in degrees) is a roof/ceiling, of down a floor, else a wall.
+	SurfaceType SurfaceTypeByUpAngle(double angle);
+
+	// A face shared by more than one cell is an interior surface. An exterior floor, or an exterior face
+	// that is underground (no vertex above z = 0, see ComputeUndergroundFaces), touches the ground; any
+	// other exterior face is outdoors.
+	BoundaryCondition SurfaceBoundaryCondition(SurfaceType type, std::size_t cellCount, bool isUnderground);
+
+	// The object names shared by BuildModel and EnergyModel.ByCellComplex: STORY_1, STORY_1_SPACE_1,
+	// STORY_1_SPACE_1_SURFACE_1, STORY_1_SPACE_1_SURFACE_1_SUBSURFACE_1 and STORY_1_SPACE_1_THERMAL_ZONE.
+	// Story indices are 0-based as returned by StoryIndex; the numbers are 1-based, spaces counted per story.
+	std::string StoryName(int storyIndex);
+	std::string SpaceName(int storyIndex, int spaceNumber);
+	std::string SurfaceName(const std::string& rkSpaceName, std::size_t surfaceNumber);
+	std::string SubSurfaceName(const std::string& rkSurfaceName, std::size_t subSurfaceNumber);
+	std::string ThermalZoneName(const std::string& rkSpaceName);
+
+	// Builds the energy model of a building from the faces of its cells, one space per cell, with the
+	// same rules as EnergyModel.ByCellComplex:
+	// - a face whose outward normal is within 5 degrees of up is a roof/ceiling, of down a floor, else a wall;
+	// - a face shared by two cells is an interior surface, matched with the face of the other cell;
+	// - an exterior face is underground if no vertex is above z = 0, and exterior floors touch the ground;
+	// - exterior above-ground walls get windows covering glazingRatio of their area.
+	// Every surface is wound counterclockwise seen from outside its space, as EnergyPlus expects.
+	BuildingModel BuildModel(const CellBuffer& rkCells, const BuildingModelParameters& rkParameters);
+
+	// Same as above, with aperture polygons hosted by the faces of the cells, in the layout of
+	// OsmGeometry. If glazingRatio is 0, the apertures of the exterior above-ground walls larger than
+	// 0.1 m2 become their windows, wound like the wall, as the face apertures in EnergyModel.ByCellComplex.
+	BuildingModel BuildModel(
+		const CellBuffer& rkCells,
+		const BuildingModelParameters& rkParameters,
+		const std::vector<double>& rkApertureCoordinates,
+		const std::vector<std::size_t>& rkApertureVertexOffsets,
+		const std::vector<std::size_t>& rkApertureHostFaces);
+}
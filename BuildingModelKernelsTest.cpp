@@ -0,0 +1,203 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+
+// Builds several synthetic buildings at the same time, as concurrent EnergyModel.ByCellComplex calls do
+// through their own ModelBuildContext, and checks that every model keeps only its own stories, spaces
+// and windows: each concurrent build must match the same build done alone.
+
+#include "BuildingModelKernels.h"
+#include "CellGridGenerator.h"
+#include "TraceRecorder.h"
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	const std::size_t ThreadCount = 4;
+	const std::size_t RepeatCount = 8;
+
+	struct BuildInput
+	{
+		TopologicEnergyCore::CellGrid grid;
+		TopologicEnergyCore::BuildingModelParameters parameters;
+	};
+
+	// What a build must not share with another: its stories, its spaces and its windows.
+	struct BuildSummary
+	{
+		std::set<int> storyIndices;
+		std::vector<std::string> spaceNames;
+		std::size_t surfaceCount;
+		std::size_t windowCount;
+	};
+
+	BuildInput MakeInput(std::size_t buildIndex)
+	{
+		TopologicEnergyCore::CellGridParameters gridParameters;
+		gridParameters.columns = 3 + buildIndex;
+		gridParameters.rows = 2 + buildIndex % 2;
+		gridParameters.stories = 1 + buildIndex;
+		gridParameters.roomWidth = 4.0;
+		gridParameters.roomDepth = 5.0;
+		gridParameters.storyHeight = 3.0;
+		gridParameters.courtyardColumns = 0;
+		gridParameters.courtyardRows = 0;
+		gridParameters.atriumColumns = 0;
+		gridParameters.atriumRows = 0;
+		gridParameters.apertureProbability = 0.25 * (double)(buildIndex + 1);
+		gridParameters.seed = 17 + (unsigned int)buildIndex;
+
+		BuildInput input;
+		input.grid = TopologicEnergyCore::GenerateCellGrid(gridParameters);
+		input.parameters.buildingName = "Building_" + std::to_string(buildIndex);
+		input.parameters.floorLevels = input.grid.floorLevels;
+		input.parameters.northAxis = 0.0;
+		input.parameters.glazingRatio = 0.0;
+		input.parameters.hasWindowLayout = false;
+		input.parameters.windowLayout.sillHeight = 0.9;
+		input.parameters.windowLayout.headHeight = 2.1;
+		input.parameters.windowLayout.windowSpacing = 3.0;
+		input.parameters.heatingTemp = 20.0;
+		input.parameters.coolingTemp = 25.0;
+		input.parameters.tolerance = 0.0001;
+		return input;
+	}
+
+	BuildSummary Build(const BuildInput& rkInput)
+	{
+		TopologicEnergyCore::BuildingModel model = TopologicEnergyCore::BuildModel(
+			rkInput.grid.cells, rkInput.parameters, rkInput.grid.apertureCoordinates, rkInput.grid.apertureVertexOffsets, rkInput.grid.apertureHostFaces);
+
+		BuildSummary summary;
+		for (const TopologicEnergyCore::ModelSpace& rkSpace : model.spaces)
+		{
+			summary.storyIndices.insert(rkSpace.storyIndex);
+			summary.spaceNames.push_back(rkSpace.name);
+		}
+		summary.surfaceCount = model.surfaces.size();
+		summary.windowCount = 0;
+		for (const TopologicEnergyCore::ModelSurface& rkSurface : model.surfaces)
+		{
+			summary.windowCount += rkSurface.windows.size();
+		}
+		return summary;
+	}
+
+	std::string Compare(const BuildSummary& rkExpected, const BuildSummary& rkActual)
+	{
+		std::ostringstream difference;
+		if (rkActual.storyIndices != rkExpected.storyIndices)
+		{
+			difference << " stories " << rkActual.storyIndices.size() << " instead of " << rkExpected.storyIndices.size() << ";";
+		}
+		if (rkActual.spaceNames != rkExpected.spaceNames)
+		{
+			difference << " spaces " << rkActual.spaceNames.size() << " instead of " << rkExpected.spaceNames.size() << ";";
+		}
+		if (rkActual.surfaceCount != rkExpected.surfaceCount)
+		{
+			difference << " surfaces " << rkActual.surfaceCount << " instead of " << rkExpected.surfaceCount << ";";
+		}
+		if (rkActual.windowCount != rkExpected.windowCount)
+		{
+			difference << " windows " << rkActual.windowCount << " instead of " << rkExpected.windowCount << ";";
+		}
+		return difference.str();
+	}
+}
+
+int main()
+{
+	std::vector<BuildInput> inputs;
+	std::vector<BuildSummary> expected;
+	try
+	{
+		for (std::size_t i = 0; i < ThreadCount; ++i)
+		{
+			inputs.push_back(MakeInput(i));
+			expected.push_back(Build(inputs.back()));
+		}
+	}
+	catch (const std::exception& rkException)
+	{
+		std::cerr << rkException.what() << "\n";
+		return 1;
+	}
+
+	// The serial builds differ from each other, so a model picking up another build's state shows.
+	for (std::size_t i = 1; i < ThreadCount; ++i)
+	{
+		if (expected[i].storyIndices.size() == expected[i - 1].storyIndices.size() || expected[i].windowCount == expected[i - 1].windowCount)
+		{
+			std::cerr << "Builds " << i - 1 << " and " << i << " have the same story or window count.\n";
+			return 1;
+		}
+	}
+
+	// Tracing is on, as in a traced run, so the build spans are recorded from every thread at once.
+	TopologicEnergyCore::EnableTracing(1 << 16);
+	std::vector<std::vector<std::string>> failures(ThreadCount);
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < ThreadCount; ++i)
+	{
+		threads.emplace_back([&inputs, &expected, &failures, i]()
+		{
+			for (std::size_t repeat = 0; repeat < RepeatCount; ++repeat)
+			{
+				try
+				{
+					std::string difference = Compare(expected[i], Build(inputs[i]));
+					if (!difference.empty())
+					{
+						failures[i].push_back(difference);
+					}
+				}
+				catch (const std::exception& rkException)
+				{
+					failures[i].push_back(std::string(" ") + rkException.what());
+				}
+			}
+		});
+	}
+	for (std::thread& rThread : threads)
+	{
+		rThread.join();
+	}
+	TopologicEnergyCore::DisableTracing();
+
+	int exitCode = 0;
+	for (std::size_t i = 0; i < ThreadCount; ++i)
+	{
+		for (const std::string& rkFailure : failures[i])
+		{
+			std::cerr << "Build " << i << ":" << rkFailure << "\n";
+			exitCode = 1;
+		}
+	}
+	if (exitCode == 0)
+	{
+		std::cout << ThreadCount << " concurrent builds x " << RepeatCount << " matched their serial builds.\n";
+	}
+	return exitCode;
+}
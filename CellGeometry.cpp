@@ -0,0 +1,166 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "CellGeometry.h"
+#include "FaceAdjacency.h"
+
+#include <algorithm>
+
+namespace TopologicEnergy
+{
+	static void GetWireCoordinates(Wire^ wire, std::vector<double>& rCoordinates)
+	{
+		rCoordinates.clear();
+		for each(Vertex^ vertex in wire->Vertices)
+		{
+			rCoordinates.push_back(vertex->X);
+			rCoordinates.push_back(vertex->Y);
+			rCoordinates.push_back(vertex->Z);
+		}
+	}
+
+	CellGeometry::CellGeometry(IList<Cell^>^ cells, IList<double>^ floorLevels)
+		: m_pBuffer(new TopologicEnergyCore::CellBuffer())
+		, m_pMetrics(nullptr)
+		, m_pUndergroundFaces(nullptr)
+		, m_storyNumbers(gcnew array<int>(cells->Count))
+	{
+		std::vector<double> coordinates;
+		for each(Cell^ cell in cells)
+		{
+			for each(Face^ face in cell->Faces)
+			{
+				// The boundaries in wire order: face->Vertices is in shape map order and mixes in the
+				// vertices of the inner boundaries.
+				GetWireCoordinates(face->ExternalBoundary, coordinates);
+				m_pBuffer->AddFace(coordinates.data(), coordinates.size() / 3);
+				for each(Wire^ innerBoundary in face->InternalBoundaries)
+				{
+					GetWireCoordinates(innerBoundary, coordinates);
+					m_pBuffer->AddHole(coordinates.data(), coordinates.size() / 3);
+				}
+			}
+			m_pBuffer->EndCell();
+		}
+
+		m_pMetrics = new std::vector<TopologicEnergyCore::CellMetrics>(TopologicEnergyCore::ComputeCellMetrics(*m_pBuffer));
+		m_pUndergroundFaces = new std::vector<unsigned char>(TopologicEnergyCore::ComputeUndergroundFaces(*m_pBuffer));
+
+		std::vector<double> levels;
+		if (floorLevels != nullptr)
+		{
+			for each(double floorLevel in floorLevels)
+			{
+				levels.push_back(floorLevel);
+			}
+		}
+		std::sort(levels.begin(), levels.end());
+		for (int i = 0; i < cells->Count; ++i)
+		{
+			m_storyNumbers[i] = TopologicEnergyCore::StoryIndex(levels, (*m_pMetrics)[i].centroid[2]);
+		}
+	}
+
+	CellGeometry::~CellGeometry()
+	{
+		this->!CellGeometry();
+	}
+
+	CellGeometry::!CellGeometry()
+	{
+		delete m_pBuffer;
+		m_pBuffer = nullptr;
+		delete m_pMetrics;
+		m_pMetrics = nullptr;
+		delete m_pUndergroundFaces;
+		m_pUndergroundFaces = nullptr;
+	}
+
+	int CellGeometry::CellCount::get()
+	{
+		return (int)m_pBuffer->CellCount();
+	}
+
+	double CellGeometry::Volume(int cellIndex)
+	{
+		return (*m_pMetrics)[cellIndex].volume;
+	}
+
+	Vertex^ CellGeometry::Centroid(int cellIndex)
+	{
+		const double* pkCentroid = (*m_pMetrics)[cellIndex].centroid;
+		return Vertex::ByCoordinates(pkCentroid[0], pkCentroid[1], pkCentroid[2]);
+	}
+
+	double CellGeometry::Height(int cellIndex)
+	{
+		const TopologicEnergyCore::CellMetrics& rkMetrics = (*m_pMetrics)[cellIndex];
+		return Math::Abs(rkMetrics.maxPosition[2] - rkMetrics.minPosition[2]);
+	}
+
+	int CellGeometry::StoryNumber(int cellIndex)
+	{
+		return m_storyNumbers[cellIndex];
+	}
+
+	bool CellGeometry::IsUnderground(int cellIndex, int faceIndex)
+	{
+		return (*m_pUndergroundFaces)[m_pBuffer->FaceId(cellIndex, faceIndex)] != 0;
+	}
+
+	Nullable<double> CellGeometry::ExteriorWallAzimuth(int cellIndex, FaceAdjacency^ faceAdjacency)
+	{
+		int faceCount = (int)m_pBuffer->FaceCount(cellIndex);
+		std::vector<unsigned char> exteriorFaces(faceCount, 0);
+		for (int i = 0; i < faceCount; ++i)
+		{
+			std::size_t faceId = m_pBuffer->FaceId(cellIndex, i);
+			exteriorFaces[i] = faceAdjacency->CellCount(cellIndex, i) < 2 && (*m_pUndergroundFaces)[faceId] == 0;
+		}
+
+		double normal[3];
+		if (!TopologicEnergyCore::LargestWallNormal(*m_pBuffer, cellIndex, exteriorFaces, normal))
+		{
+			return Nullable<double>();
+		}
+
+		double azimuth = Math::Atan2(normal[0], normal[1]) * 180.0 / Math::PI;
+		return azimuth < 0.0 ? azimuth + 360.0 : azimuth;
+	}
+
+	const TopologicEnergyCore::CellBuffer& CellGeometry::Buffer()
+	{
+		return *m_pBuffer;
+	}
+
+	void CellGeometry::Extents(double* pMinPosition, double* pMaxPosition)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			pMinPosition[k] = Double::MaxValue;
+			pMaxPosition[k] = -Double::MaxValue;
+		}
+
+		for (const TopologicEnergyCore::CellMetrics& rkMetrics : *m_pMetrics)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				pMinPosition[k] = Math::Min(pMinPosition[k], rkMetrics.minPosition[k]);
+				pMaxPosition[k] = Math::Max(pMaxPosition[k], rkMetrics.maxPosition[k]);
+			}
+		}
+	}
+}
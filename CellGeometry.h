@@ -0,0 +1,70 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "CellMetricsKernels.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace Topologic;
+
+namespace TopologicEnergy
+{
+	ref class FaceAdjacency;
+
+	// The faces of the cells of a building, read from Topologic once into a flat vertex buffer, with the
+	// per-cell metrics computed from it in one pass. Faces are indexed as in cell->Faces.
+	ref class CellGeometry
+	{
+	public:
+		CellGeometry(IList<Cell^>^ cells, IList<double>^ floorLevels);
+		~CellGeometry();
+		!CellGeometry();
+
+		property int CellCount
+		{
+			int get();
+		}
+
+		double Volume(int cellIndex);
+		Vertex^ Centroid(int cellIndex);
+
+		// The difference between the highest and the lowest vertex of the cell
+		double Height(int cellIndex);
+
+		// The index of the floor level below the centroid of the cell, or 0 if the centroid is outside the levels.
+		int StoryNumber(int cellIndex);
+
+		bool IsUnderground(int cellIndex, int faceIndex);
+
+		// The direction the largest exterior above-ground wall of the cell faces, in degrees clockwise from
+		// the model's +Y axis, or no value for a core cell without exterior walls.
+		Nullable<double> ExteriorWallAzimuth(int cellIndex, FaceAdjacency^ faceAdjacency);
+
+	internal:
+		const TopologicEnergyCore::CellBuffer& Buffer();
+
+		// The bounding box of all cells
+		void Extents(double* pMinPosition, double* pMaxPosition);
+
+	private:
+		TopologicEnergyCore::CellBuffer* m_pBuffer;
+		std::vector<TopologicEnergyCore::CellMetrics>* m_pMetrics;
+		std::vector<unsigned char>* m_pUndergroundFaces;
+		array<int>^ m_storyNumbers;
+	};
+}
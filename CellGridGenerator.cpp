@@ -0,0 +1,278 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "CellGridGenerator.h"
+#include "TraceRecorder.h"
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		enum GridPosition
+		{
+			GRID_OUTSIDE,
+			GRID_ROOM,
+			GRID_COURTYARD,
+			GRID_ATRIUM
+		};
+
+		class GridLayout
+		{
+		public:
+			explicit GridLayout(const CellGridParameters& rkParameters)
+				: m_parameters(rkParameters)
+				, m_courtyardColumn(0)
+				, m_courtyardRow(0)
+				, m_atriumColumn(0)
+				, m_atriumRow(0)
+			{
+				if (rkParameters.columns == 0 || rkParameters.rows == 0 || rkParameters.stories == 0)
+				{
+					throw std::invalid_argument("The grid must have at least one room along each axis.");
+				}
+				if (!(rkParameters.roomWidth > 0.0) || !(rkParameters.roomDepth > 0.0) || !(rkParameters.storyHeight > 0.0))
+				{
+					throw std::invalid_argument("The room dimensions must be positive.");
+				}
+				if (rkParameters.apertureProbability < 0.0 || rkParameters.apertureProbability > 1.0)
+				{
+					throw std::invalid_argument("The aperture probability must be between 0.0 and 1.0 (both inclusive).");
+				}
+
+				bool hasCourtyard = rkParameters.courtyardColumns > 0 && rkParameters.courtyardRows > 0;
+				if (hasCourtyard)
+				{
+					if (rkParameters.courtyardColumns >= rkParameters.columns || rkParameters.courtyardRows >= rkParameters.rows)
+					{
+						throw std::invalid_argument("The courtyard must be smaller than the grid.");
+					}
+					m_courtyardColumn = (rkParameters.columns - rkParameters.courtyardColumns) / 2;
+					m_courtyardRow = (rkParameters.rows - rkParameters.courtyardRows) / 2;
+				}
+
+				if (rkParameters.atriumColumns > 0 && rkParameters.atriumRows > 0)
+				{
+					std::size_t bandColumns = hasCourtyard ? m_courtyardColumn : rkParameters.columns;
+					if (rkParameters.atriumColumns + 2 > bandColumns || rkParameters.atriumRows + 2 > rkParameters.rows)
+					{
+						throw std::invalid_argument("The atrium must be surrounded by rooms.");
+					}
+					m_atriumColumn = (bandColumns - rkParameters.atriumColumns) / 2;
+					m_atriumRow = (rkParameters.rows - rkParameters.atriumRows) / 2;
+				}
+			}
+
+			GridPosition Position(std::int64_t column, std::int64_t row) const
+			{
+				if (column < 0 || row < 0 || column >= (std::int64_t)m_parameters.columns || row >= (std::int64_t)m_parameters.rows)
+				{
+					return GRID_OUTSIDE;
+				}
+				if (IsInBlock(column, row, m_courtyardColumn, m_courtyardRow, m_parameters.courtyardColumns, m_parameters.courtyardRows))
+				{
+					return GRID_COURTYARD;
+				}
+				if (IsInBlock(column, row, m_atriumColumn, m_atriumRow, m_parameters.atriumColumns, m_parameters.atriumRows))
+				{
+					return GRID_ATRIUM;
+				}
+				return GRID_ROOM;
+			}
+
+			std::size_t AtriumColumn() const { return m_atriumColumn; }
+			std::size_t AtriumRow() const { return m_atriumRow; }
+
+		private:
+			static bool IsInBlock(std::int64_t column, std::int64_t row, std::size_t blockColumn, std::size_t blockRow, std::size_t blockColumns, std::size_t blockRows)
+			{
+				return blockColumns > 0 && blockRows > 0 &&
+					column >= (std::int64_t)blockColumn && column < (std::int64_t)(blockColumn + blockColumns) &&
+					row >= (std::int64_t)blockRow && row < (std::int64_t)(blockRow + blockRows);
+			}
+
+			const CellGridParameters& m_parameters;
+			std::size_t m_courtyardColumn;
+			std::size_t m_courtyardRow;
+			std::size_t m_atriumColumn;
+			std::size_t m_atriumRow;
+		};
+
+		// The neighbour offsets of the four walls of a room: -y, +x, +y, -x
+		const int WallDirections[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+		// The wall of the room at (column, row) facing direction, from z0 to z1, counterclockwise seen from outside.
+		void WallCorners(const CellGridParameters& rkParameters, std::size_t column, std::size_t row, int direction, double z0, double z1, double* pCorners)
+		{
+			double x0 = column * rkParameters.roomWidth;
+			double x1 = x0 + rkParameters.roomWidth;
+			double y0 = row * rkParameters.roomDepth;
+			double y1 = y0 + rkParameters.roomDepth;
+
+			// Bottom edge from a to b, so that a, b, b + up, a + up is counterclockwise seen from outside
+			double a[2];
+			double b[2];
+			switch (direction)
+			{
+			case 0: a[0] = x0; a[1] = y0; b[0] = x1; b[1] = y0; break;
+			case 1: a[0] = x1; a[1] = y0; b[0] = x1; b[1] = y1; break;
+			case 2: a[0] = x1; a[1] = y1; b[0] = x0; b[1] = y1; break;
+			default: a[0] = x0; a[1] = y1; b[0] = x0; b[1] = y0; break;
+			}
+
+			const double corners[12] = {
+				a[0], a[1], z0,
+				b[0], b[1], z0,
+				b[0], b[1], z1,
+				a[0], a[1], z1 };
+			for (int i = 0; i < 12; ++i)
+			{
+				pCorners[i] = corners[i];
+			}
+		}
+
+		void HorizontalCorners(double x0, double y0, double x1, double y1, double z, bool isFacingUp, double* pCorners)
+		{
+			const double up[12] = { x0, y0, z, x1, y0, z, x1, y1, z, x0, y1, z };
+			const double down[12] = { x0, y0, z, x0, y1, z, x1, y1, z, x1, y0, z };
+			for (int i = 0; i < 12; ++i)
+			{
+				pCorners[i] = isFacingUp ? up[i] : down[i];
+			}
+		}
+	}
+
+	CellGrid GenerateCellGrid(const CellGridParameters& rkParameters)
+	{
+		TraceSpan span("GenerateCellGrid");
+		GridLayout layout(rkParameters);
+		std::mt19937 generator(rkParameters.seed);
+		std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+		CellGrid grid;
+		for (std::size_t story = 0; story <= rkParameters.stories; ++story)
+		{
+			grid.floorLevels.push_back(story * rkParameters.storyHeight);
+		}
+		grid.apertureVertexOffsets.push_back(0);
+
+		double corners[12];
+		std::size_t faceId = 0;
+		for (std::size_t story = 0; story < rkParameters.stories; ++story)
+		{
+			double z0 = story * rkParameters.storyHeight;
+			double z1 = z0 + rkParameters.storyHeight;
+			for (std::size_t row = 0; row < rkParameters.rows; ++row)
+			{
+				for (std::size_t column = 0; column < rkParameters.columns; ++column)
+				{
+					if (layout.Position((std::int64_t)column, (std::int64_t)row) != GRID_ROOM)
+					{
+						continue;
+					}
+
+					double x0 = column * rkParameters.roomWidth;
+					double y0 = row * rkParameters.roomDepth;
+					HorizontalCorners(x0, y0, x0 + rkParameters.roomWidth, y0 + rkParameters.roomDepth, z0, false, corners);
+					grid.cells.AddFace(corners, 4);
+					HorizontalCorners(x0, y0, x0 + rkParameters.roomWidth, y0 + rkParameters.roomDepth, z1, true, corners);
+					grid.cells.AddFace(corners, 4);
+					faceId += 2;
+
+					for (int direction = 0; direction < 4; ++direction)
+					{
+						WallCorners(rkParameters, column, row, direction, z0, z1, corners);
+						grid.cells.AddFace(corners, 4);
+
+						GridPosition neighbour = layout.Position((std::int64_t)column + WallDirections[direction][0], (std::int64_t)row + WallDirections[direction][1]);
+						bool isExterior = neighbour == GRID_OUTSIDE || neighbour == GRID_COURTYARD;
+						if (isExterior && unit(generator) < rkParameters.apertureProbability)
+						{
+							// A rectangle of 30-80% of the wall width and 30-60% of its height, above a sill of 10-30%
+							double widthRatio = 0.3 + 0.5 * unit(generator);
+							double heightRatio = 0.3 + 0.3 * unit(generator);
+							double sillRatio = 0.1 + 0.2 * unit(generator);
+							double offsetRatio = (1.0 - widthRatio) * unit(generator);
+							double start[3];
+							double edge[3];
+							for (int k = 0; k < 3; ++k)
+							{
+								start[k] = corners[k];
+								edge[k] = corners[3 + k] - corners[k];
+							}
+							double bottom = z0 + sillRatio * rkParameters.storyHeight;
+							double top = bottom + heightRatio * rkParameters.storyHeight;
+							const double u[4] = { offsetRatio, offsetRatio + widthRatio, offsetRatio + widthRatio, offsetRatio };
+							const double z[4] = { bottom, bottom, top, top };
+							for (int j = 0; j < 4; ++j)
+							{
+								grid.apertureCoordinates.push_back(start[0] + u[j] * edge[0]);
+								grid.apertureCoordinates.push_back(start[1] + u[j] * edge[1]);
+								grid.apertureCoordinates.push_back(z[j]);
+							}
+							grid.apertureVertexOffsets.push_back(grid.apertureCoordinates.size() / 3);
+							grid.apertureHostFaces.push_back(faceId);
+						}
+						++faceId;
+					}
+					grid.cells.EndCell();
+				}
+			}
+		}
+
+		if (rkParameters.atriumColumns > 0 && rkParameters.atriumRows > 0)
+		{
+			double x0 = layout.AtriumColumn() * rkParameters.roomWidth;
+			double y0 = layout.AtriumRow() * rkParameters.roomDepth;
+			double x1 = x0 + rkParameters.atriumColumns * rkParameters.roomWidth;
+			double y1 = y0 + rkParameters.atriumRows * rkParameters.roomDepth;
+			double height = rkParameters.stories * rkParameters.storyHeight;
+			HorizontalCorners(x0, y0, x1, y1, 0.0, false, corners);
+			grid.cells.AddFace(corners, 4);
+			HorizontalCorners(x0, y0, x1, y1, height, true, corners);
+			grid.cells.AddFace(corners, 4);
+
+			// One wall piece per story and per room along each side, matching the wall of that room
+			for (std::size_t story = 0; story < rkParameters.stories; ++story)
+			{
+				double z0 = story * rkParameters.storyHeight;
+				double z1 = z0 + rkParameters.storyHeight;
+				for (std::size_t row = layout.AtriumRow(); row < layout.AtriumRow() + rkParameters.atriumRows; ++row)
+				{
+					for (std::size_t column = layout.AtriumColumn(); column < layout.AtriumColumn() + rkParameters.atriumColumns; ++column)
+					{
+						for (int direction = 0; direction < 4; ++direction)
+						{
+							if (layout.Position((std::int64_t)column + WallDirections[direction][0], (std::int64_t)row + WallDirections[direction][1]) != GRID_ATRIUM)
+							{
+								WallCorners(rkParameters, column, row, direction, z0, z1, corners);
+								grid.cells.AddFace(corners, 4);
+							}
+						}
+					}
+				}
+			}
+			grid.cells.EndCell();
+		}
+
+		span.SetAttribute("cells", (std::int64_t)grid.cells.CellCount());
+		return grid;
+	}
+}
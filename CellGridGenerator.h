@@ -0,0 +1,65 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "CellMetricsKernels.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	struct CellGridParameters
+	{
+		std::size_t columns;				// rooms along x
+		std::size_t rows;					// rooms along y
+		std::size_t stories;
+		double roomWidth;					// x
+		double roomDepth;					// y
+		double storyHeight;
+		std::size_t courtyardColumns;		// 0 for no courtyard
+		std::size_t courtyardRows;
+		std::size_t atriumColumns;			// 0 for no atrium
+		std::size_t atriumRows;
+		double apertureProbability;			// of each exterior wall getting an aperture
+		unsigned int seed;
+	};
+
+	// A synthetic building: the cells of a cell complex, its floor levels and the apertures of its
+	// exterior walls, in the layout of OsmGeometry.
+	struct CellGrid
+	{
+		CellBuffer cells;
+		std::vector<double> floorLevels;
+		std::vector<double> apertureCoordinates;		// vertexCount x 3
+		std::vector<std::size_t> apertureVertexOffsets;	// apertureCount + 1
+		std::vector<std::size_t> apertureHostFaces;		// the face id of the host wall of each aperture
+	};
+
+	// Generates columns x rows x stories box rooms, to measure how the model pipeline scales:
+	// - a courtyard removes the central courtyardColumns x courtyardRows rooms of every story;
+	// - an atrium replaces a block of atriumColumns x atriumRows rooms of every story by one cell as tall
+	//   as the building, its walls split where they meet the rooms so that every shared face matches.
+	//   The atrium is centred, or, with a courtyard, centred between the courtyard and the x = 0 side.
+	//   It must be surrounded by rooms;
+	// - each exterior wall of a room gets a rectangular aperture with apertureProbability, of random
+	//   size and position within the wall. The same parameters always give the same grid.
+	// Faces are wound counterclockwise seen from outside their cell. Throws std::invalid_argument if
+	// the courtyard or the atrium does not fit.
+	CellGrid GenerateCellGrid(const CellGridParameters& rkParameters);
+}
@@ -0,0 +1,430 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "CellMetricsKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		const double VertexTolerance = 0.0001;
+
+		typedef std::map<std::array<std::int64_t, 3>, std::size_t> VertexIds;
+
+		// Undirected edge -> (face, true if the face goes from the lower to the higher vertex id)
+		typedef std::map<std::pair<std::size_t, std::size_t>, std::vector<std::pair<std::size_t, bool>>> EdgeFaces;
+
+		// -1 if the hole is wound like the outer boundary of its face and has to be reversed to be
+		// subtracted, +1 otherwise. pHoleNormal receives the Newell normal of the hole as stored.
+		int HoleSign(const CellBuffer& rkBuffer, std::size_t faceId, std::size_t holeIndex, const double* pkOuterNormal, double* pHoleNormal)
+		{
+			NewellNormal(rkBuffer.HoleCoordinates(faceId, holeIndex), rkBuffer.HoleVertexCount(faceId, holeIndex), pHoleNormal);
+			double dot = pHoleNormal[0] * pkOuterNormal[0] + pHoleNormal[1] * pkOuterNormal[1] + pHoleNormal[2] * pkOuterNormal[2];
+			return dot > 0.0 ? -1 : 1;
+		}
+
+		// Adds the edges of a boundary of the face, walked backwards if isReversed.
+		void AddLoopEdges(const double* pkCoordinates, std::size_t vertexCount, bool isReversed, std::size_t face, VertexIds& rVertexIds, EdgeFaces& rEdgeFaces)
+		{
+			std::vector<std::size_t> loopVertexIds;
+			for (std::size_t j = 0; j < vertexCount; ++j)
+			{
+				std::array<std::int64_t, 3> key;
+				for (std::size_t k = 0; k < 3; ++k)
+				{
+					key[k] = (std::int64_t)std::llround(pkCoordinates[j * 3 + k] / VertexTolerance);
+				}
+				loopVertexIds.push_back(rVertexIds.emplace(key, rVertexIds.size()).first->second);
+			}
+
+			for (std::size_t j = 0; j < loopVertexIds.size(); ++j)
+			{
+				std::size_t from = loopVertexIds[j];
+				std::size_t to = loopVertexIds[(j + 1) % loopVertexIds.size()];
+				if (isReversed)
+				{
+					std::swap(from, to);
+				}
+				if (from == to)
+				{
+					continue;
+				}
+				rEdgeFaces[std::make_pair(std::min(from, to), std::max(from, to))].push_back(std::make_pair(face, from < to));
+			}
+		}
+
+		// Signs (+1 or -1) to apply to the vertex order of each face so that every shared edge is
+		// traversed in opposite directions by its two faces. The holes are walked against their outer
+		// boundary, so that a face filling a hole is oriented through the edges it shares with the hole.
+		std::vector<int> OrientFaces(const CellBuffer& rkBuffer, std::size_t cellIndex)
+		{
+			std::size_t faceCount = rkBuffer.FaceCount(cellIndex);
+			VertexIds vertexIds;
+			EdgeFaces edgeFaces;
+			for (std::size_t i = 0; i < faceCount; ++i)
+			{
+				std::size_t faceId = rkBuffer.FaceId(cellIndex, i);
+				AddLoopEdges(rkBuffer.Coordinates(faceId), rkBuffer.VertexCount(faceId), false, i, vertexIds, edgeFaces);
+				if (rkBuffer.HoleCount(faceId) == 0)
+				{
+					continue;
+				}
+
+				double outerNormal[3];
+				NewellNormal(rkBuffer.Coordinates(faceId), rkBuffer.VertexCount(faceId), outerNormal);
+				for (std::size_t h = 0; h < rkBuffer.HoleCount(faceId); ++h)
+				{
+					double holeNormal[3];
+					bool isReversed = HoleSign(rkBuffer, faceId, h, outerNormal, holeNormal) < 0;
+					AddLoopEdges(rkBuffer.HoleCoordinates(faceId, h), rkBuffer.HoleVertexCount(faceId, h), isReversed, i, vertexIds, edgeFaces);
+				}
+			}
+
+			std::vector<std::vector<std::pair<std::size_t, bool>>> neighbours(faceCount);
+			for (const auto& rkEdge : edgeFaces)
+			{
+				const std::vector<std::pair<std::size_t, bool>>& rkFaces = rkEdge.second;
+				if (rkFaces.size() != 2)
+				{
+					continue;
+				}
+				// Same direction along the edge: one of the two faces has to be flipped.
+				bool isFlipped = rkFaces[0].second == rkFaces[1].second;
+				neighbours[rkFaces[0].first].push_back(std::make_pair(rkFaces[1].first, isFlipped));
+				neighbours[rkFaces[1].first].push_back(std::make_pair(rkFaces[0].first, isFlipped));
+			}
+
+			std::vector<int> signs(faceCount, 0);
+			std::vector<std::size_t> stack;
+			for (std::size_t seed = 0; seed < faceCount; ++seed)
+			{
+				if (signs[seed] != 0)
+				{
+					continue;
+				}
+				signs[seed] = 1;
+				stack.push_back(seed);
+				while (!stack.empty())
+				{
+					std::size_t face = stack.back();
+					stack.pop_back();
+					for (const std::pair<std::size_t, bool>& rkNeighbour : neighbours[face])
+					{
+						if (signs[rkNeighbour.first] == 0)
+						{
+							signs[rkNeighbour.first] = rkNeighbour.second ? -signs[face] : signs[face];
+							stack.push_back(rkNeighbour.first);
+						}
+					}
+				}
+			}
+			return signs;
+		}
+
+		// Adds the signed volumes of the tetrahedra from the origin to a fan triangulation of a boundary,
+		// and their volume-weighted centroids relative to the origin.
+		void AddFanTetrahedra(const double* pkCoordinates, std::size_t vertexCount, int sign, const double* pkOrigin, double& rVolume, double* pWeightedCentroid)
+		{
+			for (std::size_t j = 1; j + 1 < vertexCount; ++j)
+			{
+				double a[3], b[3], c[3];
+				for (int k = 0; k < 3; ++k)
+				{
+					a[k] = pkCoordinates[k] - pkOrigin[k];
+					b[k] = pkCoordinates[j * 3 + k] - pkOrigin[k];
+					c[k] = pkCoordinates[(j + 1) * 3 + k] - pkOrigin[k];
+				}
+				double tetrahedronVolume = sign * (
+					a[0] * (b[1] * c[2] - b[2] * c[1]) -
+					a[1] * (b[0] * c[2] - b[2] * c[0]) +
+					a[2] * (b[0] * c[1] - b[1] * c[0])) / 6.0;
+				rVolume += tetrahedronVolume;
+				for (int k = 0; k < 3; ++k)
+				{
+					pWeightedCentroid[k] += tetrahedronVolume * (a[k] + b[k] + c[k]) / 4.0;
+				}
+			}
+		}
+	}
+
+	void FaceNormal(const CellBuffer& rkBuffer, std::size_t faceId, double* pNormal)
+	{
+		NewellNormal(rkBuffer.Coordinates(faceId), rkBuffer.VertexCount(faceId), pNormal);
+		double outerNormal[3] = { pNormal[0], pNormal[1], pNormal[2] };
+		for (std::size_t h = 0; h < rkBuffer.HoleCount(faceId); ++h)
+		{
+			double holeNormal[3];
+			int sign = HoleSign(rkBuffer, faceId, h, outerNormal, holeNormal);
+			for (int k = 0; k < 3; ++k)
+			{
+				pNormal[k] += sign * holeNormal[k];
+			}
+		}
+	}
+
+	std::vector<int> ComputeOutwardSigns(const CellBuffer& rkBuffer, std::size_t cellIndex)
+	{
+		std::size_t faceCount = rkBuffer.FaceCount(cellIndex);
+		if (faceCount == 0)
+		{
+			return std::vector<int>();
+		}
+
+		// Consistent orientations, then outward: the signed volume must be positive.
+		std::vector<int> signs = OrientFaces(rkBuffer, cellIndex);
+		const double* pkOrigin = rkBuffer.Coordinates(rkBuffer.FaceId(cellIndex, 0));
+		double signedVolume = 0.0;
+		for (std::size_t i = 0; i < faceCount; ++i)
+		{
+			std::size_t faceId = rkBuffer.FaceId(cellIndex, i);
+			const double* pkCoordinates = rkBuffer.Coordinates(faceId);
+			double normal[3];
+			FaceNormal(rkBuffer, faceId, normal);
+			for (int k = 0; k < 3; ++k)
+			{
+				signedVolume += signs[i] * normal[k] * (pkCoordinates[k] - pkOrigin[k]) / 6.0;
+			}
+		}
+
+		if (signedVolume < 0.0)
+		{
+			for (int& rSign : signs)
+			{
+				rSign = -rSign;
+			}
+		}
+		return signs;
+	}
+
+	bool LargestWallNormal(const CellBuffer& rkBuffer, std::size_t cellIndex, const std::vector<unsigned char>& rkFaceMask, double* pOutwardNormal)
+	{
+		std::vector<int> signs = ComputeOutwardSigns(rkBuffer, cellIndex);
+		double largestArea = 0.0;
+		for (std::size_t i = 0; i < signs.size(); ++i)
+		{
+			if (rkFaceMask[i] == 0)
+			{
+				continue;
+			}
+
+			std::size_t faceId = rkBuffer.FaceId(cellIndex, i);
+			double normal[3];
+			FaceNormal(rkBuffer, faceId, normal);
+			double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length <= 0.0 || std::abs(normal[2]) / length >= 0.1 || length <= largestArea)
+			{
+				continue;
+			}
+
+			largestArea = length;
+			for (int k = 0; k < 3; ++k)
+			{
+				pOutwardNormal[k] = signs[i] * normal[k] / length;
+			}
+		}
+		return largestArea > 0.0;
+	}
+
+	void NewellNormal(const double* pkCoordinates, std::size_t vertexCount, double* pNormal)
+	{
+		pNormal[0] = 0.0;
+		pNormal[1] = 0.0;
+		pNormal[2] = 0.0;
+		for (std::size_t j = 0; j < vertexCount; ++j)
+		{
+			const double* pkCurrent = pkCoordinates + j * 3;
+			const double* pkNext = pkCoordinates + ((j + 1) % vertexCount) * 3;
+			pNormal[0] += (pkCurrent[1] - pkNext[1]) * (pkCurrent[2] + pkNext[2]);
+			pNormal[1] += (pkCurrent[2] - pkNext[2]) * (pkCurrent[0] + pkNext[0]);
+			pNormal[2] += (pkCurrent[0] - pkNext[0]) * (pkCurrent[1] + pkNext[1]);
+		}
+	}
+
+	CellBuffer::CellBuffer()
+		: m_faceVertexOffsets(1, 0)
+		, m_cellFaceOffsets(1, 0)
+		, m_holeVertexOffsets(1, 0)
+		, m_faceHoleOffsets(1, 0)
+	{
+	}
+
+	CellBuffer::CellBuffer(std::vector<double>&& rrCoordinates, std::vector<std::size_t>&& rrFaceVertexOffsets, std::vector<std::size_t>&& rrCellFaceOffsets)
+		: m_coordinates(std::move(rrCoordinates))
+		, m_faceVertexOffsets(std::move(rrFaceVertexOffsets))
+		, m_cellFaceOffsets(std::move(rrCellFaceOffsets))
+		, m_holeVertexOffsets(1, 0)
+	{
+		if (m_coordinates.size() % 3 != 0 ||
+			m_faceVertexOffsets.empty() || m_faceVertexOffsets.front() != 0 || m_faceVertexOffsets.back() != m_coordinates.size() / 3 ||
+			m_cellFaceOffsets.empty() || m_cellFaceOffsets.front() != 0 || m_cellFaceOffsets.back() != m_faceVertexOffsets.size() - 1 ||
+			!std::is_sorted(m_faceVertexOffsets.begin(), m_faceVertexOffsets.end()) ||
+			!std::is_sorted(m_cellFaceOffsets.begin(), m_cellFaceOffsets.end()))
+		{
+			throw std::invalid_argument("The cell buffer arrays are inconsistent.");
+		}
+		m_faceHoleOffsets.assign(m_faceVertexOffsets.size(), 0);
+	}
+
+	void CellBuffer::AddFace(const double* pkCoordinates, std::size_t vertexCount)
+	{
+		m_coordinates.insert(m_coordinates.end(), pkCoordinates, pkCoordinates + vertexCount * 3);
+		m_faceVertexOffsets.push_back(m_faceVertexOffsets.back() + vertexCount);
+		m_faceHoleOffsets.push_back(m_faceHoleOffsets.back());
+	}
+
+	void CellBuffer::AddHole(const double* pkCoordinates, std::size_t vertexCount)
+	{
+		if (m_faceHoleOffsets.size() < 2)
+		{
+			throw std::logic_error("A hole must follow the face it belongs to.");
+		}
+		m_holeCoordinates.insert(m_holeCoordinates.end(), pkCoordinates, pkCoordinates + vertexCount * 3);
+		m_holeVertexOffsets.push_back(m_holeVertexOffsets.back() + vertexCount);
+		++m_faceHoleOffsets.back();
+	}
+
+	void CellBuffer::EndCell()
+	{
+		m_cellFaceOffsets.push_back(m_faceVertexOffsets.size() - 1);
+	}
+
+	std::vector<CellMetrics> ComputeCellMetrics(const CellBuffer& rkBuffer)
+	{
+		std::vector<CellMetrics> metrics(rkBuffer.CellCount());
+		for (std::size_t cellIndex = 0; cellIndex < metrics.size(); ++cellIndex)
+		{
+			CellMetrics& rMetrics = metrics[cellIndex];
+			for (int k = 0; k < 3; ++k)
+			{
+				rMetrics.minPosition[k] = std::numeric_limits<double>::infinity();
+				rMetrics.maxPosition[k] = -std::numeric_limits<double>::infinity();
+				rMetrics.centroid[k] = 0.0;
+			}
+			rMetrics.volume = 0.0;
+
+			std::size_t faceCount = rkBuffer.FaceCount(cellIndex);
+			if (faceCount == 0)
+			{
+				continue;
+			}
+
+			// Extents and vertex average; the first vertex is also the origin of the tetrahedra below,
+			// which keeps the products small for models far from (0, 0, 0).
+			const double* pkOrigin = rkBuffer.Coordinates(rkBuffer.FaceId(cellIndex, 0));
+			double vertexSum[3] = { 0.0, 0.0, 0.0 };
+			std::size_t vertexCount = 0;
+			for (std::size_t i = 0; i < faceCount; ++i)
+			{
+				std::size_t faceId = rkBuffer.FaceId(cellIndex, i);
+				const double* pkCoordinates = rkBuffer.Coordinates(faceId);
+				for (std::size_t j = 0; j < rkBuffer.VertexCount(faceId); ++j)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						double value = pkCoordinates[j * 3 + k];
+						rMetrics.minPosition[k] = std::min(rMetrics.minPosition[k], value);
+						rMetrics.maxPosition[k] = std::max(rMetrics.maxPosition[k], value);
+						vertexSum[k] += value - pkOrigin[k];
+					}
+					++vertexCount;
+				}
+			}
+
+			// Divergence theorem over a fan triangulation of each face, less its holes; exact for planar
+			// polygons, convex or not.
+			std::vector<int> signs = OrientFaces(rkBuffer, cellIndex);
+			double volume = 0.0;
+			double weightedCentroid[3] = { 0.0, 0.0, 0.0 };
+			for (std::size_t i = 0; i < faceCount; ++i)
+			{
+				std::size_t faceId = rkBuffer.FaceId(cellIndex, i);
+				const double* pkCoordinates = rkBuffer.Coordinates(faceId);
+				AddFanTetrahedra(pkCoordinates, rkBuffer.VertexCount(faceId), signs[i], pkOrigin, volume, weightedCentroid);
+				if (rkBuffer.HoleCount(faceId) == 0)
+				{
+					continue;
+				}
+
+				double outerNormal[3];
+				NewellNormal(pkCoordinates, rkBuffer.VertexCount(faceId), outerNormal);
+				for (std::size_t h = 0; h < rkBuffer.HoleCount(faceId); ++h)
+				{
+					double holeNormal[3];
+					int holeSign = HoleSign(rkBuffer, faceId, h, outerNormal, holeNormal);
+					AddFanTetrahedra(rkBuffer.HoleCoordinates(faceId, h), rkBuffer.HoleVertexCount(faceId, h), signs[i] * holeSign, pkOrigin, volume, weightedCentroid);
+				}
+			}
+
+			double scale = std::max(rMetrics.maxPosition[0] - rMetrics.minPosition[0],
+				std::max(rMetrics.maxPosition[1] - rMetrics.minPosition[1], rMetrics.maxPosition[2] - rMetrics.minPosition[2]));
+			if (std::abs(volume) > 1e-9 * scale * scale * scale)
+			{
+				// The sign only depends on the orientation chosen for the first face.
+				rMetrics.volume = std::abs(volume);
+				for (int k = 0; k < 3; ++k)
+				{
+					rMetrics.centroid[k] = pkOrigin[k] + weightedCentroid[k] / volume;
+				}
+			}
+			else
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					rMetrics.centroid[k] = pkOrigin[k] + vertexSum[k] / (double)vertexCount;
+				}
+			}
+		}
+		return metrics;
+	}
+
+	std::vector<unsigned char> ComputeUndergroundFaces(const CellBuffer& rkBuffer)
+	{
+		std::size_t faceCount = rkBuffer.CellCount() == 0 ? 0 : rkBuffer.FaceId(rkBuffer.CellCount() - 1, rkBuffer.FaceCount(rkBuffer.CellCount() - 1));
+		std::vector<unsigned char> undergroundFaces(faceCount, 1);
+		for (std::size_t faceId = 0; faceId < faceCount; ++faceId)
+		{
+			const double* pkCoordinates = rkBuffer.Coordinates(faceId);
+			for (std::size_t j = 0; j < rkBuffer.VertexCount(faceId); ++j)
+			{
+				if (pkCoordinates[j * 3 + 2] > 0.0)
+				{
+					undergroundFaces[faceId] = 0;
+					break;
+				}
+			}
+		}
+		return undergroundFaces;
+	}
+
+	int StoryIndex(const std::vector<double>& rkLevels, double z)
+	{
+		std::vector<double>::const_iterator upper = std::lower_bound(rkLevels.begin(), rkLevels.end(), z);
+		if (upper == rkLevels.begin() || upper == rkLevels.end() || !(*upper > z))
+		{
+			return 0;
+		}
+		return (int)(upper - rkLevels.begin()) - 1;
+	}
+}
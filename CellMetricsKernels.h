@@ -0,0 +1,109 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	// The faces of a set of cells as one flat vertex buffer, filled once from Topologic and shared by
+	// the metrics pass and the face adjacency table.
+	class CellBuffer
+	{
+	public:
+		CellBuffer();
+
+		// Takes over flat arrays: vertexCount x 3 coordinates, faceCount + 1 vertex offsets and
+		// cellCount + 1 face offsets, both starting at 0 and ending at the vertex and face counts.
+		CellBuffer(std::vector<double>&& rrCoordinates, std::vector<std::size_t>&& rrFaceVertexOffsets, std::vector<std::size_t>&& rrCellFaceOffsets);
+
+		// Appends a face of vertexCount x 3 coordinates to the current cell: the vertices of its outer
+		// boundary, in boundary order.
+		void AddFace(const double* pkCoordinates, std::size_t vertexCount);
+
+		// Adds a hole, the vertices of an inner boundary in boundary order, to the last face. Its winding
+		// does not have to be opposite to the outer boundary's; the metrics subtract it either way.
+		void AddHole(const double* pkCoordinates, std::size_t vertexCount);
+
+		// Closes the current cell; the next faces belong to a new cell.
+		void EndCell();
+
+		std::size_t CellCount() const { return m_cellFaceOffsets.size() - 1; }
+		std::size_t FaceCount(std::size_t cellIndex) const { return m_cellFaceOffsets[cellIndex + 1] - m_cellFaceOffsets[cellIndex]; }
+
+		// The index of the face among the faces of all cells
+		std::size_t FaceId(std::size_t cellIndex, std::size_t faceIndex) const { return m_cellFaceOffsets[cellIndex] + faceIndex; }
+		std::size_t VertexCount(std::size_t faceId) const { return m_faceVertexOffsets[faceId + 1] - m_faceVertexOffsets[faceId]; }
+		const double* Coordinates(std::size_t faceId) const { return &m_coordinates[m_faceVertexOffsets[faceId] * 3]; }
+
+		std::size_t HoleCount(std::size_t faceId) const { return m_faceHoleOffsets[faceId + 1] - m_faceHoleOffsets[faceId]; }
+		std::size_t HoleVertexCount(std::size_t faceId, std::size_t holeIndex) const { std::size_t holeId = m_faceHoleOffsets[faceId] + holeIndex; return m_holeVertexOffsets[holeId + 1] - m_holeVertexOffsets[holeId]; }
+		const double* HoleCoordinates(std::size_t faceId, std::size_t holeIndex) const { return &m_holeCoordinates[m_holeVertexOffsets[m_faceHoleOffsets[faceId] + holeIndex] * 3]; }
+
+		// The flat arrays of the outer boundaries, e.g. to share them with other runtimes without copying
+		const std::vector<double>& CoordinateArray() const { return m_coordinates; }
+		const std::vector<std::size_t>& FaceVertexOffsets() const { return m_faceVertexOffsets; }
+		const std::vector<std::size_t>& CellFaceOffsets() const { return m_cellFaceOffsets; }
+
+	private:
+		std::vector<double> m_coordinates;
+		std::vector<std::size_t> m_faceVertexOffsets;
+		std::vector<std::size_t> m_cellFaceOffsets;
+		std::vector<double> m_holeCoordinates;
+		std::vector<std::size_t> m_holeVertexOffsets;
+		std::vector<std::size_t> m_faceHoleOffsets;
+	};
+
+	struct CellMetrics
+	{
+		double centroid[3];
+		double minPosition[3];
+		double maxPosition[3];
+		double volume;
+	};
+
+	// Computes the volume, centroid and extents of every cell. The face orientations are made
+	// consistent across shared edges, including the edges of holes, before integrating, since Topologic
+	// does not guarantee outward vertex order. The holes of a face are subtracted from it. If a cell is
+	// not closed, its centroid falls back to the average of its vertices.
+	std::vector<CellMetrics> ComputeCellMetrics(const CellBuffer& rkBuffer);
+
+	// A face is underground if none of its vertices is above z = 0. Indexed by face id.
+	std::vector<unsigned char> ComputeUndergroundFaces(const CellBuffer& rkBuffer);
+
+	// The Newell normal of a polygon of vertexCount x 3 coordinates: its length is twice the area of the
+	// polygon, and it follows the winding by the right-hand rule.
+	void NewellNormal(const double* pkCoordinates, std::size_t vertexCount, double* pNormal);
+
+	// The Newell normal of a face of the buffer, net of its holes.
+	void FaceNormal(const CellBuffer& rkBuffer, std::size_t faceId, double* pNormal);
+
+	// For every face of the cell, +1 if the winding of its outer boundary gives an outward normal, -1 if
+	// it has to be reversed.
+	std::vector<int> ComputeOutwardSigns(const CellBuffer& rkBuffer, std::size_t cellIndex);
+
+	// Finds the largest face of the cell that is nearly vertical (|normal.z| < 0.1) and for which
+	// rkFaceMask[i] is non-zero, e.g. its exterior above-ground walls. The mask is indexed by the face's
+	// position in the cell and has FaceCount(cellIndex) entries. Returns false if there is none;
+	// otherwise pOutwardNormal receives its unit outward normal.
+	bool LargestWallNormal(const CellBuffer& rkBuffer, std::size_t cellIndex, const std::vector<unsigned char>& rkFaceMask, double* pOutwardNormal);
+
+	// Returns i such that rkLevels[i] < z < rkLevels[i + 1], or 0 if there is none. The levels must
+	// be in ascending order.
+	int StoryIndex(const std::vector<double>& rkLevels, double z);
+}
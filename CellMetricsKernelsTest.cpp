@@ -0,0 +1,189 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Checks the cell metrics against cells whose faces would give wrong metrics if they were read in
+// the wrong vertex order or without their inner boundaries: a non-convex prism, whose faces differ
+// from their shape map order, and a box whose top face has a hole filled by another face.
+
+#include "CellMetricsKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const double Tolerance = 1e-9;
+
+	// An L-shaped footprint of area 3, counter-clockwise seen from above
+	const double Footprint[][2] = { { 0.0, 0.0 }, { 2.0, 0.0 }, { 2.0, 1.0 }, { 1.0, 1.0 }, { 1.0, 2.0 }, { 0.0, 2.0 } };
+	const std::size_t FootprintCount = sizeof(Footprint) / sizeof(Footprint[0]);
+
+	void AddFace(TopologicEnergyCore::CellBuffer& rBuffer, const std::vector<double>& rkCoordinates)
+	{
+		rBuffer.AddFace(rkCoordinates.data(), rkCoordinates.size() / 3);
+	}
+
+	void AddHole(TopologicEnergyCore::CellBuffer& rBuffer, const std::vector<double>& rkCoordinates)
+	{
+		rBuffer.AddHole(rkCoordinates.data(), rkCoordinates.size() / 3);
+	}
+
+	// The vertices sorted by coordinates, the way a shape map may list them instead of along the wire
+	std::vector<double> ShapeMapOrder(const std::vector<double>& rkCoordinates)
+	{
+		std::vector<std::vector<double>> vertices;
+		for (std::size_t i = 0; i < rkCoordinates.size(); i += 3)
+		{
+			vertices.push_back(std::vector<double>(rkCoordinates.begin() + i, rkCoordinates.begin() + i + 3));
+		}
+		std::sort(vertices.begin(), vertices.end());
+
+		std::vector<double> coordinates;
+		for (const std::vector<double>& rkVertex : vertices)
+		{
+			coordinates.insert(coordinates.end(), rkVertex.begin(), rkVertex.end());
+		}
+		return coordinates;
+	}
+
+	// The L-shaped prism of height 1, every face wound outward: the floor, the roof, then the walls
+	// along the footprint, so the wall from (0, 0) to (2, 0) is face 2.
+	TopologicEnergyCore::CellBuffer MakePrism(bool isShapeMapOrder)
+	{
+		std::vector<double> floor;
+		std::vector<double> roof;
+		for (std::size_t i = 0; i < FootprintCount; ++i)
+		{
+			const double* pkFloorPoint = Footprint[FootprintCount - 1 - i];
+			floor.insert(floor.end(), { pkFloorPoint[0], pkFloorPoint[1], 0.0 });
+			roof.insert(roof.end(), { Footprint[i][0], Footprint[i][1], 1.0 });
+		}
+
+		TopologicEnergyCore::CellBuffer buffer;
+		AddFace(buffer, isShapeMapOrder ? ShapeMapOrder(floor) : floor);
+		AddFace(buffer, isShapeMapOrder ? ShapeMapOrder(roof) : roof);
+		for (std::size_t i = 0; i < FootprintCount; ++i)
+		{
+			const double* pkFrom = Footprint[i];
+			const double* pkTo = Footprint[(i + 1) % FootprintCount];
+			AddFace(buffer, { pkFrom[0], pkFrom[1], 0.0, pkTo[0], pkTo[1], 0.0, pkTo[0], pkTo[1], 1.0, pkFrom[0], pkFrom[1], 1.0 });
+		}
+		buffer.EndCell();
+		return buffer;
+	}
+
+	// A 4 x 4 x 1 box whose roof is a ring around a 2 x 2 hole, with the face filling the hole wound
+	// inward so that only the edges it shares with the hole can orient it. The hole is wound like the
+	// ring or against it.
+	TopologicEnergyCore::CellBuffer MakeBoxWithHole(bool isHoleReversed)
+	{
+		TopologicEnergyCore::CellBuffer buffer;
+		AddFace(buffer, { 0, 0, 0, 0, 4, 0, 4, 4, 0, 4, 0, 0 });
+		AddFace(buffer, { 0, 0, 0, 4, 0, 0, 4, 0, 1, 0, 0, 1 });
+		AddFace(buffer, { 4, 0, 0, 4, 4, 0, 4, 4, 1, 4, 0, 1 });
+		AddFace(buffer, { 4, 4, 0, 0, 4, 0, 0, 4, 1, 4, 4, 1 });
+		AddFace(buffer, { 0, 4, 0, 0, 0, 0, 0, 0, 1, 0, 4, 1 });
+		AddFace(buffer, { 0, 0, 1, 4, 0, 1, 4, 4, 1, 0, 4, 1 });
+		if (isHoleReversed)
+		{
+			AddHole(buffer, { 1, 1, 1, 1, 3, 1, 3, 3, 1, 3, 1, 1 });
+		}
+		else
+		{
+			AddHole(buffer, { 1, 1, 1, 3, 1, 1, 3, 3, 1, 1, 3, 1 });
+		}
+		AddFace(buffer, { 1, 1, 1, 1, 3, 1, 3, 3, 1, 3, 1, 1 });
+		buffer.EndCell();
+		return buffer;
+	}
+
+	// Empty if the metrics match, otherwise what differs
+	std::string CompareMetrics(const TopologicEnergyCore::CellMetrics& rkMetrics, double volume, const double* pkCentroid)
+	{
+		std::ostringstream difference;
+		if (std::abs(rkMetrics.volume - volume) > Tolerance)
+		{
+			difference << "volume " << rkMetrics.volume << " instead of " << volume << ". ";
+		}
+		for (int k = 0; k < 3; ++k)
+		{
+			if (std::abs(rkMetrics.centroid[k] - pkCentroid[k]) > Tolerance)
+			{
+				difference << "centroid[" << k << "] " << rkMetrics.centroid[k] << " instead of " << pkCentroid[k] << ". ";
+			}
+		}
+		return difference.str();
+	}
+}
+
+int main()
+{
+	std::vector<std::string> failures;
+
+	const double prismCentroid[3] = { 2.5 / 3.0, 2.5 / 3.0, 0.5 };
+	TopologicEnergyCore::CellBuffer prism = MakePrism(false);
+	std::string difference = CompareMetrics(TopologicEnergyCore::ComputeCellMetrics(prism)[0], 3.0, prismCentroid);
+	if (!difference.empty())
+	{
+		failures.push_back("Prism in wire order: " + difference);
+	}
+
+	std::vector<unsigned char> southWall(prism.FaceCount(0), 0);
+	southWall[2] = 1;
+	double normal[3];
+	if (!TopologicEnergyCore::LargestWallNormal(prism, 0, southWall, normal) ||
+		std::abs(normal[0]) > Tolerance || std::abs(normal[1] + 1.0) > Tolerance || std::abs(normal[2]) > Tolerance)
+	{
+		failures.push_back("Prism in wire order: the south wall does not face -Y.");
+	}
+
+	// The case is only a check of the vertex order if the shape map order gets it wrong.
+	if (CompareMetrics(TopologicEnergyCore::ComputeCellMetrics(MakePrism(true))[0], 3.0, prismCentroid).empty())
+	{
+		failures.push_back("Prism in shape map order: the metrics do not depend on the vertex order.");
+	}
+
+	const double boxCentroid[3] = { 2.0, 2.0, 0.5 };
+	for (bool isHoleReversed : { false, true })
+	{
+		TopologicEnergyCore::CellBuffer box = MakeBoxWithHole(isHoleReversed);
+		std::string name = isHoleReversed ? "Box with a hole against its ring: " : "Box with a hole along its ring: ";
+		difference = CompareMetrics(TopologicEnergyCore::ComputeCellMetrics(box)[0], 16.0, boxCentroid);
+		if (!difference.empty())
+		{
+			failures.push_back(name + difference);
+		}
+
+		// The ring is 12 square units, facing up.
+		TopologicEnergyCore::FaceNormal(box, box.FaceId(0, 5), normal);
+		std::vector<int> signs = TopologicEnergyCore::ComputeOutwardSigns(box, 0);
+		if (std::abs(signs[5] * normal[2] - 24.0) > Tolerance || signs[6] != -1)
+		{
+			failures.push_back(name + "the ring or the face in its hole is not oriented outward.");
+		}
+	}
+
+	for (const std::string& rkFailure : failures)
+	{
+		std::cerr << rkFailure << "\n";
+	}
+	return failures.empty() ? 0 : 1;
+}
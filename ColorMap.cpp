@@ -0,0 +1,85 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ColorMap.h"
+#include "NativeInterop.h"
+
+namespace TopologicEnergy
+{
+	void ColorMap::ToBuffer(array<double>^ values, int offset, int count, double minDomain, double maxDomain, String^ colorMapName, bool includeAlpha, array<Byte>^ buffer, int bufferOffset)
+	{
+		if (values == nullptr || buffer == nullptr)
+		{
+			throw gcnew Exception("The input values and buffer must not be null.");
+		}
+
+		if (offset < 0 || count < 0 || offset + count > values->Length)
+		{
+			throw gcnew Exception("The range of values is out of bounds.");
+		}
+
+		int stride = includeAlpha ? 4 : 3;
+		if (bufferOffset < 0 || (long long)bufferOffset + (long long)count * stride > buffer->Length)
+		{
+			throw gcnew Exception("The buffer is too small for the colors.");
+		}
+
+		if (count == 0)
+		{
+			return;
+		}
+
+		const TopologicEnergyCore::ColorMap& rkColorMap = ByName(colorMapName);
+		pin_ptr<double> pValues = &values[offset];
+		pin_ptr<Byte> pBuffer = &buffer[bufferOffset];
+		rkColorMap.Apply(pValues, count, minDomain, maxDomain, pBuffer, includeAlpha);
+	}
+
+	array<Byte>^ ColorMap::ToRGB(IList<double>^ values, double minDomain, double maxDomain, String^ colorMapName)
+	{
+		if (values == nullptr)
+		{
+			throw gcnew Exception("The input values must not be null.");
+		}
+
+		array<double>^ valueArray = gcnew array<double>(values->Count);
+		values->CopyTo(valueArray, 0);
+		array<Byte>^ buffer = gcnew array<Byte>(valueArray->Length * 3);
+		ToBuffer(valueArray, 0, valueArray->Length, minDomain, maxDomain, colorMapName, false, buffer, 0);
+		return buffer;
+	}
+
+	IList<String^>^ ColorMap::Names::get()
+	{
+		List<String^>^ names = gcnew List<String^>();
+		for (const std::string& rkName : TopologicEnergyCore::ColorMap::Names())
+		{
+			names->Add(ToManagedString(rkName));
+		}
+		return names;
+	}
+
+	const TopologicEnergyCore::ColorMap& ColorMap::ByName(String^ colorMapName)
+	{
+		TopologicEnergyCore::ColorMapType colorMapType = TopologicEnergyCore::COLORMAP_DEFAULT;
+		if (!String::IsNullOrEmpty(colorMapName) &&
+			!TopologicEnergyCore::ColorMap::TypeByName(ToNativeString(colorMapName), colorMapType))
+		{
+			throw gcnew Exception("Unknown colormap " + colorMapName + ". The available colormaps are " + String::Join(", ", Names) + ".");
+		}
+		return TopologicEnergyCore::ColorMap::ByType(colorMapType);
+	}
+}
@@ -0,0 +1,68 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "ColorMapKernels.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// Batch colormaps that write packed RGB or RGBA bytes into a caller-provided buffer without allocating per value.
+	/// </summary>
+	public ref class ColorMap abstract sealed
+	{
+	public:
+		/// <summary>
+		/// Writes the colors of a range of values to a buffer as packed RGB (3 bytes per value) or RGBA (4 bytes per value).
+		/// Values are mapped linearly from the domain to the colormap and clamped; NaN values are written as transparent grey.
+		/// </summary>
+		/// <param name="values">The values</param>
+		/// <param name="offset">The index of the first value to color</param>
+		/// <param name="count">The number of values to color</param>
+		/// <param name="minDomain">The value mapped to the first color</param>
+		/// <param name="maxDomain">The value mapped to the last color</param>
+		/// <param name="colorMapName">The name of the colormap</param>
+		/// <param name="includeAlpha">If true, 4 bytes are written per value, otherwise 3</param>
+		/// <param name="buffer">The output buffer</param>
+		/// <param name="bufferOffset">The index in the output buffer of the first byte to write</param>
+		static void ToBuffer(array<double>^ values, int offset, int count, double minDomain, double maxDomain, String^ colorMapName, bool includeAlpha, array<Byte>^ buffer, int bufferOffset);
+
+		/// <summary>
+		/// Returns the colors of the values as packed RGB bytes.
+		/// </summary>
+		/// <param name="values">The values</param>
+		/// <param name="minDomain">The value mapped to the first color</param>
+		/// <param name="maxDomain">The value mapped to the last color</param>
+		/// <param name="colorMapName">The name of the colormap</param>
+		/// <returns name="byte[]">The packed RGB bytes</returns>
+		static array<Byte>^ ToRGB(IList<double>^ values, double minDomain, double maxDomain, [Autodesk::DesignScript::Runtime::DefaultArgument("\"Default\"")] String^ colorMapName);
+
+		/// <summary>
+		/// Returns the names of the available colormaps.
+		/// </summary>
+		static property IList<String^>^ Names
+		{
+			IList<String^>^ get();
+		}
+
+	internal:
+		static const TopologicEnergyCore::ColorMap& ByName(String^ colorMapName);
+	};
+}
@@ -0,0 +1,203 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ColorMapKernels.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		struct ColorStop
+		{
+			double ratio;
+			double r;
+			double g;
+			double b;
+		};
+
+		const ColorStop kViridisStops[] = {
+			{ 0.0, 68, 1, 84 }, { 0.125, 71, 44, 122 }, { 0.25, 59, 81, 139 }, { 0.375, 44, 113, 142 }, { 0.5, 33, 144, 141 },
+			{ 0.625, 39, 173, 129 }, { 0.75, 92, 200, 99 }, { 0.875, 170, 220, 50 }, { 1.0, 253, 231, 37 } };
+
+		const ColorStop kInfernoStops[] = {
+			{ 0.0, 0, 0, 4 }, { 0.125, 31, 12, 72 }, { 0.25, 85, 15, 109 }, { 0.375, 136, 34, 106 }, { 0.5, 186, 54, 85 },
+			{ 0.625, 227, 89, 51 }, { 0.75, 249, 140, 10 }, { 0.875, 249, 201, 50 }, { 1.0, 252, 255, 164 } };
+
+		const ColorStop kCoolWarmStops[] = {
+			{ 0.0, 59, 76, 192 }, { 0.25, 144, 178, 254 }, { 0.5, 221, 221, 221 }, { 0.75, 245, 156, 125 }, { 1.0, 180, 4, 38 } };
+
+		const ColorStop kGrayscaleStops[] = {
+			{ 0.0, 0, 0, 0 }, { 1.0, 255, 255, 255 } };
+
+		const char* const kNames[COLORMAP_COUNT] = { "Default", "Viridis", "Inferno", "CoolWarm", "Grayscale" };
+
+		unsigned char ToByte(double component)
+		{
+			return (unsigned char)std::max(std::min(std::floor(component), 255.0), 0.0);
+		}
+
+		void InterpolatedColor(const ColorStop* pkStops, std::size_t stopCount, double ratio, unsigned char* pColor)
+		{
+			std::size_t i = 1;
+			while (i < stopCount - 1 && pkStops[i].ratio < ratio)
+			{
+				++i;
+			}
+			const ColorStop& rkLower = pkStops[i - 1];
+			const ColorStop& rkUpper = pkStops[i];
+			double t = (ratio - rkLower.ratio) / (rkUpper.ratio - rkLower.ratio);
+			pColor[0] = ToByte(rkLower.r + t * (rkUpper.r - rkLower.r) + 0.5);
+			pColor[1] = ToByte(rkLower.g + t * (rkUpper.g - rkLower.g) + 0.5);
+			pColor[2] = ToByte(rkLower.b + t * (rkUpper.b - rkLower.b) + 0.5);
+		}
+	}
+
+	void DefaultColor(double ratio, unsigned char* pColor)
+	{
+		double r = 0.0;
+		double g = 0.0;
+		double b = 0.0;
+		if (ratio <= 0.25)
+		{
+			g = 4.0 * ratio;
+			b = 1.0;
+		}
+		else if (ratio <= 0.5)
+		{
+			g = 1.0;
+			b = 1.0 - 4.0 * (ratio - 0.25);
+		}
+		else if (ratio <= 0.75)
+		{
+			r = 4.0 * (ratio - 0.5);
+			g = 1.0;
+		}
+		else
+		{
+			r = 1.0;
+			g = 1.0 - 4.0 * (ratio - 0.75);
+		}
+		pColor[0] = ToByte(std::floor(255.0 * r));
+		pColor[1] = ToByte(std::floor(255.0 * g));
+		pColor[2] = ToByte(std::floor(255.0 * b));
+	}
+
+	const ColorMap& ColorMap::ByType(ColorMapType type)
+	{
+		static const ColorMap kColorMaps[COLORMAP_COUNT] = {
+			ColorMap(COLORMAP_DEFAULT), ColorMap(COLORMAP_VIRIDIS), ColorMap(COLORMAP_INFERNO),
+			ColorMap(COLORMAP_COOLWARM), ColorMap(COLORMAP_GRAYSCALE) };
+
+		if (type < 0 || type >= COLORMAP_COUNT)
+		{
+			return kColorMaps[COLORMAP_DEFAULT];
+		}
+		return kColorMaps[type];
+	}
+
+	bool ColorMap::TypeByName(const std::string& rkName, ColorMapType& rType)
+	{
+		std::string lowerName(rkName);
+		std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+		for (int i = 0; i < COLORMAP_COUNT; ++i)
+		{
+			std::string lowerCandidate(kNames[i]);
+			std::transform(lowerCandidate.begin(), lowerCandidate.end(), lowerCandidate.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+			if (lowerName == lowerCandidate)
+			{
+				rType = (ColorMapType)i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<std::string> ColorMap::Names()
+	{
+		return std::vector<std::string>(kNames, kNames + COLORMAP_COUNT);
+	}
+
+	void ColorMap::Apply(const double* pkValues, std::size_t count, double minValue, double maxValue, unsigned char* pBuffer, bool includeAlpha) const
+	{
+		double delta = maxValue - minValue;
+		double scale = delta != 0.0 ? (double)(LookupTableSize - 1) / delta : 0.0;
+		ApplyScaled(pkValues, count, -minValue * scale, scale, pBuffer, includeAlpha);
+	}
+
+	void ColorMap::ApplyRatios(const double* pkRatios, std::size_t count, unsigned char* pBuffer, bool includeAlpha) const
+	{
+		ApplyScaled(pkRatios, count, 0.0, (double)(LookupTableSize - 1), pBuffer, includeAlpha);
+	}
+
+	const unsigned char* ColorMap::Color(double ratio) const
+	{
+		double position = std::max(std::min(ratio * (LookupTableSize - 1) + 0.5, (double)(LookupTableSize - 1)), 0.0);
+		return m_lookupTable + 4 * (int)position;
+	}
+
+	ColorMap::ColorMap(ColorMapType type)
+	{
+		for (int i = 0; i < LookupTableSize; ++i)
+		{
+			double ratio = (double)i / (double)(LookupTableSize - 1);
+			unsigned char* pColor = m_lookupTable + 4 * i;
+			switch (type)
+			{
+			case COLORMAP_VIRIDIS:
+				InterpolatedColor(kViridisStops, sizeof(kViridisStops) / sizeof(ColorStop), ratio, pColor);
+				break;
+			case COLORMAP_INFERNO:
+				InterpolatedColor(kInfernoStops, sizeof(kInfernoStops) / sizeof(ColorStop), ratio, pColor);
+				break;
+			case COLORMAP_COOLWARM:
+				InterpolatedColor(kCoolWarmStops, sizeof(kCoolWarmStops) / sizeof(ColorStop), ratio, pColor);
+				break;
+			case COLORMAP_GRAYSCALE:
+				InterpolatedColor(kGrayscaleStops, sizeof(kGrayscaleStops) / sizeof(ColorStop), ratio, pColor);
+				break;
+			default:
+				DefaultColor(ratio, pColor);
+				break;
+			}
+			pColor[3] = 255;
+		}
+	}
+
+	void ColorMap::ApplyScaled(const double* pkValues, std::size_t count, double offset, double scale, unsigned char* pBuffer, bool includeAlpha) const
+	{
+		static const unsigned char kNoDataColor[4] = { 128, 128, 128, 0 };
+		const double kMaxPosition = (double)(LookupTableSize - 1);
+		const std::size_t kStride = includeAlpha ? 4 : 3;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			double value = pkValues[i];
+			double position = std::max(std::min(value * scale + offset + 0.5, kMaxPosition), 0.0);
+			const unsigned char* pkColor = std::isfinite(value) ? m_lookupTable + 4 * (int)position : kNoDataColor;
+			unsigned char* pTarget = pBuffer + i * kStride;
+			pTarget[0] = pkColor[0];
+			pTarget[1] = pkColor[1];
+			pTarget[2] = pkColor[2];
+			if (includeAlpha)
+			{
+				pTarget[3] = pkColor[3];
+			}
+		}
+	}
+}
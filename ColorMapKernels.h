@@ -0,0 +1,69 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	enum ColorMapType
+	{
+		COLORMAP_DEFAULT,	// blue - cyan - green - yellow - red, as EnergyModel::GetColor
+		COLORMAP_VIRIDIS,
+		COLORMAP_INFERNO,
+		COLORMAP_COOLWARM,
+		COLORMAP_GRAYSCALE,
+		COLORMAP_COUNT
+	};
+
+	// A colormap evaluated through a precomputed lookup table. Applying it to a buffer of values
+	// is one multiply-add, one clamp and one table read per value, with no allocation.
+	class ColorMap
+	{
+	public:
+		static const int LookupTableSize = 1024;
+
+		static const ColorMap& ByType(ColorMapType type);
+
+		// Returns false if the name does not match a colormap. Names are case-insensitive.
+		static bool TypeByName(const std::string& rkName, ColorMapType& rType);
+		static std::vector<std::string> Names();
+
+		// Writes count colors as packed RGB (3 bytes per value) or RGBA (4 bytes per value) to pBuffer.
+		// Values are mapped linearly from [minValue, maxValue] to [0, 1] and clamped; NaN and infinite
+		// values (no data) are written as transparent grey.
+		void Apply(const double* pkValues, std::size_t count, double minValue, double maxValue, unsigned char* pBuffer, bool includeAlpha) const;
+
+		// Same as Apply, for values that are already ratios in [0, 1].
+		void ApplyRatios(const double* pkRatios, std::size_t count, unsigned char* pBuffer, bool includeAlpha) const;
+
+		const unsigned char* Color(double ratio) const;
+
+	private:
+		explicit ColorMap(ColorMapType type);
+
+		void ApplyScaled(const double* pkValues, std::size_t count, double offset, double scale, unsigned char* pBuffer, bool includeAlpha) const;
+
+		unsigned char m_lookupTable[LookupTableSize * 4];
+	};
+
+	// Evaluates the default ramp at a ratio in [0, 1] exactly, as EnergyModel::GetColor draws it. The
+	// lookup table of COLORMAP_DEFAULT samples it, so its colors may differ by one per channel.
+	void DefaultColor(double ratio, unsigned char* pColor);
+}
@@ -0,0 +1,89 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ComparisonKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	void ComputeDeltas(const double* pkValues, const double* pkBaseline, double* pDeltas, std::size_t count)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			pDeltas[i] = pkValues[i] - pkBaseline[i];
+		}
+	}
+
+	void ComputeRatios(const double* pkValues, const double* pkBaseline, double* pRatios, std::size_t count)
+	{
+		const double kNaN = std::numeric_limits<double>::quiet_NaN();
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			double baseline = pkBaseline[i];
+			pRatios[i] = baseline != 0.0 ? pkValues[i] / baseline : kNaN;
+		}
+	}
+
+	void ComputeRanks(const double* pkMatrix, std::size_t variantCount, std::size_t zoneCount, int* pRanks)
+	{
+		// Transpose once so every zone's variants are contiguous
+		std::vector<double> zoneMajor(variantCount * zoneCount);
+		for (std::size_t v = 0; v < variantCount; ++v)
+		{
+			const double* pkRow = pkMatrix + v * zoneCount;
+			for (std::size_t z = 0; z < zoneCount; ++z)
+			{
+				zoneMajor[z * variantCount + v] = pkRow[z];
+			}
+		}
+
+		std::vector<std::size_t> order(variantCount);
+		for (std::size_t z = 0; z < zoneCount; ++z)
+		{
+			const double* pkZone = zoneMajor.data() + z * variantCount;
+			std::size_t validCount = 0;
+			for (std::size_t v = 0; v < variantCount; ++v)
+			{
+				if (std::isnan(pkZone[v]))
+				{
+					pRanks[v * zoneCount + z] = 0;
+				}
+				else
+				{
+					order[validCount++] = v;
+				}
+			}
+
+			std::sort(order.begin(), order.begin() + validCount,
+				[pkZone](std::size_t a, std::size_t b) { return pkZone[a] < pkZone[b]; });
+
+			// Tied values share the lowest rank of their run, so ranks do not depend on the variant order.
+			int rank = 0;
+			for (std::size_t r = 0; r < validCount; ++r)
+			{
+				if (r == 0 || pkZone[order[r]] != pkZone[order[r - 1]])
+				{
+					rank = (int)(r + 1);
+				}
+				pRanks[order[r] * zoneCount + z] = rank;
+			}
+		}
+	}
+}
@@ -0,0 +1,35 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+
+// Kernels over aligned result arrays. Every array is contiguous and a missing value is NaN,
+// so the loops stay branch-free and the compiler can vectorize them.
+namespace TopologicEnergyCore
+{
+	// pDeltas[i] = pkValues[i] - pkBaseline[i]
+	void ComputeDeltas(const double* pkValues, const double* pkBaseline, double* pDeltas, std::size_t count);
+
+	// pRatios[i] = pkValues[i] / pkBaseline[i], NaN where the baseline is zero
+	void ComputeRatios(const double* pkValues, const double* pkBaseline, double* pRatios, std::size_t count);
+
+	// pkMatrix holds variantCount rows of zoneCount values. For every zone, the variants are ranked
+	// from 1 (lowest value) to variantCount; pRanks has the same layout as pkMatrix. NaN is ranked 0.
+	// Equal values get the same, lowest rank and the next value skips the tied ones: 1, 2, 2, 4.
+	void ComputeRanks(const double* pkMatrix, std::size_t variantCount, std::size_t zoneCount, int* pRanks);
+}
@@ -1,78 +1,162 @@
-// This file is part of Topologic software library.
-// Copyright(C) 2019, Cardiff University and University College London
-//
-// This program is free software: you can redistribute it and/or modify
-// it under the terms of the GNU Affero General Public License as published by
-// the Free Software Foundation, either version 3 of the License, or
-// (at your option) any later version.
-//
-// This program is distributed in the hope that it will be useful,
-// but WITHOUT ANY WARRANTY; without even the implied warranty of
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
-// GNU Affero General Public License for more details.
-//
-// You should have received a copy of the GNU Affero General Public License
-// along with this program. If not, see <https://www.gnu.org/licenses/>.
-
-#include "EnergySimulation.h"
-#include "EnergyModel.h"
-
-using namespace System::Diagnostics;
-using namespace System::IO;
-using namespace System::Linq;
-
-namespace TopologicEnergy
-{
-	EnergySimulation^ EnergySimulation::ByEnergyModel(EnergyModel ^ energyModel, String ^ openStudioExePath, String ^ openStudioOutputDirectory, bool run)
-	{
-		if (!run)
-		{
-			return nullptr;
-		}
-
-		String^ oswPath = nullptr;
-
-		String^ timestamp = DateTime::Now.ToString("yyyy-MM-dd_HH-mm-ss-fff");
-		String^ openStudioTimestampOutputDirectory = openStudioOutputDirectory + "\\TopologicEnergy_" + timestamp;
-		// Create the TopologicEnergy_timestamp folder
-		energyModel->Export(energyModel, openStudioTimestampOutputDirectory, oswPath);
-
-		// https://stackoverflow.com/questions/5168612/launch-program-with-parameters
-		String^ args = "run -w \"" + oswPath + "\"";
-		System::Diagnostics::ProcessStartInfo^ startInfo = gcnew ProcessStartInfo(openStudioExePath, args);
-		startInfo->WorkingDirectory = Path::GetDirectoryName(oswPath);
-
-		Process^ process = Process::Start(startInfo);
-		process->WaitForExit();
-
-		EnergySimulation^ simulation = gcnew EnergySimulation(
-			energyModel->Topology,
-			oswPath,
-			energyModel->OsModel,
-			energyModel->OsSpaces);
-
-		return simulation;
-	}
-
-	EnergySimulation::EnergySimulation(IList<Topologic::Cell^>^ cells, System::String^ oswPath, OpenStudio::Model^ osModel, OpenStudio::SpaceVector^ osSpaces)
-		: m_osModel(gcnew OpenStudio::Model(osModel))
-		, m_osSpaces(osSpaces)
-	{
-		if (oswPath == nullptr)
-		{
-			throw gcnew Exception("The input oswPath must not be null.");
-		}
-
-		OpenStudio::Space^ osSpace = osSpaces[0];
-		System::String^ directory = System::IO::Path::GetDirectoryName(oswPath);
-		System::String^ sqlPath = directory + "\\run\\eplusout.sql";
-		m_osSqlFile = gcnew OpenStudio::SqlFile(OpenStudio::OpenStudioUtilitiesCore::toPath(sqlPath));
-		m_osModel->setSqlFile(m_osSqlFile);
-	}
-
-	EnergySimulation::~EnergySimulation()
-	{
-		m_osSqlFile->close();
-		delete m_osSqlFile;
-	}
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "EnergySimulation.h"
+#include "EnergyModel.h"
+#include "PipelineMetrics.h"
+#include "SimulationMetrics.h"
+#include "SqlFilePool.h"
+#include "TraceRecorder.h"
+
+using namespace System::Diagnostics;
+using namespace System::IO;
+using namespace System::Linq;
+
+namespace TopologicEnergy
+{
+	EnergySimulation^ EnergySimulation::ByEnergyModel(EnergyModel ^ energyModel, String ^ openStudioExePath, String ^ openStudioOutputDirectory, bool run)
+	{
+		if (!run)
+		{
+			return nullptr;
+		}
+
+		String^ oswPath = nullptr;
+		PipelineMetrics^ metrics = gcnew PipelineMetrics();
+
+		String^ timestamp = DateTime::Now.ToString("yyyy-MM-dd_HH-mm-ss-fff");
+		String^ openStudioTimestampOutputDirectory = openStudioOutputDirectory + "\\TopologicEnergy_" + timestamp;
+		// Create the TopologicEnergy_timestamp folder. A variant exports, and is simulated with, a copy of its
+		// parent's model with its overrides applied; the simulation keeps it, the variant does not.
+		metrics->BeginStage();
+		OpenStudio::SpaceVector^ osSpaces = nullptr;
+		OpenStudio::Model^ osModel = energyModel->GetExportModel(osSpaces);
+		EnergyModel::ExportModel(osModel, energyModel->BuildingName, openStudioTimestampOutputDirectory, oswPath);
+		metrics->EndStage("Export");
+
+		// https://stackoverflow.com/questions/5168612/launch-program-with-parameters
+		String^ args = "run -w \"" + oswPath + "\"";
+		System::Diagnostics::ProcessStartInfo^ startInfo = gcnew ProcessStartInfo(openStudioExePath, args);
+		startInfo->WorkingDirectory = Path::GetDirectoryName(oswPath);
+
+		{
+			TopologicEnergyCore::TraceSpan span("RunSimulation");
+			metrics->BeginStage();
+			Process^ process = Process::Start(startInfo);
+			process->WaitForExit();
+			metrics->EndStage("RunSimulation");
+			span.SetAttribute("exitCode", process->ExitCode);
+		}
+
+		EnergySimulation^ simulation = gcnew EnergySimulation(
+			energyModel->Topology,
+			oswPath,
+			osModel,
+			osSpaces);
+		simulation->m_pipelineMetrics = metrics;
+		energyModel->ReleaseExportModel(osModel);
+
+		return simulation;
+	}
+
+	EnergySimulation::EnergySimulation(IList<Topologic::Cell^>^ cells, System::String^ oswPath, OpenStudio::Model^ osModel, OpenStudio::SpaceVector^ osSpaces)
+		: m_osModel(gcnew OpenStudio::Model(osModel))
+		, m_osAttachedSqlFile(nullptr)
+		, m_osSpaces(osSpaces)
+		, m_metrics(nullptr)
+		, m_pipelineMetrics(nullptr)
+	{
+		if (oswPath == nullptr)
+		{
+			throw gcnew Exception("The input oswPath must not be null.");
+		}
+
+		// The model is copied now, as it is at simulation time; the SQL file is opened from the pool on the first query.
+		System::String^ directory = System::IO::Path::GetDirectoryName(oswPath);
+		m_sqlPath = directory + "\\run\\eplusout.sql";
+	}
+
+	OpenStudio::SqlFile^ EnergySimulation::OsSqlFile::get()
+	{
+		// A handle given out here is kept open until the simulation is disposed or collected.
+		if (m_osAttachedSqlFile == nullptr)
+		{
+			m_osAttachedSqlFile = SqlFilePool::Acquire(m_sqlPath);
+		}
+		return m_osAttachedSqlFile;
+	}
+
+	OpenStudio::SqlFile^ EnergySimulation::AcquireSqlFile()
+	{
+		return SqlFilePool::Acquire(m_sqlPath);
+	}
+
+	void EnergySimulation::ReleaseSqlFile()
+	{
+		SqlFilePool::Release(m_sqlPath);
+	}
+
+	OpenStudio::Model^ EnergySimulation::OsModel::get()
+	{
+		if (m_osModel->sqlFile()->isNull())
+		{
+			m_osModel->setSqlFile(OsSqlFile);
+		}
+		return m_osModel;
+	}
+
+	SimulationMetrics^ EnergySimulation::Metrics::get()
+	{
+		if (m_metrics == nullptr)
+		{
+			OpenStudio::SqlFile^ osSqlFile = AcquireSqlFile();
+			try {
+				m_metrics = SimulationMetrics::BySqlFile(osSqlFile);
+			}
+			finally
+			{
+				ReleaseSqlFile();
+			}
+		}
+		return m_metrics;
+	}
+
+	TopologicEnergy::PipelineMetrics^ EnergySimulation::PipelineMetrics::get()
+	{
+		// The stages of the simulation run; the query count follows the results read since.
+		if (m_pipelineMetrics != nullptr)
+		{
+			m_pipelineMetrics->SqlQueryCount = SqlFilePool::QueryCount(m_sqlPath);
+		}
+		return m_pipelineMetrics;
+	}
+
+	EnergySimulation::~EnergySimulation()
+	{
+		this->!EnergySimulation();
+	}
+
+	EnergySimulation::!EnergySimulation()
+	{
+		// Only the reference held by OsSqlFile; the file stays cached for other simulations of the same run.
+		// A simulation that is never disposed releases it when it is collected.
+		if (m_osAttachedSqlFile != nullptr)
+		{
+			SqlFilePool::Release(m_sqlPath);
+			m_osAttachedSqlFile = nullptr;
+		}
+	}
 }
\ No newline at end of file
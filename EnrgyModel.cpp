@@ -1,1384 +1,2129 @@
-// This file is part of Topologic software library.
-// Copyright(C) 2019, Cardiff University and University College London
-//
-// This program is free software: you can redistribute it and/or modify
-// it under the terms of the GNU Affero General Public License as published by
-// the Free Software Foundation, either version 3 of the License, or
-// (at your option) any later version.
-//
-// This program is distributed in the hope that it will be useful,
-// but WITHOUT ANY WARRANTY; without even the implied warranty of
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
-// GNU Affero General Public License for more details.
-//
-// You should have received a copy of the GNU Affero General Public License
-// along with this program. If not, see <https://www.gnu.org/licenses/>.
-
-#include "EnergyModel.h"
-#include "EnergySimulation.h"
-
-using namespace System::Diagnostics;
-using namespace System::IO;
-using namespace System::Linq;
-
-namespace TopologicEnergy
-{
-	bool EnergyModel::CreateIdfFile(OpenStudio::Model^ osModel, String^ idfPathName)
-	{
-		if (idfPathName == nullptr)
-		{
-			throw gcnew Exception("The input idfPathName must not be null.");
-		}
-
-		OpenStudio::EnergyPlusForwardTranslator^ osForwardTranslator = gcnew OpenStudio::EnergyPlusForwardTranslator();
-		OpenStudio::Workspace^ osWorkspace = osForwardTranslator->translateModel(osModel);
-		OpenStudio::IdfFile^ osIdfFile = osWorkspace->toIdfFile();
-		OpenStudio::Path^ osIdfPath = OpenStudio::OpenStudioUtilitiesCore::toPath(idfPathName);
-		bool idfSaveCondition = osIdfFile->save(osIdfPath);
-		return idfSaveCondition;
-	}
-
-	EnergyModel^ EnergyModel::ByCellComplex(
-		CellComplex^ building,
-		Cluster^ shadingSurfaces,
-		IList<double>^ floorLevels,
-		String^ buildingName,
-		String^ buildingType,
-		String^ defaultSpaceType,
-		double northAxis,
-		Nullable<double> glazingRatio,
-		double coolingTemp,
-		double heatingTemp,
-		String^ weatherFilePath,
-		String^ designDayFilePath,
-		String^ openStudioTemplatePath
-	)
-	{
-		IList<double>^ floorLevelList = (IList<double>^) floorLevels;
-		numOfApertures = 0;
-		numOfAppliedApertures = 0;
-		CellComplex^ buildingCopy = building->Copy<CellComplex^>();
-
-		// Create an OpenStudio model from the template, EPW, and DDY
-		OpenStudio::Model^ osModel = GetModelFromTemplate(openStudioTemplatePath, weatherFilePath, designDayFilePath);
-
-		double buildingHeight = Enumerable::Max(floorLevels);
-
-		int numFloors = floorLevelList->Count - 1;
-		OpenStudio::Building^ osBuilding = ComputeBuilding(osModel, buildingName, buildingType, buildingHeight, numFloors, northAxis, defaultSpaceType);
-		IList<Cell^>^ pBuildingCells = buildingCopy->Cells;
-
-		// Create OpenStudio spaces
-		OpenStudio::SpaceVector^ osSpaceVector = gcnew OpenStudio::SpaceVector();
-
-		Autodesk::DesignScript::Geometry::Vector^ dynamoZAxis = Autodesk::DesignScript::Geometry::Vector::ZAxis();
-		for each(Cell^ buildingCell in pBuildingCells)
-		{
-			int spaceNumber = 1;
-			OpenStudio::Space^ osSpace = AddSpace(
-				spaceNumber,
-				buildingCell,
-				buildingCopy,
-				osModel,
-				dynamoZAxis,
-				buildingHeight,
-				floorLevels,
-				glazingRatio,
-				heatingTemp,
-				coolingTemp
-			);
-
-			Dictionary<String^, Object^>^ attributes = gcnew Dictionary<String^, Object^>();
-			attributes->Add("Name", osSpace->nameString());
-			buildingCell->AddAttributesNoCopy(attributes);
-
-			OpenStudio::SpaceVector::SpaceVectorEnumerator^ spaceEnumerator = osSpaceVector->GetEnumerator();
-			while (spaceEnumerator->MoveNext())
-			{
-				OpenStudio::Space^ osExistingSpace = spaceEnumerator->Current;
-				osSpace->matchSurfaces(osExistingSpace);
-			}
-
-			osSpaceVector->Add(osSpace);
-		}
-		delete dynamoZAxis;
-
-		// Create shading surfaces
-		if (shadingSurfaces != nullptr)
-		{
-			OpenStudio::ShadingSurfaceGroup^ osShadingGroup = gcnew OpenStudio::ShadingSurfaceGroup(osModel);
-			IList<Face^>^ contextFaces = shadingSurfaces->Faces;
-			int faceIndex = 1;
-			for each(Face^ contextFace in contextFaces)
-			{
-				AddShadingSurfaces(contextFace, osModel, osShadingGroup, faceIndex++);
-			}
-		}
-
-		osModel->purgeUnusedResourceObjects();
-
-		return gcnew EnergyModel(osModel, osBuilding, pBuildingCells, shadingSurfaces, osSpaceVector);
-	}
-
-	bool EnergyModel::ExportToOSM(EnergyModel ^ energyModel, String^ filePath)
-	{
-		if (filePath == nullptr)
-		{
-			throw gcnew Exception("The input filePath must not be null.");
-		}
-
-		return SaveModel(energyModel->m_osModel, filePath);
-	}
-
-	void EnergyModel::ProcessOsModel(
-		OpenStudio::Model^ osModel, 
-		double tolerance, 
-		OpenStudio::Building^% osBuilding,
-		IList<Cell^>^% buildingCells,
-		Topologic::Cluster^% shadingFaces,
-		OpenStudio::SpaceVector^% osSpaceVector)
-	{
-		osBuilding = osModel->getBuilding(); // 2
-		osSpaceVector = osModel->getSpaces(); // 3
-		OpenStudio::SpaceVector::SpaceVectorEnumerator^ spaceEnumerator = osSpaceVector->GetEnumerator();
-		List<OpenStudio::Space^>^ osSpaces = gcnew List<OpenStudio::Space^>();
-		while (spaceEnumerator->MoveNext())
-		{
-			OpenStudio::Space^ osSpace = spaceEnumerator->Current;
-			osSpaces->Add(osSpace);
-		}
-
-		// 4. Get shading surfaces as a cluster
-		OpenStudio::ShadingSurfaceVector^ osShadingSurfaceVector = osModel->getShadingSurfaces(); //4
-		OpenStudio::ShadingSurfaceVector::ShadingSurfaceVectorEnumerator^ shadingSurfaceEnumerator = osShadingSurfaceVector->GetEnumerator();
-		List<Topologic::Topology^>^ shadingFaceList = gcnew List<Topologic::Topology^>();
-		while (shadingSurfaceEnumerator->MoveNext())
-		{
-			OpenStudio::ShadingSurface^ osShadingSurface = shadingSurfaceEnumerator->Current;
-			Face^ shadingFace = FaceByOsSurface(osShadingSurface);
-			shadingFaceList->Add(shadingFace);
-		}
-		
-		if (shadingFaceList->Count > 0)
-		{
-			shadingFaces = Topologic::Cluster::ByTopologies(shadingFaceList);
-		}
-
-		// 5. Get building spaces as a CellComplex
-		OpenStudio::SpaceVector::SpaceVectorEnumerator^ osSpaceEnumerator = osSpaceVector->GetEnumerator();
-		List<Topologic::Cell^>^ cellList = gcnew List<Topologic::Cell^>();
-		while (osSpaceEnumerator->MoveNext())
-		{
-			OpenStudio::Space^ osSpace = osSpaceEnumerator->Current;
-			OpenStudio::SurfaceVector^ osSurfaces = osSpace->surfaces;
-			OpenStudio::Transformation^ osTransformation = osSpace->transformation();
-			OpenStudio::Vector3d^ osTranslation = osTransformation->translation();
-			OpenStudio::Matrix^ osMatrix = osTransformation->rotationMatrix();
-			double rotation11 = osMatrix->__getitem__(0, 0);
-			double rotation12 = osMatrix->__getitem__(0, 1);
-			double rotation13 = osMatrix->__getitem__(0, 2);
-			double rotation21 = osMatrix->__getitem__(1, 0);
-			double rotation22 = osMatrix->__getitem__(1, 1);
-			double rotation23 = osMatrix->__getitem__(1, 2);
-			double rotation31 = osMatrix->__getitem__(2, 0);
-			double rotation32 = osMatrix->__getitem__(2, 1);
-			double rotation33 = osMatrix->__getitem__(2, 2);
-
-			OpenStudio::SurfaceVector::SurfaceVectorEnumerator^ osSurfaceEnumerator = osSurfaces->GetEnumerator();
-			List<Topologic::Face^>^ faceList = gcnew List<Topologic::Face^>();
-			while (osSurfaceEnumerator->MoveNext())
-			{
-				OpenStudio::Surface^ osSurface = osSurfaceEnumerator->Current;
-				Face^ face = FaceByOsSurface(osSurface);
-
-				// Subsurfaces
-				OpenStudio::SubSurfaceVector^ osSubSurfaces = osSurface->subSurfaces();
-				if (osSubSurfaces->Count > 0)
-				{
-					OpenStudio::SubSurfaceVector::SubSurfaceVectorEnumerator^ osSubSurfaceEnumerator = osSubSurfaces->GetEnumerator();
-					List<Topologic::Topology^>^ faceApertureList = gcnew List<Topologic::Topology^>();
-					while (osSubSurfaceEnumerator->MoveNext())
-					{
-						OpenStudio::SubSurface^ osSubSurface = osSubSurfaceEnumerator->Current;
-						Face^ subFace = FaceByOsSurface(osSubSurface);
-
-						faceApertureList->Add(subFace);
-					}
-					Topologic::Topology^ topologyWithApertures = face->AddApertures(faceApertureList);
-					try {
-						Face^ faceWithApertures = safe_cast<Topologic::Face^>(topologyWithApertures);
-
-						faceList->Add(faceWithApertures);
-					}
-					catch (Exception^)
-					{
-						throw gcnew Exception("Error converting a topology with apertures to a face.");
-					}
-				}
-				else // no subsurfaces
-				{
-					faceList->Add(face);
-				}
-			}
-
-			Cell^ cell = Cell::ByFaces(faceList, tolerance);
-
-			Topologic::Topology^ transformedTopology = Topologic::Utilities::TopologyUtility::Transform(cell,
-				osTranslation->x(), osTranslation->y(), osTranslation->z(),
-				rotation11, rotation12, rotation13,
-				rotation21, rotation22, rotation23,
-				rotation31, rotation32, rotation33);
-			Cell^ transformedCell = safe_cast<Topologic::Cell^>(transformedTopology);
-			cellList->Add(transformedCell);
-		}
-
-		buildingCells = gcnew List<Topologic::Cell^>();
-		if (cellList->Count == 1)
-		{
-			((List<Topologic::Cell^>^)buildingCells)->Add(cellList[0]);
-		}
-		else
-		{
-			CellComplex^ cellComplex = CellComplex::ByCells(cellList);
-			buildingCells = cellComplex->Cells;
-		}
-	}
-
-	EnergyModel ^ EnergyModel::ByImportedOSM(String ^ filePath, double tolerance)
-	{
-		if (filePath == nullptr)
-		{
-			throw gcnew Exception("The input filePath must not be null.");
-		}
-
-		if (tolerance <= 0.0)
-		{
-			throw gcnew Exception("The tolerance must have a positive value.");
-		}
-
-		OpenStudio::Path^ osOsmFile = OpenStudio::OpenStudioUtilitiesCore::toPath(filePath);
-
-		// Create an abstract model
-		OpenStudio::OptionalModel^ osOptionalModel = OpenStudio::Model::load(osOsmFile);
-		if (osOptionalModel->isNull())
-		{
-			return nullptr;
-		}
-
-		OpenStudio::Model^ osModel = osOptionalModel->get(); //1
-		if (osModel == nullptr)
-		{
-			return nullptr;
-		}
-
-		OpenStudio::Building^ osBuilding = nullptr;
-		List<Cell^>^ buildingCells = nullptr;
-		Cluster^ shadingFaces = nullptr;
-		OpenStudio::SpaceVector^ osSpaceVector = nullptr;
-		ProcessOsModel(osModel, tolerance, osBuilding, buildingCells, shadingFaces, osSpaceVector);
-
-		EnergyModel^ energyModel = gcnew EnergyModel(osModel, osBuilding, buildingCells, shadingFaces, osSpaceVector);
-
-		return energyModel;
-	}
-
-	bool EnergyModel::SaveModel(OpenStudio::Model^ osModel, String^ osmPathName)
-	{
-		if (osmPathName == nullptr)
-		{
-			throw gcnew Exception("The input osmPathName must not be null.");
-		}
-
-		// Purge unused resources
-		//osModel->purgeUnusedResourceObjects();
-
-		// Create a path string
-		OpenStudio::Path^ osPath = OpenStudio::OpenStudioUtilitiesCore::toPath(osmPathName);
-		bool osCondition = osModel->save(osPath, true);
-		return osCondition;
-	}
-
-	OpenStudio::Model^ EnergyModel::GetModelFromTemplate(String^ osmTemplatePath, String^ epwWeatherPath, String^ ddyPath)
-	{
-		if (osmTemplatePath == nullptr)
-		{
-			throw gcnew Exception("The input osmTemplatePath must not be null.");
-		}
-
-		if (epwWeatherPath == nullptr)
-		{
-			throw gcnew Exception("The input epwWeatherPath must not be null.");
-		}
-
-		if (ddyPath == nullptr)
-		{
-			throw gcnew Exception("The input ddyPath must not be null.");
-		}
-
-		if (osmTemplatePath == nullptr)
-		{
-			throw gcnew Exception("The input osmTemplatePath must not be null.");
-		}
-
-		if (!File::Exists(osmTemplatePath))
-		{
-			throw gcnew FileNotFoundException("OSM file not found.");
-		}
-		if (!File::Exists(epwWeatherPath))
-		{
-			throw gcnew FileNotFoundException("EPW file not found.");
-		}
-		if (!File::Exists(ddyPath))
-		{
-			throw gcnew FileNotFoundException("DDY file not found.");
-		}
-		OpenStudio::Path^ osTemplatePath = OpenStudio::OpenStudioUtilitiesCore::toPath(osmTemplatePath);
-
-		// Create an abstract model
-		OpenStudio::OptionalModel^ osOptionalModel = OpenStudio::Model::load(osTemplatePath);
-		OpenStudio::Model^ osModel = osOptionalModel->__ref__();
-
-		// Read an EPW weather file
-		OpenStudio::Path^ osEPWPath = OpenStudio::OpenStudioUtilitiesCore::toPath(epwWeatherPath);
-		OpenStudio::EpwFile^ osEPWFile = gcnew OpenStudio::EpwFile(osEPWPath);
-		OpenStudio::WeatherFile^ osWeatherFile = osModel->getWeatherFile();
-		OpenStudio::WeatherFile::setWeatherFile(osModel, osEPWFile);
-
-		// Read an DDY design days files
-		OpenStudio::Path^ osDDYPath = OpenStudio::OpenStudioUtilitiesCore::toPath(ddyPath);
-		OpenStudio::EnergyPlusReverseTranslator^ osTranslator = gcnew OpenStudio::EnergyPlusReverseTranslator();
-		OpenStudio::OptionalModel^ tempModel01 = osTranslator->loadModel(osDDYPath);
-		OpenStudio::Model^ tempModel02 = tempModel01->__ref__();
-		OpenStudio::DesignDayVector^ designDays = tempModel02->getDesignDays();
-		OpenStudio::DesignDayVector::DesignDayVectorEnumerator^ designDaysEnumerator = designDays->GetEnumerator();
-
-		while (designDaysEnumerator->MoveNext())
-		{
-			OpenStudio::DesignDay^ aDesignDay = designDaysEnumerator->Current;
-			OpenStudio::IdfObject^ anIdfObject = aDesignDay->idfObject();
-			osModel->addObject(anIdfObject);
-		}
-		return osModel;
-	}
-
-	OpenStudio::ThermalZone^ EnergyModel::CreateThermalZone(OpenStudio::Model^ model, OpenStudio::Space^ space, double ceilingHeight, double heatingTemp, double coolingTemp)
-	{
-		// Create a thermal zone for the space
-		OpenStudio::ThermalZone^ osThermalZone = gcnew OpenStudio::ThermalZone(model);
-		osThermalZone->setName(space->name()->get() + "_THERMAL_ZONE");
-		String^ name = osThermalZone->name()->get();
-		osThermalZone->setUseIdealAirLoads(true);
-		osThermalZone->setCeilingHeight(ceilingHeight);
-		osThermalZone->setVolume(space->volume());
-
-		// Assign Thermal Zone to space
-		// aSpace.setThermalZone(osThermalZone);//Not available in C#
-		OpenStudio::UUID^ tzHandle = osThermalZone->handle();
-		int location = 10;
-		space->setPointer(location, tzHandle);
-
-		OpenStudio::ScheduleConstant^ heatingScheduleConstant = gcnew OpenStudio::ScheduleConstant(model);
-		heatingScheduleConstant->setValue(heatingTemp);
-		OpenStudio::ScheduleConstant^ coolingScheduleConstant = gcnew OpenStudio::ScheduleConstant(model);
-		coolingScheduleConstant->setValue(coolingTemp);
-
-		// Create a Thermostat
-		OpenStudio::ThermostatSetpointDualSetpoint^ osThermostat = gcnew OpenStudio::ThermostatSetpointDualSetpoint(model);
-
-		// Set Heating and Cooling Schedules on the Thermostat
-		osThermostat->setHeatingSetpointTemperatureSchedule(heatingScheduleConstant);
-		osThermostat->setCoolingSetpointTemperatureSchedule(coolingScheduleConstant);
-
-		// Assign Thermostat to the Thermal Zone
-		osThermalZone->setThermostatSetpointDualSetpoint(osThermostat);
-		return osThermalZone;
-	}
-
-	OpenStudio::BuildingStory^ EnergyModel::AddBuildingStory(OpenStudio::Model^ model, int floorNumber)
-	{
-		OpenStudio::BuildingStory^ osBuildingStory = gcnew OpenStudio::BuildingStory(model);
-		osBuildingStory->setName("STORY_" + floorNumber);
-		osBuildingStory->setDefaultConstructionSet(getDefaultConstructionSet(model));
-		osBuildingStory->setDefaultScheduleSet(getDefaultScheduleSet(model));
-		return osBuildingStory;
-	}
-
-	OpenStudio::SubSurface ^ EnergyModel::CreateSubSurface(IList<Topologic::Vertex^>^ vertices, OpenStudio::Model^ osModel)
-	{
-		OpenStudio::Point3dVector^ osWindowFacePoints = gcnew OpenStudio::Point3dVector();
-		for each(Vertex^ vertex in vertices)
-		{
-			OpenStudio::Point3d^ osPoint = gcnew OpenStudio::Point3d(
-				vertex->X,
-				vertex->Y,
-				vertex->Z);
-			osWindowFacePoints->Add(osPoint);
-		}
-
-		OpenStudio::SubSurface^ osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel);
-		return osWindowSubSurface;
-	}
-
-	OpenStudio::Building^ EnergyModel::ComputeBuilding(
-		OpenStudio::Model^ osModel,
-		String^ buildingName,
-		String^ buildingType,
-		double buildingHeight,
-		int numFloors,
-		double northAxis,
-		String^ spaceType)
-	{
-		OpenStudio::Building^ osBuilding = osModel->getBuilding();
-		osBuilding->setStandardsNumberOfStories(numFloors);
-		osBuilding->setDefaultConstructionSet(getDefaultConstructionSet(osModel));
-		osBuilding->setDefaultScheduleSet(getDefaultScheduleSet(osModel));
-		osBuilding->setName(buildingName);
-		osBuilding->setStandardsBuildingType(buildingType);
-		double floorToFloorHeight = (double)buildingHeight / (double)numFloors;
-		osBuilding->setNominalFloortoFloorHeight(floorToFloorHeight);
-		// Get all space types and find the one that matches
-		OpenStudio::SpaceTypeVector^ spaceTypes = osModel->getSpaceTypes();
-		OpenStudio::SpaceTypeVector::SpaceTypeVectorEnumerator^ spaceTypesEnumerator = spaceTypes->GetEnumerator();
-		while (spaceTypesEnumerator->MoveNext())
-		{
-			OpenStudio::SpaceType^ aSpaceType = spaceTypesEnumerator->Current;
-			String^ spaceTypeName = aSpaceType->name()->__str__();
-			if (spaceTypeName == spaceType)
-			{
-				osBuilding->setSpaceType(aSpaceType);
-			}
-		}
-		buildingStories = CreateBuildingStories(osModel, numFloors);
-		osBuilding->setNorthAxis(northAxis);
-		return osBuilding;
-	}
-
-	IList<OpenStudio::BuildingStory^>^ EnergyModel::CreateBuildingStories(OpenStudio::Model^ osModel, int numFloors)
-	{
-		List<OpenStudio::BuildingStory^>^ osBuildingStories = gcnew List<OpenStudio::BuildingStory^>();
-		for (int i = 0; i < numFloors; i++)
-		{
-			osBuildingStories->Add(AddBuildingStory(osModel, (i + 1)));
-		}
-		return osBuildingStories;
-	}
-
-	OpenStudio::SqlFile^ EnergyModel::CreateSqlFile(OpenStudio::Model ^ osModel, String^ sqlFilePath)
-	{
-		if (sqlFilePath == nullptr)
-		{
-			throw gcnew Exception("The input sqlFilePath must not be null.");
-		}
-
-		OpenStudio::Path^ osSqlFilePath = OpenStudio::OpenStudioUtilitiesCore::toPath(sqlFilePath);
-		OpenStudio::SqlFile^ osSqlFile = gcnew OpenStudio::SqlFile(osSqlFilePath);
-		if (osSqlFile == nullptr)
-		{
-			throw gcnew Exception("Fails to create an SQL output file");
-		}
-		bool isSuccessful = osModel->setSqlFile(osSqlFile);
-		if (!isSuccessful)
-		{
-			throw gcnew Exception("Fails to create an SQL output file");
-		}
-		return osSqlFile;
-	}
-
-	Topologic::Face ^ EnergyModel::FaceByOsSurface(OpenStudio::PlanarSurface^ osPlanarSurface)
-	{
-		OpenStudio::Point3dVector^ osVertices = osPlanarSurface->vertices();
-		OpenStudio::Point3dVector::Point3dVectorEnumerator^ osPointEnumerator = osVertices->GetEnumerator();
-		List<Topologic::Vertex^>^ vertices = gcnew List<Topologic::Vertex^>();
-		List<int>^ indices = gcnew List<int>();
-		int index = 0;
-		while (osPointEnumerator->MoveNext())
-		{
-			OpenStudio::Point3d^ osVertex = osPointEnumerator->Current;
-			vertices->Add(Topologic::Vertex::ByCoordinates(osVertex->x(), osVertex->y(), osVertex->z()));
-			indices->Add(index);
-			++index;
-		}
-
-		if (vertices->Count < 3)
-		{
-			throw gcnew Exception("Invalid surface is found.");
-		}
-
-		indices->Add(0); // close the wire
-
-		IList<IList<int>^>^ vertexIndices = gcnew List<IList<int>^>();
-		((IList<IList<int>^>^)vertexIndices)->Add(indices);
-
-		IList<Topologic::Topology^>^ topologies = (IList<Topologic::Topology^>^)Topologic::Topology::ByVerticesIndices(vertices, vertexIndices);
-
-		if (topologies == nullptr || topologies->Count == 0)
-		{
-			throw gcnew Exception("Error creating a topology from a surface.");
-		}
-
-		Topologic::Face^ face = nullptr;
-		try {
-			face = safe_cast<Topologic::Face^>(topologies[0]);
-		}
-		catch (Exception^)
-		{
-			throw gcnew Exception("Error converting a topology to a face.");
-		}
-
-		return face;
-	}
-
-	double EnergyModel::DoubleValueFromQuery(OpenStudio::SqlFile^ sqlFile, String^ EPReportName, String^ EPReportForString, String^ EPTableName, String^ EPColumnName, String^ EPRowName, String^ EPUnits)
-	{
-		double doubleValue = 0.0;
-		String^ query = "SELECT Value FROM tabulardatawithstrings WHERE ReportName='" + EPReportName + "' AND ReportForString='" + EPReportForString + "' AND TableName = '" + EPTableName + "' AND RowName = '" + EPRowName + "' AND ColumnName= '" + EPColumnName + "' AND Units='" + EPUnits + "'";
-		OpenStudio::OptionalDouble^ osDoubleValue = sqlFile->execAndReturnFirstDouble(query);
-		if (osDoubleValue->is_initialized())
-		{
-			doubleValue = osDoubleValue->get();
-		}
-		else
-		{
-			throw gcnew Exception("Fails to get a double value from the SQL file.");
-		}
-		return doubleValue;
-	}
-
-	String^ EnergyModel::StringValueFromQuery(OpenStudio::SqlFile^ sqlFile, String^ EPReportName, String^ EPReportForString, String^ EPTableName, String^ EPColumnName, String^ EPRowName, String^ EPUnits)
-	{
-		String^ query = "SELECT Value FROM tabulardatawithstrings WHERE ReportName='" + EPReportName + "' AND ReportForString='" + EPReportForString + "' AND TableName = '" + EPTableName + "' AND RowName = '" + EPRowName + "' AND ColumnName= '" + EPColumnName + "' AND Units='" + EPUnits + "'";
-		return sqlFile->execAndReturnFirstString(query)->get();
-	}
-
-	int EnergyModel::IntValueFromQuery(OpenStudio::SqlFile^ sqlFile, String^ EPReportName, String^ EPReportForString, String^ EPTableName, String^ EPColumnName, String^ EPRowName, String^ EPUnits)
-	{
-		String^ query = "SELECT Value FROM tabulardatawithstrings WHERE ReportName='" + EPReportName + "' AND ReportForString='" + EPReportForString + "' AND TableName = '" + EPTableName + "' AND RowName = '" + EPRowName + "' AND ColumnName= '" + EPColumnName + "' AND Units='" + EPUnits + "'";
-		return sqlFile->execAndReturnFirstInt(query)->get();
-	}
-
-	bool EnergyModel::Export(EnergyModel ^ energyModel, String ^ openStudioOutputDirectory, String ^% oswPath)
-	{
-		// Add timestamp to the output file name
-		String^ openStudioOutputTimeStampPath = Path::GetDirectoryName(openStudioOutputDirectory + "\\") + "\\" +
-			Path::GetFileNameWithoutExtension(energyModel->BuildingName) +
-			".osm";
-		// Save model to an OSM file
-		bool saveCondition = SaveModel(energyModel->m_osModel, openStudioOutputTimeStampPath);
-
-		if (!saveCondition)
-		{
-			return false;
-		}
-
-		OpenStudio::WorkflowJSON^ workflow = gcnew OpenStudio::WorkflowJSON();
-		try {
-			String^ osmFilename = Path::GetFileNameWithoutExtension(openStudioOutputTimeStampPath);
-			String^ osmDirectory = Path::GetDirectoryName(openStudioOutputTimeStampPath);
-			oswPath = osmDirectory + "\\" + osmFilename + ".osw";
-			OpenStudio::Path^ osOswPath = OpenStudio::OpenStudioUtilitiesCore::toPath(oswPath);
-			workflow->setSeedFile(OpenStudio::OpenStudioUtilitiesCore::toPath(openStudioOutputTimeStampPath));
-			workflow->setWeatherFile(gcnew OpenStudio::Path());
-			workflow->saveAs(osOswPath);
-			return true;
-		}
-		catch (...)
-		{
-			return false;
-		}
-	}
-
-
-	OpenStudio::DefaultScheduleSet^ EnergyModel::getDefaultScheduleSet(OpenStudio::Model^ model)
-	{
-		// Get list of default schedule sets
-		OpenStudio::DefaultScheduleSetVector^ defaultScheduleSets = model->getDefaultScheduleSets();
-		OpenStudio::DefaultScheduleSetVector::DefaultScheduleSetVectorEnumerator^ defSchedEnum = defaultScheduleSets->GetEnumerator();
-		defSchedEnum->MoveNext();
-		defaultScheduleSet = defSchedEnum->Current;
-		return defaultScheduleSet;
-	}
-
-	OpenStudio::DefaultConstructionSet^ EnergyModel::getDefaultConstructionSet(OpenStudio::Model ^ model)
-	{
-		// Get list of default construction sets
-		OpenStudio::DefaultConstructionSetVector^ defaultConstructionSets = model->getDefaultConstructionSets();
-		// Get the first item and use as the default construction set
-		OpenStudio::DefaultConstructionSetVector::DefaultConstructionSetVectorEnumerator^ defConEnum = defaultConstructionSets->GetEnumerator();
-		defConEnum->MoveNext();
-		defaultConstructionSet = defConEnum->Current;
-		return defaultConstructionSet;
-	}
-
-	OpenStudio::Space^ EnergyModel::AddSpace(
-		int spaceNumber,
-		Cell^ cell,
-		CellComplex^ cellComplex,
-		OpenStudio::Model^ osModel,
-		Autodesk::DesignScript::Geometry::Vector^ upVector,
-		double buildingHeight,
-		IList<double>^ floorLevels,
-		Nullable<double> glazingRatio,
-		double heatingTemp,
-		double coolingTemp)
-	{
-		OpenStudio::Space^ osSpace = gcnew OpenStudio::Space(osModel);
-
-		int storyNumber = StoryNumber(cell, buildingHeight, floorLevels);
-		OpenStudio::BuildingStory^ buildingStory = ((IList< OpenStudio::BuildingStory^>^)buildingStories)[storyNumber];
-		osSpace->setName(buildingStory->name()->get() + "_SPACE_" + spaceNumber.ToString());
-		osSpace->setBuildingStory(buildingStory);
-		osSpace->setDefaultConstructionSet(getDefaultConstructionSet(osModel));
-		osSpace->setDefaultScheduleSet(getDefaultScheduleSet(osModel));
-
-		IList<Face^>^ faces = (IList<Face^>^)cell->Faces;
-		List<OpenStudio::Point3dVector^>^ facePointsList = gcnew List<OpenStudio::Point3dVector^>();
-		for each(Face^ face in faces)
-		{
-			OpenStudio::Point3dVector^ facePoints = GetFacePoints(face);
-			facePointsList->Add(facePoints);
-		}
-
-		for (int i = 0; i < faces->Count; ++i)
-		{
-			AddSurface(i + 1, faces[i], cell, cellComplex, facePointsList[i], osSpace, osModel, upVector, glazingRatio);
-		}
-
-		// Get all space types
-		OpenStudio::SpaceTypeVector^ osSpaceTypes = osModel->getSpaceTypes();
-		OpenStudio::SpaceTypeVector::SpaceTypeVectorEnumerator^ osSpaceTypesEnumerator = osSpaceTypes->GetEnumerator();
-		int spaceTypeCount = osSpaceTypes->Count;
-		while (osSpaceTypesEnumerator->MoveNext())
-		{
-			OpenStudio::SpaceType^ osSpaceType = osSpaceTypesEnumerator->Current;
-			OpenStudio::OptionalString^ osSpaceTypeOptionalString = osSpaceType->name();
-			String^ spaceTypeName = osSpaceTypeOptionalString->__str__();
-			if (spaceTypeName == "ASHRAE 189::1-2009 ClimateZone 4-8 MediumOffice")
-			{
-				osSpace->setSpaceType(osSpaceType);
-			}
-		}
-
-		IList<double>^ minMax = (IList<double>^)Topologic::Utilities::CellUtility::GetMinMax(cell);
-		double minZ = minMax[4];
-		double maxZ = minMax[5];
-		double ceilingHeight = Math::Abs(maxZ - minZ);
-
-		OpenStudio::ThermalZone^ thermalZone = CreateThermalZone(osModel, osSpace, ceilingHeight, heatingTemp, coolingTemp);
-
-		return osSpace;
-	}
-
-
-	void EnergyModel::AddShadingSurfaces(Cell^ buildingCell, OpenStudio::Model^ osModel)
-	{
-		OpenStudio::ShadingSurfaceGroup^ osShadingGroup = gcnew OpenStudio::ShadingSurfaceGroup(osModel);
-		IList<Face^>^ faceList = buildingCell->Faces;
-		int faceIndex = 1;
-		for each(Face^ face in faceList)
-		{
-			IList<Vertex^>^ vertices = face->Vertices;
-			OpenStudio::Point3dVector^ facePoints = gcnew OpenStudio::Point3dVector();
-
-			for each(Vertex^ aVertex in vertices)
-			{
-				OpenStudio::Point3d^ aPoint = gcnew OpenStudio::Point3d(aVertex->X, aVertex->Y, aVertex->Z);
-				facePoints->Add(aPoint);
-			}
-
-			OpenStudio::ShadingSurface^ aShadingSurface = gcnew OpenStudio::ShadingSurface(facePoints, osModel);
-
-			String^ surfaceName = buildingCell->ToString() + "_SHADINGSURFACE_" + (faceIndex.ToString());
-			aShadingSurface->setName(surfaceName);
-			aShadingSurface->setShadingSurfaceGroup(osShadingGroup);
-
-			++faceIndex;
-		}
-	}
-
-	void EnergyModel::AddShadingSurfaces(Face ^ buildingFace, OpenStudio::Model ^ osModel, OpenStudio::ShadingSurfaceGroup^ osShadingGroup, int faceIndex)
-	{
-		IList<Vertex^>^ vertices = buildingFace->Vertices;
-		OpenStudio::Point3dVector^ facePoints = gcnew OpenStudio::Point3dVector();
-
-		for each(Vertex^ aVertex in vertices)
-		{
-			OpenStudio::Point3d^ aPoint = gcnew OpenStudio::Point3d(aVertex->X, aVertex->Y, aVertex->Z);
-			facePoints->Add(aPoint);
-		}
-
-		OpenStudio::ShadingSurface^ aShadingSurface = gcnew OpenStudio::ShadingSurface(facePoints, osModel);
-
-		String^ surfaceName = "SHADINGSURFACE_" + (faceIndex.ToString());
-		aShadingSurface->setName(surfaceName);
-		aShadingSurface->setShadingSurfaceGroup(osShadingGroup);
-	}
-
-	OpenStudio::Surface^ EnergyModel::AddSurface(
-		int surfaceNumber,
-		Face^ buildingFace,
-		Cell^ buildingSpace,
-		CellComplex^ cellComplex,
-		OpenStudio::Point3dVector^ osFacePoints,
-		OpenStudio::Space^ osSpace,
-		OpenStudio::Model^ osModel,
-		Autodesk::DesignScript::Geometry::Vector^ upVector,
-		[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> glazingRatio)
-	{
-		OpenStudio::Construction^ osInteriorCeilingType = nullptr;
-		OpenStudio::Construction^ osExteriorRoofType = nullptr;
-		OpenStudio::Construction^ osInteriorFloorType = nullptr;
-		OpenStudio::Construction^ osInteriorWallType = nullptr;
-		OpenStudio::Construction^ osExteriorDoorType = nullptr;
-		OpenStudio::Construction^ osExteriorWallType = nullptr;
-		OpenStudio::Construction^ osExteriorWindowType = nullptr;
-		int subsurfaceCounter = 1;
-
-		OpenStudio::ConstructionVector^ osConstructionTypes = osModel->getConstructions();
-		OpenStudio::ConstructionVector::ConstructionVectorEnumerator^ osConstructionTypesEnumerator =
-			osConstructionTypes->GetEnumerator();
-		int constructionTypeCount = osConstructionTypes->Count;
-
-		while (osConstructionTypesEnumerator->MoveNext())
-		{
-			OpenStudio::Construction^ osConstruction = osConstructionTypesEnumerator->Current;
-			OpenStudio::OptionalString^ osConstructionTypeOptionalString = osConstruction->name();
-			String^ constructionTypeName = osConstructionTypeOptionalString->__str__();
-			if (constructionTypeName->Equals("000 Interior Ceiling"))
-			{
-				osInteriorCeilingType = osConstruction;
-			}
-			else if (constructionTypeName->Equals("000 Interior Floor"))
-			{
-				osInteriorFloorType = osConstruction;
-			}
-			else if (constructionTypeName->Equals("000 Interior Wall"))
-			{
-				osInteriorWallType = osConstruction;
-			}
-			else if (constructionTypeName->Equals("ASHRAE 189.1-2009 ExtWindow ClimateZone 4-5"))
-			{
-				osExteriorWindowType = osConstruction;
-			}
-			else if (constructionTypeName->Equals("000 Exterior Door"))
-			{
-				osExteriorDoorType = osConstruction;
-			}
-			else if (constructionTypeName->Equals("ASHRAE 189.1-2009 ExtRoof IEAD ClimateZone 2-5"))
-			{
-				osExteriorRoofType = osConstruction;
-			}
-			else if (constructionTypeName->Equals("ASHRAE 189.1-2009 ExtWall SteelFrame ClimateZone 4-8"))
-			{
-				osExteriorWallType = osConstruction;
-			}
-		} // while (osConstructionTypesEnumerator.MoveNext())
-
-		int adjCount = AdjacentCellCount(buildingFace);
-		//HACK
-		/*if (adjCount > 1)
-		{
-			osFacePoints->Reverse();
-		}*/
-
-		OpenStudio::Surface^ osSurface = gcnew OpenStudio::Surface(osFacePoints, osModel);
-		osSurface->setSpace(osSpace);
-		OpenStudio::OptionalString^ osSpaceOptionalString = osSpace->name();
-		String^ spaceName = osSpace->name()->get();
-		String^ surfaceName = osSpace->name()->get() + "_SURFACE_" + surfaceNumber.ToString();
-		bool isUnderground = IsUnderground(buildingFace);
-		FaceType faceType = CalculateFaceType(buildingFace, osFacePoints, buildingSpace, upVector);
-		osSurface->setName(surfaceName);
-
-		if ((faceType == FACE_ROOFCEILING) && (adjCount > 1))
-		{
-
-			osSurface->setOutsideBoundaryCondition("Surface");
-			osSurface->setSurfaceType("RoofCeiling");
-			osSurface->setConstruction(osInteriorCeilingType);
-			osSurface->setSunExposure("NoSun");
-			osSurface->setWindExposure("NoWind");
-		}
-		else if ((faceType == FACE_ROOFCEILING) && (adjCount < 2) && (!isUnderground))
-		{
-			OpenStudio::Vector3d^ pSurfaceNormal = osSurface->outwardNormal();
-
-			double x = pSurfaceNormal->x();
-			double y = pSurfaceNormal->y();
-			double z = pSurfaceNormal->z();
-			pSurfaceNormal->normalize();
-			OpenStudio::Vector3d^ upVector = gcnew OpenStudio::Vector3d(0, 0, 1.0);
-			// If the normal does not point downward, flip it. Use dot product.
-			double dotProduct = pSurfaceNormal->dot(upVector);
-			if (dotProduct < 0.98)
-			{
-				OpenStudio::Point3dVector^ surfaceVertices = osSurface->vertices();
-				surfaceVertices->Reverse();
-				osSurface->setVertices(surfaceVertices);
-			}
-			osSurface->setOutsideBoundaryCondition("Outdoors");
-			osSurface->setSurfaceType("RoofCeiling");
-			osSurface->setConstruction(osExteriorRoofType);
-			osSurface->setSunExposure("SunExposed");
-			osSurface->setWindExposure("WindExposed");
-		}
-		else if ((faceType == FACE_ROOFCEILING) && (adjCount < 2) && isUnderground)
-		{
-			OpenStudio::Vector3d^ pSurfaceNormal = osSurface->outwardNormal();
-
-			double x = pSurfaceNormal->x();
-			double y = pSurfaceNormal->y();
-			double z = pSurfaceNormal->z();
-			pSurfaceNormal->normalize();
-			OpenStudio::Vector3d^ upVector = gcnew OpenStudio::Vector3d(0, 0, 1.0);
-			// If the normal does not point downward, flip it. Use dot product.
-			double dotProduct = pSurfaceNormal->dot(upVector);
-			if (dotProduct < 0.98)
-			{
-				OpenStudio::Point3dVector^ surfaceVertices = osSurface->vertices();
-				surfaceVertices->Reverse();
-				osSurface->setVertices(surfaceVertices);
-			}
-			osSurface->setOutsideBoundaryCondition("Ground");
-			osSurface->setSurfaceType("RoofCeiling");
-			osSurface->setConstruction(osExteriorRoofType);
-			osSurface->setSunExposure("NoSun");
-			osSurface->setWindExposure("NoWind");
-		}
-		else if ((faceType == FACE_FLOOR) && (adjCount > 1))
-		{
-			osSurface->setOutsideBoundaryCondition("Surface");
-			osSurface->setSurfaceType("Floor");
-			osSurface->setConstruction(osInteriorFloorType);
-			osSurface->setSunExposure("NoSun");
-			osSurface->setWindExposure("NoWind");
-		}
-		else if ((faceType == FACE_FLOOR) && (adjCount < 2))
-		{
-			OpenStudio::Vector3d^ pSurfaceNormal = osSurface->outwardNormal();
-
-			double x = pSurfaceNormal->x();
-			double y = pSurfaceNormal->y();
-			double z = pSurfaceNormal->z();
-			pSurfaceNormal->normalize();
-			OpenStudio::Vector3d^ downwardVector = gcnew OpenStudio::Vector3d(0, 0, -1.0);
-			// If the normal does not point downward, flip it. Use dot product.
-			double dotProduct = pSurfaceNormal->dot(downwardVector);
-			if (dotProduct < 0.98)
-			{
-				OpenStudio::Point3dVector^ surfaceVertices = osSurface->vertices();
-				surfaceVertices->Reverse();
-				osSurface->setVertices(surfaceVertices);
-			}
-			osSurface->setOutsideBoundaryCondition("Ground");
-			osSurface->setSurfaceType("Floor");
-			osSurface->setConstruction(osExteriorWallType);
-			osSurface->setSunExposure("NoSun");
-			osSurface->setWindExposure("NoWind");
-		}
-		else if ((faceType == FACE_WALL) && (adjCount > 1)) // internal wall
-		{
-			osSurface->setOutsideBoundaryCondition("Surface");
-			osSurface->setSurfaceType("Wall");
-			osSurface->setConstruction(osInteriorWallType);
-			osSurface->setSunExposure("NoSun");
-			osSurface->setWindExposure("NoWind");
-		}
-		else if ((faceType == FACE_WALL) && (adjCount < 2) && isUnderground) // external wall underground
-		{
-			osSurface->setOutsideBoundaryCondition("Ground");
-			osSurface->setSurfaceType("Wall");
-			osSurface->setConstruction(osExteriorWallType);
-			osSurface->setSunExposure("NoSun");
-			osSurface->setWindExposure("NoWind");
-		}
-		else if ((faceType == FACE_WALL) && (adjCount < 2) && (!isUnderground)) // external wall overground
-		{
-			osSurface->setOutsideBoundaryCondition("Outdoors");
-			osSurface->setSurfaceType("Wall");
-			osSurface->setConstruction(osExteriorWallType);
-			osSurface->setSunExposure("SunExposed");
-			osSurface->setWindExposure("WindExposed");
-
-			if (glazingRatio.HasValue)
-			{
-				if (glazingRatio.Value < 0.0 || glazingRatio.Value > 1.0)
-				{
-					throw gcnew Exception("The glazing ratio must be between 0.0 and 1.0 (both inclusive).");
-				}
-				else if (glazingRatio.Value > 0.0 && glazingRatio.Value <= 1.0)
-				{
-					// Triangulate the Windows
-					IList<Vertex^>^ scaledVertices = (IList<Vertex^>^)ScaleFaceVertices(buildingFace, glazingRatio.Value);
-
-					for (int i = 0; i < scaledVertices->Count - 2; ++i)
-					{
-						List<Vertex^>^ triangleVertices = gcnew List<Vertex^>();
-						triangleVertices->Add(scaledVertices[0]);
-						triangleVertices->Add(scaledVertices[i + 1]);
-						triangleVertices->Add(scaledVertices[i + 2]);
-
-						IList<Vertex^>^ scaledTriangleVertices = ScaleVertices(triangleVertices, 0.999);
-
-						OpenStudio::Point3dVector^ osWindowFacePoints = gcnew OpenStudio::Point3dVector();
-
-						for each (Vertex^ scaledTriangleVertex in scaledTriangleVertices)
-						{
-							OpenStudio::Point3d^ osPoint = gcnew OpenStudio::Point3d(
-								scaledTriangleVertex->X,
-								scaledTriangleVertex->Y,
-								scaledTriangleVertex->Z);
-
-							osWindowFacePoints->Add(osPoint);
-						}
-
-						OpenStudio::SubSurface^ osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel);
-						double dotProduct = osWindowSubSurface->outwardNormal()->dot(osSurface->outwardNormal());
-						if (dotProduct < -0.99) // flipped
-						{
-							osWindowFacePoints->Reverse();
-							osWindowSubSurface->remove();
-							osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel); //CreateSubSurface(pApertureVertices, osModel);
-						}
-						else if (dotProduct > -0.99 && dotProduct < 0.99)
-						{
-							throw gcnew Exception("There is a non-coplanar subsurface.");
-						}
-						osWindowSubSurface->setSubSurfaceType("FixedWindow");
-						osWindowSubSurface->setSurface(osSurface);
-						osWindowSubSurface->setName(osSurface->name()->get() + "_SUBSURFACE_" + subsurfaceCounter.ToString());
-						subsurfaceCounter++;
-					} // for (int i = 0; i < scaledVertices->Count - 2; ++i)
-				}
-			}
-			else // glazingRatio is null
-			{
-				// Use the surface apertures
-				IList<Topologic::Topology^>^ pContents = buildingFace->Contents;
-				for each(Topologic::Topology^ pContent in pContents)
-				{
-					Aperture^ pAperture = dynamic_cast<Aperture^>(pContent);
-					if (pAperture == nullptr)
-					{
-						continue;
-					}
-
-					Face^ pFaceAperture = dynamic_cast<Face^>(pAperture->Topology);
-					if (pAperture == nullptr)
-					{
-						continue;
-					}
-					// skip small triangles
-					double area = Topologic::Utilities::FaceUtility::Area(pFaceAperture);
-					if (area <= 0.1)
-					{
-						continue;
-					}
-					Wire^ pApertureWire = pFaceAperture->ExternalBoundary;
-					List<Vertex^>^ pApertureVertices = (List<Vertex^>^)pApertureWire->Vertices;
-					//OpenStudio::SubSurface^ osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel);
-					OpenStudio::SubSurface^ osWindowSubSurface = CreateSubSurface(pApertureVertices, osModel);
-					double dotProduct = osWindowSubSurface->outwardNormal()->dot(osSurface->outwardNormal());
-					if (dotProduct < -0.99) // flipped
-					{
-						pApertureVertices->Reverse();
-						osWindowSubSurface->remove();
-						osWindowSubSurface = CreateSubSurface(pApertureVertices, osModel);
-					}
-					else if (dotProduct > -0.99 && dotProduct < 0.99)
-					{
-						throw gcnew Exception("There is a non-coplanar subsurface.");
-					}
-
-					numOfApertures++;
-
-					double grossSubsurfaceArea = osWindowSubSurface->grossArea();
-					double netSubsurfaceArea = osWindowSubSurface->netArea();
-					double grossSurfaceArea = osSurface->grossArea();
-					double netSurfaceArea = osSurface->netArea();
-					if (grossSubsurfaceArea > 0.1)
-					{
-						osWindowSubSurface->setSubSurfaceType("FixedWindow");
-						bool result = osWindowSubSurface->setSurface(osSurface);
-						if (result)
-						{
-							osWindowSubSurface->setName(osSurface->name()->get() + "_SUBSURFACE_" + subsurfaceCounter.ToString());
-							subsurfaceCounter++;
-							numOfAppliedApertures++;
-						}
-					}
-					else
-					{
-						osWindowSubSurface->remove();
-					}
-				}
-			}
-		}
-
-		return osSurface;
-	}
-
-	IList<Vertex^>^ EnergyModel::ScaleFaceVertices(Face^ buildingFace, double scaleFactor)
-	{
-		Wire^ pApertureWire = buildingFace->ExternalBoundary;
-		List<Vertex^>^ vertices = (List<Vertex^>^)pApertureWire->Vertices;
-		vertices->Reverse();
-
-		return ScaleVertices(vertices, scaleFactor);
-	}
-
-	IList<Vertex^>^ EnergyModel::ScaleVertices(IList<Vertex^>^ vertices, double scaleFactor)
-	{
-		List<Vertex^>^ scaledVertices = gcnew List<Vertex^>();
-		double sqrtScaleFactor = Math::Sqrt(scaleFactor);
-		Vertex^ centreVertex = GetCentreVertex(vertices);
-		Autodesk::DesignScript::Geometry::Point^ faceCenterPoint =
-			safe_cast<Autodesk::DesignScript::Geometry::Point^>(centreVertex->BasicGeometry);
-		for each(Vertex^ aVertex in vertices)
-		{
-			Autodesk::DesignScript::Geometry::Point^ originalPoint =
-				safe_cast<Autodesk::DesignScript::Geometry::Point^>(aVertex->BasicGeometry);
-			Autodesk::DesignScript::Geometry::Vector^ originalPointAsVector = faceCenterPoint->AsVector();
-			Autodesk::DesignScript::Geometry::Point^ translatedPoint = originalPoint->Subtract(originalPointAsVector);
-			Autodesk::DesignScript::Geometry::Point^ scaledPoint = safe_cast<Autodesk::DesignScript::Geometry::Point^>(translatedPoint->Scale(sqrtScaleFactor, sqrtScaleFactor, sqrtScaleFactor));
-			Autodesk::DesignScript::Geometry::Vector^ scaledPointAsVector = faceCenterPoint->AsVector();
-			Autodesk::DesignScript::Geometry::Point^ reTranslatedPoint = scaledPoint->Add(scaledPointAsVector);
-			scaledVertices->Add(safe_cast<Vertex^>(Topologic::Topology::ByGeometry(reTranslatedPoint, 0.001))); // tolerance does not matter as it's just a vertex
-
-			delete reTranslatedPoint;
-			delete scaledPointAsVector;
-			delete scaledPoint;
-			delete translatedPoint;
-			delete originalPointAsVector;
-			delete originalPoint;
-		}
-
-		delete faceCenterPoint;
-
-		return scaledVertices;
-	}
-
-	Vertex^ EnergyModel::GetCentreVertex(IList<Vertex^>^ vertices)
-	{
-		Autodesk::DesignScript::Geometry::Point^ sumPoint = Autodesk::DesignScript::Geometry::Point::ByCoordinates(0, 0, 0);
-
-		// assume vertices.count > 0
-		if (vertices->Count < 3)
-		{
-			throw gcnew Exception("Invalid face");
-		}
-
-		for each(Vertex^ v in vertices)
-		{
-			Autodesk::DesignScript::Geometry::Point^ p =
-				safe_cast<Autodesk::DesignScript::Geometry::Point^>(v->BasicGeometry);
-			Autodesk::DesignScript::Geometry::Vector^ vector = p->AsVector();
-			sumPoint = sumPoint->Add(vector);
-			delete vector;
-			delete p;
-		}
-		
-		double scalingFactor = 1.0 / (double)vertices->Count;
-		Autodesk::DesignScript::Geometry::Geometry^ scaledPoint = sumPoint->Scale(scalingFactor, scalingFactor, scalingFactor);
-		Autodesk::DesignScript::Geometry::Point^ dynamoPoint = safe_cast<Autodesk::DesignScript::Geometry::Point^>(scaledPoint);
-		Vertex^ vertex = safe_cast<Vertex^>(Topologic::Topology::ByGeometry(dynamoPoint, 0.001)); // tolerance does not matter as it's just a vertex
-		delete dynamoPoint;
-		delete sumPoint;
-		return vertex;
-	}
-
-	OpenStudio::Point3dVector^ EnergyModel::GetFacePoints(Face^ buildingFace)
-	{
-		Wire^ buildingOuterWire = buildingFace->ExternalBoundary;
-		IList<Vertex^>^ vertices = buildingOuterWire->Vertices;
-
-		OpenStudio::Point3dVector^ osFacePoints = gcnew OpenStudio::Point3dVector();
-
-		for each(Vertex^ v in vertices)
-		{
-			OpenStudio::Point3d^ osPoint = gcnew OpenStudio::Point3d(
-				v->X,
-				v->Y,
-				v->Z);
-
-			osFacePoints->Add(osPoint);
-		}
-
-		return osFacePoints;
-	}
-
-	bool EnergyModel::IsUnderground(Face^ buildingFace)
-	{
-		IList<Vertex^>^ vertices = buildingFace->Vertices;
-
-		for each(Vertex^ aVertex in vertices)
-		{
-			if (aVertex->Z > 0.0)
-			{
-				return false;
-			}
-		}
-
-		return true;
-	}
-
-	FaceType EnergyModel::CalculateFaceType(Face^ buildingFace, OpenStudio::Point3dVector^% facePoints, Cell^ buildingSpace, Autodesk::DesignScript::Geometry::Vector^ upVector)
-	{
-		FaceType faceType = FACE_WALL;
-		IList<Face^>^ faces = (IList<Face^>^) Topologic::Utilities::FaceUtility::Triangulate(buildingFace, 0.01);
-		if (faces->Count == 0)
-		{
-			throw gcnew Exception("Failed to triangulate a face.");
-		}
-
-		Face^ firstFace = faces[0];
-		Vertex^ centerPoint = firstFace->CenterOfMass;
-		Autodesk::DesignScript::Geometry::Point^ dynamoCenterPoint =
-			safe_cast<Autodesk::DesignScript::Geometry::Point^>(centerPoint->BasicGeometry);
-
-		IList<Vertex^>^ vertices = (IList<Vertex^>^)buildingFace->Vertices;
-		Autodesk::DesignScript::Geometry::Point^ p1 =
-			safe_cast<Autodesk::DesignScript::Geometry::Point^>(vertices[0]->BasicGeometry);
-		Autodesk::DesignScript::Geometry::Vector^ p1AsVector = p1->AsVector();
-		Autodesk::DesignScript::Geometry::Point^ p2 =
-			safe_cast<Autodesk::DesignScript::Geometry::Point^>(vertices[1]->BasicGeometry);
-		Autodesk::DesignScript::Geometry::Point^ p2Subtract = p2->Subtract(p1AsVector);
-		Autodesk::DesignScript::Geometry::Vector^ p2SubtractAsVector = p2Subtract->AsVector();
-		Autodesk::DesignScript::Geometry::Point^ p3 =
-			safe_cast<Autodesk::DesignScript::Geometry::Point^>(vertices[2]->BasicGeometry);
-		Autodesk::DesignScript::Geometry::Point^ p3Subtract = p3->Subtract(p1AsVector);
-		Autodesk::DesignScript::Geometry::Vector^ p3SubtractAsVector = p3Subtract->AsVector();
-		Autodesk::DesignScript::Geometry::Vector^ dir = p2SubtractAsVector->Cross(p3SubtractAsVector);
-		Autodesk::DesignScript::Geometry::Vector^ faceNormal = dir->Normalized();
-		double faceAngle = faceNormal->AngleWithVector(upVector);
-		Autodesk::DesignScript::Geometry::Vector^ scaledFaceNormal = faceNormal->Scale(0.001, 0.001, 0.001);
-		Autodesk::DesignScript::Geometry::Point^ pDynamoOffsetPoint =
-			dynamic_cast<Autodesk::DesignScript::Geometry::Point^>(dynamoCenterPoint->Translate(scaledFaceNormal));
-
-		Vertex^ pOffsetVertex = safe_cast<Vertex^>(Topologic::Topology::ByGeometry(pDynamoOffsetPoint, 0.001)); // tolerance does not matter as it's just a vertex
-
-		if (faceAngle < 5.0 || faceAngle > 175.0)
-		{
-			bool isInside = Topologic::Utilities::CellUtility::Contains(buildingSpace, pOffsetVertex, true, 0.0001);
-			// The offset vertex has to be false, so if isInside is true, reverse the face.
-
-			if (isInside)
-			{
-				facePoints->Reverse();
-				faceNormal = faceNormal->Reverse();
-				faceAngle = faceNormal->AngleWithVector(upVector);
-			}
-
-			if (faceAngle < 5.0)
-			{
-				faceType = FACE_ROOFCEILING;
-			}
-			else if (faceAngle > 175.0)
-			{
-				faceType = FACE_FLOOR;
-			}
-		}
-
-		delete dynamoCenterPoint;
-		delete p1;
-		delete p1AsVector;
-		delete p2;
-		delete p2Subtract;
-		delete p2SubtractAsVector;
-		delete p3;
-		delete p3Subtract;
-		delete p3SubtractAsVector;
-		delete dir;
-		delete faceNormal;
-		delete scaledFaceNormal;
-		delete pDynamoOffsetPoint;
-
-		return faceType;
-	}
-
-	int EnergyModel::AdjacentCellCount(Face^ buildingFace)
-	{
-		return buildingFace->Cells->Count;
-	}
-
-	int EnergyModel::StoryNumber(Cell^ buildingCell, double buildingHeight, IList<double>^ floorLevels)
-	{
-		IList<double>^ floorLevelList = (IList<double>^) floorLevels;
-		double volume = Utilities::CellUtility::Volume(buildingCell);
-		Vertex^ centreOfMass = buildingCell->CenterOfMass;
-		for (int i = 0; i < floorLevelList->Count - 1; ++i)
-		{
-			if (centreOfMass->Z > floorLevelList[i] && centreOfMass->Z < floorLevelList[i + 1])
-			{
-				return i;
-			}
-		}
-
-		return 0;
-	}
-
-	bool EnergyModel::ExportTogbXML(EnergyModel^ energyModel, String ^ filePath)
-	{
-		if (filePath == nullptr)
-		{
-			throw gcnew Exception("The input filePath must not be null.");
-		}
-
-		if (energyModel == nullptr)
-		{
-			throw gcnew Exception("The input energy model is null.");
-		}
-
-		OpenStudio::Model^ osModel = energyModel->OsModel;
-		OpenStudio::GbXMLForwardTranslator^ osForwardTranslator = gcnew OpenStudio::GbXMLForwardTranslator();
-		OpenStudio::Path^ osPath = OpenStudio::OpenStudioUtilitiesCore::toPath(filePath);
-		bool success = osForwardTranslator->modelToGbXML(osModel, osPath);
-		OpenStudio::LogMessageVector^ osErrors = osForwardTranslator->errors();
-		if (osErrors->Count > 0)
-		{
-			String^ errorMsg = gcnew String("Fails exporting an EnergyModel to GbXML with the following errors:\n");
-			int i = 0;
-			for each(auto osError in osErrors)
-			{
-				errorMsg += osError->logMessage();
-
-				if (i < osErrors->Count - 1)
-				{
-					errorMsg += "\n";
-				}
-				++i;
-			}
-			throw gcnew Exception(errorMsg);
-		}
-
-		return true;
-	}
-
-	EnergyModel^ EnergyModel::ByImportedgbXML(String ^ filePath, double tolerance)
-	{
-		if (filePath == nullptr)
-		{
-			throw gcnew Exception("The input filePath must not be null.");
-		}
-
-		if (tolerance <= 0.0)
-		{
-			throw gcnew Exception("The tolerance must have a positive value.");
-		}
-
-		OpenStudio::GbXMLReverseTranslator^ osReverseTranslator = gcnew OpenStudio::GbXMLReverseTranslator();
-		OpenStudio::Path^ osPath = OpenStudio::OpenStudioUtilitiesCore::toPath(filePath);
-		OpenStudio::OptionalModel^ osOptionalModel = osReverseTranslator->loadModel(osPath);
-		if (osOptionalModel->isNull())
-		{
-			throw gcnew Exception("The imported gbXML yields a null OpenStudio Model.");
-		}
-		OpenStudio::Model^ osModel = osOptionalModel->get();
-
-		OpenStudio::LogMessageVector^ osErrors = osReverseTranslator->errors();
-		if (osErrors->Count > 0)
-		{
-			String^ errorMsg = gcnew String("Fails importing an OpenStudio model from GbXML with the following errors:\n");
-			int i = 0;
-			for each(auto osError in osErrors)
-			{
-				errorMsg += osError->logMessage();
-
-				if (i < osErrors->Count - 1)
-				{
-					errorMsg += "\n";
-				}
-				++i;
-			}
-			throw gcnew Exception(errorMsg);
-		}
-
-
-		OpenStudio::Building^ osBuilding = nullptr;
-		List<Cell^>^ buildingCells = nullptr;
-		Cluster^ shadingFaces = nullptr;
-		OpenStudio::SpaceVector^ osSpaceVector = nullptr;
-		ProcessOsModel(osModel, tolerance, osBuilding, buildingCells, shadingFaces, osSpaceVector);
-
-		EnergyModel^ energyModel = gcnew EnergyModel(osModel, osBuilding, buildingCells, shadingFaces, osSpaceVector);
-
-		return energyModel;
-	}
-
-	IList<int>^ EnergyModel::GetColor(double ratio)
-	{
-		double r = 0.0;
-		double g = 0.0;
-		double b = 0.0;
-
-		double finalRatio = ratio;
-		if (finalRatio < 0.0)
-		{
-			finalRatio = 0.0;
-		}
-		else if(finalRatio > 1.0)
-		{
-			finalRatio = 1.0;
-		}
-
-		if (finalRatio >= 0.0 && finalRatio <= 0.25)
-		{
-			r = 0.0;
-			g = 4.0 * finalRatio;
-			b = 1.0;
-		}
-		else if (finalRatio > 0.25 && finalRatio <= 0.5)
-		{
-			r = 0.0;
-			g = 1.0;
-			b = 1.0 - 4.0 * (finalRatio - 0.25);
-		}
-		else if (finalRatio > 0.5 && finalRatio <= 0.75)
-		{
-			r = 4.0*(finalRatio - 0.5);
-			g = 1.0;
-			b = 0.0;
-		}
-		else
-		{
-			r = 1.0;
-			g = 1.0 - 4.0 * (finalRatio - 0.75);
-			b = 0.0;
-		}
-
-		int rcom = (int) Math::Floor(Math::Max(Math::Min(Math::Floor(255.0 * r), 255.0), 0.0));
-		int gcom = (int) Math::Floor(Math::Max(Math::Min(Math::Floor(255.0 * g), 255.0), 0.0));
-		int bcom = (int) Math::Floor(Math::Max(Math::Min(Math::Floor(255.0 * b), 255.0), 0.0));
-		List<int>^ rgb = gcnew List<int>();
-		rgb->Add(rcom);
-		rgb->Add(gcom);
-		rgb->Add(bcom);
-		return rgb;
-	}
-
-	String^ EnergyModel::BuildingName::get()
-	{
-		if (m_osBuilding == nullptr)
-		{
-			return "";
-		}
-
-		OpenStudio::OptionalString^ osName = m_osBuilding->name();
-		return osName->get();
-	}
-
-	IList<Topologic::Cell^>^ EnergyModel::Topology::get()
-	{
-		return m_buildingCells;
-	}
-
-	EnergyModel::EnergyModel(OpenStudio::Model^ osModel, OpenStudio::Building^ osBuilding, IList<Topologic::Cell^>^ pBuildingCells, 
-		Cluster^ shadingSurfaces, OpenStudio::SpaceVector^ osSpaces)
-		: m_osModel(osModel)
-		, m_osBuilding(osBuilding)
-		, m_buildingCells(pBuildingCells)
-		, m_osSpaceVector(osSpaces)
-		, m_shadingSurfaces(shadingSurfaces)
-	{
-
-	}
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "EnergyModel.h"
+#include "BuildingModelKernels.h"
+#include "CellGeometry.h"
+#include "ColorMapKernels.h"
+#include "EnergySimulation.h"
+#include "FaceAdjacency.h"
+#include "ModelBuildContext.h"
+#include "ModelOverrides.h"
+#include "ModelSnapshotFormat.h"
+#include "NativeInterop.h"
+#include "PipelineMetrics.h"
+#include "PolygonKernels.h"
+#include "RenderCache.h"
+#include "ShadingFilter.h"
+#include "SqlFilePool.h"
+#include "ThermalZoning.h"
+#include "TraceRecorder.h"
+#include "WindowLayout.h"
+
+#include <sstream>
+
+using namespace System::Diagnostics;
+using namespace System::IO;
+using namespace System::Linq;
+
+namespace TopologicEnergy
+{
+	// The tolerance of the cells rebuilt from a snapshot, as used for the face adjacency of ByCellComplex
+	static const double SnapshotTolerance = 0.0001;
+
+	// The cells of a complex in the order of the cells it was built from, matched by centroid, since
+	// CellComplex::ByCells does not keep the order of its input.
+	static IList<Cell^>^ InCellOrder(IList<Cell^>^ cells, IList<Cell^>^ complexCells)
+	{
+		if (complexCells->Count != cells->Count)
+		{
+			throw gcnew Exception("The cells of the model snapshot do not form a cell complex.");
+		}
+
+		CellGeometry^ cellGeometry = gcnew CellGeometry(cells, nullptr);
+		CellGeometry^ complexGeometry = gcnew CellGeometry(complexCells, nullptr);
+		array<Vertex^>^ centroids = gcnew array<Vertex^>(cells->Count);
+		for (int i = 0; i < cells->Count; ++i)
+		{
+			centroids[i] = cellGeometry->Centroid(i);
+		}
+
+		array<Cell^>^ orderedCells = gcnew array<Cell^>(cells->Count);
+		for (int i = 0; i < complexCells->Count; ++i)
+		{
+			Vertex^ complexCentroid = complexGeometry->Centroid(i);
+			int nearestCell = 0;
+			double nearestDistance = Double::MaxValue;
+			for (int j = 0; j < centroids->Length; ++j)
+			{
+				double dx = centroids[j]->X - complexCentroid->X;
+				double dy = centroids[j]->Y - complexCentroid->Y;
+				double dz = centroids[j]->Z - complexCentroid->Z;
+				double distance = dx * dx + dy * dy + dz * dz;
+				if (distance < nearestDistance)
+				{
+					nearestCell = j;
+					nearestDistance = distance;
+				}
+			}
+
+			if (orderedCells[nearestCell] != nullptr)
+			{
+				throw gcnew Exception("The cells of the model snapshot do not form a cell complex.");
+			}
+			orderedCells[nearestCell] = complexCells[i];
+		}
+		delete complexGeometry;
+		delete cellGeometry;
+		return gcnew List<Cell^>(orderedCells);
+	}
+
+	bool EnergyModel::CreateIdfFile(OpenStudio::Model^ osModel, String^ idfPathName)
+	{
+		if (idfPathName == nullptr)
+		{
+			throw gcnew Exception("The input idfPathName must not be null.");
+		}
+
+		OpenStudio::EnergyPlusForwardTranslator^ osForwardTranslator = gcnew OpenStudio::EnergyPlusForwardTranslator();
+		OpenStudio::Workspace^ osWorkspace = osForwardTranslator->translateModel(osModel);
+		OpenStudio::IdfFile^ osIdfFile = osWorkspace->toIdfFile();
+		OpenStudio::Path^ osIdfPath = OpenStudio::OpenStudioUtilitiesCore::toPath(idfPathName);
+		bool idfSaveCondition = osIdfFile->save(osIdfPath);
+		return idfSaveCondition;
+	}
+
+	EnergyModel^ EnergyModel::ByCellComplex(
+		CellComplex^ building,
+		Cluster^ shadingSurfaces,
+		IList<double>^ floorLevels,
+		String^ buildingName,
+		String^ buildingType,
+		String^ defaultSpaceType,
+		double northAxis,
+		Nullable<double> glazingRatio,
+		double coolingTemp,
+		double heatingTemp,
+		String^ weatherFilePath,
+		String^ designDayFilePath,
+		String^ openStudioTemplatePath,
+		WindowLayout^ windowLayout,
+		ThermalZoning^ thermalZoning,
+		ShadingFilter^ shadingFilter
+	)
+	{
+		TopologicEnergyCore::TraceSpan span("ByCellComplex");
+		IList<double>^ floorLevelList = (IList<double>^) floorLevels;
+		CellComplex^ buildingCopy = building->Copy<CellComplex^>();
+
+		// Create an OpenStudio model from the template, EPW, and DDY
+		PipelineMetrics^ metrics = gcnew PipelineMetrics();
+		metrics->BeginStage();
+		OpenStudio::Model^ osModel = GetModelFromTemplate(openStudioTemplatePath, weatherFilePath, designDayFilePath);
+		ModelBuildContext^ context = gcnew ModelBuildContext(osModel, getDefaultConstructionSet(osModel), getDefaultScheduleSet(osModel), metrics);
+		metrics->EndStage("GetModelFromTemplate");
+
+		double buildingHeight = Enumerable::Max(floorLevels);
+
+		int numFloors = floorLevelList->Count - 1;
+		metrics->BeginStage();
+		OpenStudio::Building^ osBuilding = ComputeBuilding(context, buildingName, buildingType, buildingHeight, numFloors, northAxis, defaultSpaceType);
+		metrics->EndStage("ComputeBuilding");
+		IList<Cell^>^ pBuildingCells = buildingCopy->Cells;
+		span.SetAttribute("cells", pBuildingCells->Count);
+
+		// Create OpenStudio spaces
+		metrics->BeginStage();
+		OpenStudio::SpaceVector^ osSpaceVector = gcnew OpenStudio::SpaceVector();
+
+		// One pass over the faces of all cells: the per-cell metrics, and the adjacency table read by
+		// the interior/exterior decisions and the surface matching.
+		CellGeometry^ cellGeometry = gcnew CellGeometry(pBuildingCells, floorLevels);
+		FaceAdjacency^ faceAdjacency = gcnew FaceAdjacency(cellGeometry, 0.0001);
+		List<OpenStudio::Space^>^ osSpaces = gcnew List<OpenStudio::Space^>();
+
+		Autodesk::DesignScript::Geometry::Vector^ dynamoZAxis = Autodesk::DesignScript::Geometry::Vector::ZAxis();
+		array<int>^ storySpaceCounts = gcnew array<int>(context->BuildingStories->Count);
+		for (int cellIndex = 0; cellIndex < pBuildingCells->Count; ++cellIndex)
+		{
+			Cell^ buildingCell = pBuildingCells[cellIndex];
+			// Spaces are numbered per story, as in BuildModel
+			int spaceNumber = ++storySpaceCounts[cellGeometry->StoryNumber(cellIndex)];
+			OpenStudio::Space^ osSpace = AddSpace(
+				spaceNumber,
+				buildingCell,
+				cellGeometry,
+				faceAdjacency,
+				cellIndex,
+				context,
+				dynamoZAxis,
+				glazingRatio,
+				windowLayout
+			);
+
+			Dictionary<String^, Object^>^ attributes = gcnew Dictionary<String^, Object^>();
+			attributes->Add("Name", osSpace->nameString());
+			buildingCell->AddAttributesNoCopy(attributes);
+
+			// Only the spaces sharing a face can have matching surfaces.
+			for each(int adjacentCellIndex in faceAdjacency->AdjacentCells(cellIndex))
+			{
+				if (adjacentCellIndex < cellIndex)
+				{
+					TopologicEnergyCore::TraceSpan matchSpan("matchSurfaces");
+					osSpace->matchSurfaces(osSpaces[adjacentCellIndex]);
+				}
+			}
+
+			osSpaces->Add(osSpace);
+			osSpaceVector->Add(osSpace);
+		}
+		delete dynamoZAxis;
+		metrics->EndStage("AddSpaces");
+
+		metrics->BeginStage();
+		AddThermalZones(osModel, osSpaces, cellGeometry, faceAdjacency, thermalZoning, northAxis, heatingTemp, coolingTemp);
+		metrics->EndStage("AddThermalZones");
+
+		// Create shading surfaces
+		if (shadingSurfaces != nullptr)
+		{
+			TopologicEnergyCore::TraceSpan shadingSpan("AddShadingSurfaces");
+			metrics->BeginStage();
+			OpenStudio::ShadingSurfaceGroup^ osShadingGroup = gcnew OpenStudio::ShadingSurfaceGroup(osModel);
+			IList<Face^>^ contextFaces = shadingSurfaces->Faces;
+			int faceIndex = 1;
+			if (shadingFilter == nullptr)
+			{
+				for each(Face^ contextFace in contextFaces)
+				{
+					AddShadingSurfaces(contextFace, osModel, osShadingGroup, faceIndex++);
+				}
+			}
+			else
+			{
+				// Only the context faces that can shade the building, with coplanar neighbours merged
+				for each(IList<Vertex^>^ vertices in shadingFilter->Apply(contextFaces, cellGeometry, weatherFilePath, northAxis))
+				{
+					AddShadingSurfaces(vertices, osModel, osShadingGroup, faceIndex++);
+				}
+			}
+			shadingSpan.SetAttribute("surfaces", faceIndex - 1);
+			metrics->CountShadingSurfaces(faceIndex - 1);
+			metrics->EndStage("AddShadingSurfaces");
+		}
+		delete faceAdjacency;
+		delete cellGeometry;
+
+		{
+			TopologicEnergyCore::TraceSpan purgeSpan("purgeUnusedResourceObjects");
+			metrics->BeginStage();
+			osModel->purgeUnusedResourceObjects();
+			metrics->EndStage("purgeUnusedResourceObjects");
+		}
+
+		EnergyModel^ energyModel = gcnew EnergyModel(osModel, osBuilding, pBuildingCells, shadingSurfaces, osSpaceVector);
+		energyModel->m_pipelineMetrics = metrics;
+		return energyModel;
+	}
+
+	bool EnergyModel::ExportToOSM(EnergyModel ^ energyModel, String^ filePath)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		OpenStudio::SpaceVector^ osSpaces = nullptr;
+		OpenStudio::Model^ osModel = energyModel->GetExportModel(osSpaces);
+		try {
+			return SaveModel(osModel, filePath);
+		}
+		finally
+		{
+			energyModel->ReleaseExportModel(osModel);
+		}
+	}
+
+	bool EnergyModel::ExportToSnapshot(EnergyModel^ energyModel, String^ filePath)
+	{
+		if (energyModel == nullptr)
+		{
+			throw gcnew Exception("The input energy model is null.");
+		}
+
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		// An imported snapshot that has not loaded its OSM yet saves it as it was read. Otherwise the OSM
+		// goes through a temporary file, as OpenStudio only serializes a model to a file.
+		array<unsigned char>^ osmBytes = energyModel->m_snapshotOsm;
+		if (osmBytes == nullptr)
+		{
+			String^ osmPath = Path::Combine(Path::GetTempPath(), Guid::NewGuid().ToString() + ".osm");
+			if (!ExportToOSM(energyModel, osmPath))
+			{
+				return false;
+			}
+			osmBytes = File::ReadAllBytes(osmPath);
+			File::Delete(osmPath);
+		}
+
+		std::vector<std::string> osm(1);
+		if (osmBytes->Length > 0)
+		{
+			pin_ptr<unsigned char> pOsmBytes = &osmBytes[0];
+			osm[0].assign((const char*)pOsmBytes, osmBytes->Length);
+		}
+
+		// The cells keep their order, so the space of cell i is the i-th space name. BREP does not carry
+		// the apertures, so they are saved with the index of their host face in cell->Faces, once per face:
+		// on the first cell it bounds.
+		IList<Cell^>^ cells = energyModel->m_buildingCells;
+		CellGeometry^ cellGeometry = gcnew CellGeometry(cells, nullptr);
+		FaceAdjacency^ faceAdjacency = gcnew FaceAdjacency(cellGeometry, SnapshotTolerance);
+		HashSet<int>^ savedFaces = gcnew HashSet<int>();
+		std::vector<std::string> cellBreps;
+		std::vector<std::string> spaceNames;
+		std::vector<std::string> apertureBreps;
+		std::vector<std::string> apertureHosts;
+		for (int i = 0; i < cells->Count; ++i)
+		{
+			Cell^ cell = cells[i];
+			cellBreps.push_back(ToNativeString(cell->String));
+			Object^ spaceName = cell->AttributeValue("Name");
+			spaceNames.push_back(spaceName == nullptr ? std::string() : ToNativeString(spaceName->ToString()));
+
+			IList<Face^>^ faces = cell->Faces;
+			for (int j = 0; j < faces->Count; ++j)
+			{
+				if (!savedFaces->Add(faceAdjacency->FaceId(i, j)))
+				{
+					continue;
+				}
+
+				for each(Topologic::Topology^ content in faces[j]->Contents)
+				{
+					Aperture^ aperture = dynamic_cast<Aperture^>(content);
+					if (aperture != nullptr)
+					{
+						apertureBreps.push_back(ToNativeString(aperture->Topology->String));
+						apertureHosts.push_back(std::to_string(i) + " " + std::to_string(j));
+					}
+				}
+			}
+		}
+		delete faceAdjacency;
+		delete cellGeometry;
+
+		try
+		{
+			TopologicEnergyCore::ModelSnapshotWriter writer(ToNativeString(filePath));
+			writer.AddSection(TopologicEnergyCore::SNAPSHOT_OSM, osm);
+			writer.AddSection(TopologicEnergyCore::SNAPSHOT_CELLS, cellBreps);
+			writer.AddSection(TopologicEnergyCore::SNAPSHOT_SPACE_NAMES, spaceNames);
+			writer.AddSection(TopologicEnergyCore::SNAPSHOT_APERTURES, apertureBreps);
+			writer.AddSection(TopologicEnergyCore::SNAPSHOT_APERTURE_HOSTS, apertureHosts);
+			if (energyModel->m_shadingSurfaces != nullptr)
+			{
+				writer.AddSection(TopologicEnergyCore::SNAPSHOT_SHADING, std::vector<std::string>(1, ToNativeString(energyModel->m_shadingSurfaces->String)));
+			}
+			writer.Finish();
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		return true;
+	}
+
+	EnergyModel^ EnergyModel::ByImportedSnapshot(String^ filePath)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		TopologicEnergyCore::ModelSnapshotReader* pReader = nullptr;
+		try
+		{
+			pReader = new TopologicEnergyCore::ModelSnapshotReader(ToNativeString(filePath));
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+
+		try
+		{
+			std::size_t cellCount = pReader->StringCount(TopologicEnergyCore::SNAPSHOT_CELLS);
+			if (pReader->StringCount(TopologicEnergyCore::SNAPSHOT_OSM) != 1 || pReader->StringCount(TopologicEnergyCore::SNAPSHOT_SPACE_NAMES) != cellCount)
+			{
+				throw gcnew Exception("The model snapshot is incomplete.");
+			}
+
+			// The OSM is kept as it is and only parsed when the OpenStudio model is first used, so a snapshot
+			// that is only displayed or exported as a mesh never loads it.
+			std::size_t length = 0;
+			const char* pkOsm = pReader->StringData(TopologicEnergyCore::SNAPSHOT_OSM, 0, length);
+			array<unsigned char>^ osmBytes = gcnew array<unsigned char>((int)length);
+			if (length > 0)
+			{
+				System::Runtime::InteropServices::Marshal::Copy(IntPtr((void*)pkOsm), osmBytes, 0, (int)length);
+			}
+
+			// The apertures of each host face, by cell. Snapshots written before the apertures were saved have none.
+			std::size_t apertureCount = pReader->StringCount(TopologicEnergyCore::SNAPSHOT_APERTURES);
+			if (pReader->StringCount(TopologicEnergyCore::SNAPSHOT_APERTURE_HOSTS) != apertureCount)
+			{
+				throw gcnew Exception("The model snapshot is incomplete.");
+			}
+			Dictionary<int, SortedDictionary<int, List<Topologic::Topology^>^>^>^ cellApertures = gcnew Dictionary<int, SortedDictionary<int, List<Topologic::Topology^>^>^>();
+			for (std::size_t i = 0; i < apertureCount; ++i)
+			{
+				std::istringstream host(pReader->String(TopologicEnergyCore::SNAPSHOT_APERTURE_HOSTS, i));
+				int cellIndex = -1;
+				int faceIndex = -1;
+				host >> cellIndex >> faceIndex;
+				if (!host || cellIndex < 0 || (std::size_t)cellIndex >= cellCount || faceIndex < 0)
+				{
+					throw gcnew Exception("An aperture of the model snapshot has no host face.");
+				}
+
+				SortedDictionary<int, List<Topologic::Topology^>^>^ faceApertures = nullptr;
+				if (!cellApertures->TryGetValue(cellIndex, faceApertures))
+				{
+					faceApertures = gcnew SortedDictionary<int, List<Topologic::Topology^>^>();
+					cellApertures->Add(cellIndex, faceApertures);
+				}
+				List<Topologic::Topology^>^ apertures = nullptr;
+				if (!faceApertures->TryGetValue(faceIndex, apertures))
+				{
+					apertures = gcnew List<Topologic::Topology^>();
+					faceApertures->Add(faceIndex, apertures);
+				}
+				const char* pkBrep = pReader->StringData(TopologicEnergyCore::SNAPSHOT_APERTURES, i, length);
+				apertures->Add(Topologic::Topology::ByString(ToManagedString(pkBrep, length)));
+			}
+
+			// The cells come back from their BREP, instead of being rebuilt from the OSM surfaces. A cell with
+			// apertures is rebuilt from its faces with the apertures added, as in ProcessOsModel.
+			List<Cell^>^ savedCells = gcnew List<Cell^>((int)cellCount);
+			for (std::size_t i = 0; i < cellCount; ++i)
+			{
+				const char* pkBrep = pReader->StringData(TopologicEnergyCore::SNAPSHOT_CELLS, i, length);
+				Cell^ cell = safe_cast<Cell^>(Topologic::Topology::ByString(ToManagedString(pkBrep, length)));
+
+				SortedDictionary<int, List<Topologic::Topology^>^>^ faceApertures = nullptr;
+				if (cellApertures->TryGetValue((int)i, faceApertures))
+				{
+					List<Face^>^ faces = gcnew List<Face^>(cell->Faces);
+					for each(KeyValuePair<int, List<Topologic::Topology^>^> faceAperture in faceApertures)
+					{
+						if (faceAperture.Key >= faces->Count)
+						{
+							throw gcnew Exception("An aperture of the model snapshot has no host face.");
+						}
+						faces[faceAperture.Key] = safe_cast<Face^>(faces[faceAperture.Key]->AddApertures(faceAperture.Value));
+					}
+					cell = Cell::ByFaces(faces, SnapshotTolerance);
+				}
+				savedCells->Add(cell);
+			}
+
+			// One complex, as ByCellComplex had them, so that the cells share their faces again.
+			IList<Cell^>^ buildingCells = savedCells;
+			if (savedCells->Count > 1)
+			{
+				buildingCells = InCellOrder(savedCells, CellComplex::ByCells(savedCells)->Cells);
+			}
+
+			for (int i = 0; i < buildingCells->Count; ++i)
+			{
+				Dictionary<String^, Object^>^ attributes = gcnew Dictionary<String^, Object^>();
+				attributes->Add("Name", ToManagedString(pReader->String(TopologicEnergyCore::SNAPSHOT_SPACE_NAMES, i)));
+				buildingCells[i]->AddAttributesNoCopy(attributes);
+			}
+
+			Cluster^ shadingSurfaces = nullptr;
+			if (pReader->StringCount(TopologicEnergyCore::SNAPSHOT_SHADING) == 1)
+			{
+				const char* pkBrep = pReader->StringData(TopologicEnergyCore::SNAPSHOT_SHADING, 0, length);
+				shadingSurfaces = safe_cast<Cluster^>(Topologic::Topology::ByString(ToManagedString(pkBrep, length)));
+			}
+
+			EnergyModel^ energyModel = gcnew EnergyModel(nullptr, nullptr, buildingCells, shadingSurfaces, nullptr);
+			energyModel->m_snapshotOsm = osmBytes;
+			return energyModel;
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		finally
+		{
+			delete pReader;
+		}
+	}
+
+	EnergyModel^ EnergyModel::MergeCoplanarSurfaces(EnergyModel^ energyModel, double tolerance)
+	{
+		if (energyModel == nullptr)
+		{
+			throw gcnew Exception("The input energy model is null.");
+		}
+
+		if (tolerance <= 0.0)
+		{
+			throw gcnew Exception("The tolerance must have a positive value.");
+		}
+
+		// The model is modified in place, so a variant stops sharing its parent's spaces.
+		energyModel->Detach();
+
+		OpenStudio::SpaceVector::SpaceVectorEnumerator^ osSpaceEnumerator = energyModel->m_osSpaceVector->GetEnumerator();
+		while (osSpaceEnumerator->MoveNext())
+		{
+			OpenStudio::Space^ osSpace = osSpaceEnumerator->Current;
+
+			// 1. Exterior surfaces of the space, grouped by boundary condition, type, construction and exposure.
+			// Interior surfaces are left alone: they are matched to a surface of the adjacent space.
+			List<OpenStudio::Surface^>^ osCandidateSurfaces = gcnew List<OpenStudio::Surface^>();
+			Dictionary<String^, int>^ groupIds = gcnew Dictionary<String^, int>();
+			std::vector<TopologicEnergyCore::Polygon> polygons;
+			std::vector<std::size_t> groups;
+
+			OpenStudio::SurfaceVector::SurfaceVectorEnumerator^ osSurfaceEnumerator = osSpace->surfaces()->GetEnumerator();
+			while (osSurfaceEnumerator->MoveNext())
+			{
+				OpenStudio::Surface^ osSurface = osSurfaceEnumerator->Current;
+				String^ boundaryCondition = osSurface->outsideBoundaryCondition();
+				if (boundaryCondition == "Surface")
+				{
+					continue;
+				}
+
+				OpenStudio::OptionalConstructionBase^ osConstruction = osSurface->construction();
+				String^ constructionName = osConstruction->is_initialized() ? osConstruction->get()->nameString() : "";
+				String^ key = boundaryCondition + "|" + osSurface->surfaceType() + "|" + constructionName + "|" +
+					osSurface->sunExposure() + "|" + osSurface->windExposure();
+				int groupId = 0;
+				if (!groupIds->TryGetValue(key, groupId))
+				{
+					groupId = groupIds->Count;
+					groupIds->Add(key, groupId);
+				}
+
+				TopologicEnergyCore::Polygon polygon;
+				OpenStudio::Point3dVector::Point3dVectorEnumerator^ osPointEnumerator = osSurface->vertices()->GetEnumerator();
+				while (osPointEnumerator->MoveNext())
+				{
+					OpenStudio::Point3d^ osPoint = osPointEnumerator->Current;
+					TopologicEnergyCore::Point point = { { osPoint->x(), osPoint->y(), osPoint->z() } };
+					polygon.push_back(point);
+				}
+
+				osCandidateSurfaces->Add(osSurface);
+				polygons.push_back(polygon);
+				groups.push_back(groupId);
+			}
+
+			// 2. Join the coplanar surfaces sharing an edge
+			std::vector<std::size_t> targets;
+			std::vector<TopologicEnergyCore::Polygon> mergedPolygons = TopologicEnergyCore::MergeCoplanarPolygons(polygons, groups, tolerance, targets);
+			if (mergedPolygons.size() == polygons.size())
+			{
+				continue;
+			}
+
+			// 3. The first surface of each merged group takes the joined polygon and the subsurfaces of the others,
+			// which still lie within it; the others are removed.
+			for (std::size_t mergedIndex = 0; mergedIndex < mergedPolygons.size(); ++mergedIndex)
+			{
+				List<OpenStudio::Surface^>^ osGroupSurfaces = gcnew List<OpenStudio::Surface^>();
+				for (std::size_t i = 0; i < targets.size(); ++i)
+				{
+					if (targets[i] == mergedIndex)
+					{
+						osGroupSurfaces->Add(osCandidateSurfaces[(int)i]);
+					}
+				}
+				if (osGroupSurfaces->Count < 2)
+				{
+					continue;
+				}
+
+				OpenStudio::Point3dVector^ osMergedPoints = gcnew OpenStudio::Point3dVector();
+				for (const TopologicEnergyCore::Point& rkPoint : mergedPolygons[mergedIndex])
+				{
+					osMergedPoints->Add(gcnew OpenStudio::Point3d(rkPoint[0], rkPoint[1], rkPoint[2]));
+				}
+
+				OpenStudio::Surface^ osMergedSurface = osGroupSurfaces[0];
+				if (!osMergedSurface->setVertices(osMergedPoints))
+				{
+					continue; // OpenStudio rejected the polygon: keep the original surfaces
+				}
+
+				for (int i = 1; i < osGroupSurfaces->Count; ++i)
+				{
+					OpenStudio::SubSurfaceVector::SubSurfaceVectorEnumerator^ osSubSurfaceEnumerator = osGroupSurfaces[i]->subSurfaces()->GetEnumerator();
+					while (osSubSurfaceEnumerator->MoveNext())
+					{
+						osSubSurfaceEnumerator->Current->setSurface(osMergedSurface);
+					}
+					osGroupSurfaces[i]->remove();
+				}
+			}
+		}
+
+		return energyModel;
+	}
+
+	void EnergyModel::ProcessOsModel(
+		OpenStudio::Model^ osModel, 
+		double tolerance, 
+		OpenStudio::Building^% osBuilding,
+		IList<Cell^>^% buildingCells,
+		Topologic::Cluster^% shadingFaces,
+		OpenStudio::SpaceVector^% osSpaceVector)
+	{
+		osBuilding = osModel->getBuilding(); // 2
+		osSpaceVector = osModel->getSpaces(); // 3
+		OpenStudio::SpaceVector::SpaceVectorEnumerator^ spaceEnumerator = osSpaceVector->GetEnumerator();
+		List<OpenStudio::Space^>^ osSpaces = gcnew List<OpenStudio::Space^>();
+		while (spaceEnumerator->MoveNext())
+		{
+			OpenStudio::Space^ osSpace = spaceEnumerator->Current;
+			osSpaces->Add(osSpace);
+		}
+
+		// 4. Get shading surfaces as a cluster
+		OpenStudio::ShadingSurfaceVector^ osShadingSurfaceVector = osModel->getShadingSurfaces(); //4
+		OpenStudio::ShadingSurfaceVector::ShadingSurfaceVectorEnumerator^ shadingSurfaceEnumerator = osShadingSurfaceVector->GetEnumerator();
+		List<Topologic::Topology^>^ shadingFaceList = gcnew List<Topologic::Topology^>();
+		while (shadingSurfaceEnumerator->MoveNext())
+		{
+			OpenStudio::ShadingSurface^ osShadingSurface = shadingSurfaceEnumerator->Current;
+			Face^ shadingFace = FaceByOsSurface(osShadingSurface);
+			shadingFaceList->Add(shadingFace);
+		}
+		
+		if (shadingFaceList->Count > 0)
+		{
+			shadingFaces = Topologic::Cluster::ByTopologies(shadingFaceList);
+		}
+
+		// 5. Get building spaces as a CellComplex
+		OpenStudio::SpaceVector::SpaceVectorEnumerator^ osSpaceEnumerator = osSpaceVector->GetEnumerator();
+		List<Topologic::Cell^>^ cellList = gcnew List<Topologic::Cell^>();
+		while (osSpaceEnumerator->MoveNext())
+		{
+			OpenStudio::Space^ osSpace = osSpaceEnumerator->Current;
+			OpenStudio::SurfaceVector^ osSurfaces = osSpace->surfaces;
+			OpenStudio::Transformation^ osTransformation = osSpace->transformation();
+			OpenStudio::Vector3d^ osTranslation = osTransformation->translation();
+			OpenStudio::Matrix^ osMatrix = osTransformation->rotationMatrix();
+			double rotation11 = osMatrix->__getitem__(0, 0);
+			double rotation12 = osMatrix->__getitem__(0, 1);
+			double rotation13 = osMatrix->__getitem__(0, 2);
+			double rotation21 = osMatrix->__getitem__(1, 0);
+			double rotation22 = osMatrix->__getitem__(1, 1);
+			double rotation23 = osMatrix->__getitem__(1, 2);
+			double rotation31 = osMatrix->__getitem__(2, 0);
+			double rotation32 = osMatrix->__getitem__(2, 1);
+			double rotation33 = osMatrix->__getitem__(2, 2);
+
+			OpenStudio::SurfaceVector::SurfaceVectorEnumerator^ osSurfaceEnumerator = osSurfaces->GetEnumerator();
+			List<Topologic::Face^>^ faceList = gcnew List<Topologic::Face^>();
+			while (osSurfaceEnumerator->MoveNext())
+			{
+				OpenStudio::Surface^ osSurface = osSurfaceEnumerator->Current;
+				Face^ face = FaceByOsSurface(osSurface);
+
+				// Subsurfaces
+				OpenStudio::SubSurfaceVector^ osSubSurfaces = osSurface->subSurfaces();
+				if (osSubSurfaces->Count > 0)
+				{
+					OpenStudio::SubSurfaceVector::SubSurfaceVectorEnumerator^ osSubSurfaceEnumerator = osSubSurfaces->GetEnumerator();
+					List<Topologic::Topology^>^ faceApertureList = gcnew List<Topologic::Topology^>();
+					while (osSubSurfaceEnumerator->MoveNext())
+					{
+						OpenStudio::SubSurface^ osSubSurface = osSubSurfaceEnumerator->Current;
+						Face^ subFace = FaceByOsSurface(osSubSurface);
+
+						faceApertureList->Add(subFace);
+					}
+					Topologic::Topology^ topologyWithApertures = face->AddApertures(faceApertureList);
+					try {
+						Face^ faceWithApertures = safe_cast<Topologic::Face^>(topologyWithApertures);
+
+						faceList->Add(faceWithApertures);
+					}
+					catch (Exception^)
+					{
+						throw gcnew Exception("Error converting a topology with apertures to a face.");
+					}
+				}
+				else // no subsurfaces
+				{
+					faceList->Add(face);
+				}
+			}
+
+			Cell^ cell = Cell::ByFaces(faceList, tolerance);
+
+			Topologic::Topology^ transformedTopology = Topologic::Utilities::TopologyUtility::Transform(cell,
+				osTranslation->x(), osTranslation->y(), osTranslation->z(),
+				rotation11, rotation12, rotation13,
+				rotation21, rotation22, rotation23,
+				rotation31, rotation32, rotation33);
+			Cell^ transformedCell = safe_cast<Topologic::Cell^>(transformedTopology);
+			cellList->Add(transformedCell);
+		}
+
+		buildingCells = gcnew List<Topologic::Cell^>();
+		if (cellList->Count == 1)
+		{
+			((List<Topologic::Cell^>^)buildingCells)->Add(cellList[0]);
+		}
+		else
+		{
+			CellComplex^ cellComplex = CellComplex::ByCells(cellList);
+			buildingCells = cellComplex->Cells;
+		}
+	}
+
+	EnergyModel ^ EnergyModel::ByImportedOSM(String ^ filePath, double tolerance)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		if (tolerance <= 0.0)
+		{
+			throw gcnew Exception("The tolerance must have a positive value.");
+		}
+
+		OpenStudio::Path^ osOsmFile = OpenStudio::OpenStudioUtilitiesCore::toPath(filePath);
+
+		// Create an abstract model
+		OpenStudio::OptionalModel^ osOptionalModel = OpenStudio::Model::load(osOsmFile);
+		if (osOptionalModel->isNull())
+		{
+			return nullptr;
+		}
+
+		OpenStudio::Model^ osModel = osOptionalModel->get(); //1
+		if (osModel == nullptr)
+		{
+			return nullptr;
+		}
+
+		OpenStudio::Building^ osBuilding = nullptr;
+		List<Cell^>^ buildingCells = nullptr;
+		Cluster^ shadingFaces = nullptr;
+		OpenStudio::SpaceVector^ osSpaceVector = nullptr;
+		ProcessOsModel(osModel, tolerance, osBuilding, buildingCells, shadingFaces, osSpaceVector);
+
+		EnergyModel^ energyModel = gcnew EnergyModel(osModel, osBuilding, buildingCells, shadingFaces, osSpaceVector);
+
+		return energyModel;
+	}
+
+	bool EnergyModel::SaveModel(OpenStudio::Model^ osModel, String^ osmPathName)
+	{
+		if (osmPathName == nullptr)
+		{
+			throw gcnew Exception("The input osmPathName must not be null.");
+		}
+
+		// Purge unused resources
+		//osModel->purgeUnusedResourceObjects();
+
+		// Create a path string
+		OpenStudio::Path^ osPath = OpenStudio::OpenStudioUtilitiesCore::toPath(osmPathName);
+		bool osCondition = osModel->save(osPath, true);
+		return osCondition;
+	}
+
+	OpenStudio::Model^ EnergyModel::GetModelFromTemplate(String^ osmTemplatePath, String^ epwWeatherPath, String^ ddyPath)
+	{
+		TopologicEnergyCore::TraceSpan span("GetModelFromTemplate");
+		if (osmTemplatePath == nullptr)
+		{
+			throw gcnew Exception("The input osmTemplatePath must not be null.");
+		}
+
+		if (epwWeatherPath == nullptr)
+		{
+			throw gcnew Exception("The input epwWeatherPath must not be null.");
+		}
+
+		if (ddyPath == nullptr)
+		{
+			throw gcnew Exception("The input ddyPath must not be null.");
+		}
+
+		if (osmTemplatePath == nullptr)
+		{
+			throw gcnew Exception("The input osmTemplatePath must not be null.");
+		}
+
+		if (!File::Exists(osmTemplatePath))
+		{
+			throw gcnew FileNotFoundException("OSM file not found.");
+		}
+		if (!File::Exists(epwWeatherPath))
+		{
+			throw gcnew FileNotFoundException("EPW file not found.");
+		}
+		if (!File::Exists(ddyPath))
+		{
+			throw gcnew FileNotFoundException("DDY file not found.");
+		}
+		OpenStudio::Path^ osTemplatePath = OpenStudio::OpenStudioUtilitiesCore::toPath(osmTemplatePath);
+
+		// Create an abstract model
+		OpenStudio::OptionalModel^ osOptionalModel = OpenStudio::Model::load(osTemplatePath);
+		OpenStudio::Model^ osModel = osOptionalModel->__ref__();
+
+		// Read an EPW weather file
+		OpenStudio::Path^ osEPWPath = OpenStudio::OpenStudioUtilitiesCore::toPath(epwWeatherPath);
+		OpenStudio::EpwFile^ osEPWFile = gcnew OpenStudio::EpwFile(osEPWPath);
+		OpenStudio::WeatherFile^ osWeatherFile = osModel->getWeatherFile();
+		OpenStudio::WeatherFile::setWeatherFile(osModel, osEPWFile);
+
+		// Read an DDY design days files
+		OpenStudio::Path^ osDDYPath = OpenStudio::OpenStudioUtilitiesCore::toPath(ddyPath);
+		OpenStudio::EnergyPlusReverseTranslator^ osTranslator = gcnew OpenStudio::EnergyPlusReverseTranslator();
+		OpenStudio::OptionalModel^ tempModel01 = osTranslator->loadModel(osDDYPath);
+		OpenStudio::Model^ tempModel02 = tempModel01->__ref__();
+		OpenStudio::DesignDayVector^ designDays = tempModel02->getDesignDays();
+		OpenStudio::DesignDayVector::DesignDayVectorEnumerator^ designDaysEnumerator = designDays->GetEnumerator();
+
+		while (designDaysEnumerator->MoveNext())
+		{
+			OpenStudio::DesignDay^ aDesignDay = designDaysEnumerator->Current;
+			OpenStudio::IdfObject^ anIdfObject = aDesignDay->idfObject();
+			osModel->addObject(anIdfObject);
+		}
+		return osModel;
+	}
+
+	OpenStudio::ThermalZone^ EnergyModel::CreateThermalZone(OpenStudio::Model^ model, String^ name, double ceilingHeight, double volume, OpenStudio::ScheduleConstant^ heatingSchedule, OpenStudio::ScheduleConstant^ coolingSchedule)
+	{
+		OpenStudio::ThermalZone^ osThermalZone = gcnew OpenStudio::ThermalZone(model);
+		osThermalZone->setName(name);
+		osThermalZone->setUseIdealAirLoads(true);
+		osThermalZone->setCeilingHeight(ceilingHeight);
+		osThermalZone->setVolume(volume);
+
+		// Create a Thermostat; a thermostat belongs to one zone, but the schedules are shared
+		OpenStudio::ThermostatSetpointDualSetpoint^ osThermostat = gcnew OpenStudio::ThermostatSetpointDualSetpoint(model);
+
+		// Set Heating and Cooling Schedules on the Thermostat
+		osThermostat->setHeatingSetpointTemperatureSchedule(heatingSchedule);
+		osThermostat->setCoolingSetpointTemperatureSchedule(coolingSchedule);
+
+		// Assign Thermostat to the Thermal Zone
+		osThermalZone->setThermostatSetpointDualSetpoint(osThermostat);
+		return osThermalZone;
+	}
+
+	void EnergyModel::AddThermalZones(
+		OpenStudio::Model^ osModel,
+		IList<OpenStudio::Space^>^ osSpaces,
+		CellGeometry^ cellGeometry,
+		FaceAdjacency^ faceAdjacency,
+		ThermalZoning^ thermalZoning,
+		double northAxis,
+		double heatingTemp,
+		double coolingTemp)
+	{
+		// 1. Group the spaces by zone name, in the order of the spaces; without a zoning, each space is its own zone.
+		List<String^>^ zoneNames = gcnew List<String^>();
+		Dictionary<String^, List<int>^>^ zoneSpaceIndices = gcnew Dictionary<String^, List<int>^>();
+		for (int i = 0; i < osSpaces->Count; ++i)
+		{
+			String^ zoneName = nullptr;
+			if (thermalZoning == nullptr)
+			{
+				zoneName = ToManagedString(TopologicEnergyCore::ThermalZoneName(ToNativeString(osSpaces[i]->name()->get())));
+			}
+			else
+			{
+				Nullable<double> azimuth = thermalZoning->NeedsOrientation ? cellGeometry->ExteriorWallAzimuth(i, faceAdjacency) : Nullable<double>();
+				zoneName = thermalZoning->ZoneName(i, osSpaces[i], azimuth, northAxis);
+			}
+
+			List<int>^ spaceIndices = nullptr;
+			if (!zoneSpaceIndices->TryGetValue(zoneName, spaceIndices))
+			{
+				spaceIndices = gcnew List<int>();
+				zoneSpaceIndices->Add(zoneName, spaceIndices);
+				zoneNames->Add(zoneName);
+			}
+			spaceIndices->Add(i);
+		}
+
+		// 2. One pair of setpoint schedules for the whole model
+		OpenStudio::ScheduleConstant^ heatingScheduleConstant = gcnew OpenStudio::ScheduleConstant(osModel);
+		heatingScheduleConstant->setValue(heatingTemp);
+		OpenStudio::ScheduleConstant^ coolingScheduleConstant = gcnew OpenStudio::ScheduleConstant(osModel);
+		coolingScheduleConstant->setValue(coolingTemp);
+
+		// 3. The zones
+		for each(String^ zoneName in zoneNames)
+		{
+			List<int>^ spaceIndices = zoneSpaceIndices[zoneName];
+			double ceilingHeight = 0.0;
+			double volume = 0.0;
+			for each(int spaceIndex in spaceIndices)
+			{
+				ceilingHeight = Math::Max(ceilingHeight, cellGeometry->Height(spaceIndex));
+				volume += osSpaces[spaceIndex]->volume();
+			}
+
+			OpenStudio::ThermalZone^ osThermalZone = CreateThermalZone(osModel, zoneName, ceilingHeight, volume, heatingScheduleConstant, coolingScheduleConstant);
+
+			// Assign Thermal Zone to space
+			// aSpace.setThermalZone(osThermalZone);//Not available in C#
+			OpenStudio::UUID^ tzHandle = osThermalZone->handle();
+			int location = 10;
+			for each(int spaceIndex in spaceIndices)
+			{
+				osSpaces[spaceIndex]->setPointer(location, tzHandle);
+			}
+		}
+	}
+
+	OpenStudio::BuildingStory^ EnergyModel::AddBuildingStory(ModelBuildContext^ context, int floorNumber)
+	{
+		OpenStudio::BuildingStory^ osBuildingStory = gcnew OpenStudio::BuildingStory(context->Model);
+		osBuildingStory->setName(ToManagedString(TopologicEnergyCore::StoryName(floorNumber - 1)));
+		osBuildingStory->setDefaultConstructionSet(context->DefaultConstructionSet);
+		osBuildingStory->setDefaultScheduleSet(context->DefaultScheduleSet);
+		return osBuildingStory;
+	}
+
+	OpenStudio::SubSurface ^ EnergyModel::CreateSubSurface(IList<Topologic::Vertex^>^ vertices, OpenStudio::Model^ osModel)
+	{
+		OpenStudio::Point3dVector^ osWindowFacePoints = gcnew OpenStudio::Point3dVector();
+		for each(Vertex^ vertex in vertices)
+		{
+			OpenStudio::Point3d^ osPoint = gcnew OpenStudio::Point3d(
+				vertex->X,
+				vertex->Y,
+				vertex->Z);
+			osWindowFacePoints->Add(osPoint);
+		}
+
+		OpenStudio::SubSurface^ osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel);
+		return osWindowSubSurface;
+	}
+
+	OpenStudio::Building^ EnergyModel::ComputeBuilding(
+		ModelBuildContext^ context,
+		String^ buildingName,
+		String^ buildingType,
+		double buildingHeight,
+		int numFloors,
+		double northAxis,
+		String^ spaceType)
+	{
+		TopologicEnergyCore::TraceSpan span("ComputeBuilding");
+		OpenStudio::Model^ osModel = context->Model;
+		OpenStudio::Building^ osBuilding = osModel->getBuilding();
+		osBuilding->setStandardsNumberOfStories(numFloors);
+		osBuilding->setDefaultConstructionSet(context->DefaultConstructionSet);
+		osBuilding->setDefaultScheduleSet(context->DefaultScheduleSet);
+		osBuilding->setName(buildingName);
+		osBuilding->setStandardsBuildingType(buildingType);
+		double floorToFloorHeight = (double)buildingHeight / (double)numFloors;
+		osBuilding->setNominalFloortoFloorHeight(floorToFloorHeight);
+		// Get all space types and find the one that matches
+		OpenStudio::SpaceTypeVector^ spaceTypes = osModel->getSpaceTypes();
+		OpenStudio::SpaceTypeVector::SpaceTypeVectorEnumerator^ spaceTypesEnumerator = spaceTypes->GetEnumerator();
+		while (spaceTypesEnumerator->MoveNext())
+		{
+			OpenStudio::SpaceType^ aSpaceType = spaceTypesEnumerator->Current;
+			String^ spaceTypeName = aSpaceType->name()->__str__();
+			if (spaceTypeName == spaceType)
+			{
+				osBuilding->setSpaceType(aSpaceType);
+			}
+		}
+		context->BuildingStories = CreateBuildingStories(context, numFloors);
+		osBuilding->setNorthAxis(northAxis);
+		return osBuilding;
+	}
+
+	IList<OpenStudio::BuildingStory^>^ EnergyModel::CreateBuildingStories(ModelBuildContext^ context, int numFloors)
+	{
+		List<OpenStudio::BuildingStory^>^ osBuildingStories = gcnew List<OpenStudio::BuildingStory^>();
+		for (int i = 0; i < numFloors; i++)
+		{
+			osBuildingStories->Add(AddBuildingStory(context, (i + 1)));
+		}
+		return osBuildingStories;
+	}
+
+	OpenStudio::SqlFile^ EnergyModel::CreateSqlFile(OpenStudio::Model ^ osModel, String^ sqlFilePath)
+	{
+		if (sqlFilePath == nullptr)
+		{
+			throw gcnew Exception("The input sqlFilePath must not be null.");
+		}
+
+		OpenStudio::Path^ osSqlFilePath = OpenStudio::OpenStudioUtilitiesCore::toPath(sqlFilePath);
+		OpenStudio::SqlFile^ osSqlFile = gcnew OpenStudio::SqlFile(osSqlFilePath);
+		if (osSqlFile == nullptr)
+		{
+			throw gcnew Exception("Fails to create an SQL output file");
+		}
+		bool isSuccessful = osModel->setSqlFile(osSqlFile);
+		if (!isSuccessful)
+		{
+			throw gcnew Exception("Fails to create an SQL output file");
+		}
+		return osSqlFile;
+	}
+
+	Topologic::Face ^ EnergyModel::FaceByOsSurface(OpenStudio::PlanarSurface^ osPlanarSurface)
+	{
+		OpenStudio::Point3dVector^ osVertices = osPlanarSurface->vertices();
+		OpenStudio::Point3dVector::Point3dVectorEnumerator^ osPointEnumerator = osVertices->GetEnumerator();
+		List<Topologic::Vertex^>^ vertices = gcnew List<Topologic::Vertex^>();
+		List<int>^ indices = gcnew List<int>();
+		int index = 0;
+		while (osPointEnumerator->MoveNext())
+		{
+			OpenStudio::Point3d^ osVertex = osPointEnumerator->Current;
+			vertices->Add(Topologic::Vertex::ByCoordinates(osVertex->x(), osVertex->y(), osVertex->z()));
+			indices->Add(index);
+			++index;
+		}
+
+		if (vertices->Count < 3)
+		{
+			throw gcnew Exception("Invalid surface is found.");
+		}
+
+		indices->Add(0); // close the wire
+
+		IList<IList<int>^>^ vertexIndices = gcnew List<IList<int>^>();
+		((IList<IList<int>^>^)vertexIndices)->Add(indices);
+
+		IList<Topologic::Topology^>^ topologies = (IList<Topologic::Topology^>^)Topologic::Topology::ByVerticesIndices(vertices, vertexIndices);
+
+		if (topologies == nullptr || topologies->Count == 0)
+		{
+			throw gcnew Exception("Error creating a topology from a surface.");
+		}
+
+		Topologic::Face^ face = nullptr;
+		try {
+			face = safe_cast<Topologic::Face^>(topologies[0]);
+		}
+		catch (Exception^)
+		{
+			throw gcnew Exception("Error converting a topology to a face.");
+		}
+
+		return face;
+	}
+
+	String^ EnergyModel::TabularQuery(OpenStudio::SqlFile^ sqlFile, String^ EPReportName, String^ EPReportForString, String^ EPTableName, String^ EPColumnName, String^ EPRowName, String^ EPUnits)
+	{
+		return "SELECT Value FROM " + SqlFilePool::TabularTable(sqlFile) + " WHERE ReportName='" + EPReportName + "' AND ReportForString='" + EPReportForString + "' AND TableName = '" + EPTableName + "' AND RowName = '" + EPRowName + "' AND ColumnName= '" + EPColumnName + "' AND Units='" + EPUnits + "'";
+	}
+
+	double EnergyModel::DoubleValueFromQuery(OpenStudio::SqlFile^ sqlFile, String^ EPReportName, String^ EPReportForString, String^ EPTableName, String^ EPColumnName, String^ EPRowName, String^ EPUnits)
+	{
+		TopologicEnergyCore::TraceSpan span("DoubleValueFromQuery");
+		if (span.IsActive())
+		{
+			span.SetAttribute("table", ToNativeString(EPTableName));
+			span.SetAttribute("row", ToNativeString(EPRowName));
+		}
+		double doubleValue = 0.0;
+		String^ query = TabularQuery(sqlFile, EPReportName, EPReportForString, EPTableName, EPColumnName, EPRowName, EPUnits);
+		SqlFilePool::CountQuery(sqlFile);
+		OpenStudio::OptionalDouble^ osDoubleValue = sqlFile->execAndReturnFirstDouble(query);
+		if (osDoubleValue->is_initialized())
+		{
+			doubleValue = osDoubleValue->get();
+		}
+		else
+		{
+			throw gcnew Exception("Fails to get a double value from the SQL file.");
+		}
+		return doubleValue;
+	}
+
+	String^ EnergyModel::StringValueFromQuery(OpenStudio::SqlFile^ sqlFile, String^ EPReportName, String^ EPReportForString, String^ EPTableName, String^ EPColumnName, String^ EPRowName, String^ EPUnits)
+	{
+		String^ query = TabularQuery(sqlFile, EPReportName, EPReportForString, EPTableName, EPColumnName, EPRowName, EPUnits);
+		SqlFilePool::CountQuery(sqlFile);
+		return sqlFile->execAndReturnFirstString(query)->get();
+	}
+
+	int EnergyModel::IntValueFromQuery(OpenStudio::SqlFile^ sqlFile, String^ EPReportName, String^ EPReportForString, String^ EPTableName, String^ EPColumnName, String^ EPRowName, String^ EPUnits)
+	{
+		String^ query = TabularQuery(sqlFile, EPReportName, EPReportForString, EPTableName, EPColumnName, EPRowName, EPUnits);
+		SqlFilePool::CountQuery(sqlFile);
+		return sqlFile->execAndReturnFirstInt(query)->get();
+	}
+
+	bool EnergyModel::Export(EnergyModel ^ energyModel, String ^ openStudioOutputDirectory, String ^% oswPath)
+	{
+		OpenStudio::SpaceVector^ osSpaces = nullptr;
+		OpenStudio::Model^ osModel = energyModel->GetExportModel(osSpaces);
+		try {
+			return ExportModel(osModel, energyModel->BuildingName, openStudioOutputDirectory, oswPath);
+		}
+		finally
+		{
+			energyModel->ReleaseExportModel(osModel);
+		}
+	}
+
+	bool EnergyModel::ExportModel(OpenStudio::Model^ osModel, String^ buildingName, String^ openStudioOutputDirectory, String^% oswPath)
+	{
+		TopologicEnergyCore::TraceSpan span("Export");
+		// Add timestamp to the output file name
+		String^ openStudioOutputTimeStampPath = Path::GetDirectoryName(openStudioOutputDirectory + "\\") + "\\" +
+			Path::GetFileNameWithoutExtension(buildingName) +
+			".osm";
+		// Save model to an OSM file
+		bool saveCondition = SaveModel(osModel, openStudioOutputTimeStampPath);
+
+		if (!saveCondition)
+		{
+			return false;
+		}
+
+		OpenStudio::WorkflowJSON^ workflow = gcnew OpenStudio::WorkflowJSON();
+		try {
+			String^ osmFilename = Path::GetFileNameWithoutExtension(openStudioOutputTimeStampPath);
+			String^ osmDirectory = Path::GetDirectoryName(openStudioOutputTimeStampPath);
+			oswPath = osmDirectory + "\\" + osmFilename + ".osw";
+			OpenStudio::Path^ osOswPath = OpenStudio::OpenStudioUtilitiesCore::toPath(oswPath);
+			workflow->setSeedFile(OpenStudio::OpenStudioUtilitiesCore::toPath(openStudioOutputTimeStampPath));
+			workflow->setWeatherFile(gcnew OpenStudio::Path());
+			workflow->saveAs(osOswPath);
+			return true;
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+
+
+	OpenStudio::DefaultScheduleSet^ EnergyModel::getDefaultScheduleSet(OpenStudio::Model^ model)
+	{
+		// Get list of default schedule sets
+		OpenStudio::DefaultScheduleSetVector^ defaultScheduleSets = model->getDefaultScheduleSets();
+		OpenStudio::DefaultScheduleSetVector::DefaultScheduleSetVectorEnumerator^ defSchedEnum = defaultScheduleSets->GetEnumerator();
+		defSchedEnum->MoveNext();
+		return defSchedEnum->Current;
+	}
+
+	OpenStudio::DefaultConstructionSet^ EnergyModel::getDefaultConstructionSet(OpenStudio::Model ^ model)
+	{
+		// Get list of default construction sets
+		OpenStudio::DefaultConstructionSetVector^ defaultConstructionSets = model->getDefaultConstructionSets();
+		// Get the first item and use as the default construction set
+		OpenStudio::DefaultConstructionSetVector::DefaultConstructionSetVectorEnumerator^ defConEnum = defaultConstructionSets->GetEnumerator();
+		defConEnum->MoveNext();
+		return defConEnum->Current;
+	}
+
+	OpenStudio::Space^ EnergyModel::AddSpace(
+		int spaceNumber,
+		Cell^ cell,
+		CellGeometry^ cellGeometry,
+		FaceAdjacency^ faceAdjacency,
+		int cellIndex,
+		ModelBuildContext^ context,
+		Autodesk::DesignScript::Geometry::Vector^ upVector,
+		Nullable<double> glazingRatio,
+		WindowLayout^ windowLayout)
+	{
+		TopologicEnergyCore::TraceSpan span("AddSpace");
+		OpenStudio::Model^ osModel = context->Model;
+		OpenStudio::Space^ osSpace = gcnew OpenStudio::Space(osModel);
+
+		int storyNumber = cellGeometry->StoryNumber(cellIndex);
+		OpenStudio::BuildingStory^ buildingStory = context->BuildingStories[storyNumber];
+		osSpace->setName(ToManagedString(TopologicEnergyCore::SpaceName(storyNumber, spaceNumber)));
+		if (span.IsActive())
+		{
+			span.SetAttribute("space", ToNativeString(osSpace->nameString()));
+		}
+		context->Metrics->CountSpace();
+		osSpace->setBuildingStory(buildingStory);
+		osSpace->setDefaultConstructionSet(context->DefaultConstructionSet);
+		osSpace->setDefaultScheduleSet(context->DefaultScheduleSet);
+
+		IList<Face^>^ faces = (IList<Face^>^)cell->Faces;
+		List<OpenStudio::Point3dVector^>^ facePointsList = gcnew List<OpenStudio::Point3dVector^>();
+		for each(Face^ face in faces)
+		{
+			OpenStudio::Point3dVector^ facePoints = GetFacePoints(face);
+			facePointsList->Add(facePoints);
+		}
+
+		for (int i = 0; i < faces->Count; ++i)
+		{
+			AddSurface(i + 1, faces[i], cell, faceAdjacency->CellCount(cellIndex, i), cellGeometry->IsUnderground(cellIndex, i), facePointsList[i], osSpace, context, upVector, glazingRatio, windowLayout);
+		}
+
+		// Get all space types
+		OpenStudio::SpaceTypeVector^ osSpaceTypes = osModel->getSpaceTypes();
+		OpenStudio::SpaceTypeVector::SpaceTypeVectorEnumerator^ osSpaceTypesEnumerator = osSpaceTypes->GetEnumerator();
+		int spaceTypeCount = osSpaceTypes->Count;
+		while (osSpaceTypesEnumerator->MoveNext())
+		{
+			OpenStudio::SpaceType^ osSpaceType = osSpaceTypesEnumerator->Current;
+			OpenStudio::OptionalString^ osSpaceTypeOptionalString = osSpaceType->name();
+			String^ spaceTypeName = osSpaceTypeOptionalString->__str__();
+			if (spaceTypeName == "ASHRAE 189::1-2009 ClimateZone 4-8 MediumOffice")
+			{
+				osSpace->setSpaceType(osSpaceType);
+			}
+		}
+
+		return osSpace;
+	}
+
+
+	void EnergyModel::AddShadingSurfaces(Cell^ buildingCell, OpenStudio::Model^ osModel)
+	{
+		OpenStudio::ShadingSurfaceGroup^ osShadingGroup = gcnew OpenStudio::ShadingSurfaceGroup(osModel);
+		IList<Face^>^ faceList = buildingCell->Faces;
+		int faceIndex = 1;
+		for each(Face^ face in faceList)
+		{
+			IList<Vertex^>^ vertices = face->Vertices;
+			OpenStudio::Point3dVector^ facePoints = gcnew OpenStudio::Point3dVector();
+
+			for each(Vertex^ aVertex in vertices)
+			{
+				OpenStudio::Point3d^ aPoint = gcnew OpenStudio::Point3d(aVertex->X, aVertex->Y, aVertex->Z);
+				facePoints->Add(aPoint);
+			}
+
+			OpenStudio::ShadingSurface^ aShadingSurface = gcnew OpenStudio::ShadingSurface(facePoints, osModel);
+
+			String^ surfaceName = buildingCell->ToString() + "_SHADINGSURFACE_" + (faceIndex.ToString());
+			aShadingSurface->setName(surfaceName);
+			aShadingSurface->setShadingSurfaceGroup(osShadingGroup);
+
+			++faceIndex;
+		}
+	}
+
+	void EnergyModel::AddShadingSurfaces(Face ^ buildingFace, OpenStudio::Model ^ osModel, OpenStudio::ShadingSurfaceGroup^ osShadingGroup, int faceIndex)
+	{
+		AddShadingSurfaces(buildingFace->Vertices, osModel, osShadingGroup, faceIndex);
+	}
+
+	void EnergyModel::AddShadingSurfaces(IList<Vertex^>^ vertices, OpenStudio::Model ^ osModel, OpenStudio::ShadingSurfaceGroup^ osShadingGroup, int faceIndex)
+	{
+		OpenStudio::Point3dVector^ facePoints = gcnew OpenStudio::Point3dVector();
+
+		for each(Vertex^ aVertex in vertices)
+		{
+			OpenStudio::Point3d^ aPoint = gcnew OpenStudio::Point3d(aVertex->X, aVertex->Y, aVertex->Z);
+			facePoints->Add(aPoint);
+		}
+
+		OpenStudio::ShadingSurface^ aShadingSurface = gcnew OpenStudio::ShadingSurface(facePoints, osModel);
+
+		String^ surfaceName = "SHADINGSURFACE_" + (faceIndex.ToString());
+		aShadingSurface->setName(surfaceName);
+		aShadingSurface->setShadingSurfaceGroup(osShadingGroup);
+	}
+
+	OpenStudio::Surface^ EnergyModel::AddSurface(
+		int surfaceNumber,
+		Face^ buildingFace,
+		Cell^ buildingSpace,
+		int adjCount,
+		bool isUnderground,
+		OpenStudio::Point3dVector^ osFacePoints,
+		OpenStudio::Space^ osSpace,
+		ModelBuildContext^ context,
+		Autodesk::DesignScript::Geometry::Vector^ upVector,
+		[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> glazingRatio,
+		WindowLayout^ windowLayout)
+	{
+		TopologicEnergyCore::TraceSpan span("AddSurface");
+		OpenStudio::Model^ osModel = context->Model;
+		OpenStudio::Construction^ osInteriorCeilingType = nullptr;
+		OpenStudio::Construction^ osExteriorRoofType = nullptr;
+		OpenStudio::Construction^ osInteriorFloorType = nullptr;
+		OpenStudio::Construction^ osInteriorWallType = nullptr;
+		OpenStudio::Construction^ osExteriorDoorType = nullptr;
+		OpenStudio::Construction^ osExteriorWallType = nullptr;
+		OpenStudio::Construction^ osExteriorWindowType = nullptr;
+		int subsurfaceCounter = 1;
+
+		OpenStudio::ConstructionVector^ osConstructionTypes = osModel->getConstructions();
+		OpenStudio::ConstructionVector::ConstructionVectorEnumerator^ osConstructionTypesEnumerator =
+			osConstructionTypes->GetEnumerator();
+		int constructionTypeCount = osConstructionTypes->Count;
+
+		while (osConstructionTypesEnumerator->MoveNext())
+		{
+			OpenStudio::Construction^ osConstruction = osConstructionTypesEnumerator->Current;
+			OpenStudio::OptionalString^ osConstructionTypeOptionalString = osConstruction->name();
+			String^ constructionTypeName = osConstructionTypeOptionalString->__str__();
+			if (constructionTypeName->Equals("000 Interior Ceiling"))
+			{
+				osInteriorCeilingType = osConstruction;
+			}
+			else if (constructionTypeName->Equals("000 Interior Floor"))
+			{
+				osInteriorFloorType = osConstruction;
+			}
+			else if (constructionTypeName->Equals("000 Interior Wall"))
+			{
+				osInteriorWallType = osConstruction;
+			}
+			else if (constructionTypeName->Equals("ASHRAE 189.1-2009 ExtWindow ClimateZone 4-5"))
+			{
+				osExteriorWindowType = osConstruction;
+			}
+			else if (constructionTypeName->Equals("000 Exterior Door"))
+			{
+				osExteriorDoorType = osConstruction;
+			}
+			else if (constructionTypeName->Equals("ASHRAE 189.1-2009 ExtRoof IEAD ClimateZone 2-5"))
+			{
+				osExteriorRoofType = osConstruction;
+			}
+			else if (constructionTypeName->Equals("ASHRAE 189.1-2009 ExtWall SteelFrame ClimateZone 4-8"))
+			{
+				osExteriorWallType = osConstruction;
+			}
+		} // while (osConstructionTypesEnumerator.MoveNext())
+
+		//HACK
+		/*if (adjCount > 1)
+		{
+			osFacePoints->Reverse();
+		}*/
+
+		OpenStudio::Surface^ osSurface = gcnew OpenStudio::Surface(osFacePoints, osModel);
+		osSurface->setSpace(osSpace);
+		OpenStudio::OptionalString^ osSpaceOptionalString = osSpace->name();
+		String^ spaceName = osSpace->name()->get();
+		std::string nativeSurfaceName = TopologicEnergyCore::SurfaceName(ToNativeString(spaceName), surfaceNumber);
+		String^ surfaceName = ToManagedString(nativeSurfaceName);
+		FaceType faceType = CalculateFaceType(buildingFace, osFacePoints, buildingSpace, upVector);
+		TopologicEnergyCore::SurfaceType surfaceType = faceType == FACE_ROOFCEILING ? TopologicEnergyCore::SURFACE_ROOFCEILING
+			: faceType == FACE_FLOOR ? TopologicEnergyCore::SURFACE_FLOOR : TopologicEnergyCore::SURFACE_WALL;
+		TopologicEnergyCore::BoundaryCondition boundaryCondition = TopologicEnergyCore::SurfaceBoundaryCondition(surfaceType, (std::size_t)adjCount, isUnderground);
+		osSurface->setName(surfaceName);
+		if (span.IsActive())
+		{
+			span.SetAttribute("surface", nativeSurfaceName);
+		}
+
+		if ((faceType == FACE_ROOFCEILING) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_SURFACE))
+		{
+
+			osSurface->setOutsideBoundaryCondition("Surface");
+			osSurface->setSurfaceType("RoofCeiling");
+			osSurface->setConstruction(osInteriorCeilingType);
+			osSurface->setSunExposure("NoSun");
+			osSurface->setWindExposure("NoWind");
+		}
+		else if ((faceType == FACE_ROOFCEILING) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_OUTDOORS))
+		{
+			OpenStudio::Vector3d^ pSurfaceNormal = osSurface->outwardNormal();
+
+			double x = pSurfaceNormal->x();
+			double y = pSurfaceNormal->y();
+			double z = pSurfaceNormal->z();
+			pSurfaceNormal->normalize();
+			OpenStudio::Vector3d^ upVector = gcnew OpenStudio::Vector3d(0, 0, 1.0);
+			// If the normal does not point downward, flip it. Use dot product.
+			double dotProduct = pSurfaceNormal->dot(upVector);
+			if (dotProduct < 0.98)
+			{
+				OpenStudio::Point3dVector^ surfaceVertices = osSurface->vertices();
+				surfaceVertices->Reverse();
+				osSurface->setVertices(surfaceVertices);
+			}
+			osSurface->setOutsideBoundaryCondition("Outdoors");
+			osSurface->setSurfaceType("RoofCeiling");
+			osSurface->setConstruction(osExteriorRoofType);
+			osSurface->setSunExposure("SunExposed");
+			osSurface->setWindExposure("WindExposed");
+		}
+		else if ((faceType == FACE_ROOFCEILING) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_GROUND))
+		{
+			OpenStudio::Vector3d^ pSurfaceNormal = osSurface->outwardNormal();
+
+			double x = pSurfaceNormal->x();
+			double y = pSurfaceNormal->y();
+			double z = pSurfaceNormal->z();
+			pSurfaceNormal->normalize();
+			OpenStudio::Vector3d^ upVector = gcnew OpenStudio::Vector3d(0, 0, 1.0);
+			// If the normal does not point downward, flip it. Use dot product.
+			double dotProduct = pSurfaceNormal->dot(upVector);
+			if (dotProduct < 0.98)
+			{
+				OpenStudio::Point3dVector^ surfaceVertices = osSurface->vertices();
+				surfaceVertices->Reverse();
+				osSurface->setVertices(surfaceVertices);
+			}
+			osSurface->setOutsideBoundaryCondition("Ground");
+			osSurface->setSurfaceType("RoofCeiling");
+			osSurface->setConstruction(osExteriorRoofType);
+			osSurface->setSunExposure("NoSun");
+			osSurface->setWindExposure("NoWind");
+		}
+		else if ((faceType == FACE_FLOOR) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_SURFACE))
+		{
+			osSurface->setOutsideBoundaryCondition("Surface");
+			osSurface->setSurfaceType("Floor");
+			osSurface->setConstruction(osInteriorFloorType);
+			osSurface->setSunExposure("NoSun");
+			osSurface->setWindExposure("NoWind");
+		}
+		else if ((faceType == FACE_FLOOR) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_GROUND))
+		{
+			OpenStudio::Vector3d^ pSurfaceNormal = osSurface->outwardNormal();
+
+			double x = pSurfaceNormal->x();
+			double y = pSurfaceNormal->y();
+			double z = pSurfaceNormal->z();
+			pSurfaceNormal->normalize();
+			OpenStudio::Vector3d^ downwardVector = gcnew OpenStudio::Vector3d(0, 0, -1.0);
+			// If the normal does not point downward, flip it. Use dot product.
+			double dotProduct = pSurfaceNormal->dot(downwardVector);
+			if (dotProduct < 0.98)
+			{
+				OpenStudio::Point3dVector^ surfaceVertices = osSurface->vertices();
+				surfaceVertices->Reverse();
+				osSurface->setVertices(surfaceVertices);
+			}
+			osSurface->setOutsideBoundaryCondition("Ground");
+			osSurface->setSurfaceType("Floor");
+			osSurface->setConstruction(osExteriorWallType);
+			osSurface->setSunExposure("NoSun");
+			osSurface->setWindExposure("NoWind");
+		}
+		else if ((faceType == FACE_WALL) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_SURFACE)) // internal wall
+		{
+			osSurface->setOutsideBoundaryCondition("Surface");
+			osSurface->setSurfaceType("Wall");
+			osSurface->setConstruction(osInteriorWallType);
+			osSurface->setSunExposure("NoSun");
+			osSurface->setWindExposure("NoWind");
+		}
+		else if ((faceType == FACE_WALL) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_GROUND)) // external wall underground
+		{
+			osSurface->setOutsideBoundaryCondition("Ground");
+			osSurface->setSurfaceType("Wall");
+			osSurface->setConstruction(osExteriorWallType);
+			osSurface->setSunExposure("NoSun");
+			osSurface->setWindExposure("NoWind");
+		}
+		else if ((faceType == FACE_WALL) && (boundaryCondition == TopologicEnergyCore::BOUNDARY_OUTDOORS)) // external wall overground
+		{
+			osSurface->setOutsideBoundaryCondition("Outdoors");
+			osSurface->setSurfaceType("Wall");
+			osSurface->setConstruction(osExteriorWallType);
+			osSurface->setSunExposure("SunExposed");
+			osSurface->setWindExposure("WindExposed");
+
+			if (glazingRatio.HasValue)
+			{
+				if (glazingRatio.Value < 0.0 || glazingRatio.Value > 1.0)
+				{
+					throw gcnew Exception("The glazing ratio must be between 0.0 and 1.0 (both inclusive).");
+				}
+				else if (glazingRatio.Value > 0.0 && glazingRatio.Value <= 1.0)
+				{
+					// Rectangular windows if a layout is given and fits the wall, otherwise triangulate the scaled wall
+					IList<IList<Vertex^>^>^ windows = nullptr;
+					if (windowLayout != nullptr)
+					{
+						windows = windowLayout->Windows(buildingFace, glazingRatio.Value);
+					}
+
+					if (windows == nullptr)
+					{
+						IList<Vertex^>^ scaledVertices = (IList<Vertex^>^)ScaleFaceVertices(buildingFace, glazingRatio.Value);
+						windows = gcnew List<IList<Vertex^>^>();
+						for (int i = 0; i < scaledVertices->Count - 2; ++i)
+						{
+							List<Vertex^>^ triangleVertices = gcnew List<Vertex^>();
+							triangleVertices->Add(scaledVertices[0]);
+							triangleVertices->Add(scaledVertices[i + 1]);
+							triangleVertices->Add(scaledVertices[i + 2]);
+
+							windows->Add(ScaleVertices(triangleVertices, 0.999));
+						}
+					}
+
+					for each(IList<Vertex^>^ windowVertices in windows)
+					{
+						OpenStudio::Point3dVector^ osWindowFacePoints = gcnew OpenStudio::Point3dVector();
+
+						for each (Vertex^ windowVertex in windowVertices)
+						{
+							OpenStudio::Point3d^ osPoint = gcnew OpenStudio::Point3d(
+								windowVertex->X,
+								windowVertex->Y,
+								windowVertex->Z);
+
+							osWindowFacePoints->Add(osPoint);
+						}
+
+						OpenStudio::SubSurface^ osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel);
+						context->Metrics->CountSubSurfaceCreated();
+						double dotProduct = osWindowSubSurface->outwardNormal()->dot(osSurface->outwardNormal());
+						if (dotProduct < -0.99) // flipped
+						{
+							osWindowFacePoints->Reverse();
+							osWindowSubSurface->remove();
+							osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel); //CreateSubSurface(pApertureVertices, osModel);
+							context->Metrics->CountSubSurfaceRemoved();
+							context->Metrics->CountSubSurfaceCreated();
+							context->Metrics->CountSubSurfaceFlipped();
+						}
+						else if (dotProduct > -0.99 && dotProduct < 0.99)
+						{
+							throw gcnew Exception("There is a non-coplanar subsurface.");
+						}
+						osWindowSubSurface->setSubSurfaceType("FixedWindow");
+						osWindowSubSurface->setSurface(osSurface);
+						osWindowSubSurface->setName(ToManagedString(TopologicEnergyCore::SubSurfaceName(nativeSurfaceName, subsurfaceCounter)));
+						subsurfaceCounter++;
+					} // for each(IList<Vertex^>^ windowVertices in windows)
+				}
+			}
+			else // glazingRatio is null
+			{
+				// Use the surface apertures
+				IList<Topologic::Topology^>^ pContents = buildingFace->Contents;
+				for each(Topologic::Topology^ pContent in pContents)
+				{
+					Aperture^ pAperture = dynamic_cast<Aperture^>(pContent);
+					if (pAperture == nullptr)
+					{
+						continue;
+					}
+
+					Face^ pFaceAperture = dynamic_cast<Face^>(pAperture->Topology);
+					if (pAperture == nullptr)
+					{
+						continue;
+					}
+					// skip small triangles
+					double area = Topologic::Utilities::FaceUtility::Area(pFaceAperture);
+					if (area <= 0.1)
+					{
+						continue;
+					}
+					Wire^ pApertureWire = pFaceAperture->ExternalBoundary;
+					List<Vertex^>^ pApertureVertices = (List<Vertex^>^)pApertureWire->Vertices;
+					//OpenStudio::SubSurface^ osWindowSubSurface = gcnew OpenStudio::SubSurface(osWindowFacePoints, osModel);
+					OpenStudio::SubSurface^ osWindowSubSurface = CreateSubSurface(pApertureVertices, osModel);
+					context->Metrics->CountSubSurfaceCreated();
+					double dotProduct = osWindowSubSurface->outwardNormal()->dot(osSurface->outwardNormal());
+					if (dotProduct < -0.99) // flipped
+					{
+						pApertureVertices->Reverse();
+						osWindowSubSurface->remove();
+						osWindowSubSurface = CreateSubSurface(pApertureVertices, osModel);
+						context->Metrics->CountSubSurfaceRemoved();
+						context->Metrics->CountSubSurfaceCreated();
+						context->Metrics->CountSubSurfaceFlipped();
+					}
+					else if (dotProduct > -0.99 && dotProduct < 0.99)
+					{
+						throw gcnew Exception("There is a non-coplanar subsurface.");
+					}
+
+					context->AddAperture();
+
+					double grossSubsurfaceArea = osWindowSubSurface->grossArea();
+					double netSubsurfaceArea = osWindowSubSurface->netArea();
+					double grossSurfaceArea = osSurface->grossArea();
+					double netSurfaceArea = osSurface->netArea();
+					if (grossSubsurfaceArea > 0.1)
+					{
+						osWindowSubSurface->setSubSurfaceType("FixedWindow");
+						bool result = osWindowSubSurface->setSurface(osSurface);
+						if (result)
+						{
+							osWindowSubSurface->setName(ToManagedString(TopologicEnergyCore::SubSurfaceName(nativeSurfaceName, subsurfaceCounter)));
+							subsurfaceCounter++;
+							context->AddAppliedAperture();
+						}
+					}
+					else
+					{
+						osWindowSubSurface->remove();
+						context->Metrics->CountSubSurfaceRemoved();
+					}
+				}
+			}
+		}
+
+		context->Metrics->CountSurface(osSurface->surfaceType(), osSurface->outsideBoundaryCondition());
+		return osSurface;
+	}
+
+	IList<Vertex^>^ EnergyModel::ScaleFaceVertices(Face^ buildingFace, double scaleFactor)
+	{
+		Wire^ pApertureWire = buildingFace->ExternalBoundary;
+		List<Vertex^>^ vertices = (List<Vertex^>^)pApertureWire->Vertices;
+		vertices->Reverse();
+
+		return ScaleVertices(vertices, scaleFactor);
+	}
+
+	IList<Vertex^>^ EnergyModel::ScaleVertices(IList<Vertex^>^ vertices, double scaleFactor)
+	{
+		List<Vertex^>^ scaledVertices = gcnew List<Vertex^>();
+		double sqrtScaleFactor = Math::Sqrt(scaleFactor);
+		Vertex^ centreVertex = GetCentreVertex(vertices);
+		Autodesk::DesignScript::Geometry::Point^ faceCenterPoint =
+			safe_cast<Autodesk::DesignScript::Geometry::Point^>(centreVertex->BasicGeometry);
+		for each(Vertex^ aVertex in vertices)
+		{
+			Autodesk::DesignScript::Geometry::Point^ originalPoint =
+				safe_cast<Autodesk::DesignScript::Geometry::Point^>(aVertex->BasicGeometry);
+			Autodesk::DesignScript::Geometry::Vector^ originalPointAsVector = faceCenterPoint->AsVector();
+			Autodesk::DesignScript::Geometry::Point^ translatedPoint = originalPoint->Subtract(originalPointAsVector);
+			Autodesk::DesignScript::Geometry::Point^ scaledPoint = safe_cast<Autodesk::DesignScript::Geometry::Point^>(translatedPoint->Scale(sqrtScaleFactor, sqrtScaleFactor, sqrtScaleFactor));
+			Autodesk::DesignScript::Geometry::Vector^ scaledPointAsVector = faceCenterPoint->AsVector();
+			Autodesk::DesignScript::Geometry::Point^ reTranslatedPoint = scaledPoint->Add(scaledPointAsVector);
+			scaledVertices->Add(safe_cast<Vertex^>(Topologic::Topology::ByGeometry(reTranslatedPoint, 0.001))); // tolerance does not matter as it's just a vertex
+
+			delete reTranslatedPoint;
+			delete scaledPointAsVector;
+			delete scaledPoint;
+			delete translatedPoint;
+			delete originalPointAsVector;
+			delete originalPoint;
+		}
+
+		delete faceCenterPoint;
+
+		return scaledVertices;
+	}
+
+	Vertex^ EnergyModel::GetCentreVertex(IList<Vertex^>^ vertices)
+	{
+		Autodesk::DesignScript::Geometry::Point^ sumPoint = Autodesk::DesignScript::Geometry::Point::ByCoordinates(0, 0, 0);
+
+		// assume vertices.count > 0
+		if (vertices->Count < 3)
+		{
+			throw gcnew Exception("Invalid face");
+		}
+
+		for each(Vertex^ v in vertices)
+		{
+			Autodesk::DesignScript::Geometry::Point^ p =
+				safe_cast<Autodesk::DesignScript::Geometry::Point^>(v->BasicGeometry);
+			Autodesk::DesignScript::Geometry::Vector^ vector = p->AsVector();
+			sumPoint = sumPoint->Add(vector);
+			delete vector;
+			delete p;
+		}
+		
+		double scalingFactor = 1.0 / (double)vertices->Count;
+		Autodesk::DesignScript::Geometry::Geometry^ scaledPoint = sumPoint->Scale(scalingFactor, scalingFactor, scalingFactor);
+		Autodesk::DesignScript::Geometry::Point^ dynamoPoint = safe_cast<Autodesk::DesignScript::Geometry::Point^>(scaledPoint);
+		Vertex^ vertex = safe_cast<Vertex^>(Topologic::Topology::ByGeometry(dynamoPoint, 0.001)); // tolerance does not matter as it's just a vertex
+		delete dynamoPoint;
+		delete sumPoint;
+		return vertex;
+	}
+
+	OpenStudio::Point3dVector^ EnergyModel::GetFacePoints(Face^ buildingFace)
+	{
+		Wire^ buildingOuterWire = buildingFace->ExternalBoundary;
+		IList<Vertex^>^ vertices = buildingOuterWire->Vertices;
+
+		OpenStudio::Point3dVector^ osFacePoints = gcnew OpenStudio::Point3dVector();
+
+		for each(Vertex^ v in vertices)
+		{
+			OpenStudio::Point3d^ osPoint = gcnew OpenStudio::Point3d(
+				v->X,
+				v->Y,
+				v->Z);
+
+			osFacePoints->Add(osPoint);
+		}
+
+		return osFacePoints;
+	}
+
+	FaceType EnergyModel::CalculateFaceType(Face^ buildingFace, OpenStudio::Point3dVector^% facePoints, Cell^ buildingSpace, Autodesk::DesignScript::Geometry::Vector^ upVector)
+	{
+		FaceType faceType = FACE_WALL;
+		IList<Face^>^ faces = (IList<Face^>^) Topologic::Utilities::FaceUtility::Triangulate(buildingFace, 0.01);
+		if (faces->Count == 0)
+		{
+			throw gcnew Exception("Failed to triangulate a face.");
+		}
+
+		Face^ firstFace = faces[0];
+		Vertex^ centerPoint = firstFace->CenterOfMass;
+		Autodesk::DesignScript::Geometry::Point^ dynamoCenterPoint =
+			safe_cast<Autodesk::DesignScript::Geometry::Point^>(centerPoint->BasicGeometry);
+
+		IList<Vertex^>^ vertices = (IList<Vertex^>^)buildingFace->Vertices;
+		Autodesk::DesignScript::Geometry::Point^ p1 =
+			safe_cast<Autodesk::DesignScript::Geometry::Point^>(vertices[0]->BasicGeometry);
+		Autodesk::DesignScript::Geometry::Vector^ p1AsVector = p1->AsVector();
+		Autodesk::DesignScript::Geometry::Point^ p2 =
+			safe_cast<Autodesk::DesignScript::Geometry::Point^>(vertices[1]->BasicGeometry);
+		Autodesk::DesignScript::Geometry::Point^ p2Subtract = p2->Subtract(p1AsVector);
+		Autodesk::DesignScript::Geometry::Vector^ p2SubtractAsVector = p2Subtract->AsVector();
+		Autodesk::DesignScript::Geometry::Point^ p3 =
+			safe_cast<Autodesk::DesignScript::Geometry::Point^>(vertices[2]->BasicGeometry);
+		Autodesk::DesignScript::Geometry::Point^ p3Subtract = p3->Subtract(p1AsVector);
+		Autodesk::DesignScript::Geometry::Vector^ p3SubtractAsVector = p3Subtract->AsVector();
+		Autodesk::DesignScript::Geometry::Vector^ dir = p2SubtractAsVector->Cross(p3SubtractAsVector);
+		Autodesk::DesignScript::Geometry::Vector^ faceNormal = dir->Normalized();
+		double faceAngle = faceNormal->AngleWithVector(upVector);
+		Autodesk::DesignScript::Geometry::Vector^ scaledFaceNormal = faceNormal->Scale(0.001, 0.001, 0.001);
+		Autodesk::DesignScript::Geometry::Point^ pDynamoOffsetPoint =
+			dynamic_cast<Autodesk::DesignScript::Geometry::Point^>(dynamoCenterPoint->Translate(scaledFaceNormal));
+
+		Vertex^ pOffsetVertex = safe_cast<Vertex^>(Topologic::Topology::ByGeometry(pDynamoOffsetPoint, 0.001)); // tolerance does not matter as it's just a vertex
+
+		if (TopologicEnergyCore::SurfaceTypeByUpAngle(faceAngle) != TopologicEnergyCore::SURFACE_WALL)
+		{
+			bool isInside = Topologic::Utilities::CellUtility::Contains(buildingSpace, pOffsetVertex, true, 0.0001);
+			// The offset vertex has to be false, so if isInside is true, reverse the face.
+
+			if (isInside)
+			{
+				facePoints->Reverse();
+				faceNormal = faceNormal->Reverse();
+				faceAngle = faceNormal->AngleWithVector(upVector);
+			}
+
+			// The same rule as BuildModel, on the outward normal
+			faceType = TopologicEnergyCore::SurfaceTypeByUpAngle(faceAngle) == TopologicEnergyCore::SURFACE_ROOFCEILING ? FACE_ROOFCEILING : FACE_FLOOR;
+		}
+
+		delete dynamoCenterPoint;
+		delete p1;
+		delete p1AsVector;
+		delete p2;
+		delete p2Subtract;
+		delete p2SubtractAsVector;
+		delete p3;
+		delete p3Subtract;
+		delete p3SubtractAsVector;
+		delete dir;
+		delete faceNormal;
+		delete scaledFaceNormal;
+		delete pDynamoOffsetPoint;
+
+		return faceType;
+	}
+
+	bool EnergyModel::ExportTogbXML(EnergyModel^ energyModel, String ^ filePath)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		if (energyModel == nullptr)
+		{
+			throw gcnew Exception("The input energy model is null.");
+		}
+
+		OpenStudio::SpaceVector^ osSpaces = nullptr;
+		OpenStudio::Model^ osModel = energyModel->GetExportModel(osSpaces);
+		OpenStudio::GbXMLForwardTranslator^ osForwardTranslator = gcnew OpenStudio::GbXMLForwardTranslator();
+		OpenStudio::Path^ osPath = OpenStudio::OpenStudioUtilitiesCore::toPath(filePath);
+		bool success = false;
+		try {
+			success = osForwardTranslator->modelToGbXML(osModel, osPath);
+		}
+		finally
+		{
+			energyModel->ReleaseExportModel(osModel);
+		}
+		OpenStudio::LogMessageVector^ osErrors = osForwardTranslator->errors();
+		if (osErrors->Count > 0)
+		{
+			String^ errorMsg = gcnew String("Fails exporting an EnergyModel to GbXML with the following errors:\n");
+			int i = 0;
+			for each(auto osError in osErrors)
+			{
+				errorMsg += osError->logMessage();
+
+				if (i < osErrors->Count - 1)
+				{
+					errorMsg += "\n";
+				}
+				++i;
+			}
+			throw gcnew Exception(errorMsg);
+		}
+
+		return true;
+	}
+
+	EnergyModel^ EnergyModel::ByImportedgbXML(String ^ filePath, double tolerance)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		if (tolerance <= 0.0)
+		{
+			throw gcnew Exception("The tolerance must have a positive value.");
+		}
+
+		OpenStudio::GbXMLReverseTranslator^ osReverseTranslator = gcnew OpenStudio::GbXMLReverseTranslator();
+		OpenStudio::Path^ osPath = OpenStudio::OpenStudioUtilitiesCore::toPath(filePath);
+		OpenStudio::OptionalModel^ osOptionalModel = osReverseTranslator->loadModel(osPath);
+		if (osOptionalModel->isNull())
+		{
+			throw gcnew Exception("The imported gbXML yields a null OpenStudio Model.");
+		}
+		OpenStudio::Model^ osModel = osOptionalModel->get();
+
+		OpenStudio::LogMessageVector^ osErrors = osReverseTranslator->errors();
+		if (osErrors->Count > 0)
+		{
+			String^ errorMsg = gcnew String("Fails importing an OpenStudio model from GbXML with the following errors:\n");
+			int i = 0;
+			for each(auto osError in osErrors)
+			{
+				errorMsg += osError->logMessage();
+
+				if (i < osErrors->Count - 1)
+				{
+					errorMsg += "\n";
+				}
+				++i;
+			}
+			throw gcnew Exception(errorMsg);
+		}
+
+
+		OpenStudio::Building^ osBuilding = nullptr;
+		List<Cell^>^ buildingCells = nullptr;
+		Cluster^ shadingFaces = nullptr;
+		OpenStudio::SpaceVector^ osSpaceVector = nullptr;
+		ProcessOsModel(osModel, tolerance, osBuilding, buildingCells, shadingFaces, osSpaceVector);
+
+		EnergyModel^ energyModel = gcnew EnergyModel(osModel, osBuilding, buildingCells, shadingFaces, osSpaceVector);
+
+		return energyModel;
+	}
+
+	EnergyModel^ EnergyModel::Derive(EnergyModel^ energyModel, ModelOverrides^ overrides)
+	{
+		if (energyModel == nullptr)
+		{
+			throw gcnew Exception("The input energy model is null.");
+		}
+
+		if (overrides == nullptr)
+		{
+			throw gcnew Exception("The input overrides must not be null.");
+		}
+
+		// A single setpoint override is checked against the setpoint it keeps from the parent.
+		Nullable<double> heatingTemp = overrides->HeatingTemp.HasValue ? overrides->HeatingTemp : energyModel->SetpointTemperature(true);
+		Nullable<double> coolingTemp = overrides->CoolingTemp.HasValue ? overrides->CoolingTemp : energyModel->SetpointTemperature(false);
+		if (heatingTemp.HasValue && coolingTemp.HasValue && heatingTemp.Value > coolingTemp.Value)
+		{
+			throw gcnew Exception("The heating temperature of the variant must not be greater than its cooling temperature.");
+		}
+
+		// The variant shares the cells, the shading surfaces and the render cache of its parent, and holds
+		// only its overrides. Export and EnergySimulation apply them to a copy of the parent's model that is
+		// released when they are done, so many variants in flight cost one model plus their overrides.
+		// Reading OsModel, or MergeCoplanarSurfaces, gives the variant a model of its own instead, kept for
+		// its lifetime so that changes to it persist.
+		return gcnew EnergyModel(energyModel, overrides);
+	}
+
+	OpenStudio::Model^ EnergyModel::OsModel::get()
+	{
+		Detach();
+		return m_osModel;
+	}
+
+	void EnergyModel::Detach()
+	{
+		if (m_osModel != nullptr)
+		{
+			return;
+		}
+
+		m_osModel = GetExportModel(m_osSpaceVector);
+		m_osBuilding = m_osModel->getBuilding();
+	}
+
+	OpenStudio::SpaceVector^ EnergyModel::OsSpaces::get()
+	{
+		Detach();
+		return m_osSpaceVector;
+	}
+
+	OpenStudio::Model^ EnergyModel::GetExportModel(OpenStudio::SpaceVector^% osSpaces)
+	{
+		if (m_snapshotOsm != nullptr)
+		{
+			LoadSnapshotOsm();
+		}
+
+		if (m_osModel != nullptr)
+		{
+			osSpaces = m_osSpaceVector;
+			return m_osModel;
+		}
+
+		// A variant without a model of its own: the overrides go on a copy of its parent's model. A copy
+		// made for the parent, itself a variant, is only used here, so it takes the overrides as it is.
+		OpenStudio::SpaceVector^ osParentSpaces = nullptr;
+		OpenStudio::Model^ osModel = m_parent->GetExportModel(osParentSpaces);
+		if (osModel == m_parent->m_osModel)
+		{
+			osModel = osModel->clone(true)->to_Model();
+		}
+		m_overrides->Apply(osModel);
+
+		// The handles are kept by the copy, but the spaces are looked up by name to keep the cell order.
+		osSpaces = gcnew OpenStudio::SpaceVector();
+		OpenStudio::SpaceVector::SpaceVectorEnumerator^ osSpaceEnumerator = osParentSpaces->GetEnumerator();
+		while (osSpaceEnumerator->MoveNext())
+		{
+			osSpaces->Add(osModel->getSpaceByName(osSpaceEnumerator->Current->name()->get())->get());
+		}
+		return osModel;
+	}
+
+	void EnergyModel::ReleaseExportModel(OpenStudio::Model^ osModel)
+	{
+		// Only a variant's temporary copy; the model of the EnergyModel itself stays.
+		if (osModel != m_osModel)
+		{
+			delete osModel;
+		}
+	}
+
+	void EnergyModel::LoadSnapshotOsm()
+	{
+		// OpenStudio only loads models from files, so the OSM goes through a temporary file.
+		String^ osmPath = Path::Combine(Path::GetTempPath(), Guid::NewGuid().ToString() + ".osm");
+		File::WriteAllBytes(osmPath, m_snapshotOsm);
+		OpenStudio::OptionalModel^ osOptionalModel = OpenStudio::Model::load(OpenStudio::OpenStudioUtilitiesCore::toPath(osmPath));
+		File::Delete(osmPath);
+		if (osOptionalModel->isNull())
+		{
+			throw gcnew Exception("Fails to load the OpenStudio model of the snapshot.");
+		}
+		OpenStudio::Model^ osModel = osOptionalModel->get();
+
+		// The space of each cell is the one its Name attribute refers to.
+		OpenStudio::SpaceVector^ osSpaceVector = gcnew OpenStudio::SpaceVector();
+		for each(Cell^ cell in m_buildingCells)
+		{
+			Object^ spaceName = cell->AttributeValue("Name");
+			OpenStudio::OptionalSpace^ osOptionalSpace = osModel->getSpaceByName(spaceName == nullptr ? "" : spaceName->ToString());
+			if (osOptionalSpace->isNull())
+			{
+				throw gcnew Exception("The space " + spaceName + " of the snapshot is not in its OpenStudio model.");
+			}
+			osSpaceVector->Add(osOptionalSpace->get());
+		}
+
+		m_osModel = osModel;
+		m_osBuilding = osModel->getBuilding();
+		m_osSpaceVector = osSpaceVector;
+		m_snapshotOsm = nullptr;
+	}
+
+	Nullable<double> EnergyModel::SetpointTemperature(bool isHeating)
+	{
+		if (m_overrides != nullptr)
+		{
+			Nullable<double> temperature = isHeating ? m_overrides->HeatingTemp : m_overrides->CoolingTemp;
+			if (temperature.HasValue)
+			{
+				return temperature;
+			}
+		}
+
+		if (m_snapshotOsm != nullptr)
+		{
+			LoadSnapshotOsm();
+		}
+
+		if (m_osModel == nullptr)
+		{
+			return m_parent->SetpointTemperature(isHeating);
+		}
+
+		// The thermostats share one pair of constant schedules, see AddThermalZones and ModelOverrides.
+		OpenStudio::ThermostatSetpointDualSetpointVector::ThermostatSetpointDualSetpointVectorEnumerator^ osThermostatEnumerator =
+			m_osModel->getThermostatSetpointDualSetpoints()->GetEnumerator();
+		while (osThermostatEnumerator->MoveNext())
+		{
+			OpenStudio::ThermostatSetpointDualSetpoint^ osThermostat = osThermostatEnumerator->Current;
+			OpenStudio::OptionalSchedule^ osSchedule = isHeating ?
+				osThermostat->heatingSetpointTemperatureSchedule() : osThermostat->coolingSetpointTemperatureSchedule();
+			if (!osSchedule->is_initialized())
+			{
+				continue;
+			}
+
+			OpenStudio::OptionalScheduleConstant^ osScheduleConstant = osSchedule->get()->to_ScheduleConstant();
+			if (osScheduleConstant->is_initialized())
+			{
+				return osScheduleConstant->get()->value();
+			}
+		}
+		return Nullable<double>();
+	}
+
+	IList<int>^ EnergyModel::GetColor(double ratio)
+	{
+		// No data, e.g. a space missing from a comparison or a zero baseline: grey, as in ColorMap
+		if (Double::IsNaN(ratio))
+		{
+			List<int>^ noDataRgb = gcnew List<int>();
+			noDataRgb->Add(128);
+			noDataRgb->Add(128);
+			noDataRgb->Add(128);
+			return noDataRgb;
+		}
+
+		// The blue - cyan - green - yellow - red ramp of the default colormap, clamped to [0, 1] and evaluated
+		// exactly rather than through its lookup table
+		unsigned char color[3];
+		TopologicEnergyCore::DefaultColor(Math::Max(Math::Min(ratio, 1.0), 0.0), color);
+		List<int>^ rgb = gcnew List<int>();
+		rgb->Add(color[0]);
+		rgb->Add(color[1]);
+		rgb->Add(color[2]);
+		return rgb;
+	}
+
+	String^ EnergyModel::BuildingName::get()
+	{
+		// The overrides leave the name alone, so a variant without a model of its own reads its parent's.
+		if (m_osModel == nullptr && m_parent != nullptr)
+		{
+			return m_parent->BuildingName;
+		}
+
+		if (m_snapshotOsm != nullptr)
+		{
+			LoadSnapshotOsm();
+		}
+
+		if (m_osBuilding == nullptr)
+		{
+			return "";
+		}
+
+		OpenStudio::OptionalString^ osName = m_osBuilding->name();
+		return osName->get();
+	}
+
+	IList<Topologic::Cell^>^ EnergyModel::Topology::get()
+	{
+		return m_buildingCells;
+	}
+
+	TopologicEnergy::PipelineMetrics^ EnergyModel::PipelineMetrics::get()
+	{
+		// A variant shares the build of its parent; imported models have no build metrics.
+		if (m_parent != nullptr)
+		{
+			return m_parent->PipelineMetrics;
+		}
+		return m_pipelineMetrics;
+	}
+
+	TopologicEnergy::RenderCache^ EnergyModel::RenderCache::get()
+	{
+		// A variant has the geometry of its parent.
+		if (m_parent != nullptr)
+		{
+			return m_parent->RenderCache;
+		}
+
+		if (m_renderCache == nullptr)
+		{
+			m_renderCache = gcnew TopologicEnergy::RenderCache(m_buildingCells);
+		}
+		return m_renderCache;
+	}
+
+	EnergyModel::EnergyModel(OpenStudio::Model^ osModel, OpenStudio::Building^ osBuilding, IList<Topologic::Cell^>^ pBuildingCells, 
+		Cluster^ shadingSurfaces, OpenStudio::SpaceVector^ osSpaces)
+		: m_osModel(osModel)
+		, m_osBuilding(osBuilding)
+		, m_buildingCells(pBuildingCells)
+		, m_osSpaceVector(osSpaces)
+		, m_shadingSurfaces(shadingSurfaces)
+		, m_renderCache(nullptr)
+		, m_parent(nullptr)
+		, m_overrides(nullptr)
+		, m_pipelineMetrics(nullptr)
+		, m_snapshotOsm(nullptr)
+	{
+
+	}
+
+	EnergyModel::EnergyModel(EnergyModel^ parent, ModelOverrides^ overrides)
+		: m_osModel(nullptr)
+		, m_osBuilding(nullptr)
+		, m_buildingCells(parent->m_buildingCells)
+		, m_osSpaceVector(nullptr)
+		, m_shadingSurfaces(parent->m_shadingSurfaces)
+		, m_renderCache(nullptr)
+		, m_parent(parent)
+		, m_overrides(overrides)
+		, m_pipelineMetrics(nullptr)
+		, m_snapshotOsm(nullptr)
+	{
+
+	}
 }
\ No newline at end of file
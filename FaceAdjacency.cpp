@@ -0,0 +1,68 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "FaceAdjacency.h"
+
+namespace TopologicEnergy
+{
+	FaceAdjacency::FaceAdjacency(CellGeometry^ cellGeometry, double tolerance)
+		: m_pTable(new TopologicEnergyCore::FaceAdjacencyTable(tolerance))
+		, m_cellFaceIds(gcnew array<array<int>^>(cellGeometry->CellCount))
+	{
+		const TopologicEnergyCore::CellBuffer& rkBuffer = cellGeometry->Buffer();
+		for (int i = 0; i < m_cellFaceIds->Length; ++i)
+		{
+			int faceCount = (int)rkBuffer.FaceCount(i);
+			m_cellFaceIds[i] = gcnew array<int>(faceCount);
+			for (int j = 0; j < faceCount; ++j)
+			{
+				std::size_t faceId = rkBuffer.FaceId(i, j);
+				m_cellFaceIds[i][j] = (int)m_pTable->AddFace(i, rkBuffer.Coordinates(faceId), rkBuffer.VertexCount(faceId));
+			}
+		}
+	}
+
+	FaceAdjacency::~FaceAdjacency()
+	{
+		this->!FaceAdjacency();
+	}
+
+	FaceAdjacency::!FaceAdjacency()
+	{
+		delete m_pTable;
+		m_pTable = nullptr;
+	}
+
+	int FaceAdjacency::CellCount(int cellIndex, int faceIndex)
+	{
+		return (int)m_pTable->CellCount(m_cellFaceIds[cellIndex][faceIndex]);
+	}
+
+	int FaceAdjacency::FaceId(int cellIndex, int faceIndex)
+	{
+		return m_cellFaceIds[cellIndex][faceIndex];
+	}
+
+	IList<int>^ FaceAdjacency::AdjacentCells(int cellIndex)
+	{
+		List<int>^ adjacentCells = gcnew List<int>();
+		for (std::size_t adjacentCell : m_pTable->AdjacentCells(cellIndex))
+		{
+			adjacentCells->Add((int)adjacentCell);
+		}
+		return adjacentCells;
+	}
+}
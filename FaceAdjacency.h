@@ -0,0 +1,50 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "AdjacencyKernels.h"
+#include "CellGeometry.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace Topologic;
+
+namespace TopologicEnergy
+{
+	// Face -> cells adjacency of the cells of a building, built once before the spaces are created.
+	// Replaces the per-face Face::Cells queries on the whole cell complex.
+	ref class FaceAdjacency
+	{
+	public:
+		FaceAdjacency(CellGeometry^ cellGeometry, double tolerance);
+		~FaceAdjacency();
+		!FaceAdjacency();
+
+		// The number of cells bounded by a face, indexed as in cell->Faces.
+		int CellCount(int cellIndex, int faceIndex);
+
+		// The id of a face in the table, the same for every cell bounded by it.
+		int FaceId(int cellIndex, int faceIndex);
+
+		// The indices of the cells sharing a face with the cell, in ascending order.
+		IList<int>^ AdjacentCells(int cellIndex);
+
+	private:
+		TopologicEnergyCore::FaceAdjacencyTable* m_pTable;
+		array<array<int>^>^ m_cellFaceIds;
+	};
+}
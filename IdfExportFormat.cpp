@@ -0,0 +1,279 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "IdfExportFormat.h"
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		const char* SurfaceTypeName(const ModelSurface& rkSurface)
+		{
+			switch (rkSurface.type)
+			{
+			case SURFACE_FLOOR:
+				return "Floor";
+			case SURFACE_ROOFCEILING:
+				return rkSurface.boundaryCondition == BOUNDARY_SURFACE ? "Ceiling" : "Roof";
+			default:
+				return "Wall";
+			}
+		}
+
+		const std::string& SurfaceConstruction(const ModelSurface& rkSurface, const IdfConstructions& rkConstructions)
+		{
+			if (rkSurface.boundaryCondition == BOUNDARY_SURFACE)
+			{
+				switch (rkSurface.type)
+				{
+				case SURFACE_FLOOR:
+					return rkConstructions.interiorFloor;
+				case SURFACE_ROOFCEILING:
+					return rkConstructions.interiorCeiling;
+				default:
+					return rkConstructions.interiorWall;
+				}
+			}
+
+			switch (rkSurface.type)
+			{
+			case SURFACE_FLOOR:
+				return rkConstructions.groundFloor;
+			case SURFACE_ROOFCEILING:
+				return rkConstructions.exteriorRoof;
+			default:
+				return rkConstructions.exteriorWall;
+			}
+		}
+
+		void WriteVertices(std::ostream& rStream, const std::vector<double>& rkCoordinates)
+		{
+			std::size_t vertexCount = rkCoordinates.size() / 3;
+			rStream << "    " << vertexCount << ",\n";
+			for (std::size_t j = 0; j < vertexCount; ++j)
+			{
+				rStream << "    " << rkCoordinates[j * 3] << ", " << rkCoordinates[j * 3 + 1] << ", " << rkCoordinates[j * 3 + 2]
+					<< (j + 1 < vertexCount ? ",\n" : ";\n");
+			}
+			rStream << "\n";
+		}
+
+		// True if an object of the class starts a line of the IDF text, e.g. "Output:SQLite,".
+		bool HasObject(const std::string& rkText, const std::string& rkClassName)
+		{
+			std::string className = rkClassName + ",";
+			std::transform(className.begin(), className.end(), className.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+			std::istringstream lines(rkText);
+			std::string line;
+			while (std::getline(lines, line))
+			{
+				std::size_t start = line.find_first_not_of(" \t");
+				if (start == std::string::npos || line.size() - start < className.size())
+				{
+					continue;
+				}
+
+				std::string head = line.substr(start, className.size());
+				std::transform(head.begin(), head.end(), head.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+				if (head == className)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Reads the major and minor version of the Version object, e.g. "Version,\n    9.6;  !- Version Identifier".
+		// Returns false if the text has no Version object.
+		bool ReadVersion(const std::string& rkText, int& rMajor, int& rMinor)
+		{
+			std::size_t lineStart = 0;
+			while (lineStart < rkText.size())
+			{
+				std::size_t lineEnd = rkText.find('\n', lineStart);
+				if (lineEnd == std::string::npos)
+				{
+					lineEnd = rkText.size();
+				}
+
+				// The class name starts its line and is followed by a comma.
+				std::size_t start = rkText.find_first_not_of(" \t", lineStart);
+				std::string head = start < lineEnd ? rkText.substr(start, std::min<std::size_t>(7, lineEnd - start)) : std::string();
+				std::transform(head.begin(), head.end(), head.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+				std::size_t comma = head == "version" ? rkText.find_first_not_of(" \t", start + 7) : std::string::npos;
+				if (comma == std::string::npos || rkText[comma] != ',')
+				{
+					lineStart = lineEnd + 1;
+					continue;
+				}
+
+				// The identifier may be on a later line, after blanks and "!" comments.
+				std::size_t field = comma + 1;
+				while (field < rkText.size() && (std::isspace((unsigned char)rkText[field]) || rkText[field] == '!'))
+				{
+					field = rkText[field] == '!' ? rkText.find('\n', field) : field + 1;
+				}
+				if (field >= rkText.size())
+				{
+					return false;
+				}
+
+				std::istringstream version(rkText.substr(field, rkText.find_first_of(",;", field) - field));
+				char separator = 0;
+				rMinor = 0;
+				if (!(version >> rMajor))
+				{
+					return false;
+				}
+				version >> separator >> rMinor;
+				return true;
+			}
+			return false;
+		}
+	}
+
+	IdfConstructions::IdfConstructions()
+		: exteriorWall("ASHRAE 189.1-2009 ExtWall SteelFrame ClimateZone 4-8")
+		, exteriorRoof("ASHRAE 189.1-2009 ExtRoof IEAD ClimateZone 2-5")
+		, groundFloor("ASHRAE 189.1-2009 ExtWall SteelFrame ClimateZone 4-8")
+		, interiorWall("000 Interior Wall")
+		, interiorFloor("000 Interior Floor")
+		, interiorCeiling("000 Interior Ceiling")
+		, window("ASHRAE 189.1-2009 ExtWindow ClimateZone 4-5")
+	{
+	}
+
+	void WriteIdf(
+		const BuildingModel& rkModel,
+		const std::string& rkTemplatePath,
+		const IdfConstructions& rkConstructions,
+		const std::string& rkPath)
+	{
+		TraceSpan span("WriteIdf");
+		span.SetAttribute("surfaces", (std::int64_t)rkModel.surfaces.size());
+		std::ifstream templateStream(rkTemplatePath.c_str(), std::ios::binary);
+		if (!templateStream)
+		{
+			throw std::runtime_error("Fails to open the IDF template " + rkTemplatePath + ".");
+		}
+		std::stringstream templateText;
+		templateText << templateStream.rdbuf();
+		std::string idfTemplate = templateText.str();
+
+		// BuildingSurface:Detailed has a Space Name field after the Zone Name since EnergyPlus 22.1; the
+		// fenestration fields written below are those of EnergyPlus 9.0 and later.
+		int majorVersion = 0;
+		int minorVersion = 0;
+		if (!ReadVersion(idfTemplate, majorVersion, minorVersion))
+		{
+			throw std::runtime_error("The IDF template " + rkTemplatePath + " has no Version object.");
+		}
+		if (majorVersion < 9)
+		{
+			throw std::runtime_error("The IDF template " + rkTemplatePath + " is for EnergyPlus " + std::to_string(majorVersion) + "." +
+				std::to_string(minorVersion) + "; EnergyPlus 9.0 or later is needed.");
+		}
+		bool hasSpaceName = majorVersion > 22 || (majorVersion == 22 && minorVersion >= 1);
+
+		std::ofstream stream(rkPath.c_str(), std::ios::binary);
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to create the IDF file " + rkPath + ".");
+		}
+		stream.precision(17);
+
+		stream << idfTemplate << "\n\n";
+
+		// Unique objects are only added if the template does not have them.
+		if (!HasObject(idfTemplate, "Building"))
+		{
+			stream << "Building,\n    " << rkModel.name << ",\n    " << rkModel.northAxis << ",\n    City,\n    0.04,\n    0.4,\n    FullInteriorAndExterior,\n    25,\n    6;\n\n";
+		}
+		if (!HasObject(idfTemplate, "GlobalGeometryRules"))
+		{
+			stream << "GlobalGeometryRules,\n    UpperLeftCorner,\n    Counterclockwise,\n    World;\n\n";
+		}
+		if (!HasObject(idfTemplate, "Output:SQLite"))
+		{
+			stream << "Output:SQLite,\n    SimpleAndTabular;\n\n";
+		}
+		if (!HasObject(idfTemplate, "Output:Table:SummaryReports"))
+		{
+			stream << "Output:Table:SummaryReports,\n    AllSummary;\n\n";
+		}
+
+		stream << "HVACTemplate:Thermostat,\n    TOPOLOGIC_THERMOSTAT,\n    ,\n    " << rkModel.heatingTemp << ",\n    ,\n    " << rkModel.coolingTemp << ";\n\n";
+
+		for (const ModelSpace& rkSpace : rkModel.spaces)
+		{
+			stream << "Zone,\n    " << rkSpace.zoneName << ",\n    0,\n    0,\n    0,\n    0,\n    1,\n    1,\n    "
+				<< rkSpace.ceilingHeight << ",\n    " << rkSpace.volume << ";\n\n";
+			stream << "HVACTemplate:Zone:IdealLoadsAirSystem,\n    " << rkSpace.zoneName << ",\n    TOPOLOGIC_THERMOSTAT;\n\n";
+		}
+
+		for (const ModelSurface& rkSurface : rkModel.surfaces)
+		{
+			const ModelSpace& rkSpace = rkModel.spaces[rkSurface.spaceIndex];
+			bool isExterior = rkSurface.boundaryCondition == BOUNDARY_OUTDOORS;
+			stream << "BuildingSurface:Detailed,\n    " << rkSurface.name << ",\n    " << SurfaceTypeName(rkSurface) << ",\n    "
+				<< SurfaceConstruction(rkSurface, rkConstructions) << ",\n    " << rkSpace.zoneName << ",\n    " << (hasSpaceName ? ",\n    " : "");
+			if (rkSurface.boundaryCondition == BOUNDARY_SURFACE)
+			{
+				// A shared face whose other side was not matched is adiabatic.
+				if (rkSurface.adjacentSurface >= 0)
+				{
+					stream << "Surface,\n    " << rkModel.surfaces[(std::size_t)rkSurface.adjacentSurface].name << ",\n    ";
+				}
+				else
+				{
+					stream << "Adiabatic,\n    ,\n    ";
+				}
+			}
+			else
+			{
+				stream << (isExterior ? "Outdoors" : "Ground") << ",\n    ,\n    ";
+			}
+			stream << (isExterior ? "SunExposed" : "NoSun") << ",\n    " << (isExterior ? "WindExposed" : "NoWind") << ",\n    autocalculate,\n";
+			WriteVertices(stream, rkSurface.coordinates);
+
+			for (const ModelSubSurface& rkWindow : rkSurface.windows)
+			{
+				stream << "FenestrationSurface:Detailed,\n    " << rkWindow.name << ",\n    FixedWindow,\n    " << rkConstructions.window
+					<< ",\n    " << rkSurface.name << ",\n    ,\n    autocalculate,\n    ,\n    1,\n";
+				WriteVertices(stream, rkWindow.coordinates);
+			}
+		}
+
+		for (std::size_t i = 0; i < rkModel.shadingSurfaces.size(); ++i)
+		{
+			stream << "Shading:Building:Detailed,\n    SHADINGSURFACE_" << (i + 1) << ",\n    ,\n";
+			WriteVertices(stream, rkModel.shadingSurfaces[i]);
+		}
+
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to write the IDF file " + rkPath + ".");
+		}
+	}
+}
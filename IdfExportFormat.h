@@ -0,0 +1,51 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "BuildingModelKernels.h"
+
+#include <string>
+
+namespace TopologicEnergyCore
+{
+	// The construction names the surfaces refer to; the template must define them. The defaults are
+	// the constructions EnergyModel.ByCellComplex picks from the OpenStudio template.
+	struct IdfConstructions
+	{
+		IdfConstructions();
+
+		std::string exteriorWall;
+		std::string exteriorRoof;
+		std::string groundFloor;
+		std::string interiorWall;
+		std::string interiorFloor;
+		std::string interiorCeiling;
+		std::string window;
+	};
+
+	// Writes an EnergyPlus input file: the template (version, run period, materials, constructions,
+	// schedules, ...) followed by the zones, surfaces, windows and shading surfaces of the model, an ideal
+	// loads system with a dual-setpoint thermostat per zone, and the SQLite and tabular outputs read back
+	// by SqlResultReader. The surfaces get the Space Name field only if the template's Version is 22.1 or
+	// later; throws std::runtime_error if the template has no Version or is older than EnergyPlus 9.0. The
+	// HVAC templates need EnergyPlus to run with ExpandObjects (-x).
+	void WriteIdf(
+		const BuildingModel& rkModel,
+		const std::string& rkTemplatePath,
+		const IdfConstructions& rkConstructions,
+		const std::string& rkPath);
+}
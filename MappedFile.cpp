@@ -0,0 +1,125 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TopologicEnergyCore
+{
+	MappedFile::MappedFile(const std::string& rkPath, std::uint64_t minSize)
+		: m_path(rkPath)
+		, m_pFileHandle(nullptr)
+		, m_pMappingHandle(nullptr)
+		, m_pkData(nullptr)
+		, m_size(0)
+	{
+#ifdef _WIN32
+		HANDLE hFile = CreateFileA(rkPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error("Fails to open the file " + rkPath + ".");
+		}
+		m_pFileHandle = hFile;
+
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(hFile, &fileSize);
+		m_size = (std::uint64_t)fileSize.QuadPart;
+		if (m_size >= minSize && m_size > 0)
+		{
+			m_pMappingHandle = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_pMappingHandle != nullptr)
+			{
+				m_pkData = (const unsigned char*)MapViewOfFile(m_pMappingHandle, FILE_MAP_READ, 0, 0, 0);
+			}
+		}
+#else
+		int fileDescriptor = open(rkPath.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+		{
+			throw std::runtime_error("Fails to open the file " + rkPath + ".");
+		}
+
+		struct stat fileStatus;
+		fstat(fileDescriptor, &fileStatus);
+		m_size = (std::uint64_t)fileStatus.st_size;
+		if (m_size >= minSize && m_size > 0)
+		{
+			void* pMapping = mmap(nullptr, (std::size_t)m_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+			if (pMapping != MAP_FAILED)
+			{
+				m_pkData = (const unsigned char*)pMapping;
+			}
+		}
+		close(fileDescriptor);
+#endif
+		if (m_pkData == nullptr)
+		{
+			Close();
+			throw std::runtime_error("Fails to map the file " + rkPath + ".");
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (m_pkData != nullptr)
+		{
+			UnmapViewOfFile(m_pkData);
+		}
+		if (m_pMappingHandle != nullptr)
+		{
+			CloseHandle((HANDLE)m_pMappingHandle);
+		}
+		if (m_pFileHandle != nullptr)
+		{
+			CloseHandle((HANDLE)m_pFileHandle);
+		}
+#else
+		if (m_pkData != nullptr)
+		{
+			munmap((void*)m_pkData, (std::size_t)m_size);
+		}
+#endif
+		m_pkData = nullptr;
+		m_pMappingHandle = nullptr;
+		m_pFileHandle = nullptr;
+	}
+
+	const unsigned char* MappedFile::At(std::uint64_t offset, std::uint64_t size) const
+	{
+		if (offset > m_size || size > m_size - offset)
+		{
+			throw std::runtime_error("The file " + m_path + " is truncated.");
+		}
+		return m_pkData + offset;
+	}
+}
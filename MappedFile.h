@@ -0,0 +1,50 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace TopologicEnergyCore
+{
+	// A read-only memory mapping of a whole file. Only the pages that are read are loaded.
+	class MappedFile
+	{
+	public:
+		// Throws if the file cannot be opened, or is smaller than minSize.
+		MappedFile(const std::string& rkPath, std::uint64_t minSize);
+		~MappedFile();
+
+		const unsigned char* Data() const { return m_pkData; }
+		std::uint64_t Size() const { return m_size; }
+
+		// Returns a pointer to size bytes at offset, or throws if they are past the end of the file.
+		const unsigned char* At(std::uint64_t offset, std::uint64_t size) const;
+
+	private:
+		MappedFile(const MappedFile&);
+		MappedFile& operator=(const MappedFile&);
+
+		void Close();
+
+		std::string m_path;
+		void* m_pFileHandle;
+		void* m_pMappingHandle;
+		const unsigned char* m_pkData;
+		std::uint64_t m_size;
+	};
+}
@@ -0,0 +1,411 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "MeshExportFormat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		FILE* OpenFile(const std::string& rkPath, const char* pkMode)
+		{
+			FILE* pFile = nullptr;
+#ifdef _WIN32
+			fopen_s(&pFile, rkPath.c_str(), pkMode);
+#else
+			pFile = fopen(rkPath.c_str(), pkMode);
+#endif
+			return pFile;
+		}
+
+		void WriteFully(FILE* pFile, const void* pkData, std::size_t size)
+		{
+			if (size > 0 && fwrite(pkData, 1, size, pFile) != size)
+			{
+				throw std::runtime_error("Fails to write the mesh file.");
+			}
+		}
+
+		void WriteUInt32(FILE* pFile, std::uint32_t value)
+		{
+			WriteFully(pFile, &value, sizeof(std::uint32_t));
+		}
+
+		std::string EscapeJson(const std::string& rkString)
+		{
+			std::string escaped;
+			escaped.reserve(rkString.size());
+			for (char character : rkString)
+			{
+				if (character == '"' || character == '\\')
+				{
+					escaped += '\\';
+					escaped += character;
+				}
+				else if ((unsigned char)character < 0x20)
+				{
+					escaped += ' ';
+				}
+				else
+				{
+					escaped += character;
+				}
+			}
+			return escaped;
+		}
+	}
+
+	ColoredMeshWriter::ColoredMeshWriter(const std::string& rkPath, std::size_t frameCount)
+		: m_path(rkPath)
+		, m_temporaryPath(rkPath + ".tmp")
+		, m_pTemporaryFile(nullptr)
+		, m_frameCount(frameCount)
+		, m_temporarySize(0)
+		, m_isFinished(false)
+	{
+		if (m_frameCount == 0)
+		{
+			throw std::runtime_error("A mesh needs at least one color frame.");
+		}
+
+		m_pTemporaryFile = OpenFile(m_temporaryPath, "w+b");
+		if (m_pTemporaryFile == nullptr)
+		{
+			throw std::runtime_error("Fails to create the temporary file " + m_temporaryPath + ".");
+		}
+	}
+
+	ColoredMeshWriter::~ColoredMeshWriter()
+	{
+		if (m_pTemporaryFile != nullptr)
+		{
+			fclose(m_pTemporaryFile);
+			remove(m_temporaryPath.c_str());
+		}
+	}
+
+	void ColoredMeshWriter::BeginNode(const std::string& rkName)
+	{
+		if (m_isFinished)
+		{
+			throw std::runtime_error("The mesh has already been finished.");
+		}
+
+		Node node;
+		node.name = rkName;
+		node.firstVertex = m_nodes.empty() ? 0 : m_nodes.back().firstVertex + m_nodes.back().vertexCount;
+		node.vertexCount = 0;
+		node.byteOffset = m_temporarySize;
+		for (int i = 0; i < 3; ++i)
+		{
+			node.minPosition[i] = std::numeric_limits<float>::max();
+			node.maxPosition[i] = -std::numeric_limits<float>::max();
+		}
+		m_nodes.push_back(node);
+	}
+
+	void ColoredMeshWriter::AddTriangle(const double* pkPositions, const unsigned char* pkColors)
+	{
+		if (m_nodes.empty())
+		{
+			BeginNode("Mesh");
+		}
+
+		Node& rNode = m_nodes.back();
+		for (int vertex = 0; vertex < 3; ++vertex)
+		{
+			float position[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				position[i] = (float)pkPositions[vertex * 3 + i];
+				rNode.minPosition[i] = std::min(rNode.minPosition[i], position[i]);
+				rNode.maxPosition[i] = std::max(rNode.maxPosition[i], position[i]);
+			}
+			WriteTemporary(position, 3 * sizeof(float));
+			WriteTemporary(pkColors, 4 * m_frameCount);
+		}
+		rNode.vertexCount += 3;
+	}
+
+	void ColoredMeshWriter::Finish()
+	{
+		if (m_isFinished)
+		{
+			return;
+		}
+
+		// Nodes without triangles are dropped; glTF accessors must not be empty.
+		m_nodes.erase(
+			std::remove_if(m_nodes.begin(), m_nodes.end(), [](const Node& rkNode) { return rkNode.vertexCount == 0; }),
+			m_nodes.end());
+
+		FILE* pFile = OpenFile(m_path, "wb");
+		if (pFile == nullptr)
+		{
+			throw std::runtime_error("Fails to create the mesh file " + m_path + ".");
+		}
+
+		try
+		{
+			WriteFile(pFile);
+		}
+		catch (...)
+		{
+			fclose(pFile);
+			throw;
+		}
+
+		if (fclose(pFile) != 0)
+		{
+			throw std::runtime_error("Fails to write the mesh file " + m_path + ".");
+		}
+		m_isFinished = true;
+	}
+
+	void ColoredMeshWriter::WriteTemporary(const void* pkData, std::size_t size)
+	{
+		WriteFully(m_pTemporaryFile, pkData, size);
+		m_temporarySize += size;
+	}
+
+	void ColoredMeshWriter::CopyTemporary(FILE* pFile)
+	{
+		if (fflush(m_pTemporaryFile) != 0 || fseek(m_pTemporaryFile, 0, SEEK_SET) != 0)
+		{
+			throw std::runtime_error("Fails to read the temporary file " + m_temporaryPath + ".");
+		}
+
+		std::vector<unsigned char> buffer(1 << 16);
+		std::uint64_t remaining = m_temporarySize;
+		while (remaining > 0)
+		{
+			std::size_t chunkSize = (std::size_t)std::min<std::uint64_t>(remaining, buffer.size());
+			if (fread(buffer.data(), 1, chunkSize, m_pTemporaryFile) != chunkSize)
+			{
+				throw std::runtime_error("Fails to read the temporary file " + m_temporaryPath + ".");
+			}
+			WriteFully(pFile, buffer.data(), chunkSize);
+			remaining -= chunkSize;
+		}
+	}
+
+	PlyMeshWriter::PlyMeshWriter(const std::string& rkPath, std::size_t frameCount)
+		: ColoredMeshWriter(rkPath, frameCount)
+	{
+	}
+
+	void PlyMeshWriter::WriteFile(FILE* pFile)
+	{
+		std::uint64_t vertexCount = 0;
+		for (const Node& rkNode : m_nodes)
+		{
+			vertexCount += rkNode.vertexCount;
+		}
+
+		std::ostringstream header;
+		header << "ply\n";
+		header << "format binary_little_endian 1.0\n";
+		header << "comment TopologicEnergy colored mesh\n";
+		header << "comment frames " << m_frameCount << "\n";
+		for (std::size_t i = 0; i < m_nodes.size(); ++i)
+		{
+			header << "comment node " << i << " " << m_nodes[i].name << "\n";
+		}
+		header << "element vertex " << vertexCount << "\n";
+		header << "property float x\n";
+		header << "property float y\n";
+		header << "property float z\n";
+		for (std::size_t frame = 0; frame < m_frameCount; ++frame)
+		{
+			std::string suffix = frame == 0 ? std::string() : "_" + std::to_string(frame);
+			header << "property uchar red" << suffix << "\n";
+			header << "property uchar green" << suffix << "\n";
+			header << "property uchar blue" << suffix << "\n";
+			header << "property uchar alpha" << suffix << "\n";
+		}
+		header << "element face " << vertexCount / 3 << "\n";
+		header << "property list uchar uint vertex_indices\n";
+		header << "property uchar node\n";
+		header << "end_header\n";
+		std::string headerString = header.str();
+		WriteFully(pFile, headerString.data(), headerString.size());
+
+		CopyTemporary(pFile);
+
+		// The triangles are not indexed, so the face block is generated rather than stored.
+		const std::size_t faceSize = 1 + 3 * sizeof(std::uint32_t) + 1;
+		std::vector<unsigned char> buffer;
+		buffer.reserve(faceSize * 4096);
+		for (std::size_t i = 0; i < m_nodes.size(); ++i)
+		{
+			const Node& rkNode = m_nodes[i];
+			for (std::uint64_t vertex = rkNode.firstVertex; vertex < rkNode.firstVertex + rkNode.vertexCount; vertex += 3)
+			{
+				unsigned char face[faceSize];
+				face[0] = 3;
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					std::uint32_t index = (std::uint32_t)(vertex + corner);
+					memcpy(face + 1 + corner * sizeof(std::uint32_t), &index, sizeof(std::uint32_t));
+				}
+				face[faceSize - 1] = (unsigned char)i;
+				buffer.insert(buffer.end(), face, face + faceSize);
+				if (buffer.size() >= faceSize * 4096)
+				{
+					WriteFully(pFile, buffer.data(), buffer.size());
+					buffer.clear();
+				}
+			}
+		}
+		WriteFully(pFile, buffer.data(), buffer.size());
+	}
+
+	GlbMeshWriter::GlbMeshWriter(const std::string& rkPath, std::size_t frameCount)
+		: ColoredMeshWriter(rkPath, frameCount)
+	{
+		if (frameCount > MaxFrameCount)
+		{
+			throw std::runtime_error("A glTF mesh supports at most 60 color frames. Please export to PLY instead.");
+		}
+	}
+
+	void GlbMeshWriter::WriteFile(FILE* pFile)
+	{
+		const std::size_t stride = VertexSize();
+
+		std::ostringstream json;
+		json.imbue(std::locale::classic());
+		json.precision(9);
+		json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"TopologicEnergy\"}";
+		json << ",\"scene\":0,\"scenes\":[{\"nodes\":[0]}]";
+
+		// Node 0 rotates the Z-up model into glTF's Y-up frame; nodes 1..n hold the meshes.
+		json << ",\"nodes\":[{\"name\":\"Model\",\"rotation\":[-0.707106781,0,0,0.707106781]";
+		if (!m_nodes.empty())
+		{
+			json << ",\"children\":[";
+			for (std::size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				json << (i == 0 ? "" : ",") << i + 1;
+			}
+			json << "]";
+		}
+		json << "}";
+		for (std::size_t i = 0; i < m_nodes.size(); ++i)
+		{
+			json << ",{\"name\":\"" << EscapeJson(m_nodes[i].name) << "\",\"mesh\":" << i << "}";
+		}
+		json << "]";
+
+		if (!m_nodes.empty())
+		{
+			std::size_t accessorsPerNode = 1 + m_frameCount;
+			json << ",\"meshes\":[";
+			for (std::size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				std::size_t firstAccessor = i * accessorsPerNode;
+				json << (i == 0 ? "" : ",") << "{\"name\":\"" << EscapeJson(m_nodes[i].name) << "\",\"primitives\":[{\"mode\":4,\"attributes\":{\"POSITION\":" << firstAccessor;
+				for (std::size_t frame = 0; frame < m_frameCount; ++frame)
+				{
+					json << (frame == 0 ? ",\"COLOR_0\":" : ",\"_COLOR_" + std::to_string(frame) + "\":") << firstAccessor + 1 + frame;
+				}
+				json << "}}]}";
+			}
+			json << "]";
+
+			json << ",\"accessors\":[";
+			for (std::size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				const Node& rkNode = m_nodes[i];
+				json << (i == 0 ? "" : ",") << "{\"bufferView\":" << i << ",\"byteOffset\":0,\"componentType\":5126,\"count\":" << rkNode.vertexCount << ",\"type\":\"VEC3\"";
+				json << ",\"min\":[" << rkNode.minPosition[0] << "," << rkNode.minPosition[1] << "," << rkNode.minPosition[2] << "]";
+				json << ",\"max\":[" << rkNode.maxPosition[0] << "," << rkNode.maxPosition[1] << "," << rkNode.maxPosition[2] << "]}";
+				for (std::size_t frame = 0; frame < m_frameCount; ++frame)
+				{
+					json << ",{\"bufferView\":" << i << ",\"byteOffset\":" << 3 * sizeof(float) + 4 * frame << ",\"componentType\":5121,\"normalized\":true,\"count\":" << rkNode.vertexCount << ",\"type\":\"VEC4\"}";
+				}
+			}
+			json << "]";
+
+			json << ",\"bufferViews\":[";
+			for (std::size_t i = 0; i < m_nodes.size(); ++i)
+			{
+				const Node& rkNode = m_nodes[i];
+				json << (i == 0 ? "" : ",") << "{\"buffer\":0,\"byteOffset\":" << rkNode.byteOffset << ",\"byteLength\":" << rkNode.vertexCount * stride << ",\"byteStride\":" << stride << ",\"target\":34962}";
+			}
+			json << "]";
+			json << ",\"buffers\":[{\"byteLength\":" << m_temporarySize << "}]";
+		}
+		json << ",\"extras\":{\"frames\":" << m_frameCount << "}}";
+
+		std::string jsonString = json.str();
+		while (jsonString.size() % 4 != 0)
+		{
+			jsonString += ' ';
+		}
+		std::uint64_t binLength = (m_temporarySize + 3) / 4 * 4;
+		bool hasBin = m_temporarySize > 0;
+		std::uint64_t totalLength = 12 + 8 + jsonString.size() + (hasBin ? 8 + binLength : 0);
+		if (totalLength > std::numeric_limits<std::uint32_t>::max())
+		{
+			throw std::runtime_error("The mesh is larger than the 4 GB supported by a GLB file.");
+		}
+
+		WriteUInt32(pFile, 0x46546C67); // "glTF"
+		WriteUInt32(pFile, 2);
+		WriteUInt32(pFile, (std::uint32_t)totalLength);
+
+		WriteUInt32(pFile, (std::uint32_t)jsonString.size());
+		WriteUInt32(pFile, 0x4E4F534A); // "JSON"
+		WriteFully(pFile, jsonString.data(), jsonString.size());
+
+		if (hasBin)
+		{
+			WriteUInt32(pFile, (std::uint32_t)binLength);
+			WriteUInt32(pFile, 0x004E4942); // "BIN\0"
+			CopyTemporary(pFile);
+			const unsigned char padding[3] = { 0, 0, 0 };
+			WriteFully(pFile, padding, (std::size_t)(binLength - m_temporarySize));
+		}
+	}
+
+	std::unique_ptr<ColoredMeshWriter> CreateColoredMeshWriter(const std::string& rkPath, std::size_t frameCount)
+	{
+		std::string extension;
+		std::size_t dot = rkPath.find_last_of('.');
+		if (dot != std::string::npos)
+		{
+			extension = rkPath.substr(dot + 1);
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+		}
+
+		if (extension == "ply")
+		{
+			return std::unique_ptr<ColoredMeshWriter>(new PlyMeshWriter(rkPath, frameCount));
+		}
+		if (extension == "glb")
+		{
+			return std::unique_ptr<ColoredMeshWriter>(new GlbMeshWriter(rkPath, frameCount));
+		}
+		throw std::runtime_error("The mesh file must have a .ply or .glb extension.");
+	}
+}
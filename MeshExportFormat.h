@@ -0,0 +1,106 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	// Streams a triangulated, per-vertex colored mesh to disk. Triangles are appended to a temporary
+	// file as they arrive, so only the per-node bookkeeping stays in memory; Finish() writes the header
+	// and copies the vertex data into the final file. Every triangle carries one RGBA color per frame.
+	class ColoredMeshWriter
+	{
+	public:
+		virtual ~ColoredMeshWriter();
+
+		// Starts a new node; all following triangles belong to it.
+		void BeginNode(const std::string& rkName);
+
+		// pkPositions holds 9 coordinates (3 vertices), pkColors holds frameCount RGBA colors.
+		void AddTriangle(const double* pkPositions, const unsigned char* pkColors);
+
+		void Finish();
+
+		std::size_t FrameCount() const { return m_frameCount; }
+
+	protected:
+		struct Node
+		{
+			std::string name;
+			std::uint64_t firstVertex;
+			std::uint64_t vertexCount;
+			std::uint64_t byteOffset;
+			float minPosition[3];
+			float maxPosition[3];
+		};
+
+		ColoredMeshWriter(const std::string& rkPath, std::size_t frameCount);
+
+		// Vertices are stored interleaved as 3 floats followed by frameCount RGBA colors.
+		std::size_t VertexSize() const { return 3 * sizeof(float) + 4 * m_frameCount; }
+
+		virtual void WriteFile(FILE* pFile) = 0;
+
+		void WriteTemporary(const void* pkData, std::size_t size);
+		void CopyTemporary(FILE* pFile);
+
+		ColoredMeshWriter(const ColoredMeshWriter&);
+		ColoredMeshWriter& operator=(const ColoredMeshWriter&);
+
+		std::string m_path;
+		std::string m_temporaryPath;
+		FILE* m_pTemporaryFile;
+		std::size_t m_frameCount;
+		std::uint64_t m_temporarySize;
+		std::vector<Node> m_nodes;
+		bool m_isFinished;
+	};
+
+	// Binary little-endian PLY. Frame 0 is stored as red/green/blue/alpha, later frames as red_N/green_N/...;
+	// every face has a node property, and the node names are listed in the header comments.
+	class PlyMeshWriter : public ColoredMeshWriter
+	{
+	public:
+		PlyMeshWriter(const std::string& rkPath, std::size_t frameCount);
+
+	protected:
+		virtual void WriteFile(FILE* pFile);
+	};
+
+	// Binary glTF 2.0 (GLB). Each node has its own mesh with interleaved vertices; frame 0 is COLOR_0
+	// and later frames are the custom attributes _COLOR_N. A root node converts Z-up to glTF's Y-up.
+	class GlbMeshWriter : public ColoredMeshWriter
+	{
+	public:
+		// glTF limits the vertex stride to 252 bytes: 12 bytes of position plus 4 bytes per frame.
+		static const std::size_t MaxFrameCount = 60;
+
+		GlbMeshWriter(const std::string& rkPath, std::size_t frameCount);
+
+	protected:
+		virtual void WriteFile(FILE* pFile);
+	};
+
+	// Chooses the writer from the file extension (.ply or .glb).
+	std::unique_ptr<ColoredMeshWriter> CreateColoredMeshWriter(const std::string& rkPath, std::size_t frameCount);
+}
@@ -0,0 +1,166 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "MeshExporter.h"
+#include "ColorMap.h"
+#include "EnergyModel.h"
+#include "NativeInterop.h"
+#include "SimulationResult.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace TopologicEnergy
+{
+	bool MeshExporter::Export(EnergyModel^ energyModel, SimulationResult^ simulationResult, String^ filePath, Nullable<double> minDomain, Nullable<double> maxDomain, String^ colorMapName)
+	{
+		List<SimulationResult^>^ simulationResults = gcnew List<SimulationResult^>();
+		simulationResults->Add(simulationResult);
+		return ExportFrames(energyModel, simulationResults, filePath, minDomain, maxDomain, colorMapName);
+	}
+
+	bool MeshExporter::ExportFrames(EnergyModel^ energyModel, IList<SimulationResult^>^ simulationResults, String^ filePath, Nullable<double> minDomain, Nullable<double> maxDomain, String^ colorMapName)
+	{
+		if (energyModel == nullptr || simulationResults == nullptr || filePath == nullptr)
+		{
+			throw gcnew Exception("The input energyModel, simulationResults and filePath must not be null.");
+		}
+
+		if (simulationResults->Count == 0)
+		{
+			throw gcnew Exception("At least one simulation result is needed.");
+		}
+
+		IList<Cell^>^ cells = energyModel->Topology;
+		int cellCount = cells->Count;
+		int frameCount = simulationResults->Count;
+
+		// 1. The domain is shared by all frames so that the colors are comparable over time.
+		double finalMinDomain = Double::MaxValue;
+		double finalMaxDomain = -Double::MaxValue;
+		for each(SimulationResult^ simulationResult in simulationResults)
+		{
+			if (simulationResult == nullptr)
+			{
+				throw gcnew Exception("The input simulationResults must not contain a null result.");
+			}
+			if (simulationResult->Values->Count != cellCount)
+			{
+				throw gcnew Exception("The number of values does not match the number of cells.");
+			}
+			IList<double>^ domain = simulationResult->Domain;
+			if (domain != nullptr)
+			{
+				finalMinDomain = Math::Min(finalMinDomain, domain[0]);
+				finalMaxDomain = Math::Max(finalMaxDomain, domain[1]);
+			}
+		}
+		finalMinDomain = minDomain.HasValue ? minDomain.Value : finalMinDomain;
+		finalMaxDomain = maxDomain.HasValue ? maxDomain.Value : finalMaxDomain;
+		if (!(finalMaxDomain - finalMinDomain >= 0.00001))
+		{
+			throw gcnew Exception("The domain is too small. Please increase it.");
+		}
+
+		// 2. Colors, cell-major so that each cell passes one contiguous block of frameCount RGBA colors to the writer
+		const TopologicEnergyCore::ColorMap& rkColorMap = ColorMap::ByName(colorMapName);
+		std::vector<unsigned char> frameColors((std::size_t)cellCount * 4);
+		std::vector<unsigned char> cellColors((std::size_t)cellCount * frameCount * 4);
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			IList<double>^ values = simulationResults[frame]->Values;
+			array<double>^ valueArray = gcnew array<double>(cellCount);
+			values->CopyTo(valueArray, 0);
+			if (cellCount > 0)
+			{
+				pin_ptr<double> pValues = &valueArray[0];
+				rkColorMap.Apply(pValues, cellCount, finalMinDomain, finalMaxDomain, frameColors.data(), true);
+			}
+			for (int i = 0; i < cellCount; ++i)
+			{
+				memcpy(&cellColors[((std::size_t)i * frameCount + frame) * 4], &frameColors[(std::size_t)i * 4], 4);
+			}
+		}
+		std::vector<unsigned char> apertureColors((std::size_t)frameCount * 4, 128);
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			apertureColors[frame * 4 + 3] = 255;
+		}
+
+		// 3. Stream the triangles: the cells first, then the apertures in their own node
+		try {
+			std::unique_ptr<TopologicEnergyCore::ColoredMeshWriter> pWriter =
+				TopologicEnergyCore::CreateColoredMeshWriter(ToNativeString(filePath), frameCount);
+
+			pWriter->BeginNode("Cells");
+			for (int i = 0; i < cellCount; ++i)
+			{
+				for each(Face^ face in cells[i]->Faces)
+				{
+					AddFace(*pWriter, face, &cellColors[(std::size_t)i * frameCount * 4]);
+				}
+			}
+
+			pWriter->BeginNode("Apertures");
+			for each(Cell^ cell in cells)
+			{
+				for each(Topologic::Topology^ subcontent in cell->SubContents)
+				{
+					Face^ apertureFace = dynamic_cast<Face^>(subcontent);
+					Aperture^ aperture = dynamic_cast<Aperture^>(subcontent);
+					if (aperture != nullptr)
+					{
+						apertureFace = dynamic_cast<Face^>(aperture->Topology);
+					}
+					if (apertureFace != nullptr)
+					{
+						AddFace(*pWriter, apertureFace, apertureColors.data());
+					}
+				}
+			}
+
+			pWriter->Finish();
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+
+		return true;
+	}
+
+	void MeshExporter::AddFace(TopologicEnergyCore::ColoredMeshWriter& rWriter, Face^ face, const unsigned char* pkColors)
+	{
+		IList<Face^>^ triangles = (IList<Face^>^) Topologic::Utilities::FaceUtility::Triangulate(face, 0.01);
+		for each(Face^ triangle in triangles)
+		{
+			IList<Vertex^>^ vertices = triangle->Vertices;
+			if (vertices->Count != 3)
+			{
+				continue;
+			}
+
+			double positions[9];
+			for (int i = 0; i < 3; ++i)
+			{
+				positions[i * 3] = vertices[i]->X;
+				positions[i * 3 + 1] = vertices[i]->Y;
+				positions[i * 3 + 2] = vertices[i]->Z;
+			}
+			rWriter.AddTriangle(positions, pkColors);
+		}
+	}
+}
@@ -0,0 +1,78 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "MeshExportFormat.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace Topologic;
+
+namespace TopologicEnergy
+{
+	ref class EnergyModel;
+	ref class SimulationResult;
+
+	/// <summary>
+	/// Exports an energy model colored by simulation results as a binary glTF (.glb) or PLY (.ply) mesh for web viewers.
+	/// </summary>
+	public ref class MeshExporter abstract sealed
+	{
+	public:
+		/// <summary>
+		/// Exports the triangulated cells of an energy model, colored by a simulation result, and its apertures as a separate grey node.
+		/// The format is chosen from the file extension (.glb or .ply).
+		/// </summary>
+		/// <param name="energyModel">The energy model</param>
+		/// <param name="simulationResult">The simulation result, one value per cell</param>
+		/// <param name="filePath">The path of the .glb or .ply file</param>
+		/// <param name="minDomain">The value mapped to the first color. Defaults to the minimum value.</param>
+		/// <param name="maxDomain">The value mapped to the last color. Defaults to the maximum value.</param>
+		/// <param name="colorMapName">The name of the colormap</param>
+		/// <returns name="bool">True if the mesh has been successfully exported</returns>
+		static bool Export(
+			EnergyModel^ energyModel,
+			SimulationResult^ simulationResult,
+			String^ filePath,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> minDomain,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> maxDomain,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("\"Default\"")] String^ colorMapName);
+
+		/// <summary>
+		/// Exports the triangulated cells of an energy model with one color attribute per simulation result, e.g. one per time step.
+		/// In glTF, the first frame is COLOR_0 and the next ones are _COLOR_1, _COLOR_2, etc. (at most 60 frames);
+		/// in PLY, they are red/green/blue/alpha, red_1/green_1/blue_1/alpha_1, etc. All frames share one domain.
+		/// </summary>
+		/// <param name="energyModel">The energy model</param>
+		/// <param name="simulationResults">The simulation results, one per frame</param>
+		/// <param name="filePath">The path of the .glb or .ply file</param>
+		/// <param name="minDomain">The value mapped to the first color. Defaults to the minimum value of all frames.</param>
+		/// <param name="maxDomain">The value mapped to the last color. Defaults to the maximum value of all frames.</param>
+		/// <param name="colorMapName">The name of the colormap</param>
+		/// <returns name="bool">True if the mesh has been successfully exported</returns>
+		static bool ExportFrames(
+			EnergyModel^ energyModel,
+			IList<SimulationResult^>^ simulationResults,
+			String^ filePath,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> minDomain,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> maxDomain,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("\"Default\"")] String^ colorMapName);
+
+	private:
+		static void AddFace(TopologicEnergyCore::ColoredMeshWriter& rWriter, Face^ face, const unsigned char* pkColors);
+	};
+}
@@ -0,0 +1,230 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "MetricsSnapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <fstream>
+#include <sys/resource.h>
+#endif
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		const char MetricPrefix[] = "topologic_energy_";
+
+		std::int64_t SteadyNanoseconds()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		std::string EscapeLabelValue(const std::string& rkValue)
+		{
+			std::string escaped;
+			for (char character : rkValue)
+			{
+				if (character == '\\' || character == '"')
+				{
+					escaped += '\\';
+					escaped += character;
+				}
+				else if (character == '\n')
+				{
+					escaped += "\\n";
+				}
+				else
+				{
+					escaped += character;
+				}
+			}
+			return escaped;
+		}
+
+		// The exposition format spells the special values NaN, +Inf and -Inf.
+		std::string FormatValue(double value)
+		{
+			if (std::isnan(value))
+			{
+				return "NaN";
+			}
+			if (std::isinf(value))
+			{
+				return value > 0.0 ? "+Inf" : "-Inf";
+			}
+
+			char text[32];
+			snprintf(text, sizeof(text), "%.17g", value);
+			return text;
+		}
+	}
+
+	ProcessMemory CurrentProcessMemory()
+	{
+		ProcessMemory memory = { 0, 0, 0 };
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS_EX counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters)))
+		{
+			memory.workingSet = counters.WorkingSetSize;
+			memory.peakWorkingSet = counters.PeakWorkingSetSize;
+			memory.privateBytes = counters.PrivateUsage;
+		}
+#else
+		// Linux reports the figures in kB
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			unsigned long long kilobytes = 0;
+			if (sscanf(line.c_str(), "VmRSS: %llu", &kilobytes) == 1)
+			{
+				memory.workingSet = kilobytes * 1024;
+			}
+			else if (sscanf(line.c_str(), "VmHWM: %llu", &kilobytes) == 1)
+			{
+				memory.peakWorkingSet = kilobytes * 1024;
+			}
+			else if (sscanf(line.c_str(), "RssAnon: %llu", &kilobytes) == 1)
+			{
+				memory.privateBytes = kilobytes * 1024;
+			}
+		}
+
+		if (memory.peakWorkingSet == 0)
+		{
+			struct rusage usage;
+			if (getrusage(RUSAGE_SELF, &usage) == 0)
+			{
+#ifdef __APPLE__
+				memory.peakWorkingSet = (std::uint64_t)usage.ru_maxrss;
+#else
+				memory.peakWorkingSet = (std::uint64_t)usage.ru_maxrss * 1024;
+#endif
+			}
+		}
+#endif
+		return memory;
+	}
+
+	StageMeter::StageMeter()
+		: m_start(0)
+	{
+		m_memory.workingSet = 0;
+		m_memory.peakWorkingSet = 0;
+		m_memory.privateBytes = 0;
+	}
+
+	void StageMeter::Begin()
+	{
+		m_memory = CurrentProcessMemory();
+		m_start = SteadyNanoseconds();
+	}
+
+	StageMetrics StageMeter::End(const std::string& rkName, std::int64_t allocatedBytes) const
+	{
+		std::int64_t end = SteadyNanoseconds();
+		ProcessMemory memory = CurrentProcessMemory();
+
+		StageMetrics stage;
+		stage.name = rkName;
+		stage.seconds = (end - m_start) * 1e-9;
+		stage.allocatedBytes = allocatedBytes;
+		stage.privateBytesDelta = (std::int64_t)memory.privateBytes - (std::int64_t)m_memory.privateBytes;
+		stage.peakWorkingSet = memory.peakWorkingSet > m_memory.peakWorkingSet ?
+			memory.peakWorkingSet :
+			std::max(memory.workingSet, m_memory.workingSet);
+		return stage;
+	}
+
+	void MetricsSnapshot::Add(const std::string& rkName, const std::string& rkHelp, double value,
+		const std::vector<std::pair<std::string, std::string>>& rkLabels)
+	{
+		MetricSample sample;
+		sample.name = MetricPrefix + rkName;
+		sample.help = rkHelp;
+		sample.labels = rkLabels;
+		sample.value = value;
+		m_samples.push_back(sample);
+	}
+
+	void MetricsSnapshot::AddStage(const StageMetrics& rkStage)
+	{
+		std::vector<std::pair<std::string, std::string>> labels(1, std::make_pair(std::string("stage"), rkStage.name));
+		Add("stage_seconds", "Duration of the pipeline stage.", rkStage.seconds, labels);
+		if (rkStage.allocatedBytes >= 0)
+		{
+			Add("stage_allocated_bytes", "Managed memory allocated in the AppDomain by all threads during the pipeline stage, including other pipelines running meanwhile.", (double)rkStage.allocatedBytes, labels);
+		}
+		Add("stage_private_bytes_delta", "Change of the process private memory over the pipeline stage.", (double)rkStage.privateBytesDelta, labels);
+		Add("stage_peak_working_set_bytes", "Peak working set of the process during the pipeline stage.", (double)rkStage.peakWorkingSet, labels);
+	}
+
+	std::string MetricsSnapshot::ToPrometheusText() const
+	{
+		std::vector<std::string> names;
+		for (const MetricSample& rkSample : m_samples)
+		{
+			if (std::find(names.begin(), names.end(), rkSample.name) == names.end())
+			{
+				names.push_back(rkSample.name);
+			}
+		}
+
+		std::ostringstream text;
+		for (const std::string& rkName : names)
+		{
+			bool isFirst = true;
+			for (const MetricSample& rkSample : m_samples)
+			{
+				if (rkSample.name != rkName)
+				{
+					continue;
+				}
+				if (isFirst)
+				{
+					text << "# HELP " << rkName << " " << rkSample.help << "\n";
+					text << "# TYPE " << rkName << " gauge\n";
+					isFirst = false;
+				}
+
+				text << rkName;
+				if (!rkSample.labels.empty())
+				{
+					text << "{";
+					for (std::size_t i = 0; i < rkSample.labels.size(); ++i)
+					{
+						text << (i == 0 ? "" : ",") << rkSample.labels[i].first << "=\"" << EscapeLabelValue(rkSample.labels[i].second) << "\"";
+					}
+					text << "}";
+				}
+				text << " " << FormatValue(rkSample.value) << "\n";
+			}
+		}
+		return text.str();
+	}
+}
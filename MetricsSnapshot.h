@@ -0,0 +1,90 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Counts and memory figures that explain the cost of a run, collected into a snapshot and written in the
+// Prometheus text exposition format.
+namespace TopologicEnergyCore
+{
+	// Bytes; 0 where the platform does not report the figure
+	struct ProcessMemory
+	{
+		std::uint64_t workingSet;
+		std::uint64_t peakWorkingSet;
+		std::uint64_t privateBytes;		// committed private memory on Windows, anonymous resident memory on Linux
+	};
+
+	ProcessMemory CurrentProcessMemory();
+
+	struct StageMetrics
+	{
+		std::string name;
+		double seconds;
+		std::int64_t allocatedBytes;		// allocated on the managed heap by the AppDomain during the stage, or -1 if not measured
+		std::int64_t privateBytesDelta;
+		std::uint64_t peakWorkingSet;
+	};
+
+	// Measures the time and memory of one stage. The process peak working set cannot be reset, so the
+	// stage peak is exact when the stage raised the peak, and otherwise the larger of the working sets
+	// at its start and end.
+	class StageMeter
+	{
+	public:
+		StageMeter();
+
+		void Begin();
+		StageMetrics End(const std::string& rkName, std::int64_t allocatedBytes = -1) const;
+
+	private:
+		std::int64_t m_start;
+		ProcessMemory m_memory;
+	};
+
+	struct MetricSample
+	{
+		std::string name;
+		std::string help;
+		std::vector<std::pair<std::string, std::string>> labels;
+		double value;
+	};
+
+	class MetricsSnapshot
+	{
+	public:
+		// name is prefixed with topologic_energy_; samples of the same name share the help text of the first.
+		void Add(const std::string& rkName, const std::string& rkHelp, double value,
+			const std::vector<std::pair<std::string, std::string>>& rkLabels = std::vector<std::pair<std::string, std::string>>());
+
+		// Adds the duration, allocations, private bytes and peak working set of the stage, labelled stage="name".
+		void AddStage(const StageMetrics& rkStage);
+
+		const std::vector<MetricSample>& Samples() const { return m_samples; }
+
+		// One HELP and TYPE line per metric name, in the order the names were first added
+		std::string ToPrometheusText() const;
+
+	private:
+		std::vector<MetricSample> m_samples;
+	};
+}
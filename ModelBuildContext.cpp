@@ -0,0 +1,83 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ModelBuildContext.h"
+#include "PipelineMetrics.h"
+
+namespace TopologicEnergy
+{
+	ModelBuildContext::ModelBuildContext(OpenStudio::Model^ osModel, OpenStudio::DefaultConstructionSet^ osDefaultConstructionSet, OpenStudio::DefaultScheduleSet^ osDefaultScheduleSet, PipelineMetrics^ metrics)
+		: m_osModel(osModel)
+		, m_osDefaultConstructionSet(osDefaultConstructionSet)
+		, m_osDefaultScheduleSet(osDefaultScheduleSet)
+		, m_osBuildingStories(gcnew List<OpenStudio::BuildingStory^>())
+		, m_apertureCount(0)
+		, m_appliedApertureCount(0)
+		, m_metrics(metrics)
+	{
+
+	}
+
+	OpenStudio::Model^ ModelBuildContext::Model::get()
+	{
+		return m_osModel;
+	}
+
+	OpenStudio::DefaultConstructionSet^ ModelBuildContext::DefaultConstructionSet::get()
+	{
+		return m_osDefaultConstructionSet;
+	}
+
+	OpenStudio::DefaultScheduleSet^ ModelBuildContext::DefaultScheduleSet::get()
+	{
+		return m_osDefaultScheduleSet;
+	}
+
+	IList<OpenStudio::BuildingStory^>^ ModelBuildContext::BuildingStories::get()
+	{
+		return m_osBuildingStories;
+	}
+
+	void ModelBuildContext::BuildingStories::set(IList<OpenStudio::BuildingStory^>^ value)
+	{
+		m_osBuildingStories = value;
+	}
+
+	int ModelBuildContext::ApertureCount::get()
+	{
+		return m_apertureCount;
+	}
+
+	int ModelBuildContext::AppliedApertureCount::get()
+	{
+		return m_appliedApertureCount;
+	}
+
+	void ModelBuildContext::AddAperture()
+	{
+		++m_apertureCount;
+	}
+
+	void ModelBuildContext::AddAppliedAperture()
+	{
+		++m_appliedApertureCount;
+	}
+
+	PipelineMetrics^ ModelBuildContext::Metrics::get()
+	{
+		return m_metrics;
+	}
+}
@@ -0,0 +1,86 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	ref class PipelineMetrics;
+
+	// The state shared by the steps of one ByCellComplex call: the default sets looked up once in the
+	// template model, the building stories, the aperture counts and the pipeline metrics. It used to live in static fields of
+	// EnergyModel, which prevented building two models at the same time in one process; each build now
+	// owns its context, so builds on separate threads do not share any mutable state.
+	ref class ModelBuildContext
+	{
+	public:
+		ModelBuildContext(OpenStudio::Model^ osModel, OpenStudio::DefaultConstructionSet^ osDefaultConstructionSet, OpenStudio::DefaultScheduleSet^ osDefaultScheduleSet, PipelineMetrics^ metrics);
+
+		property OpenStudio::Model^ Model
+		{
+			OpenStudio::Model^ get();
+		}
+
+		property OpenStudio::DefaultConstructionSet^ DefaultConstructionSet
+		{
+			OpenStudio::DefaultConstructionSet^ get();
+		}
+
+		property OpenStudio::DefaultScheduleSet^ DefaultScheduleSet
+		{
+			OpenStudio::DefaultScheduleSet^ get();
+		}
+
+		// Set by ComputeBuilding, read by AddSpace
+		property IList<OpenStudio::BuildingStory^>^ BuildingStories
+		{
+			IList<OpenStudio::BuildingStory^>^ get();
+			void set(IList<OpenStudio::BuildingStory^>^ value);
+		}
+
+		// The number of apertures read from the cells, and the number of those that became subsurfaces
+		property int ApertureCount
+		{
+			int get();
+		}
+
+		property int AppliedApertureCount
+		{
+			int get();
+		}
+
+		void AddAperture();
+		void AddAppliedAperture();
+
+		// The counts and stages of this build
+		property PipelineMetrics^ Metrics
+		{
+			PipelineMetrics^ get();
+		}
+
+	private:
+		OpenStudio::Model^ m_osModel;
+		OpenStudio::DefaultConstructionSet^ m_osDefaultConstructionSet;
+		OpenStudio::DefaultScheduleSet^ m_osDefaultScheduleSet;
+		IList<OpenStudio::BuildingStory^>^ m_osBuildingStories;
+		int m_apertureCount;
+		int m_appliedApertureCount;
+		PipelineMetrics^ m_metrics;
+	};
+}
@@ -0,0 +1,116 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ModelOverrides.h"
+
+namespace TopologicEnergy
+{
+	ModelOverrides^ ModelOverrides::ByParameters(Nullable<double> heatingTemp, Nullable<double> coolingTemp, Nullable<double> glazingRatio)
+	{
+		if (heatingTemp.HasValue && coolingTemp.HasValue && heatingTemp.Value > coolingTemp.Value)
+		{
+			throw gcnew Exception("The heating temperature must not be greater than the cooling temperature.");
+		}
+
+		if (glazingRatio.HasValue && (glazingRatio.Value <= 0.0 || glazingRatio.Value >= 1.0))
+		{
+			throw gcnew Exception("The glazing ratio must be between 0 and 1 exclusive.");
+		}
+
+		return gcnew ModelOverrides(heatingTemp, coolingTemp, glazingRatio);
+	}
+
+	Nullable<double> ModelOverrides::HeatingTemp::get()
+	{
+		return m_heatingTemp;
+	}
+
+	Nullable<double> ModelOverrides::CoolingTemp::get()
+	{
+		return m_coolingTemp;
+	}
+
+	Nullable<double> ModelOverrides::GlazingRatio::get()
+	{
+		return m_glazingRatio;
+	}
+
+	void ModelOverrides::Apply(OpenStudio::Model^ osModel)
+	{
+		// The thermostats share one pair of schedules, so a setpoint change is a new shared schedule.
+		if (m_heatingTemp.HasValue || m_coolingTemp.HasValue)
+		{
+			OpenStudio::ScheduleConstant^ osHeatingSchedule = nullptr;
+			if (m_heatingTemp.HasValue)
+			{
+				osHeatingSchedule = gcnew OpenStudio::ScheduleConstant(osModel);
+				osHeatingSchedule->setValue(m_heatingTemp.Value);
+			}
+
+			OpenStudio::ScheduleConstant^ osCoolingSchedule = nullptr;
+			if (m_coolingTemp.HasValue)
+			{
+				osCoolingSchedule = gcnew OpenStudio::ScheduleConstant(osModel);
+				osCoolingSchedule->setValue(m_coolingTemp.Value);
+			}
+
+			OpenStudio::ThermostatSetpointDualSetpointVector::ThermostatSetpointDualSetpointVectorEnumerator^ osThermostatEnumerator =
+				osModel->getThermostatSetpointDualSetpoints()->GetEnumerator();
+			while (osThermostatEnumerator->MoveNext())
+			{
+				OpenStudio::ThermostatSetpointDualSetpoint^ osThermostat = osThermostatEnumerator->Current;
+				if (osHeatingSchedule != nullptr)
+				{
+					osThermostat->setHeatingSetpointTemperatureSchedule(osHeatingSchedule);
+				}
+				if (osCoolingSchedule != nullptr)
+				{
+					osThermostat->setCoolingSetpointTemperatureSchedule(osCoolingSchedule);
+				}
+			}
+		}
+
+		// OpenStudio replaces the subsurfaces of each exterior wall by one window of the requested ratio.
+		if (m_glazingRatio.HasValue)
+		{
+			OpenStudio::SurfaceVector::SurfaceVectorEnumerator^ osSurfaceEnumerator = osModel->getSurfaces()->GetEnumerator();
+			while (osSurfaceEnumerator->MoveNext())
+			{
+				OpenStudio::Surface^ osSurface = osSurfaceEnumerator->Current;
+				if (osSurface->surfaceType() != "Wall" || osSurface->outsideBoundaryCondition() != "Outdoors")
+				{
+					continue;
+				}
+
+				OpenStudio::OptionalSubSurface^ osWindow = osSurface->setWindowToWallRatio(m_glazingRatio.Value);
+				if (osWindow->is_initialized())
+				{
+					osWindow->get()->setName(osSurface->name()->get() + "_SUBSURFACE_1");
+				}
+			}
+		}
+
+		osModel->purgeUnusedResourceObjects();
+	}
+
+	ModelOverrides::ModelOverrides(Nullable<double> heatingTemp, Nullable<double> coolingTemp, Nullable<double> glazingRatio)
+		: m_heatingTemp(heatingTemp)
+		, m_coolingTemp(coolingTemp)
+		, m_glazingRatio(glazingRatio)
+	{
+
+	}
+}
@@ -0,0 +1,77 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// The changes a variant of an EnergyModel makes to its parent, e.g. in a parametric study.
+	/// </summary>
+	public ref class ModelOverrides
+	{
+	public:
+		/// <summary>
+		/// Creates a set of overrides. The inputs left null keep the value of the parent model.
+		/// </summary>
+		/// <param name="heatingTemp">The heating setpoint temperature of every thermal zone</param>
+		/// <param name="coolingTemp">The cooling setpoint temperature of every thermal zone</param>
+		/// <param name="glazingRatio">The window-to-wall ratio of every exterior wall</param>
+		/// <returns name="ModelOverrides">The overrides</returns>
+		static ModelOverrides^ ByParameters(
+			[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> heatingTemp,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> coolingTemp,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("null")] Nullable<double> glazingRatio);
+
+		/// <summary>
+		/// Returns the heating setpoint temperature, or null if it is not overridden.
+		/// </summary>
+		property Nullable<double> HeatingTemp
+		{
+			Nullable<double> get();
+		}
+
+		/// <summary>
+		/// Returns the cooling setpoint temperature, or null if it is not overridden.
+		/// </summary>
+		property Nullable<double> CoolingTemp
+		{
+			Nullable<double> get();
+		}
+
+		/// <summary>
+		/// Returns the window-to-wall ratio, or null if it is not overridden.
+		/// </summary>
+		property Nullable<double> GlazingRatio
+		{
+			Nullable<double> get();
+		}
+
+	internal:
+		// Applies the overrides to a copy of the parent model.
+		void Apply(OpenStudio::Model^ osModel);
+
+	private:
+		ModelOverrides(Nullable<double> heatingTemp, Nullable<double> coolingTemp, Nullable<double> glazingRatio);
+
+		Nullable<double> m_heatingTemp;
+		Nullable<double> m_coolingTemp;
+		Nullable<double> m_glazingRatio;
+	};
+}
@@ -0,0 +1,193 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ModelSnapshotFormat.h"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	ModelSnapshotWriter::ModelSnapshotWriter(const std::string& rkPath)
+		: m_pFile(nullptr)
+		, m_position(0)
+		, m_isFinished(false)
+	{
+#ifdef _WIN32
+		fopen_s(&m_pFile, rkPath.c_str(), "wb");
+#else
+		m_pFile = fopen(rkPath.c_str(), "wb");
+#endif
+		if (m_pFile == nullptr)
+		{
+			throw std::runtime_error("Fails to create the model snapshot " + rkPath + ".");
+		}
+
+		// Placeholder, rewritten by Finish()
+		SnapshotHeader header;
+		memset(&header, 0, sizeof(SnapshotHeader));
+		Write(&header, sizeof(SnapshotHeader));
+	}
+
+	ModelSnapshotWriter::~ModelSnapshotWriter()
+	{
+		if (m_pFile != nullptr)
+		{
+			fclose(m_pFile);
+		}
+	}
+
+	void ModelSnapshotWriter::AddSection(SnapshotSection section, const std::vector<std::string>& rkStrings)
+	{
+		if (m_isFinished)
+		{
+			throw std::runtime_error("The model snapshot is already finished.");
+		}
+
+		std::vector<SnapshotStringEntry> entries;
+		entries.reserve(rkStrings.size());
+		for (const std::string& rkString : rkStrings)
+		{
+			SnapshotStringEntry entry;
+			entry.offset = m_position;
+			entry.length = rkString.size();
+			entries.push_back(entry);
+			Write(rkString.data(), rkString.size());
+		}
+		Align();
+
+		SnapshotSectionEntry sectionEntry;
+		sectionEntry.id = (std::uint32_t)section;
+		sectionEntry.reserved = 0;
+		sectionEntry.stringCount = rkStrings.size();
+		sectionEntry.stringTableOffset = m_position;
+		Write(entries.data(), entries.size() * sizeof(SnapshotStringEntry));
+		m_sections.push_back(sectionEntry);
+	}
+
+	void ModelSnapshotWriter::Finish()
+	{
+		if (m_isFinished)
+		{
+			return;
+		}
+
+		SnapshotHeader header;
+		memset(&header, 0, sizeof(SnapshotHeader));
+		memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+		header.version = SnapshotVersion;
+		header.sectionCount = (std::uint32_t)m_sections.size();
+		header.sectionTableOffset = m_position;
+		Write(m_sections.data(), m_sections.size() * sizeof(SnapshotSectionEntry));
+		header.fileSize = m_position;
+
+		if (fseek(m_pFile, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(SnapshotHeader), 1, m_pFile) != 1)
+		{
+			throw std::runtime_error("Fails to write the model snapshot header.");
+		}
+		fclose(m_pFile);
+		m_pFile = nullptr;
+		m_isFinished = true;
+	}
+
+	void ModelSnapshotWriter::Write(const void* pkData, std::uint64_t size)
+	{
+		if (size > 0 && fwrite(pkData, 1, (std::size_t)size, m_pFile) != size)
+		{
+			throw std::runtime_error("Fails to write to the model snapshot.");
+		}
+		m_position += size;
+	}
+
+	void ModelSnapshotWriter::Align()
+	{
+		static const unsigned char kPadding[8] = { 0 };
+		std::uint64_t remainder = m_position % 8;
+		if (remainder != 0)
+		{
+			Write(kPadding, 8 - remainder);
+		}
+	}
+
+	ModelSnapshotReader::ModelSnapshotReader(const std::string& rkPath)
+		: m_pFile(nullptr)
+		, m_pkHeader(nullptr)
+		, m_pkSections(nullptr)
+	{
+		// Owned here until the header and the section table are validated, so that a throw does not leak it
+		std::unique_ptr<MappedFile> pFile(new MappedFile(rkPath, sizeof(SnapshotHeader)));
+		m_pkHeader = (const SnapshotHeader*)pFile->Data();
+		if (memcmp(m_pkHeader->magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0 ||
+			m_pkHeader->version != SnapshotVersion ||
+			m_pkHeader->fileSize != pFile->Size())
+		{
+			throw std::runtime_error("The file " + rkPath + " is not a valid model snapshot.");
+		}
+
+		m_pkSections = (const SnapshotSectionEntry*)pFile->At(m_pkHeader->sectionTableOffset, m_pkHeader->sectionCount * sizeof(SnapshotSectionEntry));
+		m_pFile = pFile.release();
+	}
+
+	ModelSnapshotReader::~ModelSnapshotReader()
+	{
+		delete m_pFile;
+	}
+
+	bool ModelSnapshotReader::HasSection(SnapshotSection section) const
+	{
+		return FindSection(section) != nullptr;
+	}
+
+	std::size_t ModelSnapshotReader::StringCount(SnapshotSection section) const
+	{
+		const SnapshotSectionEntry* pkSection = FindSection(section);
+		return pkSection == nullptr ? 0 : (std::size_t)pkSection->stringCount;
+	}
+
+	const char* ModelSnapshotReader::StringData(SnapshotSection section, std::size_t index, std::size_t& rLength) const
+	{
+		const SnapshotSectionEntry* pkSection = FindSection(section);
+		if (pkSection == nullptr || index >= pkSection->stringCount)
+		{
+			throw std::out_of_range("The snapshot string index is out of range.");
+		}
+
+		const SnapshotStringEntry* pkEntry = (const SnapshotStringEntry*)m_pFile->At(
+			pkSection->stringTableOffset + index * sizeof(SnapshotStringEntry), sizeof(SnapshotStringEntry));
+		rLength = (std::size_t)pkEntry->length;
+		return (const char*)m_pFile->At(pkEntry->offset, pkEntry->length);
+	}
+
+	std::string ModelSnapshotReader::String(SnapshotSection section, std::size_t index) const
+	{
+		std::size_t length = 0;
+		const char* pkData = StringData(section, index, length);
+		return std::string(pkData, length);
+	}
+
+	const SnapshotSectionEntry* ModelSnapshotReader::FindSection(SnapshotSection section) const
+	{
+		for (std::uint32_t i = 0; i < m_pkHeader->sectionCount; ++i)
+		{
+			if (m_pkSections[i].id == (std::uint32_t)section)
+			{
+				return &m_pkSections[i];
+			}
+		}
+		return nullptr;
+	}
+}
@@ -0,0 +1,124 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Native reader and writer for the TopologicEnergy model snapshot (*.tes).
+//
+// Layout (little-endian, every block 8-byte aligned):
+//   SnapshotHeader
+//   per section: the UTF-8 bytes of its strings, followed by sectionStringCount x SnapshotStringEntry
+//   section table: sectionCount x SnapshotSectionEntry
+//
+// A section is a list of strings, e.g. the BREP of every cell. Readers map the file and hand out
+// pointers into the mapping, so only the sections that are read are paged in.
+namespace TopologicEnergyCore
+{
+	const char SnapshotMagic[8] = { 'T', 'E', 'S', 'N', 'A', 'P', '\0', '\0' };
+	const std::uint32_t SnapshotVersion = 1;
+
+	enum SnapshotSection
+	{
+		SNAPSHOT_OSM = 1,			// the OpenStudio model, as OSM text
+		SNAPSHOT_CELLS = 2,			// the BREP of every building cell
+		SNAPSHOT_SPACE_NAMES = 3,	// the name of the space of every building cell
+		SNAPSHOT_SHADING = 4,		// the BREP of the shading surfaces cluster, if any
+		SNAPSHOT_APERTURES = 5,		// the BREP of every aperture face, as BREP does not carry contents
+		SNAPSHOT_APERTURE_HOSTS = 6	// "<cell index> <face index>" of the host face of every aperture
+	};
+
+	struct SnapshotHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t sectionCount;
+		std::uint64_t sectionTableOffset;
+		std::uint64_t fileSize;
+	};
+
+	struct SnapshotSectionEntry
+	{
+		std::uint32_t id;
+		std::uint32_t reserved;
+		std::uint64_t stringCount;
+		std::uint64_t stringTableOffset;
+	};
+
+	struct SnapshotStringEntry
+	{
+		std::uint64_t offset;
+		std::uint64_t length;
+	};
+
+	class ModelSnapshotWriter
+	{
+	public:
+		explicit ModelSnapshotWriter(const std::string& rkPath);
+		~ModelSnapshotWriter();
+
+		void AddSection(SnapshotSection section, const std::vector<std::string>& rkStrings);
+
+		// Writes the section table and the final header.
+		void Finish();
+
+	private:
+		void Write(const void* pkData, std::uint64_t size);
+		void Align();
+
+		ModelSnapshotWriter(const ModelSnapshotWriter&);
+		ModelSnapshotWriter& operator=(const ModelSnapshotWriter&);
+
+		FILE* m_pFile;
+		std::uint64_t m_position;
+		bool m_isFinished;
+		std::vector<SnapshotSectionEntry> m_sections;
+	};
+
+	class ModelSnapshotReader
+	{
+	public:
+		explicit ModelSnapshotReader(const std::string& rkPath);
+		~ModelSnapshotReader();
+
+		bool HasSection(SnapshotSection section) const;
+
+		// The number of strings in the section, 0 if the snapshot does not have it.
+		std::size_t StringCount(SnapshotSection section) const;
+
+		// Points directly into the mapped file; valid as long as the reader is alive. Not null-terminated.
+		const char* StringData(SnapshotSection section, std::size_t index, std::size_t& rLength) const;
+
+		std::string String(SnapshotSection section, std::size_t index) const;
+
+	private:
+		ModelSnapshotReader(const ModelSnapshotReader&);
+		ModelSnapshotReader& operator=(const ModelSnapshotReader&);
+
+		const SnapshotSectionEntry* FindSection(SnapshotSection section) const;
+
+		MappedFile* m_pFile;
+		const SnapshotHeader* m_pkHeader;
+		const SnapshotSectionEntry* m_pkSections;
+	};
+}
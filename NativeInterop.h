@@ -0,0 +1,57 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace TopologicEnergy
+{
+	// UTF-8 conversions used wherever a managed class hands strings to the native core.
+	inline std::string ToNativeString(System::String^ string)
+	{
+		if (System::String::IsNullOrEmpty(string))
+		{
+			return std::string();
+		}
+
+		array<unsigned char>^ bytes = System::Text::Encoding::UTF8->GetBytes(string);
+		pin_ptr<unsigned char> pBytes = &bytes[0];
+		return std::string((const char*)pBytes, bytes->Length);
+	}
+
+	inline System::String^ ToManagedString(const std::string& rkString)
+	{
+		if (rkString.empty())
+		{
+			return System::String::Empty;
+		}
+
+		return gcnew System::String((signed char*)rkString.data(), 0, (int)rkString.size(), System::Text::Encoding::UTF8);
+	}
+
+	// Decodes UTF-8 bytes in place, e.g. straight from a mapped file, without an intermediate std::string.
+	inline System::String^ ToManagedString(const char* pkData, std::size_t length)
+	{
+		if (length == 0)
+		{
+			return System::String::Empty;
+		}
+
+		return gcnew System::String((signed char*)pkData, 0, (int)length, System::Text::Encoding::UTF8);
+	}
+}
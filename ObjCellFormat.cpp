@@ -0,0 +1,128 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ObjCellFormat.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	CellBuffer ReadObjCells(const std::string& rkPath)
+	{
+		std::ifstream stream(rkPath.c_str());
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to open the OBJ file " + rkPath + ".");
+		}
+
+		CellBuffer cells;
+		std::vector<double> vertices;
+		std::vector<double> face;
+		bool hasOpenCell = false;
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			std::istringstream tokens(line);
+			std::string keyword;
+			tokens >> keyword;
+			if (keyword == "v")
+			{
+				double x = 0.0, y = 0.0, z = 0.0;
+				tokens >> x >> y >> z;
+				vertices.push_back(x);
+				vertices.push_back(y);
+				vertices.push_back(z);
+			}
+			else if (keyword == "o" || keyword == "g")
+			{
+				if (hasOpenCell)
+				{
+					cells.EndCell();
+					hasOpenCell = false;
+				}
+			}
+			else if (keyword == "f")
+			{
+				face.clear();
+				std::string token;
+				while (tokens >> token)
+				{
+					long index = std::strtol(token.c_str(), nullptr, 10);
+					long vertexCount = (long)(vertices.size() / 3);
+					long vertexIndex = index < 0 ? vertexCount + index : index - 1;
+					if (vertexIndex < 0 || vertexIndex >= vertexCount)
+					{
+						throw std::runtime_error("The OBJ file " + rkPath + " has a face with an invalid vertex index.");
+					}
+					face.insert(face.end(), vertices.begin() + vertexIndex * 3, vertices.begin() + vertexIndex * 3 + 3);
+				}
+				if (face.size() >= 9)
+				{
+					cells.AddFace(face.data(), face.size() / 3);
+					hasOpenCell = true;
+				}
+			}
+		}
+
+		if (hasOpenCell)
+		{
+			cells.EndCell();
+		}
+		return cells;
+	}
+
+	void WriteObjCells(const CellBuffer& rkCells, const std::string& rkPath)
+	{
+		std::ofstream stream(rkPath.c_str());
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to create the OBJ file " + rkPath + ".");
+		}
+		stream.precision(17);
+
+		std::size_t vertexOffset = 1;
+		for (std::size_t cellIndex = 0; cellIndex < rkCells.CellCount(); ++cellIndex)
+		{
+			stream << "o cell_" << cellIndex << "\n";
+			for (std::size_t i = 0; i < rkCells.FaceCount(cellIndex); ++i)
+			{
+				std::size_t faceId = rkCells.FaceId(cellIndex, i);
+				const double* pkCoordinates = rkCells.Coordinates(faceId);
+				std::size_t vertexCount = rkCells.VertexCount(faceId);
+				for (std::size_t j = 0; j < vertexCount; ++j)
+				{
+					stream << "v " << pkCoordinates[j * 3] << " " << pkCoordinates[j * 3 + 1] << " " << pkCoordinates[j * 3 + 2] << "\n";
+				}
+				stream << "f";
+				for (std::size_t j = 0; j < vertexCount; ++j)
+				{
+					stream << " " << vertexOffset + j;
+				}
+				stream << "\n";
+				vertexOffset += vertexCount;
+			}
+		}
+
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to write the OBJ file " + rkPath + ".");
+		}
+	}
+}
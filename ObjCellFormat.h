@@ -0,0 +1,31 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "CellMetricsKernels.h"
+
+#include <string>
+
+namespace TopologicEnergyCore
+{
+	// Reads cells from a Wavefront OBJ file: every object or group ("o" or "g") is one cell, made of its
+	// polygonal faces ("f"). Texture and normal indices are ignored, negative indices are relative.
+	CellBuffer ReadObjCells(const std::string& rkPath);
+
+	// Writes every cell as an OBJ object named cell_<index>, readable by ReadObjCells.
+	void WriteObjCells(const CellBuffer& rkCells, const std::string& rkPath);
+}
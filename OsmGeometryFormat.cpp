@@ -0,0 +1,236 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "OsmGeometryFormat.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		typedef std::vector<std::string> OsmObject;
+
+		std::string Trim(const std::string& rkText)
+		{
+			std::size_t begin = rkText.find_first_not_of(" \t\r\n");
+			if (begin == std::string::npos)
+			{
+				return std::string();
+			}
+			std::size_t end = rkText.find_last_not_of(" \t\r\n");
+			return rkText.substr(begin, end - begin + 1);
+		}
+
+		// Splits the file into objects of comma-separated fields, the class name first, dropping "!" comments.
+		// Only the classes in rkClasses are kept.
+		std::vector<OsmObject> ParseObjects(const std::string& rkText, const std::vector<std::string>& rkClasses)
+		{
+			std::vector<OsmObject> objects;
+			OsmObject object;
+			std::string field;
+			for (std::size_t i = 0; i < rkText.size(); ++i)
+			{
+				char c = rkText[i];
+				if (c == '!')
+				{
+					while (i < rkText.size() && rkText[i] != '\n')
+					{
+						++i;
+					}
+				}
+				else if (c == ',' || c == ';')
+				{
+					object.push_back(Trim(field));
+					field.clear();
+					if (c == ';')
+					{
+						for (const std::string& rkClass : rkClasses)
+						{
+							if (object.front() == rkClass)
+							{
+								objects.push_back(object);
+								break;
+							}
+						}
+						object.clear();
+					}
+				}
+				else
+				{
+					field += c;
+				}
+			}
+			return objects;
+		}
+
+		double Number(const OsmObject& rkObject, std::size_t index)
+		{
+			return index < rkObject.size() ? std::atof(rkObject[index].c_str()) : 0.0;
+		}
+
+		// The rotation about z by the direction of relative north, then the translation to the origin,
+		// as OpenStudio's PlanarSurfaceGroup::transformation().
+		struct SpaceTransformation
+		{
+			double cosAngle;
+			double sinAngle;
+			double origin[3];
+
+			void Apply(const OsmObject& rkObject, std::size_t firstVertexField, std::vector<double>& rCoordinates) const
+			{
+				for (std::size_t i = firstVertexField; i + 2 < rkObject.size(); i += 3)
+				{
+					double x = Number(rkObject, i);
+					double y = Number(rkObject, i + 1);
+					rCoordinates.push_back(cosAngle * x - sinAngle * y + origin[0]);
+					rCoordinates.push_back(sinAngle * x + cosAngle * y + origin[1]);
+					rCoordinates.push_back(Number(rkObject, i + 2) + origin[2]);
+				}
+			}
+		};
+
+		// Field indices, counting the class name as field 0
+		const std::size_t SpaceNorthField = 6;
+		const std::size_t SpaceOriginField = 7;
+		const std::size_t SurfaceSpaceField = 5;
+		const std::size_t SurfaceFirstVertexField = 12;
+		const std::size_t SubSurfaceSurfaceField = 5;
+		const std::size_t SubSurfaceFirstVertexField = 11;
+	}
+
+	OsmGeometry ReadOsmGeometry(const std::string& rkPath)
+	{
+		std::ifstream stream(rkPath.c_str(), std::ios::binary);
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to open the OSM file " + rkPath + ".");
+		}
+		std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+		std::vector<std::string> classes;
+		classes.push_back("OS:Space");
+		classes.push_back("OS:Surface");
+		classes.push_back("OS:SubSurface");
+		std::vector<OsmObject> objects = ParseObjects(text, classes);
+
+		// Surfaces refer to their space, and subsurfaces to their surface, by handle; older files use names.
+		std::vector<const OsmObject*> spaces;
+		std::map<std::string, std::size_t> spaceIds;
+		for (const OsmObject& rkObject : objects)
+		{
+			if (rkObject[0] == "OS:Space" && rkObject.size() > 2)
+			{
+				spaceIds[rkObject[1]] = spaces.size();
+				spaceIds[rkObject[2]] = spaces.size();
+				spaces.push_back(&rkObject);
+			}
+		}
+
+		std::vector<std::vector<const OsmObject*>> spaceSurfaces(spaces.size());
+		for (const OsmObject& rkObject : objects)
+		{
+			if (rkObject[0] == "OS:Surface" && rkObject.size() > SurfaceFirstVertexField)
+			{
+				std::map<std::string, std::size_t>::const_iterator kIterator = spaceIds.find(rkObject[SurfaceSpaceField]);
+				if (kIterator != spaceIds.end())
+				{
+					spaceSurfaces[kIterator->second].push_back(&rkObject);
+				}
+			}
+		}
+
+		OsmGeometry geometry;
+		std::vector<SpaceTransformation> transformations(spaces.size());
+		std::map<std::string, std::size_t> surfaceIds;
+		std::vector<double> coordinates;
+		std::size_t faceId = 0;
+		for (std::size_t spaceIndex = 0; spaceIndex < spaces.size(); ++spaceIndex)
+		{
+			const OsmObject& rkSpace = *spaces[spaceIndex];
+			SpaceTransformation& rTransformation = transformations[spaceIndex];
+			double angle = -Number(rkSpace, SpaceNorthField) * std::acos(-1.0) / 180.0;
+			rTransformation.cosAngle = std::cos(angle);
+			rTransformation.sinAngle = std::sin(angle);
+			for (int k = 0; k < 3; ++k)
+			{
+				rTransformation.origin[k] = Number(rkSpace, SpaceOriginField + k);
+			}
+
+			for (const OsmObject* pkSurface : spaceSurfaces[spaceIndex])
+			{
+				coordinates.clear();
+				rTransformation.Apply(*pkSurface, SurfaceFirstVertexField, coordinates);
+				if (coordinates.size() < 9)
+				{
+					continue;
+				}
+				geometry.cells.AddFace(coordinates.data(), coordinates.size() / 3);
+				geometry.surfaceNames.push_back((*pkSurface)[2]);
+				geometry.surfaceTypes.push_back((*pkSurface)[3]);
+				surfaceIds[(*pkSurface)[1]] = faceId;
+				surfaceIds[(*pkSurface)[2]] = faceId;
+				++faceId;
+			}
+			geometry.cells.EndCell();
+			geometry.spaceNames.push_back(rkSpace[2]);
+		}
+
+		std::vector<std::size_t> faceSpaces(faceId);
+		for (std::size_t spaceIndex = 0; spaceIndex < spaces.size(); ++spaceIndex)
+		{
+			for (std::size_t i = 0; i < geometry.cells.FaceCount(spaceIndex); ++i)
+			{
+				faceSpaces[geometry.cells.FaceId(spaceIndex, i)] = spaceIndex;
+			}
+		}
+
+		geometry.apertureVertexOffsets.push_back(0);
+		for (const OsmObject& rkObject : objects)
+		{
+			if (rkObject[0] != "OS:SubSurface" || rkObject.size() < SubSurfaceFirstVertexField + 9)
+			{
+				continue;
+			}
+			std::map<std::string, std::size_t>::const_iterator kIterator = surfaceIds.find(rkObject[SubSurfaceSurfaceField]);
+			if (kIterator == surfaceIds.end())
+			{
+				continue;
+			}
+
+			// OpenStudio 3 dropped the Shading Control Name field, which moves the vertices up by one;
+			// the vertex fields come in threes, which tells the two layouts apart.
+			std::size_t firstVertexField = (rkObject.size() - SubSurfaceFirstVertexField) % 3 == 0 ? SubSurfaceFirstVertexField : SubSurfaceFirstVertexField + 1;
+			std::size_t coordinateCount = geometry.apertureCoordinates.size();
+			transformations[faceSpaces[kIterator->second]].Apply(rkObject, firstVertexField, geometry.apertureCoordinates);
+			std::size_t vertexCount = (geometry.apertureCoordinates.size() - coordinateCount) / 3;
+			if (vertexCount < 3)
+			{
+				geometry.apertureCoordinates.resize(coordinateCount);
+				continue;
+			}
+			geometry.apertureNames.push_back(rkObject[2]);
+			geometry.apertureVertexOffsets.push_back(geometry.apertureVertexOffsets.back() + vertexCount);
+			geometry.apertureHostFaces.push_back(kIterator->second);
+		}
+		return geometry;
+	}
+}
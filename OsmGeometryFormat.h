@@ -0,0 +1,46 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "CellMetricsKernels.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	// The geometry of an OpenStudio model, in building coordinates: one cell per space, made of the
+	// surfaces of the space, and the subsurfaces as apertures of their host surfaces.
+	struct OsmGeometry
+	{
+		CellBuffer cells;
+		std::vector<std::string> spaceNames;			// indexed by cell
+		std::vector<std::string> surfaceNames;			// indexed by face id
+		std::vector<std::string> surfaceTypes;			// indexed by face id, e.g. "Wall"
+		std::vector<std::string> apertureNames;
+		std::vector<double> apertureCoordinates;		// vertexCount x 3
+		std::vector<std::size_t> apertureVertexOffsets;	// apertureCount + 1
+		std::vector<std::size_t> apertureHostFaces;		// the face id of the host surface of each aperture
+	};
+
+	// Reads the OS:Space, OS:Surface and OS:SubSurface objects of an OSM file, as EnergyModel.ByImportedOSM
+	// does through the OpenStudio SDK. Space vertices are relative to the space origin, rotated by the
+	// space's direction of relative north; both are applied here. Surfaces whose space is not found,
+	// and subsurfaces whose surface is not found, are skipped.
+	OsmGeometry ReadOsmGeometry(const std::string& rkPath);
+}
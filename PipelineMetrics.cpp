@@ -0,0 +1,262 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "PipelineMetrics.h"
+#include "NativeInterop.h"
+
+using namespace System::IO;
+
+namespace TopologicEnergy
+{
+	int PipelineMetrics::Spaces::get()
+	{
+		return m_spaces;
+	}
+
+	IDictionary<String^, int>^ PipelineMetrics::Surfaces::get()
+	{
+		return gcnew Dictionary<String^, int>(m_surfaces);
+	}
+
+	int PipelineMetrics::SubSurfacesCreated::get()
+	{
+		return m_subSurfacesCreated;
+	}
+
+	int PipelineMetrics::SubSurfacesRemoved::get()
+	{
+		return m_subSurfacesRemoved;
+	}
+
+	int PipelineMetrics::SubSurfacesFlipped::get()
+	{
+		return m_subSurfacesFlipped;
+	}
+
+	int PipelineMetrics::ShadingSurfaces::get()
+	{
+		return m_shadingSurfaces;
+	}
+
+	int PipelineMetrics::SqlQueries::get()
+	{
+		return m_sqlQueries;
+	}
+
+	IList<String^>^ PipelineMetrics::Stages::get()
+	{
+		ThrowIfDisposed();
+		List<String^>^ stages = gcnew List<String^>();
+		for (const TopologicEnergyCore::StageMetrics& rkStage : *m_pStages)
+		{
+			stages->Add(ToManagedString(rkStage.name));
+		}
+		return stages;
+	}
+
+	IList<double>^ PipelineMetrics::StageSeconds::get()
+	{
+		ThrowIfDisposed();
+		List<double>^ values = gcnew List<double>();
+		for (const TopologicEnergyCore::StageMetrics& rkStage : *m_pStages)
+		{
+			values->Add(rkStage.seconds);
+		}
+		return values;
+	}
+
+	IList<double>^ PipelineMetrics::StageAllocatedBytes::get()
+	{
+		ThrowIfDisposed();
+		List<double>^ values = gcnew List<double>();
+		for (const TopologicEnergyCore::StageMetrics& rkStage : *m_pStages)
+		{
+			values->Add(rkStage.allocatedBytes >= 0 ? (double)rkStage.allocatedBytes : Double::NaN);
+		}
+		return values;
+	}
+
+	IList<double>^ PipelineMetrics::StagePrivateBytesDelta::get()
+	{
+		ThrowIfDisposed();
+		List<double>^ values = gcnew List<double>();
+		for (const TopologicEnergyCore::StageMetrics& rkStage : *m_pStages)
+		{
+			values->Add((double)rkStage.privateBytesDelta);
+		}
+		return values;
+	}
+
+	IList<double>^ PipelineMetrics::StagePeakWorkingSet::get()
+	{
+		ThrowIfDisposed();
+		List<double>^ values = gcnew List<double>();
+		for (const TopologicEnergyCore::StageMetrics& rkStage : *m_pStages)
+		{
+			values->Add((double)rkStage.peakWorkingSet);
+		}
+		return values;
+	}
+
+	bool PipelineMetrics::MonitorAllocations::get()
+	{
+		return AppDomain::MonitoringIsEnabled;
+	}
+
+	void PipelineMetrics::MonitorAllocations::set(bool value)
+	{
+		if (value)
+		{
+			AppDomain::MonitoringIsEnabled = true;
+		}
+		else if (AppDomain::MonitoringIsEnabled)
+		{
+			throw gcnew Exception("The AppDomain resource monitoring cannot be turned off once it is on.");
+		}
+	}
+
+	String^ PipelineMetrics::ToPrometheusText()
+	{
+		ThrowIfDisposed();
+		TopologicEnergyCore::MetricsSnapshot snapshot;
+		snapshot.Add("spaces", "Spaces created.", m_spaces);
+		for each(KeyValuePair<String^, int> surfaceCount in m_surfaces)
+		{
+			array<String^>^ keys = surfaceCount.Key->Split('/');
+			std::vector<std::pair<std::string, std::string>> labels;
+			labels.push_back(std::make_pair(std::string("type"), ToNativeString(keys[0])));
+			labels.push_back(std::make_pair(std::string("boundary_condition"), ToNativeString(keys[1])));
+			snapshot.Add("surfaces", "Surfaces created, by type and outside boundary condition.", surfaceCount.Value, labels);
+		}
+		snapshot.Add("subsurfaces_created", "Subsurfaces created, including the recreated ones.", m_subSurfacesCreated);
+		snapshot.Add("subsurfaces_removed", "Subsurfaces removed.", m_subSurfacesRemoved);
+		snapshot.Add("subsurfaces_flipped", "Subsurfaces recreated with reversed vertices.", m_subSurfacesFlipped);
+		snapshot.Add("shading_surfaces", "Shading surfaces created.", m_shadingSurfaces);
+		snapshot.Add("sql_queries", "SQL queries run against the simulation results.", m_sqlQueries);
+		for (const TopologicEnergyCore::StageMetrics& rkStage : *m_pStages)
+		{
+			snapshot.AddStage(rkStage);
+		}
+		return ToManagedString(snapshot.ToPrometheusText());
+	}
+
+	bool PipelineMetrics::ExportPrometheus(PipelineMetrics^ pipelineMetrics, String^ filePath)
+	{
+		if (pipelineMetrics == nullptr)
+		{
+			throw gcnew Exception("The input pipelineMetrics must not be null.");
+		}
+
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		// The exposition format requires \n line endings.
+		File::WriteAllText(filePath, pipelineMetrics->ToPrometheusText(), gcnew System::Text::UTF8Encoding(false));
+		return true;
+	}
+
+	PipelineMetrics::PipelineMetrics()
+		: m_spaces(0)
+		, m_surfaces(gcnew Dictionary<String^, int>())
+		, m_subSurfacesCreated(0)
+		, m_subSurfacesRemoved(0)
+		, m_subSurfacesFlipped(0)
+		, m_shadingSurfaces(0)
+		, m_sqlQueries(0)
+		, m_stageAllocatedBytes(0)
+		, m_pStageMeter(new TopologicEnergyCore::StageMeter())
+		, m_pStages(new std::vector<TopologicEnergyCore::StageMetrics>())
+	{
+
+	}
+
+	void PipelineMetrics::CountSpace()
+	{
+		++m_spaces;
+	}
+
+	void PipelineMetrics::CountSurface(String^ surfaceType, String^ boundaryCondition)
+	{
+		String^ key = surfaceType + "/" + boundaryCondition;
+		int count = 0;
+		m_surfaces->TryGetValue(key, count);
+		m_surfaces[key] = count + 1;
+	}
+
+	void PipelineMetrics::CountSubSurfaceCreated()
+	{
+		++m_subSurfacesCreated;
+	}
+
+	void PipelineMetrics::CountSubSurfaceRemoved()
+	{
+		++m_subSurfacesRemoved;
+	}
+
+	void PipelineMetrics::CountSubSurfaceFlipped()
+	{
+		++m_subSurfacesFlipped;
+	}
+
+	void PipelineMetrics::CountShadingSurfaces(int count)
+	{
+		m_shadingSurfaces += count;
+	}
+
+	void PipelineMetrics::SqlQueryCount::set(int value)
+	{
+		m_sqlQueries = value;
+	}
+
+	void PipelineMetrics::BeginStage()
+	{
+		ThrowIfDisposed();
+		// The counter covers every thread of the AppDomain; there is no per-thread one in the .NET Framework.
+		m_stageAllocatedBytes = AppDomain::MonitoringIsEnabled ? AppDomain::CurrentDomain->MonitoringTotalAllocatedMemorySize : -1;
+		m_pStageMeter->Begin();
+	}
+
+	void PipelineMetrics::EndStage(String^ name)
+	{
+		ThrowIfDisposed();
+		long long allocatedBytes = m_stageAllocatedBytes >= 0 ?
+			AppDomain::CurrentDomain->MonitoringTotalAllocatedMemorySize - m_stageAllocatedBytes : -1;
+		m_pStages->push_back(m_pStageMeter->End(ToNativeString(name), allocatedBytes));
+	}
+
+	PipelineMetrics::~PipelineMetrics()
+	{
+		this->!PipelineMetrics();
+	}
+
+	PipelineMetrics::!PipelineMetrics()
+	{
+		delete m_pStageMeter;
+		m_pStageMeter = nullptr;
+		delete m_pStages;
+		m_pStages = nullptr;
+	}
+
+	void PipelineMetrics::ThrowIfDisposed()
+	{
+		if (m_pStages == nullptr)
+		{
+			throw gcnew ObjectDisposedException("PipelineMetrics");
+		}
+	}
+}
@@ -0,0 +1,191 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "MetricsSnapshot.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// The counts and memory figures of building or simulating an energy model, e.g. to predict the EnergyPlus run time from the complexity of the model.
+	/// The counts belong to one build or simulation; the memory figures are those of the whole process during each stage, so they include any other work running at the same time.
+	/// </summary>
+	public ref class PipelineMetrics
+	{
+	public:
+		/// <summary>
+		/// Returns the number of spaces created.
+		/// </summary>
+		property int Spaces
+		{
+			int get();
+		}
+
+		/// <summary>
+		/// Returns the number of surfaces created, keyed by surface type and outside boundary condition, e.g. "Wall/Outdoors".
+		/// </summary>
+		property IDictionary<String^, int>^ Surfaces
+		{
+			IDictionary<String^, int>^ get();
+		}
+
+		/// <summary>
+		/// Returns the number of subsurfaces created, including those recreated with reversed vertices.
+		/// </summary>
+		property int SubSurfacesCreated
+		{
+			int get();
+		}
+
+		/// <summary>
+		/// Returns the number of subsurfaces removed, either to be recreated or because they are too small.
+		/// </summary>
+		property int SubSurfacesRemoved
+		{
+			int get();
+		}
+
+		/// <summary>
+		/// Returns the number of subsurfaces whose vertices had to be reversed to face the same way as their surface.
+		/// </summary>
+		property int SubSurfacesFlipped
+		{
+			int get();
+		}
+
+		/// <summary>
+		/// Returns the number of shading surfaces created.
+		/// </summary>
+		property int ShadingSurfaces
+		{
+			int get();
+		}
+
+		/// <summary>
+		/// Returns the number of SQL queries run against the simulation results so far.
+		/// </summary>
+		property int SqlQueries
+		{
+			int get();
+		}
+
+		/// <summary>
+		/// Returns the names of the measured stages, in order.
+		/// </summary>
+		property IList<String^>^ Stages
+		{
+			IList<String^>^ get();
+		}
+
+		/// <summary>
+		/// Returns the duration of each stage in seconds.
+		/// </summary>
+		property IList<double>^ StageSeconds
+		{
+			IList<double>^ get();
+		}
+
+		/// <summary>
+		/// Returns the managed memory allocated in the AppDomain by all threads during each stage in bytes, or NaN if MonitorAllocations was off.
+		/// The figure is not per pipeline: it includes the allocations of any other pipeline running at the same time.
+		/// Native allocations, e.g. by OpenStudio, are not included; they show in StagePrivateBytesDelta.
+		/// </summary>
+		property IList<double>^ StageAllocatedBytes
+		{
+			IList<double>^ get();
+		}
+
+		/// <summary>
+		/// Returns the change of the private memory of the process over each stage in bytes, native and managed.
+		/// </summary>
+		property IList<double>^ StagePrivateBytesDelta
+		{
+			IList<double>^ get();
+		}
+
+		/// <summary>
+		/// Returns the peak working set of the process during each stage in bytes.
+		/// </summary>
+		property IList<double>^ StagePeakWorkingSet
+		{
+			IList<double>^ get();
+		}
+
+		/// <summary>
+		/// If true, the managed allocations of each stage are measured. Turning it on enables AppDomain resource monitoring for the whole process, which cannot be turned off again.
+		/// </summary>
+		static property bool MonitorAllocations
+		{
+			bool get();
+			void set(bool value);
+		}
+
+		/// <summary>
+		/// Returns the metrics in the Prometheus text exposition format.
+		/// </summary>
+		/// <returns>The metrics as text</returns>
+		String^ ToPrometheusText();
+
+		/// <summary>
+		/// Writes the metrics to a file in the Prometheus text exposition format, e.g. for the textfile collector of the node exporter.
+		/// </summary>
+		/// <param name="pipelineMetrics">The metrics</param>
+		/// <param name="filePath">The path of the file</param>
+		/// <returns>True if the file is written</returns>
+		static bool ExportPrometheus(PipelineMetrics^ pipelineMetrics, String^ filePath);
+
+		~PipelineMetrics();
+		!PipelineMetrics();
+
+	internal:
+		PipelineMetrics();
+
+		void CountSpace();
+		void CountSurface(String^ surfaceType, String^ boundaryCondition);
+		void CountSubSurfaceCreated();
+		void CountSubSurfaceRemoved();
+		void CountSubSurfaceFlipped();
+		void CountShadingSurfaces(int count);
+
+		property int SqlQueryCount
+		{
+			void set(int value);
+		}
+
+		// Measures the time and memory between the two calls as a stage.
+		void BeginStage();
+		void EndStage(String^ name);
+
+	private:
+		// Throws ObjectDisposedException once the native stages have been released.
+		void ThrowIfDisposed();
+
+		int m_spaces;
+		Dictionary<String^, int>^ m_surfaces;
+		int m_subSurfacesCreated;
+		int m_subSurfacesRemoved;
+		int m_subSurfacesFlipped;
+		int m_shadingSurfaces;
+		int m_sqlQueries;
+		long long m_stageAllocatedBytes;
+		TopologicEnergyCore::StageMeter* m_pStageMeter;
+		std::vector<TopologicEnergyCore::StageMetrics>* m_pStages;
+	};
+}
@@ -0,0 +1,317 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "PolygonKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		Point Subtract(const Point& rkA, const Point& rkB)
+		{
+			Point difference = { { rkA[0] - rkB[0], rkA[1] - rkB[1], rkA[2] - rkB[2] } };
+			return difference;
+		}
+
+		double Dot(const Point& rkA, const Point& rkB)
+		{
+			return rkA[0] * rkB[0] + rkA[1] * rkB[1] + rkA[2] * rkB[2];
+		}
+
+		double Length(const Point& rkA)
+		{
+			return std::sqrt(Dot(rkA, rkA));
+		}
+
+		// Newell normal; its length is twice the area of the polygon.
+		Point Normal(const Polygon& rkPolygon)
+		{
+			Point normal = { { 0.0, 0.0, 0.0 } };
+			for (std::size_t i = 0; i < rkPolygon.size(); ++i)
+			{
+				const Point& rkCurrent = rkPolygon[i];
+				const Point& rkNext = rkPolygon[(i + 1) % rkPolygon.size()];
+				normal[0] += (rkCurrent[1] - rkNext[1]) * (rkCurrent[2] + rkNext[2]);
+				normal[1] += (rkCurrent[2] - rkNext[2]) * (rkCurrent[0] + rkNext[0]);
+				normal[2] += (rkCurrent[0] - rkNext[0]) * (rkCurrent[1] + rkNext[1]);
+			}
+			return normal;
+		}
+
+		double DistanceToSegment(const Point& rkPoint, const Point& rkStart, const Point& rkEnd, double& rParameter)
+		{
+			Point direction = Subtract(rkEnd, rkStart);
+			double lengthSquared = Dot(direction, direction);
+			rParameter = lengthSquared > 0.0 ? Dot(Subtract(rkPoint, rkStart), direction) / lengthSquared : 0.0;
+			rParameter = std::min(std::max(rParameter, 0.0), 1.0);
+			Point closest = { { rkStart[0] + direction[0] * rParameter, rkStart[1] + direction[1] * rParameter, rkStart[2] + direction[2] * rParameter } };
+			return Length(Subtract(rkPoint, closest));
+		}
+
+		// Index of the point in rPoints within tolerance of rkPoint, appending it if there is none.
+		std::size_t PointId(std::vector<Point>& rPoints, const Point& rkPoint, double tolerance)
+		{
+			for (std::size_t i = 0; i < rPoints.size(); ++i)
+			{
+				if (Length(Subtract(rPoints[i], rkPoint)) <= tolerance)
+				{
+					return i;
+				}
+			}
+			rPoints.push_back(rkPoint);
+			return rPoints.size() - 1;
+		}
+
+		// The polygon as point ids, with the points of rkOther that lie on its edges inserted, so that
+		// partially shared edges are split at the same points in both polygons.
+		std::vector<std::size_t> SplitEdges(const Polygon& rkPolygon, const Polygon& rkOther, std::vector<Point>& rPoints, double tolerance)
+		{
+			std::vector<std::size_t> ids;
+			for (std::size_t i = 0; i < rkPolygon.size(); ++i)
+			{
+				const Point& rkStart = rkPolygon[i];
+				const Point& rkEnd = rkPolygon[(i + 1) % rkPolygon.size()];
+				ids.push_back(PointId(rPoints, rkStart, tolerance));
+
+				std::vector<std::pair<double, std::size_t>> splits;
+				for (const Point& rkPoint : rkOther)
+				{
+					double parameter = 0.0;
+					if (DistanceToSegment(rkPoint, rkStart, rkEnd, parameter) <= tolerance &&
+						Length(Subtract(rkPoint, rkStart)) > tolerance && Length(Subtract(rkPoint, rkEnd)) > tolerance)
+					{
+						splits.push_back(std::make_pair(parameter, PointId(rPoints, rkPoint, tolerance)));
+					}
+				}
+				std::sort(splits.begin(), splits.end());
+				for (const std::pair<double, std::size_t>& rkSplit : splits)
+				{
+					ids.push_back(rkSplit.second);
+				}
+			}
+			return ids;
+		}
+	}
+
+	bool AreCoplanar(const Polygon& rkPolygon, const Polygon& rkOther, double tolerance)
+	{
+		Point normal = Normal(rkPolygon);
+		Point otherNormal = Normal(rkOther);
+		double length = Length(normal);
+		double otherLength = Length(otherNormal);
+		if (length <= 0.0 || otherLength <= 0.0 || rkPolygon.empty())
+		{
+			return false;
+		}
+
+		if (Dot(normal, otherNormal) / (length * otherLength) <= 0.0)
+		{
+			return false;
+		}
+
+		for (const Point& rkPoint : rkOther)
+		{
+			if (std::abs(Dot(Subtract(rkPoint, rkPolygon[0]), normal)) / length > tolerance)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool JoinPolygons(const Polygon& rkPolygon, const Polygon& rkOther, double tolerance, Polygon& rJoined)
+	{
+		std::vector<Point> points;
+		std::vector<std::size_t> ids = SplitEdges(rkPolygon, rkOther, points, tolerance);
+		std::vector<std::size_t> otherIds = SplitEdges(rkOther, rkPolygon, points, tolerance);
+
+		std::vector<std::pair<std::size_t, std::size_t>> edges;
+		for (const std::vector<std::size_t>* pkIds : { &ids, &otherIds })
+		{
+			for (std::size_t i = 0; i < pkIds->size(); ++i)
+			{
+				std::size_t from = (*pkIds)[i];
+				std::size_t to = (*pkIds)[(i + 1) % pkIds->size()];
+				if (from != to)
+				{
+					edges.push_back(std::make_pair(from, to));
+				}
+			}
+		}
+
+		// Cancel each edge run in both directions; these are the shared edges.
+		std::vector<bool> isRemoved(edges.size(), false);
+		bool isShared = false;
+		for (std::size_t i = 0; i < edges.size(); ++i)
+		{
+			for (std::size_t j = i + 1; j < edges.size() && !isRemoved[i]; ++j)
+			{
+				if (!isRemoved[j] && edges[i].first == edges[j].second && edges[i].second == edges[j].first)
+				{
+					isRemoved[i] = true;
+					isRemoved[j] = true;
+					isShared = true;
+				}
+			}
+		}
+		if (!isShared)
+		{
+			return false;
+		}
+
+		// The remaining edges must form exactly one loop.
+		std::vector<std::pair<std::size_t, std::size_t>> remainingEdges;
+		for (std::size_t i = 0; i < edges.size(); ++i)
+		{
+			if (!isRemoved[i])
+			{
+				remainingEdges.push_back(edges[i]);
+			}
+		}
+		if (remainingEdges.size() < 3)
+		{
+			return false;
+		}
+
+		std::vector<bool> isUsed(remainingEdges.size(), false);
+		std::vector<std::size_t> loop;
+		std::size_t current = 0;
+		for (std::size_t step = 0; step < remainingEdges.size(); ++step)
+		{
+			isUsed[current] = true;
+			loop.push_back(remainingEdges[current].first);
+			std::size_t next = remainingEdges.size();
+			for (std::size_t i = 0; i < remainingEdges.size(); ++i)
+			{
+				if (!isUsed[i] && remainingEdges[i].first == remainingEdges[current].second)
+				{
+					if (next != remainingEdges.size())
+					{
+						return false; // A vertex with two outgoing edges: the union is not a simple loop.
+					}
+					next = i;
+				}
+			}
+			if (next == remainingEdges.size())
+			{
+				break;
+			}
+			current = next;
+		}
+		if (loop.size() != remainingEdges.size() || remainingEdges[current].second != remainingEdges[0].first)
+		{
+			return false;
+		}
+
+		rJoined.clear();
+		for (std::size_t id : loop)
+		{
+			rJoined.push_back(points[id]);
+		}
+		RemoveCollinearVertices(rJoined, tolerance);
+		return rJoined.size() >= 3;
+	}
+
+	void RemoveCollinearVertices(Polygon& rPolygon, double tolerance)
+	{
+		bool isChanged = true;
+		while (isChanged && rPolygon.size() > 3)
+		{
+			isChanged = false;
+			for (std::size_t i = 0; i < rPolygon.size() && rPolygon.size() > 3; ++i)
+			{
+				const Point& rkPrevious = rPolygon[(i + rPolygon.size() - 1) % rPolygon.size()];
+				const Point& rkNext = rPolygon[(i + 1) % rPolygon.size()];
+				double parameter = 0.0;
+				if (DistanceToSegment(rPolygon[i], rkPrevious, rkNext, parameter) <= tolerance)
+				{
+					rPolygon.erase(rPolygon.begin() + i);
+					isChanged = true;
+					break;
+				}
+			}
+		}
+	}
+
+	std::vector<Polygon> MergeCoplanarPolygons(
+		const std::vector<Polygon>& rkPolygons,
+		const std::vector<std::size_t>& rkGroups,
+		double tolerance,
+		std::vector<std::size_t>& rTargets)
+	{
+		std::vector<Polygon> merged(rkPolygons);
+		std::vector<bool> isAlive(merged.size(), true);
+		std::vector<std::size_t> owners(merged.size());
+		for (std::size_t i = 0; i < owners.size(); ++i)
+		{
+			owners[i] = i;
+		}
+
+		bool isChanged = true;
+		while (isChanged)
+		{
+			isChanged = false;
+			for (std::size_t i = 0; i < merged.size(); ++i)
+			{
+				for (std::size_t j = i + 1; j < merged.size() && isAlive[i]; ++j)
+				{
+					if (!isAlive[j] || rkGroups[i] != rkGroups[j] || !AreCoplanar(merged[i], merged[j], tolerance))
+					{
+						continue;
+					}
+
+					Polygon joined;
+					if (!JoinPolygons(merged[i], merged[j], tolerance, joined))
+					{
+						continue;
+					}
+
+					merged[i] = joined;
+					isAlive[j] = false;
+					for (std::size_t& rOwner : owners)
+					{
+						if (rOwner == j)
+						{
+							rOwner = i;
+						}
+					}
+					isChanged = true;
+				}
+			}
+		}
+
+		// Compact the surviving polygons and renumber the targets.
+		std::vector<Polygon> result;
+		std::vector<std::size_t> newIndices(merged.size(), 0);
+		for (std::size_t i = 0; i < merged.size(); ++i)
+		{
+			if (isAlive[i])
+			{
+				newIndices[i] = result.size();
+				result.push_back(merged[i]);
+			}
+		}
+		rTargets.resize(rkPolygons.size());
+		for (std::size_t i = 0; i < rkPolygons.size(); ++i)
+		{
+			rTargets[i] = newIndices[owners[i]];
+		}
+		return result;
+	}
+}
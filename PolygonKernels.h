@@ -0,0 +1,49 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	typedef std::array<double, 3> Point;
+	typedef std::vector<Point> Polygon;
+
+	// Returns true if every vertex of rkOther lies within tolerance of the plane of rkPolygon and both
+	// polygons face the same way.
+	bool AreCoplanar(const Polygon& rkPolygon, const Polygon& rkOther, double tolerance);
+
+	// Joins two coplanar polygons with the same orientation that share at least one edge (or part of
+	// one) into a single polygon. The edges both polygons run along in opposite directions are removed
+	// and the remaining edges are walked into one loop. Returns false if the polygons do not share an
+	// edge or if the union is not a single loop (e.g. it would enclose a hole).
+	bool JoinPolygons(const Polygon& rkPolygon, const Polygon& rkOther, double tolerance, Polygon& rJoined);
+
+	// Removes the vertices that are within tolerance of the line through their neighbours, and repeated vertices.
+	void RemoveCollinearVertices(Polygon& rPolygon, double tolerance);
+
+	// Repeatedly joins coplanar polygons of the same group that share an edge. rkGroups gives the group of
+	// each polygon (e.g. its boundary condition and construction); polygons of different groups are never
+	// joined. On return, rTargets[i] is the index of the output polygon that polygon i was merged into.
+	std::vector<Polygon> MergeCoplanarPolygons(
+		const std::vector<Polygon>& rkPolygons,
+		const std::vector<std::size_t>& rkGroups,
+		double tolerance,
+		std::vector<std::size_t>& rTargets);
+}
@@ -0,0 +1,110 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "RenderCache.h"
+
+namespace TopologicEnergy
+{
+	RenderCache::RenderCache(IList<Cell^>^ cells)
+		: m_cellGeometries(gcnew array<List<Autodesk::DesignScript::Geometry::Geometry^>^>(cells->Count))
+		, m_apertureGeometries(gcnew List<Autodesk::DesignScript::Geometry::Geometry^>())
+		, m_apertureGeometryColors(gcnew List<Modifiers::GeometryColor^>())
+	{
+		for (int i = 0; i < cells->Count; ++i)
+		{
+			Cell^ cell = cells[i];
+			m_cellGeometries[i] = gcnew List<Autodesk::DesignScript::Geometry::Geometry^>();
+			AddGeometries(cell->BasicGeometry, m_cellGeometries[i]);
+
+			IList<Topologic::Topology^>^ subcontents = cell->SubContents;
+			for each(Topologic::Topology^ subcontent in subcontents)
+			{
+				AddGeometries(subcontent->BasicGeometry, m_apertureGeometries);
+			}
+		}
+
+		DSCore::Color^ contentColor = DSCore::Color::ByARGB(255, 128, 128, 128);
+		for each(Autodesk::DesignScript::Geometry::Geometry^ apertureGeometry in m_apertureGeometries)
+		{
+			m_apertureGeometryColors->Add(Modifiers::GeometryColor::ByGeometryColor(apertureGeometry, contentColor));
+		}
+	}
+
+	RenderCache::~RenderCache()
+	{
+		for each(List<Autodesk::DesignScript::Geometry::Geometry^>^ cellGeometries in m_cellGeometries)
+		{
+			for each(Autodesk::DesignScript::Geometry::Geometry^ geometry in cellGeometries)
+			{
+				delete geometry;
+			}
+			cellGeometries->Clear();
+		}
+
+		for each(Autodesk::DesignScript::Geometry::Geometry^ geometry in m_apertureGeometries)
+		{
+			delete geometry;
+		}
+		m_apertureGeometries->Clear();
+		m_apertureGeometryColors->Clear();
+	}
+
+	List<Modifiers::GeometryColor^>^ RenderCache::Colorize(IList<DSCore::Color^>^ cellColors)
+	{
+		if (cellColors->Count != m_cellGeometries->Length)
+		{
+			throw gcnew Exception("The number of colors does not match the number of cells.");
+		}
+
+		List<Modifiers::GeometryColor^>^ dynamoGeometryColors = gcnew List<Modifiers::GeometryColor^>(m_cellGeometries->Length + m_apertureGeometryColors->Count);
+		for (int i = 0; i < m_cellGeometries->Length; ++i)
+		{
+			DSCore::Color^ color = cellColors[i];
+			for each(Autodesk::DesignScript::Geometry::Geometry^ cellGeometry in m_cellGeometries[i])
+			{
+				dynamoGeometryColors->Add(Modifiers::GeometryColor::ByGeometryColor(cellGeometry, color));
+			}
+		}
+
+		dynamoGeometryColors->AddRange(m_apertureGeometryColors);
+		return dynamoGeometryColors;
+	}
+
+	void RenderCache::AddGeometries(Object^ basicGeometry, List<Autodesk::DesignScript::Geometry::Geometry^>^ geometries)
+	{
+		// 1. A single Dynamo geometry
+		Autodesk::DesignScript::Geometry::Geometry^ dynamoGeometry = dynamic_cast<Autodesk::DesignScript::Geometry::Geometry^>(basicGeometry);
+		if (dynamoGeometry != nullptr)
+		{
+			geometries->Add(dynamoGeometry);
+			return;
+		}
+
+		// 2. Try a list of Dynamo geometries
+		List<Object^>^ listOfObjects = dynamic_cast<List<Object^>^>(basicGeometry);
+		if (listOfObjects != nullptr)
+		{
+			for each(Object^ object in listOfObjects)
+			{
+				Autodesk::DesignScript::Geometry::Geometry^ dynamoListGeometry = dynamic_cast<Autodesk::DesignScript::Geometry::Geometry^>(object);
+				if (dynamoListGeometry != nullptr)
+				{
+					geometries->Add(dynamoListGeometry);
+				}
+			}
+		}
+	}
+}
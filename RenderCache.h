@@ -0,0 +1,53 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace Topologic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// Keeps the Dynamo geometry of every cell and aperture of an EnergyModel, so displaying a new result only recolors it.
+	/// </summary>
+	public ref class RenderCache
+	{
+	public:
+		~RenderCache();
+
+	internal:
+		RenderCache(IList<Cell^>^ cells);
+
+		// Returns one colored geometry per piece of every cell, followed by the (grey) apertures.
+		List<Modifiers::GeometryColor^>^ Colorize(IList<DSCore::Color^>^ cellColors);
+
+		property int CellCount
+		{
+			int get() { return m_cellGeometries->Length; }
+		}
+
+	protected:
+		static void AddGeometries(Object^ basicGeometry, List<Autodesk::DesignScript::Geometry::Geometry^>^ geometries);
+
+		array<List<Autodesk::DesignScript::Geometry::Geometry^>^>^ m_cellGeometries;
+		List<Autodesk::DesignScript::Geometry::Geometry^>^ m_apertureGeometries;
+
+		// The aperture color never changes, so their colored geometries are built once.
+		List<Modifiers::GeometryColor^>^ m_apertureGeometryColors;
+	};
+}
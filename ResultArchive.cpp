@@ -0,0 +1,359 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ResultArchive.h"
+#include "SimulationResult.h"
+#include "SimulationMetrics.h"
+#include "NativeInterop.h"
+
+#include <stdexcept>
+
+namespace TopologicEnergy
+{
+	ResultArchiveWriter^ ResultArchiveWriter::ByFilePath(String^ filePath)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		return gcnew ResultArchiveWriter(filePath);
+	}
+
+	void ResultArchiveWriter::AddResult(String^ runName, String^ metricName, SimulationResult^ simulationResult)
+	{
+		if (simulationResult == nullptr)
+		{
+			throw gcnew Exception("The input simulationResult must not be null.");
+		}
+
+		List<IList<double>^>^ frames = gcnew List<IList<double>^>();
+		frames->Add(simulationResult->Values);
+		AddTimeSeries(runName, metricName, simulationResult->Unit, simulationResult->Names, frames);
+
+		// The summary metrics are cached with the simulation, so they are written once per run.
+		SimulationMetrics^ metrics = simulationResult->Metrics;
+		if (metrics != nullptr && m_summaryRuns->Add(runName))
+		{
+			List<IList<double>^>^ summaryFrames = gcnew List<IList<double>^>();
+			summaryFrames->Add(metrics->Values);
+			AddTimeSeries(runName, SummaryMetricName, "", metrics->Names, summaryFrames);
+		}
+	}
+
+	void ResultArchiveWriter::AddTimeSeries(String^ runName, String^ metricName, String^ units, IList<String^>^ names, IList<IList<double>^>^ frames)
+	{
+		if (m_pWriter == nullptr)
+		{
+			throw gcnew Exception("The result archive has already been closed.");
+		}
+
+		if (runName == nullptr || metricName == nullptr)
+		{
+			throw gcnew Exception("The input runName and metricName must not be null.");
+		}
+
+		if (names == nullptr || frames == nullptr || frames->Count == 0)
+		{
+			throw gcnew Exception("The input names and frames must not be null or empty.");
+		}
+
+		std::vector<std::string> labels;
+		labels.reserve(names->Count);
+		for each(String^ name in names)
+		{
+			labels.push_back(ToNativeString(name));
+		}
+
+		int rowCount = names->Count;
+		std::vector<double> values;
+		values.reserve((size_t)rowCount * (size_t)frames->Count);
+		for each(IList<double>^ frame in frames)
+		{
+			if (frame == nullptr || frame->Count != rowCount)
+			{
+				throw gcnew Exception("The number of values in a frame does not match the number of names.");
+			}
+
+			for each(double value in frame)
+			{
+				values.push_back(value);
+			}
+		}
+
+		try {
+			m_pWriter->AddColumn(ToNativeString(runName), ToNativeString(metricName), ToNativeString(units), labels, values.data(), rowCount, frames->Count);
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+	}
+
+	void ResultArchiveWriter::Close()
+	{
+		if (m_pWriter == nullptr)
+		{
+			return;
+		}
+
+		try {
+			m_pWriter->Finish();
+		}
+		catch (const std::exception& rkException)
+		{
+			this->!ResultArchiveWriter();
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		this->!ResultArchiveWriter();
+	}
+
+	ResultArchiveWriter::ResultArchiveWriter(String^ filePath)
+		: m_pWriter(nullptr)
+		, m_summaryRuns(gcnew HashSet<String^>())
+	{
+		try {
+			m_pWriter = new TopologicEnergyCore::ResultArchiveWriter(ToNativeString(filePath));
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+	}
+
+	ResultArchiveWriter::~ResultArchiveWriter()
+	{
+		Close();
+	}
+
+	ResultArchiveWriter::!ResultArchiveWriter()
+	{
+		// An archive that is never closed has no index and cannot be read back.
+		delete m_pWriter;
+		m_pWriter = nullptr;
+	}
+
+	bool ResultArchive::Export(IList<SimulationResult^>^ simulationResults, IList<String^>^ runNames, IList<String^>^ metricNames, String^ filePath)
+	{
+		if (simulationResults == nullptr || runNames == nullptr || metricNames == nullptr)
+		{
+			throw gcnew Exception("The input simulationResults, runNames and metricNames must not be null.");
+		}
+
+		if (simulationResults->Count != runNames->Count || simulationResults->Count != metricNames->Count)
+		{
+			throw gcnew Exception("The number of run and metric names does not match the number of simulation results.");
+		}
+
+		ResultArchiveWriter^ writer = ResultArchiveWriter::ByFilePath(filePath);
+		try {
+			for (int i = 0; i < simulationResults->Count; ++i)
+			{
+				writer->AddResult(runNames[i], metricNames[i], simulationResults[i]);
+			}
+			writer->Close();
+		}
+		finally
+		{
+			delete writer;
+		}
+		return true;
+	}
+
+	ResultArchive^ ResultArchive::ByFilePath(String^ filePath)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		TopologicEnergyCore::ResultArchiveReader* pReader = nullptr;
+		try {
+			pReader = new TopologicEnergyCore::ResultArchiveReader(ToNativeString(filePath));
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		return gcnew ResultArchive(pReader);
+	}
+
+	SimulationResult^ ResultArchive::Result(String^ runName, String^ metricName, int frame)
+	{
+		int rowCount = 0;
+		IList<String^>^ names = nullptr;
+		String^ units = nullptr;
+		const double* pkValues = ColumnData(runName, metricName, frame, rowCount, names, units);
+
+		array<double>^ values = gcnew array<double>(rowCount);
+		for (int i = 0; i < rowCount; ++i)
+		{
+			values[i] = pkValues[i];
+		}
+
+		return SimulationResult::ByNamesValues(names, values, units);
+	}
+
+	Dictionary<String^, IList<double>^>^ ResultArchive::ValuesByRun(String^ metricName, int frame)
+	{
+		if (metricName == nullptr)
+		{
+			throw gcnew Exception("The input metricName must not be null.");
+		}
+
+		TopologicEnergyCore::ResultArchiveReader* pReader = Reader();
+		Dictionary<String^, IList<double>^>^ valuesByRun = gcnew Dictionary<String^, IList<double>^>();
+		try {
+			std::vector<size_t> columns = pReader->FindColumns(ToNativeString(metricName));
+			for (size_t column : columns)
+			{
+				const TopologicEnergyCore::ArchiveColumnEntry& rkColumn = pReader->Column(column);
+				if (frame < 0 || (std::uint64_t)frame >= rkColumn.frameCount)
+				{
+					continue;
+				}
+
+				int rowCount = (int)rkColumn.rowCount;
+				const double* pkValues = pReader->Data(column) + (size_t)frame * (size_t)rowCount;
+				List<double>^ values = gcnew List<double>(rowCount);
+				for (int i = 0; i < rowCount; ++i)
+				{
+					values->Add(pkValues[i]);
+				}
+				valuesByRun[ToManagedString(pReader->String(rkColumn.runName))] = values;
+			}
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+
+		return valuesByRun;
+	}
+
+	IList<String^>^ ResultArchive::Runs::get()
+	{
+		List<String^>^ runs = gcnew List<String^>();
+		HashSet<String^>^ visitedRuns = gcnew HashSet<String^>();
+		TopologicEnergyCore::ResultArchiveReader* pReader = Reader();
+		try {
+			for (size_t i = 0; i < pReader->ColumnCount(); ++i)
+			{
+				String^ runName = ToManagedString(pReader->String(pReader->Column(i).runName));
+				if (visitedRuns->Add(runName))
+				{
+					runs->Add(runName);
+				}
+			}
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		return runs;
+	}
+
+	IList<String^>^ ResultArchive::Metrics::get()
+	{
+		List<String^>^ metrics = gcnew List<String^>();
+		HashSet<String^>^ visitedMetrics = gcnew HashSet<String^>();
+		TopologicEnergyCore::ResultArchiveReader* pReader = Reader();
+		try {
+			for (size_t i = 0; i < pReader->ColumnCount(); ++i)
+			{
+				String^ metricName = ToManagedString(pReader->String(pReader->Column(i).metricName));
+				if (visitedMetrics->Add(metricName))
+				{
+					metrics->Add(metricName);
+				}
+			}
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		return metrics;
+	}
+
+	ResultArchive::ResultArchive(TopologicEnergyCore::ResultArchiveReader* pReader)
+		: m_pReader(pReader)
+	{
+
+	}
+
+	ResultArchive::~ResultArchive()
+	{
+		this->!ResultArchive();
+	}
+
+	ResultArchive::!ResultArchive()
+	{
+		delete m_pReader;
+		m_pReader = nullptr;
+	}
+
+	TopologicEnergyCore::ResultArchiveReader* ResultArchive::Reader()
+	{
+		if (m_pReader == nullptr)
+		{
+			throw gcnew ObjectDisposedException("ResultArchive");
+		}
+		return m_pReader;
+	}
+
+	const double* ResultArchive::ColumnData(String^ runName, String^ metricName, int frame, int% rowCount, IList<String^>^% names, String^% units)
+	{
+		if (runName == nullptr || metricName == nullptr)
+		{
+			throw gcnew Exception("The input runName and metricName must not be null.");
+		}
+
+		TopologicEnergyCore::ResultArchiveReader* pReader = Reader();
+		int column = pReader->FindColumn(ToNativeString(runName), ToNativeString(metricName));
+		if (column < 0)
+		{
+			throw gcnew Exception("The result archive does not contain the metric " + metricName + " for the run " + runName + ".");
+		}
+
+		const TopologicEnergyCore::ArchiveColumnEntry& rkColumn = pReader->Column(column);
+		if (frame < 0 || (std::uint64_t)frame >= rkColumn.frameCount)
+		{
+			throw gcnew Exception("The frame index is out of range.");
+		}
+
+		std::vector<std::string> labels;
+		const double* pkData = nullptr;
+		try {
+			labels = pReader->Labels(rkColumn.labelSet);
+			units = ToManagedString(pReader->String(rkColumn.units));
+			pkData = pReader->Data(column);
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+
+		List<String^>^ nameList = gcnew List<String^>((int)labels.size());
+		for (const std::string& rkLabel : labels)
+		{
+			nameList->Add(ToManagedString(rkLabel));
+		}
+
+		rowCount = (int)rkColumn.rowCount;
+		names = nameList;
+		return pkData + (size_t)frame * (size_t)rkColumn.rowCount;
+	}
+}
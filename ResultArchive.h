@@ -0,0 +1,151 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "ResultArchiveFormat.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	ref class SimulationResult;
+
+	/// <summary>
+	/// Writes simulation results to a versioned, column-oriented binary archive. Each column holds one metric of one run.
+	/// </summary>
+	public ref class ResultArchiveWriter
+	{
+	public:
+		/// <summary>
+		/// Creates a result archive. Columns are streamed to the file as they are added.
+		/// </summary>
+		/// <param name="filePath">The path to the archive file</param>
+		/// <returns name="ResultArchiveWriter">The archive writer</returns>
+		static ResultArchiveWriter^ ByFilePath(String^ filePath);
+
+		/// <summary>
+		/// Adds a simulation result as a column. The summary metrics of its simulation are added once per run.
+		/// </summary>
+		/// <param name="runName">The name of the simulation run</param>
+		/// <param name="metricName">The name of the metric</param>
+		/// <param name="simulationResult">The simulation result</param>
+		void AddResult(String^ runName, String^ metricName, SimulationResult^ simulationResult);
+
+		/// <summary>
+		/// Adds a time series as a column. Each frame holds one value per name.
+		/// </summary>
+		/// <param name="runName">The name of the simulation run</param>
+		/// <param name="metricName">The name of the metric</param>
+		/// <param name="units">The units of the values</param>
+		/// <param name="names">The names of the rows, usually the space names</param>
+		/// <param name="frames">The values, one list per time step</param>
+		void AddTimeSeries(String^ runName, String^ metricName, String^ units, IList<String^>^ names, IList<IList<double>^>^ frames);
+
+		/// <summary>
+		/// Writes the archive index and closes the file.
+		/// </summary>
+		void Close();
+
+		/// <summary>
+		/// The metric name under which the summary metrics of a run are stored.
+		/// </summary>
+		literal String^ SummaryMetricName = "Summary";
+
+		~ResultArchiveWriter();
+		!ResultArchiveWriter();
+
+	internal:
+		ResultArchiveWriter(String^ filePath);
+
+	protected:
+		TopologicEnergyCore::ResultArchiveWriter* m_pWriter;
+		HashSet<String^>^ m_summaryRuns;
+	};
+
+	/// <summary>
+	/// A memory-mapped result archive. Reading a metric only touches the columns that hold it.
+	/// </summary>
+	public ref class ResultArchive
+	{
+	public:
+		/// <summary>
+		/// Exports simulation results to a result archive. The n-th result is stored under the n-th run and metric names.
+		/// </summary>
+		/// <param name="simulationResults">The simulation results</param>
+		/// <param name="runNames">The names of the simulation runs</param>
+		/// <param name="metricNames">The names of the metrics</param>
+		/// <param name="filePath">The path to the archive file</param>
+		/// <returns name="bool">True if the export succeeds, otherwise false</returns>
+		static bool Export(IList<SimulationResult^>^ simulationResults, IList<String^>^ runNames, IList<String^>^ metricNames, String^ filePath);
+
+		/// <summary>
+		/// Opens a result archive.
+		/// </summary>
+		/// <param name="filePath">The path to the archive file</param>
+		/// <returns name="ResultArchive">The result archive</returns>
+		static ResultArchive^ ByFilePath(String^ filePath);
+
+		/// <summary>
+		/// Returns the simulation result of a run.
+		/// </summary>
+		/// <param name="runName">The name of the simulation run</param>
+		/// <param name="metricName">The name of the metric</param>
+		/// <param name="frame">The time step, 0 for scalar results</param>
+		/// <returns name="SimulationResult">The simulation result</returns>
+		SimulationResult^ Result(String^ runName, String^ metricName, [Autodesk::DesignScript::Runtime::DefaultArgument("0")] int frame);
+
+		/// <summary>
+		/// Returns the values of a metric in every run that contains it, without reading the other metrics.
+		/// </summary>
+		/// <param name="metricName">The name of the metric</param>
+		/// <param name="frame">The time step, 0 for scalar results</param>
+		/// <returns name="Dictionary">The values per run name</returns>
+		Dictionary<String^, IList<double>^>^ ValuesByRun(String^ metricName, [Autodesk::DesignScript::Runtime::DefaultArgument("0")] int frame);
+
+		/// <summary>
+		/// Returns the names of the simulation runs.
+		/// </summary>
+		property IList<String^>^ Runs
+		{
+			IList<String^>^ get();
+		}
+
+		/// <summary>
+		/// Returns the names of the metrics.
+		/// </summary>
+		property IList<String^>^ Metrics
+		{
+			IList<String^>^ get();
+		}
+
+		~ResultArchive();
+		!ResultArchive();
+
+	internal:
+		ResultArchive(TopologicEnergyCore::ResultArchiveReader* pReader);
+
+		// The native reader; throws ObjectDisposedException once the archive has been disposed.
+		TopologicEnergyCore::ResultArchiveReader* Reader();
+
+		// Points into the mapped file; the pointer is valid as long as the archive is alive.
+		const double* ColumnData(String^ runName, String^ metricName, int frame, int% rowCount, IList<String^>^% names, String^% units);
+
+	protected:
+		TopologicEnergyCore::ResultArchiveReader* m_pReader;
+	};
+}
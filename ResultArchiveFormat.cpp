@@ -0,0 +1,358 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ResultArchiveFormat.h"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		// count x elementSize, checked against maximumSize before multiplying: the counts come from the
+		// file, and a product that wraps around would pass the bounds check of MappedFile::At.
+		std::uint64_t CheckedSize(std::uint64_t count, std::uint64_t elementSize, std::uint64_t maximumSize)
+		{
+			if (elementSize != 0 && count > maximumSize / elementSize)
+			{
+				throw std::runtime_error("The result archive is truncated.");
+			}
+			return count * elementSize;
+		}
+	}
+
+	ResultArchiveWriter::ResultArchiveWriter(const std::string& rkPath)
+		: m_pFile(nullptr)
+		, m_position(0)
+		, m_isFinished(false)
+	{
+#ifdef _WIN32
+		fopen_s(&m_pFile, rkPath.c_str(), "wb");
+#else
+		m_pFile = fopen(rkPath.c_str(), "wb");
+#endif
+		if (m_pFile == nullptr)
+		{
+			throw std::runtime_error("Fails to create the result archive " + rkPath + ".");
+		}
+
+		// Placeholder, rewritten by Finish()
+		ArchiveHeader header;
+		memset(&header, 0, sizeof(ArchiveHeader));
+		Write(&header, sizeof(ArchiveHeader));
+	}
+
+	ResultArchiveWriter::~ResultArchiveWriter()
+	{
+		if (m_pFile != nullptr)
+		{
+			fclose(m_pFile);
+		}
+	}
+
+	void ResultArchiveWriter::AddColumn(
+		const std::string& rkRunName,
+		const std::string& rkMetricName,
+		const std::string& rkUnits,
+		const std::vector<std::string>& rkLabels,
+		const double* pkValues,
+		std::uint64_t rowCount,
+		std::uint64_t frameCount)
+	{
+		if (m_isFinished)
+		{
+			throw std::runtime_error("The result archive has already been finished.");
+		}
+
+		if (rkLabels.size() != rowCount)
+		{
+			throw std::runtime_error("The number of labels does not match the number of rows.");
+		}
+
+		ArchiveColumnEntry column;
+		column.runName = Intern(rkRunName);
+		column.metricName = Intern(rkMetricName);
+		if (!m_columnIds.insert(std::make_pair(column.runName, column.metricName)).second)
+		{
+			throw std::runtime_error("The result archive already contains the metric " + rkMetricName + " for the run " + rkRunName + ".");
+		}
+		column.units = Intern(rkUnits);
+		column.labelSet = InternLabels(rkLabels);
+		column.rowCount = rowCount;
+		column.frameCount = frameCount;
+		column.dataOffset = m_position;
+		Write(pkValues, rowCount * frameCount * sizeof(double));
+		m_columns.push_back(column);
+	}
+
+	void ResultArchiveWriter::Finish()
+	{
+		if (m_isFinished)
+		{
+			return;
+		}
+
+		ArchiveHeader header;
+		memset(&header, 0, sizeof(ArchiveHeader));
+		memcpy(header.magic, ArchiveMagic, sizeof(ArchiveMagic));
+		header.version = ArchiveVersion;
+		header.columnCount = (std::uint32_t)m_columns.size();
+		header.stringCount = (std::uint32_t)m_strings.size();
+		header.labelSetCount = (std::uint32_t)m_labelSets.size();
+
+		// String table
+		header.stringTableOffset = m_position;
+		std::uint64_t stringOffset = m_position + m_strings.size() * sizeof(ArchiveStringEntry);
+		for (const std::string& rkString : m_strings)
+		{
+			ArchiveStringEntry entry;
+			entry.offset = stringOffset;
+			entry.length = (std::uint32_t)rkString.size();
+			entry.reserved = 0;
+			Write(&entry, sizeof(ArchiveStringEntry));
+			stringOffset += rkString.size();
+		}
+		for (const std::string& rkString : m_strings)
+		{
+			Write(rkString.data(), rkString.size());
+		}
+		Align();
+
+		// Label set table
+		header.labelSetTableOffset = m_position;
+		std::uint64_t labelOffset = m_position + m_labelSets.size() * sizeof(ArchiveLabelSetEntry);
+		for (const std::vector<std::uint32_t>& rkLabelSet : m_labelSets)
+		{
+			ArchiveLabelSetEntry entry;
+			entry.offset = labelOffset;
+			entry.count = rkLabelSet.size();
+			Write(&entry, sizeof(ArchiveLabelSetEntry));
+			labelOffset += rkLabelSet.size() * sizeof(std::uint32_t);
+		}
+		for (const std::vector<std::uint32_t>& rkLabelSet : m_labelSets)
+		{
+			Write(rkLabelSet.data(), rkLabelSet.size() * sizeof(std::uint32_t));
+		}
+		Align();
+
+		// Column table
+		header.columnTableOffset = m_position;
+		Write(m_columns.data(), m_columns.size() * sizeof(ArchiveColumnEntry));
+		header.fileSize = m_position;
+
+		if (fseek(m_pFile, 0, SEEK_SET) != 0 ||
+			fwrite(&header, sizeof(ArchiveHeader), 1, m_pFile) != 1)
+		{
+			throw std::runtime_error("Fails to write the result archive header.");
+		}
+
+		fclose(m_pFile);
+		m_pFile = nullptr;
+		m_isFinished = true;
+	}
+
+	std::uint32_t ResultArchiveWriter::Intern(const std::string& rkString)
+	{
+		std::map<std::string, std::uint32_t>::const_iterator kIterator = m_stringIds.find(rkString);
+		if (kIterator != m_stringIds.end())
+		{
+			return kIterator->second;
+		}
+
+		std::uint32_t id = (std::uint32_t)m_strings.size();
+		m_strings.push_back(rkString);
+		m_stringIds[rkString] = id;
+		return id;
+	}
+
+	std::uint32_t ResultArchiveWriter::InternLabels(const std::vector<std::string>& rkLabels)
+	{
+		std::vector<std::uint32_t> labelSet;
+		labelSet.reserve(rkLabels.size());
+		for (const std::string& rkLabel : rkLabels)
+		{
+			labelSet.push_back(Intern(rkLabel));
+		}
+
+		// Runs of the same model share one label set
+		std::map<std::vector<std::uint32_t>, std::uint32_t>::const_iterator kIterator = m_labelSetIds.find(labelSet);
+		if (kIterator != m_labelSetIds.end())
+		{
+			return kIterator->second;
+		}
+
+		std::uint32_t id = (std::uint32_t)m_labelSets.size();
+		m_labelSets.push_back(labelSet);
+		m_labelSetIds[labelSet] = id;
+		return id;
+	}
+
+	void ResultArchiveWriter::Write(const void* pkData, std::uint64_t size)
+	{
+		if (size > 0 && fwrite(pkData, 1, (std::size_t)size, m_pFile) != size)
+		{
+			throw std::runtime_error("Fails to write to the result archive.");
+		}
+		m_position += size;
+	}
+
+	void ResultArchiveWriter::Align()
+	{
+		static const unsigned char kPadding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		std::uint64_t remainder = m_position % 8;
+		if (remainder != 0)
+		{
+			std::uint64_t paddingSize = 8 - remainder;
+			if (fwrite(kPadding, 1, (std::size_t)paddingSize, m_pFile) != paddingSize)
+			{
+				throw std::runtime_error("Fails to write to the result archive.");
+			}
+			m_position += paddingSize;
+		}
+	}
+
+	ResultArchiveReader::ResultArchiveReader(const std::string& rkPath)
+		: m_pFile(nullptr)
+		, m_columnCount(0)
+		, m_pkHeader(nullptr)
+		, m_pkStrings(nullptr)
+		, m_pkLabelSets(nullptr)
+		, m_pkColumns(nullptr)
+	{
+		// Owned here until the tables are validated: the destructor does not run if the constructor throws.
+		std::unique_ptr<MappedFile> pFile(new MappedFile(rkPath, sizeof(ArchiveHeader)));
+		m_pFile = pFile.get();
+		m_pkHeader = (const ArchiveHeader*)m_pFile->Data();
+		if (memcmp(m_pkHeader->magic, ArchiveMagic, sizeof(ArchiveMagic)) != 0 ||
+			m_pkHeader->version != ArchiveVersion ||
+			m_pkHeader->fileSize != m_pFile->Size())
+		{
+			throw std::runtime_error("The file " + rkPath + " is not a valid result archive.");
+		}
+
+		m_columnCount = m_pkHeader->columnCount;
+		m_pkStrings = (const ArchiveStringEntry*)At(m_pkHeader->stringTableOffset, m_pkHeader->stringCount * sizeof(ArchiveStringEntry));
+		m_pkLabelSets = (const ArchiveLabelSetEntry*)At(m_pkHeader->labelSetTableOffset, m_pkHeader->labelSetCount * sizeof(ArchiveLabelSetEntry));
+		m_pkColumns = (const ArchiveColumnEntry*)At(m_pkHeader->columnTableOffset, m_columnCount * sizeof(ArchiveColumnEntry));
+
+		// Only the index is read here; the column blocks stay untouched until requested.
+		for (std::uint32_t i = 0; i < m_pkHeader->stringCount; ++i)
+		{
+			m_stringIds[String(i)] = i;
+		}
+		for (std::size_t i = 0; i < m_columnCount; ++i)
+		{
+			if (!m_columnIds.insert(std::make_pair(std::make_pair(m_pkColumns[i].runName, m_pkColumns[i].metricName), i)).second)
+			{
+				throw std::runtime_error("The result archive " + rkPath + " contains the same metric twice for a run.");
+			}
+		}
+		pFile.release();
+	}
+
+	ResultArchiveReader::~ResultArchiveReader()
+	{
+		delete m_pFile;
+	}
+
+	const ArchiveColumnEntry& ResultArchiveReader::Column(std::size_t index) const
+	{
+		if (index >= m_columnCount)
+		{
+			throw std::out_of_range("The column index is out of range.");
+		}
+		return m_pkColumns[index];
+	}
+
+	std::string ResultArchiveReader::String(std::uint32_t id) const
+	{
+		if (id >= m_pkHeader->stringCount)
+		{
+			throw std::out_of_range("The string id is out of range.");
+		}
+		const ArchiveStringEntry& rkEntry = m_pkStrings[id];
+		return std::string((const char*)At(rkEntry.offset, rkEntry.length), rkEntry.length);
+	}
+
+	std::vector<std::string> ResultArchiveReader::Labels(std::uint32_t labelSet) const
+	{
+		if (labelSet >= m_pkHeader->labelSetCount)
+		{
+			throw std::out_of_range("The label set id is out of range.");
+		}
+		const ArchiveLabelSetEntry& rkEntry = m_pkLabelSets[labelSet];
+		const std::uint32_t* pkIds = (const std::uint32_t*)At(rkEntry.offset, CheckedSize(rkEntry.count, sizeof(std::uint32_t), m_pFile->Size()));
+
+		std::vector<std::string> labels;
+		labels.reserve((std::size_t)rkEntry.count);
+		for (std::uint64_t i = 0; i < rkEntry.count; ++i)
+		{
+			labels.push_back(String(pkIds[i]));
+		}
+		return labels;
+	}
+
+	int ResultArchiveReader::FindColumn(const std::string& rkRunName, const std::string& rkMetricName) const
+	{
+		std::map<std::string, std::uint32_t>::const_iterator kRunIterator = m_stringIds.find(rkRunName);
+		std::map<std::string, std::uint32_t>::const_iterator kMetricIterator = m_stringIds.find(rkMetricName);
+		if (kRunIterator == m_stringIds.end() || kMetricIterator == m_stringIds.end())
+		{
+			return -1;
+		}
+
+		std::map<std::pair<std::uint32_t, std::uint32_t>, std::size_t>::const_iterator kIterator =
+			m_columnIds.find(std::make_pair(kRunIterator->second, kMetricIterator->second));
+		if (kIterator == m_columnIds.end())
+		{
+			return -1;
+		}
+		return (int)kIterator->second;
+	}
+
+	std::vector<std::size_t> ResultArchiveReader::FindColumns(const std::string& rkMetricName) const
+	{
+		std::vector<std::size_t> columns;
+		std::map<std::string, std::uint32_t>::const_iterator kMetricIterator = m_stringIds.find(rkMetricName);
+		if (kMetricIterator == m_stringIds.end())
+		{
+			return columns;
+		}
+
+		for (std::size_t i = 0; i < m_columnCount; ++i)
+		{
+			if (m_pkColumns[i].metricName == kMetricIterator->second)
+			{
+				columns.push_back(i);
+			}
+		}
+		return columns;
+	}
+
+	const double* ResultArchiveReader::Data(std::size_t column) const
+	{
+		const ArchiveColumnEntry& rkColumn = Column(column);
+		std::uint64_t valueCount = CheckedSize(rkColumn.rowCount, rkColumn.frameCount, m_pFile->Size());
+		return (const double*)At(rkColumn.dataOffset, CheckedSize(valueCount, sizeof(double), m_pFile->Size()));
+	}
+
+	const unsigned char* ResultArchiveReader::At(std::uint64_t offset, std::uint64_t size) const
+	{
+		return m_pFile->At(offset, size);
+	}
+}
@@ -0,0 +1,159 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Native reader and writer for the TopologicEnergy result archive (*.tea).
+//
+// Layout (little-endian, every block 8-byte aligned):
+//   ArchiveHeader
+//   column data blocks, one per column, doubles stored frame-major (frame * rowCount + row)
+//   string table:    stringCount x ArchiveStringEntry, followed by the UTF-8 bytes
+//   label set table: labelSetCount x ArchiveLabelSetEntry, followed by the uint32 string ids
+//   column table:    columnCount x ArchiveColumnEntry
+//
+// The header is rewritten when the archive is finished, so columns can be streamed to disk
+// as they are added. Readers map the file and only touch the pages of the columns they read.
+namespace TopologicEnergyCore
+{
+	const char ArchiveMagic[8] = { 'T', 'E', 'A', 'R', 'C', 'H', 'V', '\0' };
+	const std::uint32_t ArchiveVersion = 1;
+
+	struct ArchiveHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t columnCount;
+		std::uint32_t stringCount;
+		std::uint32_t labelSetCount;
+		std::uint64_t stringTableOffset;
+		std::uint64_t labelSetTableOffset;
+		std::uint64_t columnTableOffset;
+		std::uint64_t fileSize;
+		std::uint64_t reserved;
+	};
+
+	struct ArchiveStringEntry
+	{
+		std::uint64_t offset;
+		std::uint32_t length;
+		std::uint32_t reserved;
+	};
+
+	struct ArchiveLabelSetEntry
+	{
+		std::uint64_t offset;
+		std::uint64_t count;
+	};
+
+	struct ArchiveColumnEntry
+	{
+		std::uint32_t runName;
+		std::uint32_t metricName;
+		std::uint32_t units;
+		std::uint32_t labelSet;
+		std::uint64_t rowCount;
+		std::uint64_t frameCount;
+		std::uint64_t dataOffset;
+	};
+
+	class ResultArchiveWriter
+	{
+	public:
+		explicit ResultArchiveWriter(const std::string& rkPath);
+		~ResultArchiveWriter();
+
+		// Appends a column of rowCount x frameCount values. Scalar results use frameCount = 1. Throws
+		// std::runtime_error if the archive already has a column for the run and metric.
+		void AddColumn(
+			const std::string& rkRunName,
+			const std::string& rkMetricName,
+			const std::string& rkUnits,
+			const std::vector<std::string>& rkLabels,
+			const double* pkValues,
+			std::uint64_t rowCount,
+			std::uint64_t frameCount = 1);
+
+		// Writes the string, label set and column tables and the final header.
+		void Finish();
+
+	private:
+		std::uint32_t Intern(const std::string& rkString);
+		std::uint32_t InternLabels(const std::vector<std::string>& rkLabels);
+		void Write(const void* pkData, std::uint64_t size);
+		void Align();
+
+		ResultArchiveWriter(const ResultArchiveWriter&);
+		ResultArchiveWriter& operator=(const ResultArchiveWriter&);
+
+		FILE* m_pFile;
+		std::uint64_t m_position;
+		bool m_isFinished;
+		std::vector<std::string> m_strings;
+		std::map<std::string, std::uint32_t> m_stringIds;
+		std::vector<std::vector<std::uint32_t>> m_labelSets;
+		std::map<std::vector<std::uint32_t>, std::uint32_t> m_labelSetIds;
+		std::vector<ArchiveColumnEntry> m_columns;
+		std::set<std::pair<std::uint32_t, std::uint32_t>> m_columnIds;	// (run, metric) of the columns added
+	};
+
+	class ResultArchiveReader
+	{
+	public:
+		explicit ResultArchiveReader(const std::string& rkPath);
+		~ResultArchiveReader();
+
+		std::size_t ColumnCount() const { return m_columnCount; }
+		const ArchiveColumnEntry& Column(std::size_t index) const;
+
+		std::string String(std::uint32_t id) const;
+		std::vector<std::string> Labels(std::uint32_t labelSet) const;
+
+		// Returns the column index, or -1 if the run does not contain the metric.
+		int FindColumn(const std::string& rkRunName, const std::string& rkMetricName) const;
+
+		// Returns the indices of the columns holding the metric, one per run, in file order.
+		std::vector<std::size_t> FindColumns(const std::string& rkMetricName) const;
+
+		// Points directly into the mapped file; valid as long as the reader is alive.
+		const double* Data(std::size_t column) const;
+
+	private:
+		ResultArchiveReader(const ResultArchiveReader&);
+		ResultArchiveReader& operator=(const ResultArchiveReader&);
+
+		const unsigned char* At(std::uint64_t offset, std::uint64_t size) const;
+
+		MappedFile* m_pFile;
+		std::size_t m_columnCount;
+		const ArchiveHeader* m_pkHeader;
+		const ArchiveStringEntry* m_pkStrings;
+		const ArchiveLabelSetEntry* m_pkLabelSets;
+		const ArchiveColumnEntry* m_pkColumns;
+		std::map<std::string, std::uint32_t> m_stringIds;
+		std::map<std::pair<std::uint32_t, std::uint32_t>, std::size_t> m_columnIds;
+	};
+}
@@ -0,0 +1,123 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Checks that the result archive rejects what it cannot read back unambiguously: a second column for
+// the same run and metric, and a column whose size wraps around when computed from its counts.
+
+#include "ResultArchiveFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* const ArchivePath = "result-archive-test.tea";
+
+	void WriteArchive()
+	{
+		const double values[4] = { 1.0, 2.0, 3.0, 4.0 };
+		std::vector<std::string> labels = { "STORY_1_SPACE_1", "STORY_1_SPACE_2" };
+		TopologicEnergyCore::ResultArchiveWriter writer(ArchivePath);
+		writer.AddColumn("Baseline", "Heating", "kWh", labels, values, 2, 2);
+		writer.AddColumn("Baseline", "Cooling", "kWh", labels, values, 2, 1);
+		writer.Finish();
+	}
+
+	// Overwrites the counts of the first column in place.
+	void PatchFirstColumn(std::uint64_t rowCount, std::uint64_t frameCount)
+	{
+		FILE* pFile = fopen(ArchivePath, "r+b");
+		if (pFile == nullptr)
+		{
+			throw std::runtime_error("Fails to open the test archive.");
+		}
+
+		TopologicEnergyCore::ArchiveHeader header;
+		TopologicEnergyCore::ArchiveColumnEntry column;
+		bool isPatched = fread(&header, sizeof(header), 1, pFile) == 1 &&
+			fseek(pFile, (long)header.columnTableOffset, SEEK_SET) == 0 &&
+			fread(&column, sizeof(column), 1, pFile) == 1;
+		if (isPatched)
+		{
+			column.rowCount = rowCount;
+			column.frameCount = frameCount;
+			isPatched = fseek(pFile, (long)header.columnTableOffset, SEEK_SET) == 0 &&
+				fwrite(&column, sizeof(column), 1, pFile) == 1;
+		}
+		fclose(pFile);
+		if (!isPatched)
+		{
+			throw std::runtime_error("Fails to patch the test archive.");
+		}
+	}
+}
+
+int main()
+{
+	std::vector<std::string> failures;
+	try
+	{
+		WriteArchive();
+		TopologicEnergyCore::ResultArchiveReader reader(ArchivePath);
+		int column = reader.FindColumn("Baseline", "Heating");
+		if (column < 0 || reader.Data(column)[3] != 4.0 || reader.Labels(reader.Column(column).labelSet).size() != 2)
+		{
+			failures.push_back("The heating column does not read back.");
+		}
+	}
+	catch (const std::exception& rkException)
+	{
+		failures.push_back(std::string("Round trip: ") + rkException.what());
+	}
+
+	try
+	{
+		const double value = 0.0;
+		std::vector<std::string> labels = { "STORY_1_SPACE_1" };
+		TopologicEnergyCore::ResultArchiveWriter writer(ArchivePath);
+		writer.AddColumn("Baseline", "Heating", "kWh", labels, &value, 1);
+		writer.AddColumn("Baseline", "Heating", "kWh", labels, &value, 1);
+		failures.push_back("A second column for the same run and metric is accepted.");
+	}
+	catch (const std::runtime_error&)
+	{
+	}
+
+	// 2^61 rows x 8 frames x 8 bytes wraps around to 0 bytes, which would pass the bounds check.
+	try
+	{
+		WriteArchive();
+		PatchFirstColumn(std::uint64_t(1) << 61, 8);
+		TopologicEnergyCore::ResultArchiveReader reader(ArchivePath);
+		reader.Data(0);
+		failures.push_back("A column whose size wraps around is read.");
+	}
+	catch (const std::runtime_error&)
+	{
+	}
+
+	std::remove(ArchivePath);
+	for (const std::string& rkFailure : failures)
+	{
+		std::cerr << rkFailure << "\n";
+	}
+	return failures.empty() ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ShadingFilter.h"
+#include "CellGeometry.h"
+
+using namespace System::Globalization;
+using namespace System::IO;
+
+namespace TopologicEnergy
+{
+	ShadingFilter^ ShadingFilter::ByParameters(double maxDistance, double minHeight, double minElevation, bool mergeCoplanar, double tolerance)
+	{
+		if (maxDistance <= 0.0)
+		{
+			throw gcnew Exception("The maximum distance must have a positive value.");
+		}
+
+		if (minElevation < 0.0 || minElevation >= 90.0)
+		{
+			throw gcnew Exception("The minimum elevation must be between 0 and 90 degrees.");
+		}
+
+		if (tolerance <= 0.0)
+		{
+			throw gcnew Exception("The tolerance must have a positive value.");
+		}
+
+		return gcnew ShadingFilter(maxDistance, minHeight, minElevation, mergeCoplanar, tolerance);
+	}
+
+	double ShadingFilter::MaxDistance::get()
+	{
+		return m_maxDistance;
+	}
+
+	double ShadingFilter::MinHeight::get()
+	{
+		return m_minHeight;
+	}
+
+	double ShadingFilter::MinElevation::get()
+	{
+		return m_minElevation;
+	}
+
+	bool ShadingFilter::MergeCoplanar::get()
+	{
+		return m_mergeCoplanar;
+	}
+
+	IList<IList<Vertex^>^>^ ShadingFilter::Apply(IList<Face^>^ contextFaces, CellGeometry^ cellGeometry, String^ weatherFilePath, double northAxis)
+	{
+		std::vector<TopologicEnergyCore::Polygon> polygons;
+		polygons.reserve(contextFaces->Count);
+		for each(Face^ contextFace in contextFaces)
+		{
+			TopologicEnergyCore::Polygon polygon;
+			for each(Vertex^ vertex in contextFace->Vertices)
+			{
+				TopologicEnergyCore::Point point = { { vertex->X, vertex->Y, vertex->Z } };
+				polygon.push_back(point);
+			}
+			polygons.push_back(polygon);
+		}
+
+		TopologicEnergyCore::Point buildingMin;
+		TopologicEnergyCore::Point buildingMax;
+		cellGeometry->Extents(buildingMin.data(), buildingMax.data());
+
+		Nullable<double> latitude = LatitudeByWeatherFile(weatherFilePath);
+
+		TopologicEnergyCore::ShadingFilterParameters parameters;
+		parameters.maxDistance = m_maxDistance;
+		parameters.minHeight = m_minHeight;
+		parameters.minElevation = m_minElevation;
+		parameters.hasLatitude = latitude.HasValue;
+		parameters.latitude = latitude.HasValue ? latitude.Value : 0.0;
+		parameters.northAxis = northAxis;
+		parameters.mergeCoplanar = m_mergeCoplanar;
+		parameters.tolerance = m_tolerance;
+
+		std::vector<TopologicEnergyCore::Polygon> filteredPolygons = TopologicEnergyCore::FilterShadingPolygons(polygons, buildingMin, buildingMax, parameters);
+
+		List<IList<Vertex^>^>^ vertexLists = gcnew List<IList<Vertex^>^>((int)filteredPolygons.size());
+		for (const TopologicEnergyCore::Polygon& rkPolygon : filteredPolygons)
+		{
+			List<Vertex^>^ vertices = gcnew List<Vertex^>((int)rkPolygon.size());
+			for (const TopologicEnergyCore::Point& rkPoint : rkPolygon)
+			{
+				vertices->Add(Vertex::ByCoordinates(rkPoint[0], rkPoint[1], rkPoint[2]));
+			}
+			vertexLists->Add(vertices);
+		}
+		return vertexLists;
+	}
+
+	Nullable<double> ShadingFilter::LatitudeByWeatherFile(String^ weatherFilePath)
+	{
+		if (String::IsNullOrEmpty(weatherFilePath) || !File::Exists(weatherFilePath))
+		{
+			return Nullable<double>();
+		}
+
+		// LOCATION,City,State,Country,Source,WMO,Latitude,Longitude,TimeZone,Elevation
+		StreamReader^ reader = gcnew StreamReader(weatherFilePath);
+		String^ locationLine = reader->ReadLine();
+		delete reader;
+
+		if (locationLine == nullptr || !locationLine->StartsWith("LOCATION", StringComparison::OrdinalIgnoreCase))
+		{
+			return Nullable<double>();
+		}
+
+		array<String^>^ fields = locationLine->Split(',');
+		double latitude = 0.0;
+		if (fields->Length < 7 || !Double::TryParse(fields[6], NumberStyles::Float, CultureInfo::InvariantCulture, latitude))
+		{
+			return Nullable<double>();
+		}
+		return latitude;
+	}
+
+	ShadingFilter::ShadingFilter(double maxDistance, double minHeight, double minElevation, bool mergeCoplanar, double tolerance)
+		: m_maxDistance(maxDistance)
+		, m_minHeight(minHeight)
+		, m_minElevation(minElevation)
+		, m_mergeCoplanar(mergeCoplanar)
+		, m_tolerance(tolerance)
+	{
+
+	}
+}
@@ -0,0 +1,100 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "ShadingKernels.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace Topologic;
+
+namespace TopologicEnergy
+{
+	ref class CellGeometry;
+
+	/// <summary>
+	/// Preprocesses the context faces before they become shading surfaces: drops the faces that cannot shade the building
+	/// and merges coplanar neighbours, which reduces the cost of the EnergyPlus shading calculations.
+	/// </summary>
+	public ref class ShadingFilter
+	{
+	public:
+		/// <summary>
+		/// Creates a shading filter. If the weather file has a location, the faces lying only where the sun never is at its latitude are dropped too.
+		/// </summary>
+		/// <param name="maxDistance">The horizontal distance from the building beyond which context faces are dropped</param>
+		/// <param name="minHeight">The context faces whose top is less than this height above the bottom of the building are dropped</param>
+		/// <param name="minElevation">The context faces seen under less than this angle (in degrees) from the building are dropped</param>
+		/// <param name="mergeCoplanar">If true, coplanar context faces sharing edges are merged</param>
+		/// <param name="tolerance">The tolerance of the coplanarity and shared-edge tests</param>
+		/// <returns name="ShadingFilter">The shading filter</returns>
+		static ShadingFilter^ ByParameters(
+			[Autodesk::DesignScript::Runtime::DefaultArgument("200.0")] double maxDistance,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("0.0")] double minHeight,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("1.0")] double minElevation,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("true")] bool mergeCoplanar,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("0.0001")] double tolerance);
+
+		/// <summary>
+		/// Returns the horizontal distance from the building beyond which context faces are dropped.
+		/// </summary>
+		property double MaxDistance
+		{
+			double get();
+		}
+
+		/// <summary>
+		/// Returns the height above the bottom of the building the top of a context face must reach.
+		/// </summary>
+		property double MinHeight
+		{
+			double get();
+		}
+
+		/// <summary>
+		/// Returns the angle (in degrees) under which a context face must be seen from the building.
+		/// </summary>
+		property double MinElevation
+		{
+			double get();
+		}
+
+		/// <summary>
+		/// Returns true if coplanar context faces are merged.
+		/// </summary>
+		property bool MergeCoplanar
+		{
+			bool get();
+		}
+
+	internal:
+		// Returns the polygons of the context faces to turn into shading surfaces.
+		IList<IList<Vertex^>^>^ Apply(IList<Face^>^ contextFaces, CellGeometry^ cellGeometry, String^ weatherFilePath, double northAxis);
+
+		// Reads the latitude from the LOCATION line of an EPW file, or returns no value.
+		static Nullable<double> LatitudeByWeatherFile(String^ weatherFilePath);
+
+	private:
+		ShadingFilter(double maxDistance, double minHeight, double minElevation, bool mergeCoplanar, double tolerance);
+
+		double m_maxDistance;
+		double m_minHeight;
+		double m_minElevation;
+		bool m_mergeCoplanar;
+		double m_tolerance;
+	};
+}
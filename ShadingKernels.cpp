@@ -0,0 +1,280 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ShadingKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		const double Pi = 3.14159265358979323846;
+		const double MaxDeclination = 23.44;
+
+		struct Box
+		{
+			Point minPoint;
+			Point maxPoint;
+		};
+
+		Box BoundingBox(const Polygon& rkPolygon)
+		{
+			Box box;
+			box.minPoint.fill(std::numeric_limits<double>::max());
+			box.maxPoint.fill(-std::numeric_limits<double>::max());
+			for (const Point& rkPoint : rkPolygon)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					box.minPoint[k] = std::min(box.minPoint[k], rkPoint[k]);
+					box.maxPoint[k] = std::max(box.maxPoint[k], rkPoint[k]);
+				}
+			}
+			return box;
+		}
+
+		// Horizontal distance between two boxes, 0 if their footprints overlap.
+		double HorizontalDistance(const Box& rkBox, const Point& rkMin, const Point& rkMax)
+		{
+			double dx = std::max(0.0, std::max(rkBox.minPoint[0] - rkMax[0], rkMin[0] - rkBox.maxPoint[0]));
+			double dy = std::max(0.0, std::max(rkBox.minPoint[1] - rkMax[1], rkMin[1] - rkBox.maxPoint[1]));
+			return std::sqrt(dx * dx + dy * dy);
+		}
+
+		// True if every direction from the building footprint to the face footprint has a true azimuth
+		// within halfWidth degrees of centre. The directions between two rectangles form a convex set whose
+		// corners are the differences of the corners, and the sector is convex (less than 180 degrees).
+		bool IsInSector(const Box& rkBox, const Point& rkMin, const Point& rkMax, double northAxis, double centre, double halfWidth)
+		{
+			const double buildingX[2] = { rkMin[0], rkMax[0] };
+			const double buildingY[2] = { rkMin[1], rkMax[1] };
+			const double faceX[2] = { rkBox.minPoint[0], rkBox.maxPoint[0] };
+			const double faceY[2] = { rkBox.minPoint[1], rkBox.maxPoint[1] };
+			for (double bx : buildingX)
+			{
+				for (double by : buildingY)
+				{
+					for (double fx : faceX)
+					{
+						for (double fy : faceY)
+						{
+							double dx = fx - bx;
+							double dy = fy - by;
+							if (dx == 0.0 && dy == 0.0)
+							{
+								return false;
+							}
+							double azimuth = std::atan2(dx, dy) * 180.0 / Pi + northAxis;
+							double offset = std::fmod(azimuth - centre + 540.0, 360.0) - 180.0;
+							if (std::abs(offset) >= halfWidth)
+							{
+								return false;
+							}
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		struct CellKeyHash
+		{
+			std::size_t operator()(const std::pair<std::int64_t, std::int64_t>& rkKey) const
+			{
+				return (std::size_t)(rkKey.first * 73856093LL ^ rkKey.second * 19349663LL);
+			}
+		};
+
+		typedef std::unordered_map<std::pair<std::int64_t, std::int64_t>, std::vector<std::size_t>, CellKeyHash> Grid;
+
+		void GridCells(const Box& rkBox, double cellSize, double tolerance, std::int64_t* pRange)
+		{
+			pRange[0] = (std::int64_t)std::floor((rkBox.minPoint[0] - tolerance) / cellSize);
+			pRange[1] = (std::int64_t)std::floor((rkBox.minPoint[1] - tolerance) / cellSize);
+			pRange[2] = (std::int64_t)std::floor((rkBox.maxPoint[0] + tolerance) / cellSize);
+			pRange[3] = (std::int64_t)std::floor((rkBox.maxPoint[1] + tolerance) / cellSize);
+		}
+
+		void Insert(Grid& rGrid, const Box& rkBox, double cellSize, double tolerance, std::size_t index)
+		{
+			std::int64_t range[4];
+			GridCells(rkBox, cellSize, tolerance, range);
+			for (std::int64_t x = range[0]; x <= range[2]; ++x)
+			{
+				for (std::int64_t y = range[1]; y <= range[3]; ++y)
+				{
+					rGrid[std::make_pair(x, y)].push_back(index);
+				}
+			}
+		}
+
+		bool Overlap(const Box& rkBox, const Box& rkOther, double tolerance)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				if (rkBox.minPoint[k] > rkOther.maxPoint[k] + tolerance || rkOther.minPoint[k] > rkBox.maxPoint[k] + tolerance)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		std::vector<Polygon> MergeNeighbours(std::vector<Polygon>& rPolygons, double tolerance)
+		{
+			std::size_t count = rPolygons.size();
+			std::vector<Box> boxes(count);
+			double extentSum = 0.0;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				boxes[i] = BoundingBox(rPolygons[i]);
+				extentSum += std::max(boxes[i].maxPoint[0] - boxes[i].minPoint[0], boxes[i].maxPoint[1] - boxes[i].minPoint[1]);
+			}
+			double cellSize = std::max(count > 0 ? 2.0 * extentSum / (double)count : 1.0, 10.0 * tolerance);
+
+			Grid grid;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				Insert(grid, boxes[i], cellSize, tolerance, i);
+			}
+
+			std::vector<bool> isAlive(count, true);
+			std::vector<std::size_t> candidates;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				bool isChanged = isAlive[i];
+				while (isChanged)
+				{
+					isChanged = false;
+					std::int64_t range[4];
+					GridCells(boxes[i], cellSize, tolerance, range);
+					candidates.clear();
+					for (std::int64_t x = range[0]; x <= range[2]; ++x)
+					{
+						for (std::int64_t y = range[1]; y <= range[3]; ++y)
+						{
+							Grid::const_iterator cell = grid.find(std::make_pair(x, y));
+							if (cell != grid.end())
+							{
+								candidates.insert(candidates.end(), cell->second.begin(), cell->second.end());
+							}
+						}
+					}
+					std::sort(candidates.begin(), candidates.end());
+					candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+					for (std::size_t j : candidates)
+					{
+						if (j == i || !isAlive[j] || !Overlap(boxes[i], boxes[j], tolerance) || !AreCoplanar(rPolygons[i], rPolygons[j], tolerance))
+						{
+							continue;
+						}
+
+						Polygon joined;
+						if (JoinPolygons(rPolygons[i], rPolygons[j], tolerance, joined))
+						{
+							rPolygons[i] = joined;
+							boxes[i] = BoundingBox(joined);
+							isAlive[j] = false;
+							Insert(grid, boxes[i], cellSize, tolerance, i);
+							isChanged = true;
+							break; // The candidates depend on the new bounding box
+						}
+					}
+				}
+			}
+
+			std::vector<Polygon> merged;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (isAlive[i])
+				{
+					merged.push_back(rPolygons[i]);
+				}
+			}
+			return merged;
+		}
+	}
+
+	std::vector<Polygon> FilterShadingPolygons(
+		const std::vector<Polygon>& rkPolygons,
+		const Point& rkBuildingMin,
+		const Point& rkBuildingMax,
+		const ShadingFilterParameters& rkParameters)
+	{
+		// The sector around the pole-facing direction where the sun never is: inside the solstice sunrise
+		// azimuths, cos(A) = sin(declination) / cos(latitude). There is none in the tropics, where the sun
+		// crosses the meridian on the pole side for part of the year, nor inside the polar circles.
+		bool hasSunlessSector = false;
+		double sunlessCentre = 0.0;
+		double sunlessHalfWidth = 0.0;
+		if (rkParameters.hasLatitude && std::abs(rkParameters.latitude) > MaxDeclination)
+		{
+			double cosine = std::sin(MaxDeclination * Pi / 180.0) / std::cos(rkParameters.latitude * Pi / 180.0);
+			if (cosine < 1.0)
+			{
+				hasSunlessSector = true;
+				sunlessCentre = rkParameters.latitude >= 0.0 ? 0.0 : 180.0;
+				sunlessHalfWidth = std::acos(cosine) * 180.0 / Pi;
+			}
+		}
+
+		std::vector<Polygon> kept;
+		for (const Polygon& rkPolygon : rkPolygons)
+		{
+			if (rkPolygon.size() < 3)
+			{
+				continue;
+			}
+
+			Box box = BoundingBox(rkPolygon);
+			double distance = HorizontalDistance(box, rkBuildingMin, rkBuildingMax);
+			if (distance > rkParameters.maxDistance)
+			{
+				continue;
+			}
+
+			double height = box.maxPoint[2] - rkBuildingMin[2];
+			if (height < rkParameters.minHeight || height <= rkParameters.tolerance)
+			{
+				continue;
+			}
+
+			if (distance > 0.0 && std::atan2(height, distance) * 180.0 / Pi < rkParameters.minElevation)
+			{
+				continue;
+			}
+
+			if (hasSunlessSector && IsInSector(box, rkBuildingMin, rkBuildingMax, rkParameters.northAxis, sunlessCentre, sunlessHalfWidth))
+			{
+				continue;
+			}
+
+			kept.push_back(rkPolygon);
+		}
+
+		if (!rkParameters.mergeCoplanar)
+		{
+			return kept;
+		}
+		return MergeNeighbours(kept, rkParameters.tolerance);
+	}
+}
@@ -0,0 +1,53 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "PolygonKernels.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	struct ShadingFilterParameters
+	{
+		double maxDistance;		// horizontal distance from the building beyond which faces are dropped
+		double minHeight;		// faces whose top is less than this above the bottom of the building are dropped
+		double minElevation;	// faces seen under less than this angle (degrees) from the building are dropped
+		bool hasLatitude;		// if false, the sun-path test is skipped
+		double latitude;		// degrees, positive north
+		double northAxis;		// degrees clockwise from true north to the model's +Y axis
+		bool mergeCoplanar;
+		double tolerance;
+	};
+
+	// Drops the context faces that cannot shade the building and merges the remaining coplanar
+	// neighbours. A face is dropped if:
+	// - it is farther than maxDistance from the building's bounding box,
+	// - its top is less than minHeight above the bottom of the building,
+	// - its highest point is seen under less than minElevation from the nearest point of the building, or
+	// - every direction from the building to it lies in the azimuth sector where the sun never is at the
+	//   latitude (around the pole-facing side, outside the solstice sunrise/sunset azimuths; only
+	//   between the tropics and the polar circles).
+	// Coplanar neighbours are found through a uniform grid over their bounding boxes, so merging stays
+	// close to linear in the number of faces.
+	std::vector<Polygon> FilterShadingPolygons(
+		const std::vector<Polygon>& rkPolygons,
+		const Point& rkBuildingMin,
+		const Point& rkBuildingMax,
+		const ShadingFilterParameters& rkParameters);
+}
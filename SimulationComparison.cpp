@@ -0,0 +1,156 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "SimulationComparison.h"
+#include "SimulationResult.h"
+#include "ComparisonKernels.h"
+
+namespace TopologicEnergy
+{
+	SimulationComparison^ SimulationComparison::ByResults(IList<SimulationResult^>^ simulationResults, int baselineIndex)
+	{
+		if (simulationResults == nullptr || simulationResults->Count == 0)
+		{
+			throw gcnew Exception("The input simulationResults must not be null or empty.");
+		}
+
+		if (baselineIndex < 0 || baselineIndex >= simulationResults->Count)
+		{
+			throw gcnew Exception("The baseline index is out of range.");
+		}
+
+		// Align every result by space name once. A space missing from a variant stays NaN.
+		List<String^>^ names = gcnew List<String^>();
+		Dictionary<String^, int>^ nameIndices = gcnew Dictionary<String^, int>();
+		List<IList<String^>^>^ resultNames = gcnew List<IList<String^>^>();
+		for each(SimulationResult^ simulationResult in simulationResults)
+		{
+			if (simulationResult == nullptr)
+			{
+				throw gcnew Exception("The input simulationResults contains a null result.");
+			}
+
+			IList<String^>^ variantNames = simulationResult->Names;
+			for each(String^ name in variantNames)
+			{
+				if (!nameIndices->ContainsKey(name))
+				{
+					nameIndices->Add(name, names->Count);
+					names->Add(name);
+				}
+			}
+			resultNames->Add(variantNames);
+		}
+
+		int variantCount = simulationResults->Count;
+		int zoneCount = names->Count;
+		array<double>^ values = gcnew array<double>(variantCount * zoneCount);
+		for (int i = 0; i < values->Length; ++i)
+		{
+			values[i] = Double::NaN;
+		}
+
+		for (int v = 0; v < variantCount; ++v)
+		{
+			IList<String^>^ variantNames = resultNames[v];
+			IList<double>^ variantValues = simulationResults[v]->Values;
+			int rowOffset = v * zoneCount;
+			for (int i = 0; i < variantNames->Count; ++i)
+			{
+				values[rowOffset + nameIndices[variantNames[i]]] = variantValues[i];
+			}
+		}
+
+		return gcnew SimulationComparison(names, values, variantCount, baselineIndex, simulationResults[baselineIndex]->Unit);
+	}
+
+	SimulationResult^ SimulationComparison::Deltas(int variantIndex)
+	{
+		CheckVariantIndex(variantIndex);
+		int zoneCount = m_names->Count;
+		array<double>^ deltas = gcnew array<double>(zoneCount);
+		if (zoneCount > 0)
+		{
+			pin_ptr<double> pValues = &m_values[0];
+			pin_ptr<double> pDeltas = &deltas[0];
+			TopologicEnergyCore::ComputeDeltas(pValues + variantIndex * zoneCount, pValues + m_baselineIndex * zoneCount, pDeltas, zoneCount);
+		}
+		return SimulationResult::ByNamesValues(m_names, deltas, m_unit);
+	}
+
+	SimulationResult^ SimulationComparison::Ratios(int variantIndex)
+	{
+		CheckVariantIndex(variantIndex);
+		int zoneCount = m_names->Count;
+		array<double>^ ratios = gcnew array<double>(zoneCount);
+		if (zoneCount > 0)
+		{
+			pin_ptr<double> pValues = &m_values[0];
+			pin_ptr<double> pRatios = &ratios[0];
+			TopologicEnergyCore::ComputeRatios(pValues + variantIndex * zoneCount, pValues + m_baselineIndex * zoneCount, pRatios, zoneCount);
+		}
+		return SimulationResult::ByNamesValues(m_names, ratios, "");
+	}
+
+	SimulationResult^ SimulationComparison::Ranks(int variantIndex)
+	{
+		CheckVariantIndex(variantIndex);
+		int zoneCount = m_names->Count;
+
+		// Ranking needs every variant, so it is computed for all of them on the first request.
+		if (m_ranks == nullptr)
+		{
+			m_ranks = gcnew array<int>(m_values->Length);
+			if (m_values->Length > 0)
+			{
+				pin_ptr<double> pValues = &m_values[0];
+				pin_ptr<int> pRanks = &m_ranks[0];
+				TopologicEnergyCore::ComputeRanks(pValues, m_variantCount, zoneCount, pRanks);
+			}
+		}
+
+		array<double>^ ranks = gcnew array<double>(zoneCount);
+		for (int i = 0; i < zoneCount; ++i)
+		{
+			ranks[i] = (double)m_ranks[variantIndex * zoneCount + i];
+		}
+		return SimulationResult::ByNamesValues(m_names, ranks, "");
+	}
+
+	IList<String^>^ SimulationComparison::Names::get()
+	{
+		return gcnew List<String^>(m_names);
+	}
+
+	SimulationComparison::SimulationComparison(List<String^>^ names, array<double>^ values, int variantCount, int baselineIndex, String^ unit)
+		: m_names(names)
+		, m_values(values)
+		, m_ranks(nullptr)
+		, m_variantCount(variantCount)
+		, m_baselineIndex(baselineIndex)
+		, m_unit(unit)
+	{
+
+	}
+
+	void SimulationComparison::CheckVariantIndex(int variantIndex)
+	{
+		if (variantIndex < 0 || variantIndex >= m_variantCount)
+		{
+			throw gcnew Exception("The variant index is out of range.");
+		}
+	}
+}
@@ -0,0 +1,89 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	ref class SimulationResult;
+
+	/// <summary>
+	/// Compares any number of simulation results. The results are aligned by space name once; deltas, ratios and ranks are then computed over the aligned arrays.
+	/// </summary>
+	public ref class SimulationComparison
+	{
+	public:
+		/// <summary>
+		/// Creates a comparison of simulation results against a baseline.
+		/// </summary>
+		/// <param name="simulationResults">The simulation results, one per variant</param>
+		/// <param name="baselineIndex">The index of the baseline variant</param>
+		/// <returns name="SimulationComparison">The comparison</returns>
+		static SimulationComparison^ ByResults(IList<SimulationResult^>^ simulationResults, [Autodesk::DesignScript::Runtime::DefaultArgument("0")] int baselineIndex);
+
+		/// <summary>
+		/// Returns the difference between a variant and the baseline, per space.
+		/// </summary>
+		/// <param name="variantIndex">The index of the variant</param>
+		/// <returns name="SimulationResult">The deltas</returns>
+		SimulationResult^ Deltas(int variantIndex);
+
+		/// <summary>
+		/// Returns the ratio of a variant to the baseline, per space.
+		/// </summary>
+		/// <param name="variantIndex">The index of the variant</param>
+		/// <returns name="SimulationResult">The ratios</returns>
+		SimulationResult^ Ratios(int variantIndex);
+
+		/// <summary>
+		/// Returns the rank of a variant among all variants, per space. 1 is the lowest value; variants with equal values share the lower rank.
+		/// </summary>
+		/// <param name="variantIndex">The index of the variant</param>
+		/// <returns name="SimulationResult">The ranks</returns>
+		SimulationResult^ Ranks(int variantIndex);
+
+		/// <summary>
+		/// Returns the names of the aligned spaces.
+		/// </summary>
+		property IList<String^>^ Names
+		{
+			IList<String^>^ get();
+		}
+
+		/// <summary>
+		/// Returns the number of variants.
+		/// </summary>
+		property int VariantCount
+		{
+			int get() { return m_variantCount; }
+		}
+
+	protected:
+		SimulationComparison(List<String^>^ names, array<double>^ values, int variantCount, int baselineIndex, String^ unit);
+
+		void CheckVariantIndex(int variantIndex);
+
+		List<String^>^ m_names;
+		array<double>^ m_values; // variant-major: m_values[variant * zoneCount + zone]
+		array<int>^ m_ranks;
+		int m_variantCount;
+		int m_baselineIndex;
+		String^ m_unit;
+	};
+}
@@ -0,0 +1,104 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "SimulationMetrics.h"
+#include "EnergyModel.h"
+
+namespace TopologicEnergy
+{
+	SimulationMetrics^ SimulationMetrics::BySqlFile(OpenStudio::SqlFile^ osSqlFile)
+	{
+		if (osSqlFile == nullptr)
+		{
+			throw gcnew Exception("The input osSqlFile must not be null.");
+		}
+
+		SimulationMetrics^ metrics = gcnew SimulationMetrics();
+		metrics->m_totalSiteEnergy = ToKWh(osSqlFile->totalSiteEnergy());
+		metrics->m_totalSourceEnergy = ToKWh(osSqlFile->totalSourceEnergy());
+		metrics->m_electricityTotalEndUses = ToKWh(osSqlFile->electricityTotalEndUses());
+		metrics->m_naturalGasTotalEndUses = ToKWh(osSqlFile->naturalGasTotalEndUses());
+		metrics->m_districtCoolingTotalEndUses = ToKWh(osSqlFile->districtCoolingTotalEndUses());
+		metrics->m_districtHeatingTotalEndUses = ToKWh(osSqlFile->districtHeatingTotalEndUses());
+		metrics->m_hoursHeatingSetpointNotMet = ToNullable(osSqlFile->hoursHeatingSetpointNotMet());
+		metrics->m_hoursCoolingSetpointNotMet = ToNullable(osSqlFile->hoursCoolingSetpointNotMet());
+
+		try {
+			metrics->m_peakElectricityDemand = EnergyModel::DoubleValueFromQuery(osSqlFile,
+				"DemandEndUseComponentsSummary", "Entire Facility", "End Uses", "Electricity", "Total End Uses", "W");
+		}
+		catch (...)
+		{
+			// Not every output has the demand summary report.
+		}
+
+		return metrics;
+	}
+
+	IList<String^>^ SimulationMetrics::Names::get()
+	{
+		List<String^>^ names = gcnew List<String^>();
+		names->Add("TotalSiteEnergy");
+		names->Add("TotalSourceEnergy");
+		names->Add("ElectricityTotalEndUses");
+		names->Add("NaturalGasTotalEndUses");
+		names->Add("DistrictCoolingTotalEndUses");
+		names->Add("DistrictHeatingTotalEndUses");
+		names->Add("HoursHeatingSetpointNotMet");
+		names->Add("HoursCoolingSetpointNotMet");
+		names->Add("PeakElectricityDemand");
+		return names;
+	}
+
+	IList<double>^ SimulationMetrics::Values::get()
+	{
+		List<double>^ values = gcnew List<double>();
+		values->Add(m_totalSiteEnergy.HasValue ? m_totalSiteEnergy.Value : Double::NaN);
+		values->Add(m_totalSourceEnergy.HasValue ? m_totalSourceEnergy.Value : Double::NaN);
+		values->Add(m_electricityTotalEndUses.HasValue ? m_electricityTotalEndUses.Value : Double::NaN);
+		values->Add(m_naturalGasTotalEndUses.HasValue ? m_naturalGasTotalEndUses.Value : Double::NaN);
+		values->Add(m_districtCoolingTotalEndUses.HasValue ? m_districtCoolingTotalEndUses.Value : Double::NaN);
+		values->Add(m_districtHeatingTotalEndUses.HasValue ? m_districtHeatingTotalEndUses.Value : Double::NaN);
+		values->Add(m_hoursHeatingSetpointNotMet.HasValue ? m_hoursHeatingSetpointNotMet.Value : Double::NaN);
+		values->Add(m_hoursCoolingSetpointNotMet.HasValue ? m_hoursCoolingSetpointNotMet.Value : Double::NaN);
+		values->Add(m_peakElectricityDemand.HasValue ? m_peakElectricityDemand.Value : Double::NaN);
+		return values;
+	}
+
+	SimulationMetrics::SimulationMetrics()
+	{
+
+	}
+
+	Nullable<double> SimulationMetrics::ToKWh(OpenStudio::OptionalDouble^ osGJValue)
+	{
+		Nullable<double> gjValue = ToNullable(osGJValue);
+		if (!gjValue.HasValue)
+		{
+			return gjValue;
+		}
+		return gjValue.Value * 277.8;
+	}
+
+	Nullable<double> SimulationMetrics::ToNullable(OpenStudio::OptionalDouble^ osValue)
+	{
+		if (osValue == nullptr || !osValue->is_initialized())
+		{
+			return Nullable<double>();
+		}
+		return osValue->get();
+	}
+}
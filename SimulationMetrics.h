@@ -0,0 +1,104 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// The standard summary metrics of an energy simulation. They are read from the SQL output once and cached with the simulation.
+	/// </summary>
+	public ref class SimulationMetrics
+	{
+	public:
+		/// <summary>
+		/// Returns the total site energy in kWh.
+		/// </summary>
+		property Nullable<double> TotalSiteEnergy { Nullable<double> get() { return m_totalSiteEnergy; } }
+
+		/// <summary>
+		/// Returns the total source energy in kWh.
+		/// </summary>
+		property Nullable<double> TotalSourceEnergy { Nullable<double> get() { return m_totalSourceEnergy; } }
+
+		/// <summary>
+		/// Returns the total electricity end uses in kWh.
+		/// </summary>
+		property Nullable<double> ElectricityTotalEndUses { Nullable<double> get() { return m_electricityTotalEndUses; } }
+
+		/// <summary>
+		/// Returns the total natural gas end uses in kWh.
+		/// </summary>
+		property Nullable<double> NaturalGasTotalEndUses { Nullable<double> get() { return m_naturalGasTotalEndUses; } }
+
+		/// <summary>
+		/// Returns the total district cooling end uses in kWh.
+		/// </summary>
+		property Nullable<double> DistrictCoolingTotalEndUses { Nullable<double> get() { return m_districtCoolingTotalEndUses; } }
+
+		/// <summary>
+		/// Returns the total district heating end uses in kWh.
+		/// </summary>
+		property Nullable<double> DistrictHeatingTotalEndUses { Nullable<double> get() { return m_districtHeatingTotalEndUses; } }
+
+		/// <summary>
+		/// Returns the number of hours the heating setpoint is not met.
+		/// </summary>
+		property Nullable<double> HoursHeatingSetpointNotMet { Nullable<double> get() { return m_hoursHeatingSetpointNotMet; } }
+
+		/// <summary>
+		/// Returns the number of hours the cooling setpoint is not met.
+		/// </summary>
+		property Nullable<double> HoursCoolingSetpointNotMet { Nullable<double> get() { return m_hoursCoolingSetpointNotMet; } }
+
+		/// <summary>
+		/// Returns the peak electricity demand of the facility in W.
+		/// </summary>
+		property Nullable<double> PeakElectricityDemand { Nullable<double> get() { return m_peakElectricityDemand; } }
+
+		/// <summary>
+		/// Returns the names of the metrics, in the same order as Values.
+		/// </summary>
+		property IList<String^>^ Names { IList<String^>^ get(); }
+
+		/// <summary>
+		/// Returns the values of the metrics. A metric that is not in the SQL output is NaN.
+		/// </summary>
+		property IList<double>^ Values { IList<double>^ get(); }
+
+	internal:
+		static SimulationMetrics^ BySqlFile(OpenStudio::SqlFile^ osSqlFile);
+
+	protected:
+		SimulationMetrics();
+
+		static Nullable<double> ToKWh(OpenStudio::OptionalDouble^ osGJValue);
+		static Nullable<double> ToNullable(OpenStudio::OptionalDouble^ osValue);
+
+		Nullable<double> m_totalSiteEnergy;
+		Nullable<double> m_totalSourceEnergy;
+		Nullable<double> m_electricityTotalEndUses;
+		Nullable<double> m_naturalGasTotalEndUses;
+		Nullable<double> m_districtCoolingTotalEndUses;
+		Nullable<double> m_districtHeatingTotalEndUses;
+		Nullable<double> m_hoursHeatingSetpointNotMet;
+		Nullable<double> m_hoursCoolingSetpointNotMet;
+		Nullable<double> m_peakElectricityDemand;
+	};
+}
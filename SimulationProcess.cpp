@@ -0,0 +1,166 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "SimulationProcess.h"
+#include "TraceRecorder.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace TopologicEnergyCore
+{
+#ifdef _WIN32
+	namespace
+	{
+		// Quotes an argument for CommandLineToArgvW-style parsing.
+		std::string Quote(const std::string& rkArgument)
+		{
+			if (!rkArgument.empty() && rkArgument.find_first_of(" \t\"") == std::string::npos)
+			{
+				return rkArgument;
+			}
+
+			std::string quoted = "\"";
+			std::size_t backslashCount = 0;
+			for (char character : rkArgument)
+			{
+				if (character == '\\')
+				{
+					++backslashCount;
+					continue;
+				}
+				if (character == '"')
+				{
+					quoted.append(backslashCount * 2 + 1, '\\');
+				}
+				else
+				{
+					quoted.append(backslashCount, '\\');
+				}
+				backslashCount = 0;
+				quoted.push_back(character);
+			}
+			quoted.append(backslashCount * 2, '\\');
+			quoted.push_back('"');
+			return quoted;
+		}
+	}
+#endif
+
+	int RunProcess(const std::string& rkExecutable, const std::vector<std::string>& rkArguments, const std::string& rkWorkingDirectory)
+	{
+		TraceSpan span("RunProcess");
+		span.SetAttribute("executable", rkExecutable);
+#ifdef _WIN32
+		std::string commandLine = Quote(rkExecutable);
+		for (const std::string& rkArgument : rkArguments)
+		{
+			commandLine += " " + Quote(rkArgument);
+		}
+
+		STARTUPINFOA startupInfo;
+		ZeroMemory(&startupInfo, sizeof(startupInfo));
+		startupInfo.cb = sizeof(startupInfo);
+		PROCESS_INFORMATION processInfo;
+		ZeroMemory(&processInfo, sizeof(processInfo));
+		if (!CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr,
+			rkWorkingDirectory.empty() ? nullptr : rkWorkingDirectory.c_str(), &startupInfo, &processInfo))
+		{
+			throw std::runtime_error("Fails to start " + rkExecutable + ".");
+		}
+
+		WaitForSingleObject(processInfo.hProcess, INFINITE);
+		DWORD exitCode = 0;
+		GetExitCodeProcess(processInfo.hProcess, &exitCode);
+		CloseHandle(processInfo.hThread);
+		CloseHandle(processInfo.hProcess);
+		return (int)exitCode;
+#else
+		std::vector<char*> argv;
+		argv.push_back(const_cast<char*>(rkExecutable.c_str()));
+		for (const std::string& rkArgument : rkArguments)
+		{
+			argv.push_back(const_cast<char*>(rkArgument.c_str()));
+		}
+		argv.push_back(nullptr);
+
+		pid_t processId = fork();
+		if (processId < 0)
+		{
+			throw std::runtime_error("Fails to start " + rkExecutable + ".");
+		}
+		if (processId == 0)
+		{
+			// Only async-signal-safe calls between fork and exec
+			if (!rkWorkingDirectory.empty() && chdir(rkWorkingDirectory.c_str()) != 0)
+			{
+				_exit(127);
+			}
+			execvp(argv[0], argv.data());
+			_exit(127);
+		}
+
+		int status = 0;
+		while (waitpid(processId, &status, 0) < 0)
+		{
+			if (errno != EINTR)
+			{
+				throw std::runtime_error("Fails to wait for " + rkExecutable + ".");
+			}
+		}
+		if (WIFEXITED(status))
+		{
+			// 127 is the shell convention for a command that could not be run.
+			int exitCode = WEXITSTATUS(status);
+			if (exitCode == 127)
+			{
+				throw std::runtime_error("Fails to start " + rkExecutable + ".");
+			}
+			return exitCode;
+		}
+		return -1;
+#endif
+	}
+
+	std::vector<std::string> OpenStudioArguments(const std::string& rkOswPath)
+	{
+		std::vector<std::string> arguments;
+		arguments.push_back("run");
+		arguments.push_back("-w");
+		arguments.push_back(rkOswPath);
+		return arguments;
+	}
+
+	std::vector<std::string> EnergyPlusArguments(const std::string& rkIdfPath, const std::string& rkWeatherPath, const std::string& rkOutputDirectory)
+	{
+		std::vector<std::string> arguments;
+		arguments.push_back("-x");
+		arguments.push_back("-w");
+		arguments.push_back(rkWeatherPath);
+		arguments.push_back("-d");
+		arguments.push_back(rkOutputDirectory);
+		arguments.push_back(rkIdfPath);
+		return arguments;
+	}
+}
@@ -0,0 +1,34 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	// Runs an executable with its arguments in a working directory and waits for it. Returns its exit
+	// code; throws if it cannot be started.
+	int RunProcess(const std::string& rkExecutable, const std::vector<std::string>& rkArguments, const std::string& rkWorkingDirectory);
+
+	// The arguments of "openstudio run -w <osw>", as launched by EnergySimulation.ByEnergyModel.
+	std::vector<std::string> OpenStudioArguments(const std::string& rkOswPath);
+
+	// The arguments of an EnergyPlus run of an IDF written by WriteIdf, with ExpandObjects enabled.
+	// The results, including eplusout.sql, go to rkOutputDirectory.
+	std::vector<std::string> EnergyPlusArguments(const std::string& rkIdfPath, const std::string& rkWeatherPath, const std::string& rkOutputDirectory);
+}
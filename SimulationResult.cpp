@@ -1,347 +1,419 @@
-// This file is part of Topologic software library.
-// Copyright(C) 2019, Cardiff University and University College London
-//
-// This program is free software: you can redistribute it and/or modify
-// it under the terms of the GNU Affero General Public License as published by
-// the Free Software Foundation, either version 3 of the License, or
-// (at your option) any later version.
-//
-// This program is distributed in the hope that it will be useful,
-// but WITHOUT ANY WARRANTY; without even the implied warranty of
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
-// GNU Affero General Public License for more details.
-//
-// You should have received a copy of the GNU Affero General Public License
-// along with this program. If not, see <https://www.gnu.org/licenses/>.
-
-#include "SimulationResult.h"
-#include "EnergySimulation.h"
-#include "EnergyModel.h"
-
-using namespace System::Diagnostics;
-using namespace System::IO;
-using namespace System::Linq;
-
-namespace TopologicEnergy
-{
-
-	SimulationResult^ SimulationResult::ByEnergySimulation(EnergySimulation^ energySimulation, String ^ EPReportName, String ^ EPReportForString, String ^ EPTableName, String ^ EPColumnName, String ^ EPUnits)
-	{
-		OpenStudio::OptionalDouble^ totalSE = energySimulation->OsSqlFile->totalSiteEnergy();
-
-		double totalSEGJ = totalSE->__float__();
-		double totalSEkwh = totalSEGJ * 277.8;
-		OpenStudio::OptionalDouble^ totalEU = energySimulation->OsSqlFile->electricityTotalEndUses();
-		double totalEUGJ = totalEU->__float__();
-		double totalEUkwh = totalEUGJ * 277.8;
-		OpenStudio::OptionalString^ spaceNameTemp = energySimulation->OsSpaces[0]->name();
-		
-		String^ spaceName = spaceNameTemp->get();
-		String^ EPRowName = spaceName + "_THERMAL_ZONE";
-
-		//If min and max values are not specified then calculate them from the data
-		double maxValue = 0.0;
-		try {
-			maxValue = EnergyModel::DoubleValueFromQuery(energySimulation->OsSqlFile, EPReportName, EPReportForString, EPTableName, EPColumnName, EPRowName, EPUnits);
-		}
-		catch (...)
-		{
-			throw gcnew Exception("Fails to execute SQL query. There is an incorrect argument.");
-		}
-		double minValue = maxValue;
-		for each(OpenStudio::Space^ space in energySimulation->OsSpaces)
-		{
-			OpenStudio::OptionalString^ osSpaceName = space->name();
-			String^ spaceName = osSpaceName->get();
-			EPRowName = spaceName + "_THERMAL_ZONE";
-			double aValue = 10000.0;
-			try {
-				aValue = EnergyModel::DoubleValueFromQuery(energySimulation->OsSqlFile, EPReportName, EPReportForString, EPTableName, EPColumnName, EPRowName, EPUnits);
-			}
-			catch (...)
-			{
-				throw gcnew Exception("Fails to execute SQL query. There is an incorrect argument.");
-			}
-			if (aValue > maxValue)
-			{
-				maxValue = aValue;
-			}
-			if (aValue < minValue)
-			{
-				minValue = aValue;
-			}
-		}
-
-		if (minValue <= maxValue && maxValue - minValue < 0.0001)
-		{
-			minValue = maxValue - (maxValue * 0.0001);
-		}
-
-
-		// Create a map: space name -> cell
-		Dictionary<String^, Dictionary<String^, Object^>^>^ data = gcnew Dictionary<String^, Dictionary<String^, Object^>^>();
-
-		//STEP 2: Find the cell that matches the space and set its colour.
-		int i = 0;
-		for each(OpenStudio::Space^ space in energySimulation->OsSpaces)
-		{
-			if (space == nullptr)
-			{
-				throw gcnew Exception("The energy simulation result contains a null space.");
-			}
-			++i;
-			OpenStudio::OptionalString^ osSpaceName = space->name();
-			String^ spaceName = osSpaceName->get();
-			EPRowName = spaceName + "_THERMAL_ZONE";
-			double outputVariable = 0.0;
-			try {
-				outputVariable = EnergyModel::DoubleValueFromQuery(energySimulation->OsSqlFile, EPReportName, EPReportForString, EPTableName, EPColumnName, EPRowName, EPUnits);
-			}
-			catch (...)
-			{
-				throw gcnew Exception("Fails to execute SQL query. There is an incorrect argument.");
-			}
-
-			Dictionary<String^, Object^>^ attributes = gcnew Dictionary<String^, Object^>();
-			attributes->Add("Value", outputVariable);
-			attributes->Add("Unit", EPUnits);
-			data->Add(spaceName, attributes);
-		}
-
-		return gcnew SimulationResult(data);
-	}
-
-	IList<Modifiers::GeometryColor^>^ SimulationResult::Display(EnergyModel^ energyModel, IList<DSCore::Color^>^ colors)
-	{
-		IList<DSCore::Color^>^ colorList = (IList<DSCore::Color^>^) colors;
-		if (((IList<Topology^>^)energyModel->Topology)->Count != colorList->Count)
-		{
-			throw gcnew Exception("The number of colors does not match the number of cells.");
-		}
-
-		List<Modifiers::GeometryColor^>^ dynamoGeometryColors = gcnew List<Modifiers::GeometryColor^>();
-		List<Modifiers::GeometryColor^>^ dynamoApertures = gcnew List<Modifiers::GeometryColor^>();
-		for(int i = 0; i < colorList->Count; ++i)
-		{
-			IList<Cell^>^ energyModelTopology = (IList<Cell^>^)(energyModel->Topology);
-			Cell^ cell = energyModelTopology[i];
-			DSCore::Color^ color = colorList[i];
-
-			{
-				System::Object^ cellGeometry = cell->BasicGeometry;
-				Autodesk::DesignScript::Geometry::Geometry^ dynamoGeometry = dynamic_cast<Autodesk::DesignScript::Geometry::Geometry^>(cellGeometry);
-				if (dynamoGeometry != nullptr)
-				{
-					Modifiers::GeometryColor^ dynamoGeometryColor = Modifiers::GeometryColor::ByGeometryColor(dynamoGeometry, color);
-					dynamoGeometryColors->Add(dynamoGeometryColor);
-				}else
-				{
-					// 2. Try a list of Dynamo geometries
-					List<Object^>^ listOfObjects = dynamic_cast<List<Object^>^>(cellGeometry);
-					if (listOfObjects != nullptr)
-					{
-						for each(Object^ object in listOfObjects)
-						{
-							Autodesk::DesignScript::Geometry::Geometry^ dynamoGeometry = dynamic_cast<Autodesk::DesignScript::Geometry::Geometry^>(object);
-							if (dynamoGeometry != nullptr)
-							{
-								Modifiers::GeometryColor^ dynamoGeometryColor = Modifiers::GeometryColor::ByGeometryColor(dynamoGeometry, color);
-								delete object;
-								dynamoGeometryColors->Add(dynamoGeometryColor);
-							}
-						}
-					}
-				}
-			}
-
-			DSCore::Color^ contentColor = DSCore::Color::ByARGB(255, 128, 128, 128);
-			IList<Topologic::Topology^>^ subcontents = cell->SubContents;
-			for each(Topologic::Topology^ subcontent in subcontents)
-			{
-				System::Object^ contentGeometry = subcontent->BasicGeometry;
-				Autodesk::DesignScript::Geometry::Geometry^ dynamoContentGeometry = dynamic_cast<Autodesk::DesignScript::Geometry::Geometry^>(contentGeometry);
-				if (dynamoContentGeometry != nullptr)
-				{
-					Modifiers::GeometryColor^ dynamoGeometryColor = Modifiers::GeometryColor::ByGeometryColor(dynamoContentGeometry, contentColor);
-					dynamoApertures->Add(dynamoGeometryColor);
-				}else
-				{
-					// 2. Try a list of Dynamo geometries
-					List<Object^>^ listOfObjects = dynamic_cast<List<Object^>^>(contentGeometry);
-					if (listOfObjects != nullptr)
-					{
-						for each(Object^ object in listOfObjects)
-						{
-							Autodesk::DesignScript::Geometry::Geometry^ dynamoGeometry = dynamic_cast<Autodesk::DesignScript::Geometry::Geometry^>(object);
-							if (dynamoContentGeometry != nullptr)
-							{
-								Modifiers::GeometryColor^ dynamoGeometryColor = Modifiers::GeometryColor::ByGeometryColor(dynamoContentGeometry, contentColor);
-								delete object;
-								dynamoApertures->Add(dynamoGeometryColor);
-							}
-						}
-					}
-				}
-			}
-		}
-
-		dynamoGeometryColors->AddRange(dynamoApertures);
-		return dynamoGeometryColors;
-	}
-
-	IList<IList<int>^>^ SimulationResult::LegendRGB(Nullable<double> minDomain, Nullable<double> maxDomain, int count)
-	{
-		IList<IList<int>^>^ colors = gcnew List<IList<int>^>();
-		double finalMinDomain = 0.0;
-		double finalMaxDomain = 0.0;
-		IList<double>^ ratios = LegendRatios(minDomain, maxDomain, count, finalMinDomain, finalMaxDomain);
-		for each(double ratio in ratios)
-		{
-			IList<int>^ color = EnergyModel::GetColor(ratio);
-			((List<IList<int>^>^)colors)->Add(color);
-		}
-
-		return colors;
-	}
-
-	IList<double>^ SimulationResult::LegendValues(Nullable<double> minDomain, Nullable<double> maxDomain, int count)
-	{
-		List<double>^ values = gcnew List<double>();
-		double finalMinDomain = 0.0;
-		double finalMaxDomain = 0.0;
-		IList<double>^ ratios = LegendRatios(minDomain, maxDomain, count, finalMinDomain, finalMaxDomain);
-		double deltaFinalDomain = finalMaxDomain - finalMinDomain; // Any problem with this should have been caught in LegendRatios
-		for each(double ratio in ratios)
-		{
-			double value = finalMinDomain + deltaFinalDomain * ratio;
-			values->Add(value);
-		}
-
-		return values;
-	}
-
-	IList<String^>^ SimulationResult::Names::get()
-	{
-		return gcnew List<String^>(m_data->Keys);
-	}
-
-	IList<double>^ SimulationResult::Values::get()
-	{
-		List<double>^ values = gcnew List<double>();
-		for each(KeyValuePair<String^, Dictionary<String^, Object^>^> pair in m_data)
-		{
-			Dictionary<String^, Object^>^ dictionary = pair.Value;
-			if (dictionary->ContainsKey("Value"))
-			{
-				try {
-					values->Add((double)dictionary["Value"]);
-				}
-				catch (...)
-				{
-					values->Add(-1);
-				}
-			}
-			else
-			{
-				values->Add(-1);
-			}
-		}
-		return values;
-	}
-
-	IList<double>^ SimulationResult::Domain::get()
-	{
-		IList<double>^ values = Values;
-
-		if (values->Count == 0)
-		{
-			return nullptr;
-		}
-
-		List<double>^ domain = gcnew List<double>();
-		domain->Add(Enumerable::Min(values));
-		domain->Add(Enumerable::Max(values));
-		return domain;
-	}
-
-	IList<IList<int>^>^ SimulationResult::RGB(Nullable<double> minDomain, Nullable<double> maxDomain)
-	{
-		IList<double>^ domain = Domain;
-		double finalMinDomain = Enumerable::Min(domain);
-		double finalMaxDomain = Enumerable::Max(domain);
-
-		if(minDomain.HasValue)
-		{
-			finalMinDomain = minDomain.Value;
-		}
-		if (maxDomain.HasValue)
-		{
-			finalMaxDomain = maxDomain.Value;
-		}
-
-		double deltaFinalDomain = finalMaxDomain - finalMinDomain;
-		if (deltaFinalDomain < 0.00001)
-		{
-			throw gcnew Exception("The domain is too small. Please increase it.");
-		}
-
-		IList<IList<int>^>^ colorList = gcnew List<IList<int>^>();
-		IList<double>^ values = Values;
-		for each(double value in values)
-		{
-			double ratio = (value - finalMinDomain) / deltaFinalDomain;
-			IList<int>^ rgb = EnergyModel::GetColor(ratio);
-			colorList->Add(rgb);
-		}
-
-		return colorList;
-	}
-
-	SimulationResult::SimulationResult(Dictionary<String^, Dictionary<String^, Object^>^>^ data)
-		: m_data(data)
-	{
-
-	}
-
-	SimulationResult::~SimulationResult()
-	{
-
-	}
-
-	IList<double>^ SimulationResult::LegendRatios(Nullable<double> minDomain, Nullable<double> maxDomain, int count, double% finalMinDomain, double& finalMaxDomain)
-	{
-		if (count < 2)
-		{
-			throw gcnew Exception("The number of steps must be more than 2.");
-		}
-
-		IList<double>^ domain = Domain;
-		finalMinDomain = Enumerable::Min(domain);
-		finalMaxDomain = Enumerable::Max(domain);
-
-		if (minDomain.HasValue)
-		{
-			finalMinDomain = minDomain.Value;
-		}
-		if (maxDomain.HasValue)
-		{
-			finalMaxDomain = maxDomain.Value;
-		}
-
-		double deltaFinalDomain = finalMaxDomain - finalMinDomain;
-		if (deltaFinalDomain < 0.00001)
-		{
-			throw gcnew Exception("The domain is too small. Please provide a larger interval.");
-		}
-
-		List<double>^ ratios = gcnew List<double>();
-		double countMinusOne = (double)(count-1);
-		for (int i = 0; i < count; ++i)
-		{
-			double doubleI = (double)i;	// 0..10
-			double ratio = doubleI / countMinusOne; // 0..1
-			ratios->Add(ratio);
-		}
-		return ratios;
-	}
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "SimulationResult.h"
+#include "EnergySimulation.h"
+#include "EnergyModel.h"
+#include "NativeInterop.h"
+#include "RenderCache.h"
+#include "SimulationMetrics.h"
+#include "StatisticsKernels.h"
+#include "ColorMapKernels.h"
+
+using namespace System::Diagnostics;
+using namespace System::IO;
+using namespace System::Linq;
+
+namespace TopologicEnergy
+{
+	// Colors ratios in [0, 1] with the default colormap (the colors of EnergyModel::GetColor) in one pass.
+	static IList<IList<int>^>^ RatiosToRGB(array<double>^ ratios)
+	{
+		List<IList<int>^>^ colors = gcnew List<IList<int>^>(ratios->Length);
+		if (ratios->Length == 0)
+		{
+			return colors;
+		}
+
+		std::vector<unsigned char> rgbBuffer(ratios->Length * 3);
+		{
+			pin_ptr<double> pRatios = &ratios[0];
+			TopologicEnergyCore::ColorMap::ByType(TopologicEnergyCore::COLORMAP_DEFAULT).ApplyRatios(pRatios, ratios->Length, rgbBuffer.data(), false);
+		}
+
+		for (int i = 0; i < ratios->Length; ++i)
+		{
+			array<int>^ rgb = { rgbBuffer[3 * i], rgbBuffer[3 * i + 1], rgbBuffer[3 * i + 2] };
+			colors->Add(rgb);
+		}
+		return colors;
+	}
+
+	SimulationResult^ SimulationResult::ByEnergySimulation(EnergySimulation^ energySimulation, String ^ EPReportName, String ^ EPReportForString, String ^ EPTableName, String ^ EPColumnName, String ^ EPUnits)
+	{
+		// Computed once per simulation and shared by every result built from it
+		SimulationMetrics^ metrics = energySimulation->Metrics;
+		// Each space is queried once; the domain comes from the statistics cached with the result.
+		String^ EPRowName = nullptr;
+
+		// Create a map: space name -> cell
+		Dictionary<String^, Dictionary<String^, Object^>^>^ data = gcnew Dictionary<String^, Dictionary<String^, Object^>^>();
+
+		//STEP 2: Find the cell that matches the space and set its colour.
+		int i = 0;
+		// Referenced for the whole loop so that another thread cannot close it between queries.
+		OpenStudio::SqlFile^ osSqlFile = energySimulation->AcquireSqlFile();
+		try {
+			for each(OpenStudio::Space^ space in energySimulation->OsSpaces)
+			{
+				if (space == nullptr)
+				{
+					throw gcnew Exception("The energy simulation result contains a null space.");
+				}
+				++i;
+				OpenStudio::OptionalString^ osSpaceName = space->name();
+				String^ spaceName = osSpaceName->get();
+				// The tabular reports are per thermal zone, which several spaces may share.
+				OpenStudio::OptionalThermalZone^ osThermalZone = space->thermalZone();
+				EPRowName = osThermalZone->is_initialized() ? osThermalZone->get()->nameString()->ToUpperInvariant() : spaceName + "_THERMAL_ZONE";
+				double outputVariable = 0.0;
+				try {
+					outputVariable = EnergyModel::DoubleValueFromQuery(osSqlFile, EPReportName, EPReportForString, EPTableName, EPColumnName, EPRowName, EPUnits);
+				}
+				catch (...)
+				{
+					throw gcnew Exception("Fails to execute SQL query. There is an incorrect argument.");
+				}
+
+				Dictionary<String^, Object^>^ attributes = gcnew Dictionary<String^, Object^>();
+				attributes->Add("Value", outputVariable);
+				attributes->Add("Unit", EPUnits);
+				data->Add(spaceName, attributes);
+			}
+		}
+		finally
+		{
+			energySimulation->ReleaseSqlFile();
+		}
+
+		return gcnew SimulationResult(data, metrics);
+	}
+
+	IList<Modifiers::GeometryColor^>^ SimulationResult::Display(EnergyModel^ energyModel, IList<DSCore::Color^>^ colors)
+	{
+		if (energyModel == nullptr || colors == nullptr)
+		{
+			throw gcnew Exception("The input energyModel and colors must not be null.");
+		}
+
+		// The cell and aperture geometries are converted once per model; only the colors change here.
+		return energyModel->RenderCache->Colorize(colors);
+	}
+
+	IList<IList<int>^>^ SimulationResult::LegendRGB(Nullable<double> minDomain, Nullable<double> maxDomain, int count)
+	{
+		double finalMinDomain = 0.0;
+		double finalMaxDomain = 0.0;
+		IList<double>^ ratios = LegendRatios(minDomain, maxDomain, count, finalMinDomain, finalMaxDomain);
+		return RatiosToRGB(Enumerable::ToArray(ratios));
+	}
+
+	IList<double>^ SimulationResult::LegendValues(Nullable<double> minDomain, Nullable<double> maxDomain, int count, String^ binning)
+	{
+		double finalMinDomain = 0.0;
+		double finalMaxDomain = 0.0;
+		LegendRatios(minDomain, maxDomain, count, finalMinDomain, finalMaxDomain); // Validates the count and the domain
+		array<double>^ breaks = Breaks(finalMinDomain, finalMaxDomain, count, BinningModeByName(binning));
+		return gcnew List<double>(breaks);
+	}
+
+	IList<String^>^ SimulationResult::BinningModes::get()
+	{
+		List<String^>^ names = gcnew List<String^>();
+		for (const std::string& rkName : TopologicEnergyCore::BinningModeNames())
+		{
+			names->Add(ToManagedString(rkName));
+		}
+		return names;
+	}
+
+	IList<String^>^ SimulationResult::Names::get()
+	{
+		EnsureCache();
+		return gcnew List<String^>(m_names);
+	}
+
+	IList<double>^ SimulationResult::Values::get()
+	{
+		EnsureCache();
+		return gcnew List<double>(m_values);
+	}
+
+	Nullable<double> SimulationResult::Mean::get()
+	{
+		EnsureCache();
+		if (m_valueCount == 0)
+		{
+			return Nullable<double>();
+		}
+		return m_meanValue;
+	}
+
+	IList<int>^ SimulationResult::Histogram::get()
+	{
+		EnsureCache();
+		return gcnew List<int>(m_histogram);
+	}
+
+	String^ SimulationResult::Unit::get()
+	{
+		for each(KeyValuePair<String^, Dictionary<String^, Object^>^> pair in m_data)
+		{
+			Object^ unit = nullptr;
+			if (pair.Value->TryGetValue("Unit", unit) && unit != nullptr)
+			{
+				return unit->ToString();
+			}
+		}
+		return "";
+	}
+
+	IList<double>^ SimulationResult::Domain::get()
+	{
+		EnsureCache();
+		if (m_valueCount == 0)
+		{
+			return nullptr;
+		}
+
+		List<double>^ domain = gcnew List<double>();
+		domain->Add(m_minValue);
+		domain->Add(m_maxValue);
+		return domain;
+	}
+
+	IList<IList<int>^>^ SimulationResult::RGB(Nullable<double> minDomain, Nullable<double> maxDomain, String^ binning, int count)
+	{
+		EnsureCache();
+		double finalMinDomain = minDomain.HasValue ? minDomain.Value : m_minValue;
+		double finalMaxDomain = maxDomain.HasValue ? maxDomain.Value : m_maxValue;
+
+		double deltaFinalDomain = finalMaxDomain - finalMinDomain;
+		if (!(deltaFinalDomain >= 0.00001))
+		{
+			throw gcnew Exception("The domain is too small. Please increase it.");
+		}
+
+		if (count < 2)
+		{
+			throw gcnew Exception("The number of steps must be more than 2.");
+		}
+
+		// The value at LegendValues()[i] gets the color at LegendRGB()[i]; values in between are interpolated.
+		TopologicEnergyCore::BinningMode binningMode = BinningModeByName(binning);
+		array<double>^ breaks = Breaks(finalMinDomain, finalMaxDomain, count, binningMode);
+		pin_ptr<double> pBreaks = &breaks[0];
+		std::vector<double> nativeBreaks(pBreaks, pBreaks + breaks->Length);
+
+		if (m_values->Length == 0)
+		{
+			return gcnew List<IList<int>^>();
+		}
+
+		array<double>^ ratios = gcnew array<double>(m_values->Length);
+		{
+			pin_ptr<double> pValues = &m_values[0];
+			pin_ptr<double> pRatios = &ratios[0];
+			pin_ptr<double> pSortedValues = m_sortedValues->Length > 0 ? &m_sortedValues[0] : nullptr;
+			TopologicEnergyCore::ComputeBinnedRatios(pValues, m_values->Length, pSortedValues, m_sortedValues->Length, binningMode, nativeBreaks, pRatios);
+		}
+
+		return RatiosToRGB(ratios);
+	}
+
+	SimulationResult^ SimulationResult::ByNamesValues(IList<String^>^ names, array<double>^ values, String^ unit)
+	{
+		Dictionary<String^, Dictionary<String^, Object^>^>^ data = gcnew Dictionary<String^, Dictionary<String^, Object^>^>();
+		for (int i = 0; i < names->Count; ++i)
+		{
+			Dictionary<String^, Object^>^ attributes = gcnew Dictionary<String^, Object^>();
+			attributes->Add("Value", values[i]);
+			attributes->Add("Unit", unit);
+			data->Add(names[i], attributes);
+		}
+
+		return gcnew SimulationResult(data);
+	}
+
+	SimulationMetrics^ SimulationResult::Metrics::get()
+	{
+		return m_metrics;
+	}
+
+	SimulationResult::SimulationResult(Dictionary<String^, Dictionary<String^, Object^>^>^ data)
+		: m_data(data)
+		, m_metrics(nullptr)
+		, m_isCacheValid(false)
+	{
+		EnsureCache();
+	}
+
+	SimulationResult::SimulationResult(Dictionary<String^, Dictionary<String^, Object^>^>^ data, SimulationMetrics^ metrics)
+		: m_data(data)
+		, m_metrics(metrics)
+		, m_isCacheValid(false)
+	{
+		EnsureCache();
+	}
+
+	void SimulationResult::EnsureCache()
+	{
+		if (m_isCacheValid)
+		{
+			return;
+		}
+
+		// Unbox the values once; Names, Values, Domain, RGB and the legends all read these arrays.
+		int count = m_data->Count;
+		m_names = gcnew array<String^>(count);
+		m_values = gcnew array<double>(count);
+		int i = 0;
+		for each(KeyValuePair<String^, Dictionary<String^, Object^>^> pair in m_data)
+		{
+			m_names[i] = pair.Key;
+			m_values[i] = -1;
+			Object^ value = nullptr;
+			if (pair.Value->TryGetValue("Value", value))
+			{
+				try {
+					m_values[i] = (double)value;
+				}
+				catch (...)
+				{
+					// Not a double: reported as -1, like a missing value
+				}
+			}
+			++i;
+		}
+
+		TopologicEnergyCore::ValueStatistics statistics;
+		if (count > 0)
+		{
+			pin_ptr<double> pValues = &m_values[0];
+			statistics = TopologicEnergyCore::ComputeStatistics(pValues, count, HistogramBinCount);
+		}
+		else
+		{
+			statistics = TopologicEnergyCore::ComputeStatistics(nullptr, 0, HistogramBinCount);
+		}
+
+		m_valueCount = (int)statistics.count;
+		m_minValue = statistics.minValue;
+		m_maxValue = statistics.maxValue;
+		m_meanValue = statistics.meanValue;
+		m_histogram = gcnew array<int>((int)statistics.histogram.size());
+		for (int bin = 0; bin < m_histogram->Length; ++bin)
+		{
+			m_histogram[bin] = (int)statistics.histogram[bin];
+		}
+		m_sortedValues = nullptr;
+		m_breaks = nullptr;
+		m_isCacheValid = true;
+	}
+
+	void SimulationResult::EnsureSortedValues()
+	{
+		EnsureCache();
+		if (m_sortedValues != nullptr)
+		{
+			return;
+		}
+
+		// One sort per result; every binning mode, domain and legend count reuses it.
+		std::vector<double> sortedValues;
+		if (m_values->Length > 0)
+		{
+			pin_ptr<double> pValues = &m_values[0];
+			sortedValues = TopologicEnergyCore::SortValues(pValues, m_values->Length);
+		}
+
+		m_sortedValues = gcnew array<double>((int)sortedValues.size());
+		for (int i = 0; i < m_sortedValues->Length; ++i)
+		{
+			m_sortedValues[i] = sortedValues[i];
+		}
+	}
+
+	array<double>^ SimulationResult::Breaks(double minDomain, double maxDomain, int count, TopologicEnergyCore::BinningMode binningMode)
+	{
+		EnsureSortedValues();
+		if (m_breaks != nullptr && m_breaksMinDomain == minDomain && m_breaksMaxDomain == maxDomain &&
+			m_breaks->Length == count && m_breaksBinningMode == (int)binningMode)
+		{
+			return m_breaks;
+		}
+
+		std::vector<double> breaks;
+		{
+			pin_ptr<double> pSortedValues = m_sortedValues->Length > 0 ? &m_sortedValues[0] : nullptr;
+			breaks = TopologicEnergyCore::ComputeBreaks(pSortedValues, m_sortedValues->Length, binningMode, count, minDomain, maxDomain);
+		}
+
+		m_breaks = gcnew array<double>((int)breaks.size());
+		for (int i = 0; i < m_breaks->Length; ++i)
+		{
+			m_breaks[i] = breaks[i];
+		}
+		m_breaksMinDomain = minDomain;
+		m_breaksMaxDomain = maxDomain;
+		m_breaksBinningMode = (int)binningMode;
+		return m_breaks;
+	}
+
+	TopologicEnergyCore::BinningMode SimulationResult::BinningModeByName(String^ binning)
+	{
+		TopologicEnergyCore::BinningMode binningMode = TopologicEnergyCore::BINNING_LINEAR;
+		if (!String::IsNullOrEmpty(binning) &&
+			!TopologicEnergyCore::BinningModeByName(ToNativeString(binning), binningMode))
+		{
+			throw gcnew Exception("Unknown binning mode " + binning + ". The available binning modes are " + String::Join(", ", BinningModes) + ".");
+		}
+		return binningMode;
+	}
+
+	SimulationResult::~SimulationResult()
+	{
+
+	}
+
+	IList<double>^ SimulationResult::LegendRatios(Nullable<double> minDomain, Nullable<double> maxDomain, int count, double% finalMinDomain, double& finalMaxDomain)
+	{
+		if (count < 2)
+		{
+			throw gcnew Exception("The number of steps must be more than 2.");
+		}
+
+		EnsureCache();
+		finalMinDomain = minDomain.HasValue ? minDomain.Value : m_minValue;
+		finalMaxDomain = maxDomain.HasValue ? maxDomain.Value : m_maxValue;
+
+		double deltaFinalDomain = finalMaxDomain - finalMinDomain;
+		if (!(deltaFinalDomain >= 0.00001))
+		{
+			throw gcnew Exception("The domain is too small. Please provide a larger interval.");
+		}
+
+		List<double>^ ratios = gcnew List<double>();
+		double countMinusOne = (double)(count-1);
+		for (int i = 0; i < count; ++i)
+		{
+			double doubleI = (double)i;	// 0..10
+			double ratio = doubleI / countMinusOne; // 0..1
+			ratios->Add(ratio);
+		}
+		return ratios;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "SqlFilePool.h"
+#include "NativeInterop.h"
+#include "TraceRecorder.h"
+
+using namespace System::IO;
+using namespace System::Threading;
+
+namespace TopologicEnergy
+{
+	static void TraceIndexFailure(TopologicEnergyCore::TraceSpan& rSpan, String^ message)
+	{
+		if (rSpan.IsActive())
+		{
+			rSpan.SetAttribute("error", ToNativeString(message));
+		}
+		System::Diagnostics::Trace::TraceWarning("SqlFilePool: the SQL file is queried without indexes ({0}).", message);
+	}
+
+	int SqlFilePool::Capacity::get()
+	{
+		return m_capacity;
+	}
+
+	void SqlFilePool::Capacity::set(int value)
+	{
+		if (value < 1)
+		{
+			throw gcnew Exception("The capacity of the SQL file pool must be at least 1.");
+		}
+
+		Monitor::Enter(m_lock);
+		try {
+			m_capacity = value;
+			Trim(m_capacity);
+		}
+		finally
+		{
+			Monitor::Exit(m_lock);
+		}
+	}
+
+	bool SqlFilePool::CreateIndexes::get()
+	{
+		return m_createIndexes;
+	}
+
+	void SqlFilePool::CreateIndexes::set(bool value)
+	{
+		m_createIndexes = value;
+	}
+
+	bool SqlFilePool::MaterializeTabularData::get()
+	{
+		return m_materializeTabularData;
+	}
+
+	void SqlFilePool::MaterializeTabularData::set(bool value)
+	{
+		m_materializeTabularData = value;
+	}
+
+	int SqlFilePool::Count::get()
+	{
+		Monitor::Enter(m_lock);
+		try {
+			return m_entries->Count;
+		}
+		finally
+		{
+			Monitor::Exit(m_lock);
+		}
+	}
+
+	OpenStudio::SqlFile^ SqlFilePool::Acquire(String^ sqlPath)
+	{
+		if (sqlPath == nullptr)
+		{
+			throw gcnew Exception("The input sqlPath must not be null.");
+		}
+
+		String^ fullPath = Path::GetFullPath(sqlPath);
+
+		Monitor::Enter(m_lock);
+		try {
+			Entry^ entry = nullptr;
+			if (m_entries->TryGetValue(fullPath, entry))
+			{
+				m_recentlyUsed->Remove(entry->Node);
+				m_recentlyUsed->AddFirst(entry->Node);
+				++entry->ReferenceCount;
+				return entry->SqlFile;
+			}
+
+			if (!File::Exists(fullPath))
+			{
+				throw gcnew FileNotFoundException("SQL file not found.", fullPath);
+			}
+
+			Trim(m_capacity - 1);
+
+			TopologicEnergyCore::TraceSpan span("OpenSqlFile");
+			if (span.IsActive())
+			{
+				span.SetAttribute("path", ToNativeString(fullPath));
+			}
+
+			entry = gcnew Entry();
+			entry->SqlFile = gcnew OpenStudio::SqlFile(OpenStudio::OpenStudioUtilitiesCore::toPath(fullPath));
+			try {
+				entry->TabularTable = Index(entry->SqlFile);
+			}
+			catch (Exception^)
+			{
+				entry->SqlFile->close();
+				delete entry->SqlFile;
+				throw;
+			}
+
+			// Registered only once the file is open and indexed, so a failure leaves the pool as it was.
+			entry->Node = m_recentlyUsed->AddFirst(fullPath);
+			entry->ReferenceCount = 1;
+			m_entries->Add(fullPath, entry);
+			m_tabularTables->Add(entry->SqlFile, entry->TabularTable);
+			m_paths->Add(entry->SqlFile, fullPath);
+			return entry->SqlFile;
+		}
+		finally
+		{
+			Monitor::Exit(m_lock);
+		}
+	}
+
+	void SqlFilePool::Release(String^ sqlPath)
+	{
+		if (sqlPath == nullptr)
+		{
+			return;
+		}
+
+		String^ fullPath = Path::GetFullPath(sqlPath);
+
+		Monitor::Enter(m_lock);
+		try {
+			Entry^ entry = nullptr;
+			if (m_entries->TryGetValue(fullPath, entry) && entry->ReferenceCount > 0)
+			{
+				--entry->ReferenceCount;
+
+				// Files opened beyond the capacity while every file was in use
+				Trim(m_capacity);
+			}
+		}
+		finally
+		{
+			Monitor::Exit(m_lock);
+		}
+	}
+
+	String^ SqlFilePool::TabularTable(OpenStudio::SqlFile^ sqlFile)
+	{
+		Monitor::Enter(m_lock);
+		try {
+			String^ tabularTable = nullptr;
+			if (sqlFile != nullptr && m_tabularTables->TryGetValue(sqlFile, tabularTable))
+			{
+				return tabularTable;
+			}
+			return "tabulardatawithstrings";
+		}
+		finally
+		{
+			Monitor::Exit(m_lock);
+		}
+	}
+
+	void SqlFilePool::CountQuery(OpenStudio::SqlFile^ sqlFile)
+	{
+		Monitor::Enter(m_lock);
+		try {
+			String^ fullPath = nullptr;
+			if (sqlFile != nullptr && m_paths->TryGetValue(sqlFile, fullPath))
+			{
+				int queryCount = 0;
+				m_queryCounts->TryGetValue(fullPath, queryCount);
+				m_queryCounts[fullPath] = queryCount + 1;
+			}
+		}
+		finally
+		{
+			Monitor::Exit(m_lock);
+		}
+	}
+
+	int SqlFilePool::QueryCount(String^ sqlPath)
+	{
+		if (sqlPath == nullptr)
+		{
+			return 0;
+		}
+
+		String^ fullPath = Path::GetFullPath(sqlPath);
+
+		Monitor::Enter(m_lock);
+		try {
+			int queryCount = 0;
+			m_queryCounts->TryGetValue(fullPath, queryCount);
+			return queryCount;
+		}
+		finally
+		{
+			Monitor::Exit(m_lock);
+		}
+	}
+
+	String^ SqlFilePool::Index(OpenStudio::SqlFile^ sqlFile)
+	{
+		// TabularDataWithStrings is a view that joins TabularData to Strings six times. Indexing Strings by value
+		// and TabularData by its string indices turns every filtered lookup into index seeks instead of scans.
+		// All statements are idempotent, so a file indexed by an earlier run is left as it is.
+		if (!m_createIndexes && !m_materializeTabularData)
+		{
+			return "tabulardatawithstrings";
+		}
+
+		// A file that cannot be written (read-only, locked, or on a read-only share) is still queried, only without the indexes.
+		// SqlFile::execute reports an SQLite failure by returning false; the bindings raise the I/O failures.
+		TopologicEnergyCore::TraceSpan span("IndexSqlFile");
+		try {
+			bool isIndexed = sqlFile->execute("CREATE INDEX IF NOT EXISTS TopologicEnergy_Strings_Value ON Strings (Value)")
+				&& sqlFile->execute("CREATE INDEX IF NOT EXISTS TopologicEnergy_TabularData_Lookup ON TabularData "
+					"(ReportNameIndex, ReportForStringIndex, TableNameIndex, RowNameIndex, ColumnNameIndex, UnitsIndex, Value)")
+				&& sqlFile->execute("CREATE INDEX IF NOT EXISTS TopologicEnergy_ReportData_Lookup ON ReportData "
+					"(ReportDataDictionaryIndex, TimeIndex, Value)");
+			if (!isIndexed)
+			{
+				TraceIndexFailure(span, "CREATE INDEX failed");
+				return "tabulardatawithstrings";
+			}
+
+			if (m_materializeTabularData)
+			{
+				bool isMaterialized = sqlFile->execute("CREATE TABLE IF NOT EXISTS TopologicEnergy_TabularLookup AS "
+						"SELECT ReportName, ReportForString, TableName, RowName, ColumnName, Units, Value FROM tabulardatawithstrings")
+					&& sqlFile->execute("CREATE INDEX IF NOT EXISTS TopologicEnergy_TabularLookup_Index ON TopologicEnergy_TabularLookup "
+						"(ReportName, ReportForString, TableName, RowName, ColumnName, Units, Value)");
+				if (isMaterialized)
+				{
+					return "TopologicEnergy_TabularLookup";
+				}
+				TraceIndexFailure(span, "CREATE TABLE TopologicEnergy_TabularLookup failed");
+			}
+		}
+		catch (ApplicationException^ e)
+		{
+			TraceIndexFailure(span, e->Message);
+		}
+		catch (IOException^ e)
+		{
+			TraceIndexFailure(span, e->Message);
+		}
+		return "tabulardatawithstrings";
+	}
+
+	void SqlFilePool::Trim(int capacity)
+	{
+		LinkedListNode<String^>^ node = m_recentlyUsed->Last;
+		while (m_entries->Count > capacity && node != nullptr)
+		{
+			LinkedListNode<String^>^ previousNode = node->Previous;
+			Entry^ entry = m_entries[node->Value];
+			if (entry->ReferenceCount == 0)
+			{
+				String^ path = node->Value;
+				Close(entry);
+				m_entries->Remove(path);
+			}
+			node = previousNode;
+		}
+	}
+
+	void SqlFilePool::Close(Entry^ entry)
+	{
+		m_tabularTables->Remove(entry->SqlFile);
+		m_paths->Remove(entry->SqlFile);
+		m_recentlyUsed->Remove(entry->Node);
+		entry->SqlFile->close();
+		delete entry->SqlFile;
+		entry->SqlFile = nullptr;
+	}
+}
@@ -0,0 +1,108 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// A bounded pool of open EnergyPlus SQL output files. When the pool is full, the least recently used file that is not in use is closed; it is reopened on its next use.
+	/// </summary>
+	public ref class SqlFilePool abstract sealed
+	{
+	public:
+		/// <summary>
+		/// The maximum number of SQL files kept open at the same time. Files in use are never closed, so the pool may exceed it until they are released.
+		/// </summary>
+		static property int Capacity
+		{
+			int get();
+			void set(int value);
+		}
+
+		/// <summary>
+		/// If true, indexes on the TabularData, Strings and ReportData tables are added when a SQL file is first opened, so result lookups no longer scan the tables.
+		/// This writes to the EnergyPlus output file, so it is off by default.
+		/// </summary>
+		static property bool CreateIndexes
+		{
+			bool get();
+			void set(bool value);
+		}
+
+		/// <summary>
+		/// If true, the TabularDataWithStrings view is also materialized into an indexed lookup table when a SQL file is first opened.
+		/// </summary>
+		static property bool MaterializeTabularData
+		{
+			bool get();
+			void set(bool value);
+		}
+
+		/// <summary>
+		/// Returns the number of SQL files that are currently open.
+		/// </summary>
+		static property int Count
+		{
+			int get();
+		}
+
+	internal:
+		// Returns the open SQL file at sqlPath, opening it (and closing the least recently used unreferenced
+		// file) if needed, and adds a reference to it. The handle stays open until every Acquire is matched by a Release.
+		static OpenStudio::SqlFile^ Acquire(String^ sqlPath);
+
+		// Removes a reference added by Acquire. The file stays cached until it is evicted.
+		static void Release(String^ sqlPath);
+
+		// Returns the table or view to run tabular queries against for a SQL file returned by Acquire.
+		static String^ TabularTable(OpenStudio::SqlFile^ sqlFile);
+
+		// Counts a query run against a SQL file returned by Acquire.
+		static void CountQuery(OpenStudio::SqlFile^ sqlFile);
+
+		// Returns the number of queries counted for the SQL file at sqlPath, including those run before it was last closed.
+		static int QueryCount(String^ sqlPath);
+
+	private:
+		ref class Entry
+		{
+		public:
+			OpenStudio::SqlFile^ SqlFile;
+			LinkedListNode<String^>^ Node;
+			String^ TabularTable;
+			int ReferenceCount;
+		};
+
+		// Closes the least recently used unreferenced files until the pool is within its capacity.
+		static void Trim(int capacity);
+		static void Close(Entry^ entry);
+		static String^ Index(OpenStudio::SqlFile^ sqlFile);
+
+		static Object^ m_lock = gcnew Object();
+		static int m_capacity = 64;
+		static bool m_createIndexes = false;
+		static bool m_materializeTabularData = false;
+		static Dictionary<String^, Entry^>^ m_entries = gcnew Dictionary<String^, Entry^>(StringComparer::OrdinalIgnoreCase);
+		static LinkedList<String^>^ m_recentlyUsed = gcnew LinkedList<String^>(); // most recently used first
+		static Dictionary<OpenStudio::SqlFile^, String^>^ m_tabularTables = gcnew Dictionary<OpenStudio::SqlFile^, String^>();
+		static Dictionary<OpenStudio::SqlFile^, String^>^ m_paths = gcnew Dictionary<OpenStudio::SqlFile^, String^>();
+		static Dictionary<String^, int>^ m_queryCounts = gcnew Dictionary<String^, int>(StringComparer::OrdinalIgnoreCase);
+	};
+}
@@ -0,0 +1,185 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "SqlResultReader.h"
+#include "TraceRecorder.h"
+
+#include <sqlite3.h>
+
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		class Statement
+		{
+		public:
+			Statement(sqlite3* pDatabase, const char* pkSql)
+				: m_pStatement(nullptr)
+			{
+				if (sqlite3_prepare_v2(pDatabase, pkSql, -1, &m_pStatement, nullptr) != SQLITE_OK)
+				{
+					throw std::runtime_error(std::string("Fails to prepare an SQL query: ") + sqlite3_errmsg(pDatabase));
+				}
+			}
+
+			~Statement()
+			{
+				sqlite3_finalize(m_pStatement);
+			}
+
+			void Bind(int index, const std::string& rkValue)
+			{
+				sqlite3_bind_text(m_pStatement, index, rkValue.c_str(), (int)rkValue.size(), SQLITE_TRANSIENT);
+			}
+
+			sqlite3_stmt* Get() { return m_pStatement; }
+
+		private:
+			Statement(const Statement&);
+			Statement& operator=(const Statement&);
+
+			sqlite3_stmt* m_pStatement;
+		};
+
+		// Values are stored as text in the tabular data.
+		double ColumnDouble(sqlite3_stmt* pStatement, int column)
+		{
+			if (sqlite3_column_type(pStatement, column) == SQLITE_NULL)
+			{
+				return std::numeric_limits<double>::quiet_NaN();
+			}
+
+			const char* pkText = (const char*)sqlite3_column_text(pStatement, column);
+			char* pEnd = nullptr;
+			double value = std::strtod(pkText, &pEnd);
+			return pEnd == pkText ? std::numeric_limits<double>::quiet_NaN() : value;
+		}
+
+		const char* const TabularQuery =
+			"SELECT RowName, Value FROM tabulardatawithstrings WHERE ReportName = ?1 AND ReportForString = ?2 "
+			"AND TableName = ?3 AND ColumnName = ?4 AND Units = ?5";
+	}
+
+	SqlResultReader::SqlResultReader(const std::string& rkPath, bool createIndexes)
+		: m_pDatabase(nullptr)
+		, m_queryCount(0)
+	{
+		TraceSpan span("OpenSqlFile");
+		span.SetAttribute("path", rkPath);
+		if (createIndexes && sqlite3_open_v2(rkPath.c_str(), &m_pDatabase, SQLITE_OPEN_READWRITE, nullptr) == SQLITE_OK)
+		{
+			// A failure only leaves the lookups unindexed.
+			sqlite3_exec(m_pDatabase,
+				"CREATE INDEX IF NOT EXISTS TopologicEnergy_Strings_Value ON Strings (Value);"
+				"CREATE INDEX IF NOT EXISTS TopologicEnergy_TabularData_Lookup ON TabularData "
+				"(ReportNameIndex, ReportForStringIndex, TableNameIndex, RowNameIndex, ColumnNameIndex, UnitsIndex, Value);"
+				"CREATE INDEX IF NOT EXISTS TopologicEnergy_ReportData_Lookup ON ReportData "
+				"(ReportDataDictionaryIndex, TimeIndex, Value);",
+				nullptr, nullptr, nullptr);
+			return;
+		}
+
+		sqlite3_close(m_pDatabase);
+		m_pDatabase = nullptr;
+		if (sqlite3_open_v2(rkPath.c_str(), &m_pDatabase, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+		{
+			sqlite3_close(m_pDatabase);
+			throw std::runtime_error("Fails to open the SQL file " + rkPath + ".");
+		}
+	}
+
+	SqlResultReader::~SqlResultReader()
+	{
+		sqlite3_close(m_pDatabase);
+	}
+
+	bool SqlResultReader::TabularValue(
+		const std::string& rkReportName,
+		const std::string& rkReportForString,
+		const std::string& rkTableName,
+		const std::string& rkColumnName,
+		const std::string& rkRowName,
+		const std::string& rkUnits,
+		double& rValue) const
+	{
+		TraceSpan span("TabularValue");
+		++m_queryCount;
+		span.SetAttribute("table", rkTableName);
+		span.SetAttribute("row", rkRowName);
+		Statement statement(m_pDatabase, (std::string(TabularQuery) + " AND RowName = ?6").c_str());
+		statement.Bind(1, rkReportName);
+		statement.Bind(2, rkReportForString);
+		statement.Bind(3, rkTableName);
+		statement.Bind(4, rkColumnName);
+		statement.Bind(5, rkUnits);
+		statement.Bind(6, rkRowName);
+		if (sqlite3_step(statement.Get()) != SQLITE_ROW)
+		{
+			return false;
+		}
+
+		rValue = ColumnDouble(statement.Get(), 1);
+		return rValue == rValue;
+	}
+
+	std::vector<double> SqlResultReader::TabularValues(
+		const std::string& rkReportName,
+		const std::string& rkReportForString,
+		const std::string& rkTableName,
+		const std::string& rkColumnName,
+		const std::vector<std::string>& rkRowNames,
+		const std::string& rkUnits) const
+	{
+		TraceSpan span("TabularValues");
+		++m_queryCount;
+		span.SetAttribute("table", rkTableName);
+		span.SetAttribute("rows", (std::int64_t)rkRowNames.size());
+		std::map<std::string, std::size_t> rowIndices;
+		for (std::size_t i = 0; i < rkRowNames.size(); ++i)
+		{
+			rowIndices.emplace(rkRowNames[i], i);
+		}
+
+		std::vector<double> values(rkRowNames.size(), std::numeric_limits<double>::quiet_NaN());
+		Statement statement(m_pDatabase, TabularQuery);
+		statement.Bind(1, rkReportName);
+		statement.Bind(2, rkReportForString);
+		statement.Bind(3, rkTableName);
+		statement.Bind(4, rkColumnName);
+		statement.Bind(5, rkUnits);
+		while (sqlite3_step(statement.Get()) == SQLITE_ROW)
+		{
+			const char* pkRowName = (const char*)sqlite3_column_text(statement.Get(), 0);
+			std::map<std::string, std::size_t>::const_iterator kRow = rowIndices.find(pkRowName == nullptr ? "" : pkRowName);
+			if (kRow != rowIndices.end() && values[kRow->second] != values[kRow->second])
+			{
+				values[kRow->second] = ColumnDouble(statement.Get(), 1);
+			}
+		}
+
+		// Duplicate row names get the same value.
+		for (std::size_t i = 0; i < rkRowNames.size(); ++i)
+		{
+			values[i] = values[rowIndices[rkRowNames[i]]];
+		}
+		return values;
+	}
+}
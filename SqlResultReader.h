@@ -0,0 +1,66 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+namespace TopologicEnergyCore
+{
+	// Reads the tabular results of an EnergyPlus eplusout.sql through SQLite, without OpenStudio.
+	// Queries the same view as EnergyModel.DoubleValueFromQuery, with the indexes SqlFilePool creates.
+	class SqlResultReader
+	{
+	public:
+		// Opens the file for reading; if createIndexes is true and the file is writable, first adds the
+		// lookup indexes (idempotent, so a file indexed by an earlier run is left as it is).
+		explicit SqlResultReader(const std::string& rkPath, bool createIndexes = true);
+		~SqlResultReader();
+
+		// Returns false if the table has no such value.
+		bool TabularValue(
+			const std::string& rkReportName,
+			const std::string& rkReportForString,
+			const std::string& rkTableName,
+			const std::string& rkColumnName,
+			const std::string& rkRowName,
+			const std::string& rkUnits,
+			double& rValue) const;
+
+		// The values of many rows of one column in a single query, NaN for the rows without a value.
+		std::vector<double> TabularValues(
+			const std::string& rkReportName,
+			const std::string& rkReportForString,
+			const std::string& rkTableName,
+			const std::string& rkColumnName,
+			const std::vector<std::string>& rkRowNames,
+			const std::string& rkUnits) const;
+
+		// The number of queries run through this reader.
+		std::size_t QueryCount() const { return m_queryCount; }
+
+	private:
+		SqlResultReader(const SqlResultReader&);
+		SqlResultReader& operator=(const SqlResultReader&);
+
+		sqlite3* m_pDatabase;
+		mutable std::size_t m_queryCount;
+	};
+}
@@ -0,0 +1,295 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "StatisticsKernels.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+
+namespace TopologicEnergyCore
+{
+	ValueStatistics ComputeStatistics(const double* pkValues, std::size_t count, std::size_t binCount)
+	{
+		ValueStatistics statistics;
+		statistics.count = 0;
+		statistics.minValue = std::numeric_limits<double>::infinity();
+		statistics.maxValue = -std::numeric_limits<double>::infinity();
+		statistics.histogram.assign(binCount, 0);
+
+		double sum = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			double value = pkValues[i];
+			if (!std::isfinite(value))
+			{
+				continue;
+			}
+			statistics.minValue = std::min(statistics.minValue, value);
+			statistics.maxValue = std::max(statistics.maxValue, value);
+			sum += value;
+			++statistics.count;
+		}
+
+		if (statistics.count == 0)
+		{
+			statistics.minValue = std::numeric_limits<double>::quiet_NaN();
+			statistics.maxValue = std::numeric_limits<double>::quiet_NaN();
+			statistics.meanValue = std::numeric_limits<double>::quiet_NaN();
+			return statistics;
+		}
+		statistics.meanValue = sum / (double)statistics.count;
+
+		if (binCount == 0)
+		{
+			return statistics;
+		}
+
+		double delta = statistics.maxValue - statistics.minValue;
+		double scale = delta > 0.0 ? (double)binCount / delta : 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			double value = pkValues[i];
+			if (!std::isfinite(value))
+			{
+				continue;
+			}
+			std::size_t bin = std::min((std::size_t)((value - statistics.minValue) * scale), binCount - 1);
+			++statistics.histogram[bin];
+		}
+
+		return statistics;
+	}
+
+	namespace
+	{
+		const char* const BinningModeNameTable[BINNING_COUNT] = { "Linear", "Quantile", "NaturalBreaks", "HistogramEqualization" };
+
+		// Fisher-Jenks dynamic programming over sorted values: O(classCount * count^2).
+		std::vector<double> NaturalBreaks(const std::vector<double>& rkValues, std::size_t classCount)
+		{
+			std::size_t count = rkValues.size();
+			std::vector<double> prefixSums(count + 1, 0.0);
+			std::vector<double> prefixSquares(count + 1, 0.0);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				prefixSums[i + 1] = prefixSums[i] + rkValues[i];
+				prefixSquares[i + 1] = prefixSquares[i] + rkValues[i] * rkValues[i];
+			}
+
+			// Sum of squared deviations of the values [first, last)
+			auto deviation = [&](std::size_t first, std::size_t last)
+			{
+				double n = (double)(last - first);
+				double sum = prefixSums[last] - prefixSums[first];
+				return (prefixSquares[last] - prefixSquares[first]) - sum * sum / n;
+			};
+
+			const double infinity = std::numeric_limits<double>::infinity();
+			// costs[k][i]: best cost of splitting the first i values into k + 1 classes
+			std::vector<std::vector<double>> costs(classCount, std::vector<double>(count + 1, infinity));
+			std::vector<std::vector<std::size_t>> starts(classCount, std::vector<std::size_t>(count + 1, 0));
+			for (std::size_t i = 1; i <= count; ++i)
+			{
+				costs[0][i] = deviation(0, i);
+			}
+			for (std::size_t k = 1; k < classCount; ++k)
+			{
+				for (std::size_t i = k + 1; i <= count; ++i)
+				{
+					for (std::size_t j = k; j < i; ++j)
+					{
+						double cost = costs[k - 1][j] + deviation(j, i);
+						if (cost < costs[k][i])
+						{
+							costs[k][i] = cost;
+							starts[k][i] = j;
+						}
+					}
+				}
+			}
+
+			// Walk back to the first value of each class; the breaks are the class lower bounds.
+			std::vector<double> breaks(classCount + 1);
+			std::size_t last = count;
+			for (std::size_t k = classCount - 1; k > 0; --k)
+			{
+				last = starts[k][last];
+				breaks[k] = rkValues[last];
+			}
+			return breaks;
+		}
+	}
+
+	bool BinningModeByName(const std::string& rkName, BinningMode& rMode)
+	{
+		std::string lowerName(rkName);
+		std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+		for (int i = 0; i < BINNING_COUNT; ++i)
+		{
+			std::string lowerModeName(BinningModeNameTable[i]);
+			std::transform(lowerModeName.begin(), lowerModeName.end(), lowerModeName.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+			if (lowerName == lowerModeName)
+			{
+				rMode = (BinningMode)i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<std::string> BinningModeNames()
+	{
+		return std::vector<std::string>(BinningModeNameTable, BinningModeNameTable + BINNING_COUNT);
+	}
+
+	std::vector<double> SortValues(const double* pkValues, std::size_t count)
+	{
+		std::vector<double> sortedValues;
+		sortedValues.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (std::isfinite(pkValues[i]))
+			{
+				sortedValues.push_back(pkValues[i]);
+			}
+		}
+		std::sort(sortedValues.begin(), sortedValues.end());
+		return sortedValues;
+	}
+
+	std::vector<double> ComputeBreaks(const double* pkSortedValues, std::size_t sortedCount, BinningMode mode, std::size_t breakCount, double minValue, double maxValue)
+	{
+		std::vector<double> breaks(breakCount);
+		if (breakCount < 2)
+		{
+			return breaks;
+		}
+
+		double delta = maxValue - minValue;
+		double lastIndex = (double)(breakCount - 1);
+		for (std::size_t i = 0; i < breakCount; ++i)
+		{
+			breaks[i] = minValue + delta * (double)i / lastIndex;
+		}
+
+		const double* first = std::lower_bound(pkSortedValues, pkSortedValues + sortedCount, minValue);
+		const double* last = std::upper_bound(pkSortedValues, pkSortedValues + sortedCount, maxValue);
+		std::size_t count = (std::size_t)(last - first);
+		if (mode == BINNING_LINEAR || count < 2)
+		{
+			return breaks;
+		}
+
+		// Fisher-Jenks costs classCount x sampleSize^2, so a finer legend gets the quantile breaks.
+		if (mode == BINNING_NATURAL_BREAKS && breakCount - 1 > NaturalBreaksMaxClassCount)
+		{
+			mode = BINNING_QUANTILE;
+		}
+
+		if (mode == BINNING_QUANTILE || mode == BINNING_HISTOGRAM_EQUALIZATION)
+		{
+			for (std::size_t i = 1; i + 1 < breakCount; ++i)
+			{
+				double position = (double)(count - 1) * (double)i / lastIndex;
+				std::size_t index = (std::size_t)position;
+				double fraction = position - (double)index;
+				double value = first[index];
+				if (index + 1 < count)
+				{
+					value += (first[index + 1] - value) * fraction;
+				}
+				breaks[i] = value;
+			}
+		}
+		else if (mode == BINNING_NATURAL_BREAKS)
+		{
+			std::size_t sampleSize = std::min(count, NaturalBreaksSampleSize);
+			std::vector<double> sample(sampleSize);
+			for (std::size_t i = 0; i < sampleSize; ++i)
+			{
+				sample[i] = first[sampleSize == 1 ? 0 : i * (count - 1) / (sampleSize - 1)];
+			}
+
+			std::size_t classCount = std::min(breakCount - 1, sampleSize);
+			std::vector<double> naturalBreaks = NaturalBreaks(sample, classCount);
+			for (std::size_t i = 1; i + 1 < breakCount; ++i)
+			{
+				// Fewer classes than requested: the remaining breaks repeat the maximum.
+				breaks[i] = i < classCount ? naturalBreaks[i] : maxValue;
+			}
+		}
+
+		// Keep the breaks ascending even when the sampled values repeat.
+		for (std::size_t i = 1; i < breakCount; ++i)
+		{
+			breaks[i] = std::max(breaks[i], breaks[i - 1]);
+		}
+		breaks[breakCount - 1] = maxValue;
+		return breaks;
+	}
+
+	void ComputeBinnedRatios(const double* pkValues, std::size_t count, const double* pkSortedValues, std::size_t sortedCount, BinningMode mode, const std::vector<double>& rkBreaks, double* pRatios)
+	{
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		if (rkBreaks.size() < 2)
+		{
+			std::fill(pRatios, pRatios + count, nan);
+			return;
+		}
+
+		double minValue = rkBreaks.front();
+		double maxValue = rkBreaks.back();
+		const double* first = std::lower_bound(pkSortedValues, pkSortedValues + sortedCount, minValue);
+		const double* last = std::upper_bound(pkSortedValues, pkSortedValues + sortedCount, maxValue);
+		std::size_t domainCount = (std::size_t)(last - first);
+		double lastBreakIndex = (double)(rkBreaks.size() - 1);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			double value = pkValues[i];
+			if (!std::isfinite(value))
+			{
+				pRatios[i] = nan;
+				continue;
+			}
+
+			double ratio = 0.0;
+			if (mode == BINNING_HISTOGRAM_EQUALIZATION && domainCount >= 2)
+			{
+				// Mid-rank of the value among the sorted values in the domain, so ties share one color.
+				double lower = (double)(std::lower_bound(first, last, value) - first);
+				double upper = (double)(std::upper_bound(first, last, value) - first);
+				double rank = lower < upper ? (lower + upper - 1.0) * 0.5 : lower - 0.5;
+				ratio = rank / (double)(domainCount - 1);
+			}
+			else if (value >= maxValue)
+			{
+				ratio = 1.0;
+			}
+			else if (value > minValue)
+			{
+				// The last break that is <= value starts the bin; empty bins (repeated breaks) are skipped.
+				std::size_t bin = (std::size_t)(std::upper_bound(rkBreaks.begin(), rkBreaks.end(), value) - rkBreaks.begin()) - 1;
+				double binWidth = rkBreaks[bin + 1] - rkBreaks[bin];
+				double fraction = binWidth > 0.0 ? (value - rkBreaks[bin]) / binWidth : 0.0;
+				ratio = ((double)bin + fraction) / lastBreakIndex;
+			}
+			pRatios[i] = std::min(std::max(ratio, 0.0), 1.0);
+		}
+	}
+}
@@ -0,0 +1,69 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	struct ValueStatistics
+	{
+		std::size_t count;	// number of finite values
+		double minValue;
+		double maxValue;
+		double meanValue;
+		std::vector<std::size_t> histogram;	// binCount equal bins over [minValue, maxValue]
+	};
+
+	// Computes the statistics of the values, skipping NaN and infinite values (no data, e.g. a space
+	// missing from a comparison or a zero baseline). If no value is finite, count is 0 and minValue,
+	// maxValue and meanValue are NaN.
+	ValueStatistics ComputeStatistics(const double* pkValues, std::size_t count, std::size_t binCount);
+
+	enum BinningMode
+	{
+		BINNING_LINEAR,					// evenly spaced breaks between the domain bounds
+		BINNING_QUANTILE,				// the same number of values between consecutive breaks
+		BINNING_NATURAL_BREAKS,			// Jenks breaks, minimizing the variance within each class
+		BINNING_HISTOGRAM_EQUALIZATION,	// ratios follow the cumulative distribution of the values
+		BINNING_COUNT
+	};
+
+	// Returns false if the name does not match a binning mode. Names are case-insensitive.
+	bool BinningModeByName(const std::string& rkName, BinningMode& rMode);
+	std::vector<std::string> BinningModeNames();
+
+	// Sorts the values in ascending order, dropping NaN and infinite values. Computed once per result and shared by
+	// ComputeBreaks and ComputeBinnedRatios.
+	std::vector<double> SortValues(const double* pkValues, std::size_t count);
+
+	// Returns breakCount ascending breaks from minValue to maxValue. Break i is the value drawn at
+	// legend ratio i / (breakCount - 1). Only the sorted values within [minValue, maxValue] are used.
+	// Natural breaks are computed on an evenly strided sample of at most NaturalBreaksSampleSize
+	// values, so their cost does not grow with the number of values. Their cost still grows with the
+	// number of classes: for more than NaturalBreaksMaxClassCount classes, the quantile breaks are used.
+	const std::size_t NaturalBreaksSampleSize = 1000;
+	const std::size_t NaturalBreaksMaxClassCount = 16;
+	std::vector<double> ComputeBreaks(const double* pkSortedValues, std::size_t sortedCount, BinningMode mode, std::size_t breakCount, double minValue, double maxValue);
+
+	// Maps each value to a ratio in [0, 1], linearly between consecutive breaks, or along the
+	// cumulative distribution of the sorted values for histogram equalization. NaN and infinite
+	// values get a NaN ratio, drawn with the no-data color.
+	void ComputeBinnedRatios(const double* pkValues, std::size_t count, const double* pkSortedValues, std::size_t sortedCount, BinningMode mode, const std::vector<double>& rkBreaks, double* pRatios);
+}
@@ -0,0 +1,126 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ThermalZoning.h"
+
+namespace TopologicEnergy
+{
+	ThermalZoning^ ThermalZoning::ByMode(String^ mode)
+	{
+		if (mode == nullptr)
+		{
+			throw gcnew Exception("The input mode must not be null.");
+		}
+
+		for each(String^ availableMode in Modes)
+		{
+			if (String::Equals(mode, availableMode, StringComparison::OrdinalIgnoreCase))
+			{
+				return gcnew ThermalZoning(availableMode, nullptr);
+			}
+		}
+
+		throw gcnew Exception("Unknown zoning mode " + mode + ". The available zoning modes are " + String::Join(", ", Modes) + ".");
+	}
+
+	ThermalZoning^ ThermalZoning::ByKeys(IList<String^>^ zoneKeys)
+	{
+		if (zoneKeys == nullptr)
+		{
+			throw gcnew Exception("The input zoneKeys must not be null.");
+		}
+
+		for each(String^ zoneKey in zoneKeys)
+		{
+			if (String::IsNullOrEmpty(zoneKey))
+			{
+				throw gcnew Exception("The input zoneKeys must not contain a null or empty key.");
+			}
+		}
+
+		return gcnew ThermalZoning("Keys", gcnew List<String^>(zoneKeys));
+	}
+
+	String^ ThermalZoning::Mode::get()
+	{
+		return m_mode;
+	}
+
+	IList<String^>^ ThermalZoning::Modes::get()
+	{
+		List<String^>^ modes = gcnew List<String^>();
+		modes->Add("Space");
+		modes->Add("Story");
+		modes->Add("StoryOrientation");
+		modes->Add("SpaceType");
+		return modes;
+	}
+
+	String^ ThermalZoning::ZoneName(int cellIndex, OpenStudio::Space^ osSpace, Nullable<double> azimuth, double northAxis)
+	{
+		if (m_mode == "Keys")
+		{
+			if (cellIndex >= m_zoneKeys->Count)
+			{
+				throw gcnew Exception("There are fewer zone keys than cells.");
+			}
+			return m_zoneKeys[cellIndex]->ToUpperInvariant() + "_THERMAL_ZONE";
+		}
+
+		if (m_mode == "SpaceType")
+		{
+			OpenStudio::OptionalSpaceType^ osSpaceType = osSpace->spaceType();
+			String^ spaceTypeName = osSpaceType->is_initialized() ? osSpaceType->get()->nameString() : "NO_SPACE_TYPE";
+			return spaceTypeName->ToUpperInvariant() + "_THERMAL_ZONE";
+		}
+
+		if (m_mode == "Space")
+		{
+			return osSpace->name()->get() + "_THERMAL_ZONE";
+		}
+
+		OpenStudio::OptionalBuildingStory^ osBuildingStory = osSpace->buildingStory();
+		String^ storyName = osBuildingStory->is_initialized() ? osBuildingStory->get()->nameString() : "NO_STORY";
+		if (m_mode == "Story")
+		{
+			return storyName + "_THERMAL_ZONE";
+		}
+
+		// StoryOrientation: the façade quadrant relative to true north, or the core
+		if (!azimuth.HasValue)
+		{
+			return storyName + "_CORE_THERMAL_ZONE";
+		}
+
+		double trueAzimuth = azimuth.Value + northAxis;
+		trueAzimuth -= 360.0 * Math::Floor(trueAzimuth / 360.0);
+		array<String^>^ orientations = { "NORTH", "EAST", "SOUTH", "WEST" };
+		int quadrant = (int)Math::Floor((trueAzimuth + 45.0) / 90.0) % 4;
+		return storyName + "_" + orientations[quadrant] + "_THERMAL_ZONE";
+	}
+
+	bool ThermalZoning::NeedsOrientation::get()
+	{
+		return m_mode == "StoryOrientation";
+	}
+
+	ThermalZoning::ThermalZoning(String^ mode, IList<String^>^ zoneKeys)
+		: m_mode(mode)
+		, m_zoneKeys(zoneKeys)
+	{
+
+	}
+}
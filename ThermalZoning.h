@@ -0,0 +1,78 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// Groups spaces into shared thermal zones, so that early-stage models simulate with fewer zones than rooms.
+	/// </summary>
+	public ref class ThermalZoning
+	{
+	public:
+		/// <summary>
+		/// Creates a zoning by mode: "Space" (one zone per space), "Story" (one zone per story), "StoryOrientation"
+		/// (per story, one perimeter zone per façade orientation and one core zone) or "SpaceType" (one zone per space type).
+		/// </summary>
+		/// <param name="mode">The zoning mode</param>
+		/// <returns name="ThermalZoning">The zoning</returns>
+		static ThermalZoning^ ByMode([Autodesk::DesignScript::Runtime::DefaultArgument("\"StoryOrientation\"")] String^ mode);
+
+		/// <summary>
+		/// Creates a zoning where the spaces with the same key share a thermal zone.
+		/// </summary>
+		/// <param name="zoneKeys">One key per cell, in the order of the cells of the cell complex</param>
+		/// <returns name="ThermalZoning">The zoning</returns>
+		static ThermalZoning^ ByKeys(IList<String^>^ zoneKeys);
+
+		/// <summary>
+		/// Returns the zoning mode, or "Keys" for a zoning created from keys.
+		/// </summary>
+		property String^ Mode
+		{
+			String^ get();
+		}
+
+		/// <summary>
+		/// Returns the available zoning modes.
+		/// </summary>
+		static property IList<String^>^ Modes
+		{
+			IList<String^>^ get();
+		}
+
+	internal:
+		// Returns the name of the thermal zone of a space. azimuth is the direction of its largest exterior
+		// wall in model coordinates (no value for a core space) and northAxis the building's north axis.
+		String^ ZoneName(int cellIndex, OpenStudio::Space^ osSpace, Nullable<double> azimuth, double northAxis);
+
+		// True if the zone name depends on the orientation of the space
+		property bool NeedsOrientation
+		{
+			bool get();
+		}
+
+	private:
+		ThermalZoning(String^ mode, IList<String^>^ zoneKeys);
+
+		String^ m_mode;
+		IList<String^>^ m_zoneKeys;
+	};
+}
@@ -0,0 +1,506 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+
+// Microbenchmarks of the result and color hot paths, for a baseline before and after changing them.
+// The managed members below call these kernels, so their figures are the kernels' plus the cost of
+// copying between managed and native buffers, which is not measured here:
+// - EnergyModel::GetColor                   -> DefaultColor (the exact ramp, not the lookup table)
+// - SimulationResult::Domain                -> ComputeStatistics (the value cache)
+// - SimulationResult::LegendRatios/Breaks   -> SortValues + ComputeBreaks
+// - SimulationResult::RGB/LegendRGB         -> ComputeBreaks + ComputeBinnedRatios + ColorMap::ApplyRatios
+// EnergyModel::DoubleValueFromQuery is not one of them: it runs its query through the OpenStudio SqlFile
+// binding. SqlResultReader::TabularValue runs the same query against the same view through SQLite, so
+// its figures measure the query plan (indexed or not) but not the overhead of the binding.
+//
+// Allocations are counted by replacing the global operator new, so they cover the C++ allocations of
+// the kernels but not the internal allocations of SQLite.
+
+#include "ColorMapKernels.h"
+#include "SqlResultReader.h"
+#include "StatisticsKernels.h"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// The benchmarks run on the main thread only.
+	std::size_t g_allocationCount = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	++g_allocationCount;
+	void* pMemory = std::malloc(size == 0 ? 1 : size);
+	if (pMemory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return pMemory;
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	std::free(pMemory);
+}
+
+namespace
+{
+	const char* const Usage =
+		"Usage: topologic-energy-bench [--sizes n1,n2,...] [--zones z1,z2,...] [--rows count] [--min-time seconds]\n"
+		"  [--filter text] [--database eplusout.sql] [--csv results.csv]\n"
+		"Sizes are the value counts of the color and legend benchmarks; zones and rows the shape of the\n"
+		"synthetic SQL file. The same arguments give the same inputs, so runs can be compared.\n";
+
+	const std::size_t HistogramBinCount = 10;
+	const std::size_t LegendCount = 11;
+	const unsigned int Seed = 20200506;
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		std::size_t size;
+		std::size_t itemsPerOperation;
+		std::size_t operations;
+		double nanosecondsPerOperation;
+		double allocationsPerOperation;
+		double itemsPerSecond;
+	};
+
+	volatile double g_sink = 0.0;
+
+	std::vector<std::size_t> SplitSizes(const std::string& rkText)
+	{
+		std::vector<std::size_t> sizes;
+		std::istringstream stream(rkText);
+		std::string part;
+		while (std::getline(stream, part, ','))
+		{
+			sizes.push_back((std::size_t)std::strtoull(part.c_str(), nullptr, 10));
+		}
+		return sizes;
+	}
+
+	// Runs the operation in doubling batches until a batch takes at least minTime seconds, after one
+	// warm-up call, and reports the last batch.
+	BenchmarkResult Measure(const std::string& rkName, std::size_t size, std::size_t itemsPerOperation, double minTime, const std::function<void()>& rkOperation)
+	{
+		rkOperation();
+
+		std::size_t operations = 1;
+		while (true)
+		{
+			std::size_t allocationCount = g_allocationCount;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < operations; ++i)
+			{
+				rkOperation();
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			allocationCount = g_allocationCount - allocationCount;
+
+			if (seconds >= minTime || operations >= ((std::size_t)1 << 40))
+			{
+				BenchmarkResult result;
+				result.name = rkName;
+				result.size = size;
+				result.itemsPerOperation = itemsPerOperation;
+				result.operations = operations;
+				result.nanosecondsPerOperation = seconds * 1e9 / (double)operations;
+				result.allocationsPerOperation = (double)allocationCount / (double)operations;
+				result.itemsPerSecond = seconds > 0.0 ? (double)(itemsPerOperation * operations) / seconds : 0.0;
+				return result;
+			}
+			operations *= 2;
+		}
+	}
+
+	// Skewed like simulation results: most zones near the median, a few large ones.
+	std::vector<double> SyntheticValues(std::size_t count)
+	{
+		std::mt19937 generator(Seed);
+		std::lognormal_distribution<double> distribution(3.0, 0.75);
+		std::vector<double> values(count);
+		for (double& rValue : values)
+		{
+			rValue = distribution(generator);
+		}
+		return values;
+	}
+
+	void Execute(sqlite3* pDatabase, const char* pkSql)
+	{
+		char* pError = nullptr;
+		if (sqlite3_exec(pDatabase, pkSql, nullptr, nullptr, &pError) != SQLITE_OK)
+		{
+			std::string message = pError != nullptr ? pError : "unknown error";
+			sqlite3_free(pError);
+			throw std::runtime_error("Fails to run an SQL statement: " + message);
+		}
+	}
+
+	// Writes an eplusout.sql with the EnergyPlus tabular schema: zoneCount zones in the queried table
+	// (InputVerificationandResultsSummary / Entire Facility / Zone Summary), padded to rowCount rows of
+	// TabularData with other reports, tables and columns.
+	void WriteSyntheticSqlFile(const std::string& rkPath, std::size_t zoneCount, std::size_t rowCount)
+	{
+		std::remove(rkPath.c_str());
+		sqlite3* pDatabase = nullptr;
+		if (sqlite3_open(rkPath.c_str(), &pDatabase) != SQLITE_OK)
+		{
+			sqlite3_close(pDatabase);
+			throw std::runtime_error("Fails to create the SQL file " + rkPath + ".");
+		}
+
+		try {
+			Execute(pDatabase,
+				"CREATE TABLE Strings (StringIndex INTEGER PRIMARY KEY, StringTypeIndex INTEGER, Value TEXT);"
+				"CREATE TABLE TabularData (TabularDataIndex INTEGER PRIMARY KEY, ReportNameIndex INTEGER, ReportForStringIndex INTEGER, "
+				"TableNameIndex INTEGER, RowNameIndex INTEGER, ColumnNameIndex INTEGER, UnitsIndex INTEGER, SimulationIndex INTEGER, "
+				"RowId INTEGER, ColumnId INTEGER, Value TEXT);"
+				"CREATE TABLE ReportData (ReportDataIndex INTEGER PRIMARY KEY, TimeIndex INTEGER, ReportDataDictionaryIndex INTEGER, Value REAL);"
+				"CREATE VIEW TabularDataWithStrings AS SELECT td.TabularDataIndex, td.Value AS Value, reportn.Value AS ReportName, "
+				"fs.Value AS ReportForString, tn.Value AS TableName, rn.Value AS RowName, cn.Value AS ColumnName, u.Value AS Units "
+				"FROM TabularData AS td "
+				"INNER JOIN Strings AS reportn ON reportn.StringIndex = td.ReportNameIndex "
+				"INNER JOIN Strings AS fs ON fs.StringIndex = td.ReportForStringIndex "
+				"INNER JOIN Strings AS tn ON tn.StringIndex = td.TableNameIndex "
+				"INNER JOIN Strings AS rn ON rn.StringIndex = td.RowNameIndex "
+				"INNER JOIN Strings AS cn ON cn.StringIndex = td.ColumnNameIndex "
+				"INNER JOIN Strings AS u ON u.StringIndex = td.UnitsIndex;"
+				"BEGIN TRANSACTION;");
+
+			sqlite3_stmt* pStringStatement = nullptr;
+			sqlite3_stmt* pRowStatement = nullptr;
+			sqlite3_prepare_v2(pDatabase, "INSERT INTO Strings VALUES (?1, 1, ?2)", -1, &pStringStatement, nullptr);
+			sqlite3_prepare_v2(pDatabase, "INSERT INTO TabularData VALUES (NULL, ?1, ?2, ?3, ?4, ?5, ?6, 1, ?7, ?8, ?9)", -1, &pRowStatement, nullptr);
+
+			int stringCount = 0;
+			std::function<int(const std::string&)> addString = [&](const std::string& rkValue)
+			{
+				sqlite3_reset(pStringStatement);
+				sqlite3_bind_int(pStringStatement, 1, ++stringCount);
+				sqlite3_bind_text(pStringStatement, 2, rkValue.c_str(), (int)rkValue.size(), SQLITE_TRANSIENT);
+				if (sqlite3_step(pStringStatement) != SQLITE_DONE)
+				{
+					throw std::runtime_error("Fails to write the synthetic SQL file.");
+				}
+				return stringCount;
+			};
+
+			int entireFacility = addString("Entire Facility");
+			int squareMeters = addString("m2");
+			std::vector<int> zoneNames;
+			for (std::size_t zone = 0; zone < zoneCount; ++zone)
+			{
+				zoneNames.push_back(addString("ZONE_" + std::to_string(zone + 1)));
+			}
+
+			std::mt19937 generator(Seed);
+			std::uniform_real_distribution<double> distribution(1.0, 500.0);
+			std::function<void(int, int, int, std::size_t, int)> addRow = [&](int reportName, int tableName, int columnName, std::size_t zone, int column)
+			{
+				std::string value = std::to_string(distribution(generator));
+				sqlite3_reset(pRowStatement);
+				sqlite3_bind_int(pRowStatement, 1, reportName);
+				sqlite3_bind_int(pRowStatement, 2, entireFacility);
+				sqlite3_bind_int(pRowStatement, 3, tableName);
+				sqlite3_bind_int(pRowStatement, 4, zoneNames[zone]);
+				sqlite3_bind_int(pRowStatement, 5, columnName);
+				sqlite3_bind_int(pRowStatement, 6, squareMeters);
+				sqlite3_bind_int(pRowStatement, 7, (int)zone);
+				sqlite3_bind_int(pRowStatement, 8, column);
+				sqlite3_bind_text(pRowStatement, 9, value.c_str(), (int)value.size(), SQLITE_TRANSIENT);
+				if (sqlite3_step(pRowStatement) != SQLITE_DONE)
+				{
+					throw std::runtime_error("Fails to write the synthetic SQL file.");
+				}
+			};
+
+			// The tables that only make the file larger come first and the queried one last, as in a real
+			// eplusout.sql where the zone summary is one table among many: a scan of the unindexed view
+			// has to read the whole file before it reaches the queried rows.
+			std::size_t fillerRowCount = rowCount - std::min(rowCount, zoneCount);
+			std::size_t rows = 0;
+			for (std::size_t table = 1; rows < fillerRowCount; ++table)
+			{
+				int reportName = addString("SyntheticReport" + std::to_string(table / 8));
+				int tableName = addString("Synthetic Table " + std::to_string(table));
+				for (int column = 0; column < 4 && rows < fillerRowCount; ++column)
+				{
+					int columnName = addString(column == 0 ? "Area" : "Column " + std::to_string(column));
+					for (std::size_t zone = 0; zone < zoneCount && rows < fillerRowCount; ++zone, ++rows)
+					{
+						addRow(reportName, tableName, columnName, zone, column);
+					}
+				}
+			}
+
+			int reportName = addString("InputVerificationandResultsSummary");
+			int tableName = addString("Zone Summary");
+			int columnName = addString("Area");
+			for (std::size_t zone = 0; zone < zoneCount; ++zone)
+			{
+				addRow(reportName, tableName, columnName, zone, 0);
+			}
+
+			sqlite3_finalize(pStringStatement);
+			sqlite3_finalize(pRowStatement);
+			Execute(pDatabase, "COMMIT;");
+		}
+		catch (...)
+		{
+			sqlite3_close(pDatabase);
+			throw;
+		}
+		sqlite3_close(pDatabase);
+	}
+
+	void Print(const BenchmarkResult& rkResult)
+	{
+		std::cout << std::left << std::setw(44) << rkResult.name << std::right
+			<< std::setw(10) << rkResult.size
+			<< std::setw(16) << std::fixed << std::setprecision(1) << rkResult.nanosecondsPerOperation
+			<< std::setw(14) << std::setprecision(2) << rkResult.allocationsPerOperation
+			<< std::setw(16) << std::scientific << std::setprecision(3) << rkResult.itemsPerSecond
+			<< std::defaultfloat << "\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::size_t> sizes = { 100, 10000, 1000000 };
+	std::vector<std::size_t> zoneCounts = { 10, 100, 1000 };
+	std::size_t rowCount = 100000;
+	double minTime = 0.2;
+	std::string filter;
+	std::string databasePath = "topologic-energy-bench.sql";
+	std::string csvPath;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string option = argv[i];
+		if (option == "--help")
+		{
+			std::cout << Usage;
+			return 0;
+		}
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing value for " << option << ".\n" << Usage;
+			return 2;
+		}
+
+		std::string value = argv[++i];
+		if (option == "--sizes") sizes = SplitSizes(value);
+		else if (option == "--zones") zoneCounts = SplitSizes(value);
+		else if (option == "--rows") rowCount = (std::size_t)std::strtoull(value.c_str(), nullptr, 10);
+		else if (option == "--min-time") minTime = std::atof(value.c_str());
+		else if (option == "--filter") filter = value;
+		else if (option == "--database") databasePath = value;
+		else if (option == "--csv") csvPath = value;
+		else
+		{
+			std::cerr << "Unknown option " << option << ".\n" << Usage;
+			return 2;
+		}
+	}
+
+	std::vector<BenchmarkResult> results;
+	std::function<void(const BenchmarkResult&)> add = [&](const BenchmarkResult& rkResult)
+	{
+		Print(rkResult);
+		results.push_back(rkResult);
+	};
+	std::function<bool(const std::string&)> isSelected = [&](const std::string& rkName)
+	{
+		return filter.empty() || rkName.find(filter) != std::string::npos;
+	};
+
+	std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(10) << "size"
+		<< std::setw(16) << "ns/op" << std::setw(14) << "allocs/op" << std::setw(16) << "items/s" << "\n";
+
+	try
+	{
+		const TopologicEnergyCore::ColorMap& rkColorMap = TopologicEnergyCore::ColorMap::ByType(TopologicEnergyCore::COLORMAP_DEFAULT);
+		for (std::size_t size : sizes)
+		{
+			if (size == 0)
+			{
+				continue;
+			}
+
+			std::vector<double> values = SyntheticValues(size);
+			std::vector<double> sortedValues = TopologicEnergyCore::SortValues(values.data(), values.size());
+			TopologicEnergyCore::ValueStatistics statistics = TopologicEnergyCore::ComputeStatistics(values.data(), values.size(), HistogramBinCount);
+			std::vector<double> ratios(size);
+			std::vector<unsigned char> colors(size * 3);
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				ratios[i] = (double)i / (double)size;
+			}
+
+			if (isSelected("GetColor"))
+			{
+				add(Measure("GetColor", size, size, minTime, [&]()
+				{
+					unsigned int sum = 0;
+					for (double ratio : ratios)
+					{
+						unsigned char color[3];
+						TopologicEnergyCore::DefaultColor(ratio, color);
+						sum += color[0];
+					}
+					g_sink = sum;
+				}));
+			}
+
+			if (isSelected("Domain"))
+			{
+				add(Measure("Domain", size, size, minTime, [&]()
+				{
+					g_sink = TopologicEnergyCore::ComputeStatistics(values.data(), values.size(), HistogramBinCount).maxValue;
+				}));
+			}
+
+			if (isSelected("SortValues"))
+			{
+				add(Measure("SortValues", size, size, minTime, [&]()
+				{
+					g_sink = TopologicEnergyCore::SortValues(values.data(), values.size()).back();
+				}));
+			}
+
+			for (const std::string& rkBinningName : TopologicEnergyCore::BinningModeNames())
+			{
+				TopologicEnergyCore::BinningMode binningMode = TopologicEnergyCore::BINNING_LINEAR;
+				TopologicEnergyCore::BinningModeByName(rkBinningName, binningMode);
+
+				std::string legendName = "LegendRatios/" + rkBinningName;
+				if (isSelected(legendName))
+				{
+					add(Measure(legendName, size, LegendCount, minTime, [&]()
+					{
+						g_sink = TopologicEnergyCore::ComputeBreaks(sortedValues.data(), sortedValues.size(), binningMode, LegendCount, statistics.minValue, statistics.maxValue)[1];
+					}));
+				}
+
+				std::string rgbName = "RGB/" + rkBinningName;
+				if (isSelected(rgbName))
+				{
+					add(Measure(rgbName, size, size, minTime, [&]()
+					{
+						std::vector<double> breaks = TopologicEnergyCore::ComputeBreaks(sortedValues.data(), sortedValues.size(), binningMode, LegendCount, statistics.minValue, statistics.maxValue);
+						TopologicEnergyCore::ComputeBinnedRatios(values.data(), values.size(), sortedValues.data(), sortedValues.size(), binningMode, breaks, ratios.data());
+						rkColorMap.ApplyRatios(ratios.data(), ratios.size(), colors.data(), false);
+						g_sink = colors[0];
+					}));
+				}
+			}
+		}
+
+		if (isSelected("DoubleValueFromQuery") || isSelected("TabularValues"))
+		{
+			for (std::size_t zoneCount : zoneCounts)
+			{
+				if (zoneCount == 0)
+				{
+					continue;
+				}
+
+				std::size_t fileRowCount = std::max(rowCount, zoneCount);
+				WriteSyntheticSqlFile(databasePath, zoneCount, fileRowCount);
+				std::vector<std::string> zoneNames;
+				for (std::size_t zone = 0; zone < zoneCount; ++zone)
+				{
+					zoneNames.push_back("ZONE_" + std::to_string(zone + 1));
+				}
+
+				// The first reader leaves the file as EnergyPlus wrote it; the second adds the lookup indexes.
+				for (int isIndexed = 0; isIndexed < 2; ++isIndexed)
+				{
+					TopologicEnergyCore::SqlResultReader reader(databasePath, isIndexed != 0);
+					std::string suffix = std::string(isIndexed != 0 ? "/indexed" : "/unindexed") + "/rows=" + std::to_string(fileRowCount);
+
+					if (isSelected("DoubleValueFromQuery" + suffix))
+					{
+						std::size_t zone = 0;
+						add(Measure("DoubleValueFromQuery" + suffix, zoneCount, 1, minTime, [&]()
+						{
+							double value = 0.0;
+							reader.TabularValue("InputVerificationandResultsSummary", "Entire Facility", "Zone Summary", "Area", zoneNames[zone], "m2", value);
+							zone = (zone + 1) % zoneCount;
+							g_sink = value;
+						}));
+					}
+
+					if (isSelected("TabularValues" + suffix))
+					{
+						add(Measure("TabularValues" + suffix, zoneCount, zoneCount, minTime, [&]()
+						{
+							g_sink = reader.TabularValues("InputVerificationandResultsSummary", "Entire Facility", "Zone Summary", "Area", zoneNames, "m2")[0];
+						}));
+					}
+				}
+			}
+			std::remove(databasePath.c_str());
+		}
+	}
+	catch (const std::exception& rkException)
+	{
+		std::cerr << rkException.what() << "\n";
+		return 1;
+	}
+
+	if (!csvPath.empty())
+	{
+		std::ofstream file(csvPath.c_str());
+		file << "benchmark,size,items_per_op,operations,ns_per_op,allocs_per_op,items_per_second\n";
+		file << std::setprecision(17);
+		for (const BenchmarkResult& rkResult : results)
+		{
+			file << rkResult.name << "," << rkResult.size << "," << rkResult.itemsPerOperation << "," << rkResult.operations << ","
+				<< rkResult.nanosecondsPerOperation << "," << rkResult.allocationsPerOperation << "," << rkResult.itemsPerSecond << "\n";
+		}
+		if (!file)
+		{
+			std::cerr << "Fails to write " << csvPath << ".\n";
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,540 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Python bindings of the native core (module topologic_energy). Buffers owned by the native objects
+// (cell vertices, surface coordinates, result columns) are returned as read-only NumPy arrays that
+// point into them and keep their owner alive, so no vertex or value is copied or visited in Python.
+
+#include "BuildingModelKernels.h"
+#include "IdfExportFormat.h"
+#include "ObjCellFormat.h"
+#include "OsmGeometryFormat.h"
+#include "ResultArchiveFormat.h"
+#include "SimulationProcess.h"
+#include "SqlResultReader.h"
+#include "TraceRecorder.h"
+
+#include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace bp = boost::python;
+namespace np = boost::python::numpy;
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		// A read-only, C-ordered array over native memory, alive as long as rkOwner
+		template <typename T>
+		np::ndarray View(const T* pkData, const std::vector<Py_intptr_t>& rkShape, const bp::object& rkOwner)
+		{
+			static const T kEmpty = T();
+			std::vector<Py_intptr_t> strides(rkShape.size());
+			Py_intptr_t stride = sizeof(T);
+			for (std::size_t i = rkShape.size(); i-- > 0;)
+			{
+				strides[i] = stride;
+				stride *= rkShape[i];
+			}
+			return np::from_data(pkData != nullptr ? pkData : &kEmpty, np::dtype::get_builtin<T>(), rkShape, strides, rkOwner);
+		}
+
+		template <typename T>
+		void DeleteVector(PyObject* pCapsule)
+		{
+			delete (std::vector<T>*)PyCapsule_GetPointer(pCapsule, nullptr);
+		}
+
+		// Hands a vector over to NumPy without copying its values.
+		template <typename T>
+		np::ndarray Adopt(std::vector<T>&& rrValues)
+		{
+			std::vector<T>* pValues = new std::vector<T>(std::move(rrValues));
+			bp::object owner(bp::handle<>(PyCapsule_New(pValues, nullptr, &DeleteVector<T>)));
+			return View(pValues->data(), std::vector<Py_intptr_t>{ (Py_intptr_t)pValues->size() }, owner);
+		}
+
+		// A C-ordered copy of any array-like, or the array itself if it already is one.
+		template <typename T>
+		np::ndarray Contiguous(const bp::object& rkArray)
+		{
+			bp::object numpy = bp::import("numpy");
+			return bp::extract<np::ndarray>(numpy.attr("ascontiguousarray")(rkArray, np::dtype::get_builtin<T>()));
+		}
+
+		template <typename T>
+		std::vector<T> ToVector(const np::ndarray& rkArray)
+		{
+			std::size_t count = 1;
+			for (int i = 0; i < rkArray.get_nd(); ++i)
+			{
+				count *= (std::size_t)rkArray.shape(i);
+			}
+			const T* pkData = (const T*)rkArray.get_data();
+			return std::vector<T>(pkData, pkData + count);
+		}
+
+		template <typename T>
+		bp::list ToList(const std::vector<T>& rkValues)
+		{
+			bp::list list;
+			for (const T& rkValue : rkValues)
+			{
+				list.append(rkValue);
+			}
+			return list;
+		}
+
+		std::vector<std::string> ToStrings(const bp::object& rkSequence)
+		{
+			std::vector<std::string> strings;
+			for (bp::ssize_t i = 0; i < bp::len(rkSequence); ++i)
+			{
+				strings.push_back(bp::extract<std::string>(rkSequence[i]));
+			}
+			return strings;
+		}
+
+		// Lets other Python threads (e.g. Blender's UI) run while a native call blocks.
+		class ReleasedGil
+		{
+		public:
+			ReleasedGil() : m_pState(PyEval_SaveThread()) {}
+			~ReleasedGil() { PyEval_RestoreThread(m_pState); }
+
+		private:
+			PyThreadState* m_pState;
+		};
+
+		// CellBuffer
+
+		// The vertices are copied once, in bulk, since the buffer owns them.
+		CellBuffer* CellBufferByArrays(const bp::object& rkCoordinates, const bp::object& rkFaceVertexOffsets, const bp::object& rkCellFaceOffsets)
+		{
+			return new CellBuffer(
+				ToVector<double>(Contiguous<double>(rkCoordinates)),
+				ToVector<std::size_t>(Contiguous<std::size_t>(rkFaceVertexOffsets)),
+				ToVector<std::size_t>(Contiguous<std::size_t>(rkCellFaceOffsets)));
+		}
+
+		np::ndarray CellBufferCoordinates(const bp::object& rkSelf)
+		{
+			const CellBuffer& rkCells = bp::extract<const CellBuffer&>(rkSelf);
+			return View(rkCells.CoordinateArray().data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkCells.CoordinateArray().size() / 3, 3 }, rkSelf);
+		}
+
+		np::ndarray CellBufferFaceVertexOffsets(const bp::object& rkSelf)
+		{
+			const CellBuffer& rkCells = bp::extract<const CellBuffer&>(rkSelf);
+			return View(rkCells.FaceVertexOffsets().data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkCells.FaceVertexOffsets().size() }, rkSelf);
+		}
+
+		np::ndarray CellBufferCellFaceOffsets(const bp::object& rkSelf)
+		{
+			const CellBuffer& rkCells = bp::extract<const CellBuffer&>(rkSelf);
+			return View(rkCells.CellFaceOffsets().data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkCells.CellFaceOffsets().size() }, rkSelf);
+		}
+
+		std::size_t CellBufferFaceCount(const CellBuffer& rkCells, std::size_t cellIndex)
+		{
+			if (cellIndex >= rkCells.CellCount())
+			{
+				throw std::out_of_range("The cell index is out of range.");
+			}
+			return rkCells.FaceCount(cellIndex);
+		}
+
+		std::size_t CellBufferFaceId(const CellBuffer& rkCells, std::size_t cellIndex, std::size_t faceIndex)
+		{
+			if (faceIndex >= CellBufferFaceCount(rkCells, cellIndex))
+			{
+				throw std::out_of_range("The face index is out of range.");
+			}
+			return rkCells.FaceId(cellIndex, faceIndex);
+		}
+
+		np::ndarray CellBufferFace(const bp::object& rkSelf, std::size_t faceId)
+		{
+			const CellBuffer& rkCells = bp::extract<const CellBuffer&>(rkSelf);
+			if (faceId + 1 >= rkCells.FaceVertexOffsets().size())
+			{
+				throw std::out_of_range("The face id is out of range.");
+			}
+			return View(rkCells.Coordinates(faceId), std::vector<Py_intptr_t>{ (Py_intptr_t)rkCells.VertexCount(faceId), 3 }, rkSelf);
+		}
+
+		CellBuffer* ReadObjCellsByPath(const std::string& rkPath)
+		{
+			return new CellBuffer(ReadObjCells(rkPath));
+		}
+
+		// OsmGeometry
+
+		OsmGeometry* ReadOsmGeometryByPath(const std::string& rkPath)
+		{
+			ReleasedGil releasedGil;
+			return new OsmGeometry(ReadOsmGeometry(rkPath));
+		}
+
+		bp::list OsmGeometrySpaceNames(const OsmGeometry& rkGeometry) { return ToList(rkGeometry.spaceNames); }
+		bp::list OsmGeometrySurfaceNames(const OsmGeometry& rkGeometry) { return ToList(rkGeometry.surfaceNames); }
+		bp::list OsmGeometrySurfaceTypes(const OsmGeometry& rkGeometry) { return ToList(rkGeometry.surfaceTypes); }
+		bp::list OsmGeometryApertureNames(const OsmGeometry& rkGeometry) { return ToList(rkGeometry.apertureNames); }
+
+		np::ndarray OsmGeometryApertureCoordinates(const bp::object& rkSelf)
+		{
+			const OsmGeometry& rkGeometry = bp::extract<const OsmGeometry&>(rkSelf);
+			return View(rkGeometry.apertureCoordinates.data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkGeometry.apertureCoordinates.size() / 3, 3 }, rkSelf);
+		}
+
+		np::ndarray OsmGeometryApertureVertexOffsets(const bp::object& rkSelf)
+		{
+			const OsmGeometry& rkGeometry = bp::extract<const OsmGeometry&>(rkSelf);
+			return View(rkGeometry.apertureVertexOffsets.data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkGeometry.apertureVertexOffsets.size() }, rkSelf);
+		}
+
+		np::ndarray OsmGeometryApertureHostFaces(const bp::object& rkSelf)
+		{
+			const OsmGeometry& rkGeometry = bp::extract<const OsmGeometry&>(rkSelf);
+			return View(rkGeometry.apertureHostFaces.data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkGeometry.apertureHostFaces.size() }, rkSelf);
+		}
+
+		// BuildingModel
+
+		bp::list ParametersFloorLevels(const BuildingModelParameters& rkParameters)
+		{
+			return ToList(rkParameters.floorLevels);
+		}
+
+		void SetParametersFloorLevels(BuildingModelParameters& rParameters, const bp::object& rkFloorLevels)
+		{
+			rParameters.floorLevels = ToVector<double>(Contiguous<double>(rkFloorLevels));
+		}
+
+		BuildingModelParameters* BuildingModelParametersByDefault()
+		{
+			BuildingModelParameters* pParameters = new BuildingModelParameters();
+			pParameters->buildingName = "Building";
+			pParameters->northAxis = 0.0;
+			pParameters->glazingRatio = 0.0;
+			pParameters->hasWindowLayout = false;
+			pParameters->windowLayout.sillHeight = 0.9;
+			pParameters->windowLayout.headHeight = 2.1;
+			pParameters->windowLayout.windowSpacing = 3.0;
+			pParameters->heatingTemp = 20.0;
+			pParameters->coolingTemp = 25.0;
+			pParameters->tolerance = 0.0001;
+			return pParameters;
+		}
+
+		BuildingModel* BuildModelByCells(const CellBuffer& rkCells, const BuildingModelParameters& rkParameters)
+		{
+			ReleasedGil releasedGil;
+			return new BuildingModel(BuildModel(rkCells, rkParameters));
+		}
+
+		std::size_t BuildingModelSpaceCount(const BuildingModel& rkModel) { return rkModel.spaces.size(); }
+		std::size_t BuildingModelSurfaceCount(const BuildingModel& rkModel) { return rkModel.surfaces.size(); }
+
+		const ModelSpace& BuildingModelSpace(const BuildingModel& rkModel, std::size_t index)
+		{
+			if (index >= rkModel.spaces.size())
+			{
+				throw std::out_of_range("The space index is out of range.");
+			}
+			return rkModel.spaces[index];
+		}
+
+		const ModelSurface& BuildingModelSurface(const BuildingModel& rkModel, std::size_t index)
+		{
+			if (index >= rkModel.surfaces.size())
+			{
+				throw std::out_of_range("The surface index is out of range.");
+			}
+			return rkModel.surfaces[index];
+		}
+
+		bp::list ModelSpaceSurfaces(const ModelSpace& rkSpace)
+		{
+			return ToList(rkSpace.surfaces);
+		}
+
+		// The surface object keeps its model alive, and the array keeps the surface object alive.
+		np::ndarray ModelSurfaceCoordinates(const bp::object& rkSelf)
+		{
+			const ModelSurface& rkSurface = bp::extract<const ModelSurface&>(rkSelf);
+			return View(rkSurface.coordinates.data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkSurface.coordinates.size() / 3, 3 }, rkSelf);
+		}
+
+		std::size_t ModelSurfaceWindowCount(const ModelSurface& rkSurface)
+		{
+			return rkSurface.windows.size();
+		}
+
+		np::ndarray ModelSurfaceWindow(const bp::object& rkSelf, std::size_t index)
+		{
+			const ModelSurface& rkSurface = bp::extract<const ModelSurface&>(rkSelf);
+			if (index >= rkSurface.windows.size())
+			{
+				throw std::out_of_range("The window index is out of range.");
+			}
+			const std::vector<double>& rkCoordinates = rkSurface.windows[index].coordinates;
+			return View(rkCoordinates.data(), std::vector<Py_intptr_t>{ (Py_intptr_t)rkCoordinates.size() / 3, 3 }, rkSelf);
+		}
+
+		std::string ModelSurfaceWindowName(const ModelSurface& rkSurface, std::size_t index)
+		{
+			if (index >= rkSurface.windows.size())
+			{
+				throw std::out_of_range("The window index is out of range.");
+			}
+			return rkSurface.windows[index].name;
+		}
+
+		void WriteIdfByModel(const BuildingModel& rkModel, const std::string& rkTemplatePath, const std::string& rkPath, const IdfConstructions& rkConstructions)
+		{
+			ReleasedGil releasedGil;
+			WriteIdf(rkModel, rkTemplatePath, rkConstructions, rkPath);
+		}
+
+		void WriteIdfByDefault(const BuildingModel& rkModel, const std::string& rkTemplatePath, const std::string& rkPath)
+		{
+			WriteIdfByModel(rkModel, rkTemplatePath, rkPath, IdfConstructions());
+		}
+
+		int RunEnergyPlus(const std::string& rkExecutable, const std::string& rkIdfPath, const std::string& rkWeatherPath, const std::string& rkOutputDirectory)
+		{
+			std::vector<std::string> arguments = EnergyPlusArguments(rkIdfPath, rkWeatherPath, rkOutputDirectory);
+			ReleasedGil releasedGil;
+			return RunProcess(rkExecutable, arguments, rkOutputDirectory);
+		}
+
+		// Results
+
+		bp::object SqlTabularValue(const SqlResultReader& rkReader,
+			const std::string& rkReportName, const std::string& rkReportForString, const std::string& rkTableName,
+			const std::string& rkColumnName, const std::string& rkRowName, const std::string& rkUnits)
+		{
+			double value = 0.0;
+			if (!rkReader.TabularValue(rkReportName, rkReportForString, rkTableName, rkColumnName, rkRowName, rkUnits, value))
+			{
+				return bp::object();
+			}
+			return bp::object(value);
+		}
+
+		np::ndarray SqlTabularValues(const SqlResultReader& rkReader,
+			const std::string& rkReportName, const std::string& rkReportForString, const std::string& rkTableName,
+			const std::string& rkColumnName, const bp::object& rkRowNames, const std::string& rkUnits)
+		{
+			std::vector<std::string> rowNames = ToStrings(rkRowNames);
+			std::vector<double> values;
+			{
+				ReleasedGil releasedGil;
+				values = rkReader.TabularValues(rkReportName, rkReportForString, rkTableName, rkColumnName, rowNames, rkUnits);
+			}
+			return Adopt(std::move(values));
+		}
+
+		int ArchiveFindColumn(const ResultArchiveReader& rkReader, const std::string& rkRunName, const std::string& rkMetricName)
+		{
+			return rkReader.FindColumn(rkRunName, rkMetricName);
+		}
+
+		bp::list ArchiveFindColumns(const ResultArchiveReader& rkReader, const std::string& rkMetricName)
+		{
+			return ToList(rkReader.FindColumns(rkMetricName));
+		}
+
+		bp::tuple ArchiveColumnNames(const ResultArchiveReader& rkReader, std::size_t column)
+		{
+			const ArchiveColumnEntry& rkColumn = rkReader.Column(column);
+			return bp::make_tuple(rkReader.String(rkColumn.runName), rkReader.String(rkColumn.metricName), rkReader.String(rkColumn.units));
+		}
+
+		bp::list ArchiveLabels(const ResultArchiveReader& rkReader, std::size_t column)
+		{
+			return ToList(rkReader.Labels(rkReader.Column(column).labelSet));
+		}
+
+		// frameCount x rowCount, straight from the mapped file
+		np::ndarray ArchiveData(const bp::object& rkSelf, std::size_t column)
+		{
+			const ResultArchiveReader& rkReader = bp::extract<const ResultArchiveReader&>(rkSelf);
+			const ArchiveColumnEntry& rkColumn = rkReader.Column(column);
+			return View(rkReader.Data(column), std::vector<Py_intptr_t>{ (Py_intptr_t)rkColumn.frameCount, (Py_intptr_t)rkColumn.rowCount }, rkSelf);
+		}
+
+		// Tracing
+
+		void WriteChromeTraceByPath(const std::string& rkPath)
+		{
+			WriteChromeTrace(TraceRecords(), rkPath);
+		}
+
+		void WriteBinaryTraceByPath(const std::string& rkPath)
+		{
+			WriteBinaryTrace(TraceRecords(), rkPath);
+		}
+
+		void ConvertBinaryTrace(const std::string& rkBinaryPath, const std::string& rkChromePath)
+		{
+			WriteChromeTrace(ReadBinaryTrace(rkBinaryPath), rkChromePath);
+		}
+
+		void TranslateOutOfRange(const std::out_of_range& rkException)
+		{
+			PyErr_SetString(PyExc_IndexError, rkException.what());
+		}
+
+		void TranslateRuntimeError(const std::runtime_error& rkException)
+		{
+			PyErr_SetString(PyExc_RuntimeError, rkException.what());
+		}
+
+		void TranslateInvalidArgument(const std::invalid_argument& rkException)
+		{
+			PyErr_SetString(PyExc_ValueError, rkException.what());
+		}
+	}
+}
+
+BOOST_PYTHON_MODULE(topologic_energy)
+{
+	using namespace TopologicEnergyCore;
+
+	np::initialize();
+	bp::register_exception_translator<std::out_of_range>(&TranslateOutOfRange);
+	bp::register_exception_translator<std::runtime_error>(&TranslateRuntimeError);
+	bp::register_exception_translator<std::invalid_argument>(&TranslateInvalidArgument);
+
+	bp::class_<CellBuffer, boost::noncopyable>("CellBuffer", "The faces of a set of cells as flat vertex arrays.", bp::no_init)
+		.def("__init__", bp::make_constructor(&CellBufferByArrays))
+		.def("cell_count", &CellBuffer::CellCount)
+		.def("face_count", &CellBufferFaceCount)
+		.def("face_id", &CellBufferFaceId)
+		.def("face", &CellBufferFace)
+		.add_property("coordinates", &CellBufferCoordinates)
+		.add_property("face_vertex_offsets", &CellBufferFaceVertexOffsets)
+		.add_property("cell_face_offsets", &CellBufferCellFaceOffsets);
+
+	bp::def("read_obj_cells", &ReadObjCellsByPath, bp::return_value_policy<bp::manage_new_object>());
+	bp::def("write_obj_cells", &WriteObjCells);
+
+	bp::class_<OsmGeometry, boost::noncopyable>("OsmGeometry", "The spaces, surfaces and subsurfaces of an OSM file.", bp::no_init)
+		.add_property("cells", bp::make_getter(&OsmGeometry::cells, bp::return_internal_reference<>()))
+		.add_property("space_names", &OsmGeometrySpaceNames)
+		.add_property("surface_names", &OsmGeometrySurfaceNames)
+		.add_property("surface_types", &OsmGeometrySurfaceTypes)
+		.add_property("aperture_names", &OsmGeometryApertureNames)
+		.add_property("aperture_coordinates", &OsmGeometryApertureCoordinates)
+		.add_property("aperture_vertex_offsets", &OsmGeometryApertureVertexOffsets)
+		.add_property("aperture_host_faces", &OsmGeometryApertureHostFaces);
+
+	bp::def("read_osm_geometry", &ReadOsmGeometryByPath, bp::return_value_policy<bp::manage_new_object>());
+
+	bp::enum_<SurfaceType>("SurfaceType")
+		.value("WALL", SURFACE_WALL)
+		.value("FLOOR", SURFACE_FLOOR)
+		.value("ROOFCEILING", SURFACE_ROOFCEILING);
+
+	bp::enum_<BoundaryCondition>("BoundaryCondition")
+		.value("OUTDOORS", BOUNDARY_OUTDOORS)
+		.value("GROUND", BOUNDARY_GROUND)
+		.value("SURFACE", BOUNDARY_SURFACE);
+
+	bp::class_<WindowLayoutParameters>("WindowLayoutParameters")
+		.def_readwrite("sill_height", &WindowLayoutParameters::sillHeight)
+		.def_readwrite("head_height", &WindowLayoutParameters::headHeight)
+		.def_readwrite("window_spacing", &WindowLayoutParameters::windowSpacing);
+
+	bp::class_<BuildingModelParameters>("BuildingModelParameters", bp::no_init)
+		.def("__init__", bp::make_constructor(&BuildingModelParametersByDefault))
+		.def_readwrite("building_name", &BuildingModelParameters::buildingName)
+		.add_property("floor_levels", &ParametersFloorLevels, &SetParametersFloorLevels)
+		.def_readwrite("north_axis", &BuildingModelParameters::northAxis)
+		.def_readwrite("glazing_ratio", &BuildingModelParameters::glazingRatio)
+		.def_readwrite("has_window_layout", &BuildingModelParameters::hasWindowLayout)
+		.def_readwrite("window_layout", &BuildingModelParameters::windowLayout)
+		.def_readwrite("heating_temp", &BuildingModelParameters::heatingTemp)
+		.def_readwrite("cooling_temp", &BuildingModelParameters::coolingTemp)
+		.def_readwrite("tolerance", &BuildingModelParameters::tolerance);
+
+	bp::class_<ModelSpace, boost::noncopyable>("ModelSpace", bp::no_init)
+		.def_readonly("name", &ModelSpace::name)
+		.def_readonly("zone_name", &ModelSpace::zoneName)
+		.def_readonly("story_index", &ModelSpace::storyIndex)
+		.def_readonly("volume", &ModelSpace::volume)
+		.def_readonly("ceiling_height", &ModelSpace::ceilingHeight)
+		.add_property("surfaces", &ModelSpaceSurfaces);
+
+	bp::class_<ModelSurface, boost::noncopyable>("ModelSurface", bp::no_init)
+		.def_readonly("name", &ModelSurface::name)
+		.def_readonly("type", &ModelSurface::type)
+		.def_readonly("boundary_condition", &ModelSurface::boundaryCondition)
+		.def_readonly("space_index", &ModelSurface::spaceIndex)
+		.def_readonly("adjacent_surface", &ModelSurface::adjacentSurface)
+		.add_property("coordinates", &ModelSurfaceCoordinates)
+		.def("window_count", &ModelSurfaceWindowCount)
+		.def("window", &ModelSurfaceWindow)
+		.def("window_name", &ModelSurfaceWindowName);
+
+	bp::class_<BuildingModel, boost::noncopyable>("BuildingModel", bp::no_init)
+		.def_readonly("name", &BuildingModel::name)
+		.def("space_count", &BuildingModelSpaceCount)
+		.def("space", &BuildingModelSpace, bp::return_internal_reference<>())
+		.def("surface_count", &BuildingModelSurfaceCount)
+		.def("surface", &BuildingModelSurface, bp::return_internal_reference<>());
+
+	bp::def("build_model", &BuildModelByCells, bp::return_value_policy<bp::manage_new_object>());
+
+	bp::class_<IdfConstructions>("IdfConstructions")
+		.def_readwrite("exterior_wall", &IdfConstructions::exteriorWall)
+		.def_readwrite("exterior_roof", &IdfConstructions::exteriorRoof)
+		.def_readwrite("ground_floor", &IdfConstructions::groundFloor)
+		.def_readwrite("interior_wall", &IdfConstructions::interiorWall)
+		.def_readwrite("interior_floor", &IdfConstructions::interiorFloor)
+		.def_readwrite("interior_ceiling", &IdfConstructions::interiorCeiling)
+		.def_readwrite("window", &IdfConstructions::window);
+
+	bp::def("write_idf", &WriteIdfByModel);
+	bp::def("write_idf", &WriteIdfByDefault);
+	bp::def("run_energyplus", &RunEnergyPlus);
+
+	bp::class_<SqlResultReader, boost::noncopyable>("SqlResultReader", bp::init<std::string, bp::optional<bool>>())
+		.def("tabular_value", &SqlTabularValue)
+		.def("tabular_values", &SqlTabularValues);
+
+	bp::class_<ResultArchiveReader, boost::noncopyable>("ResultArchiveReader", bp::init<std::string>())
+		.def("column_count", &ResultArchiveReader::ColumnCount)
+		.def("find_column", &ArchiveFindColumn)
+		.def("find_columns", &ArchiveFindColumns)
+		.def("column_names", &ArchiveColumnNames)
+		.def("labels", &ArchiveLabels)
+		.def("data", &ArchiveData);
+
+	bp::def("enable_tracing", &EnableTracing, (bp::arg("capacity") = 65536));
+	bp::def("disable_tracing", &DisableTracing);
+	bp::def("is_tracing_enabled", &IsTracingEnabled);
+	bp::def("write_chrome_trace", &WriteChromeTraceByPath);
+	bp::def("write_binary_trace", &WriteBinaryTraceByPath);
+	bp::def("convert_binary_trace", &ConvertBinaryTrace);
+}
@@ -0,0 +1,346 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Headless pipeline for Linux simulation servers: cells (OBJ) -> energy model -> IDF -> EnergyPlus -> SQL results.
+
+#include "BuildingModelKernels.h"
+#include "IdfExportFormat.h"
+#include "MetricsSnapshot.h"
+#include "ObjCellFormat.h"
+#include "SimulationProcess.h"
+#include "SqlResultReader.h"
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* const Usage =
+		"Usage: topologic-energy-run --cells <cells.obj> --template <template.idf> --weather <weather.epw> --output <directory>\n"
+		"  [--floor-levels z0,z1,...] [--north-axis degrees] [--glazing ratio] [--window-layout sill,head,spacing]\n"
+		"  [--heating temperature] [--cooling temperature] [--energyplus executable] [--no-run]\n"
+		"  [--query report,reportFor,table,column,units]... [--trace trace.json] [--trace-binary trace.tet]\n"
+		"  [--metrics metrics.prom]\n"
+		"Each OBJ object or group is one cell. Each query prints one line per zone: zone,value.\n";
+
+	std::vector<std::string> Split(const std::string& rkText, char separator)
+	{
+		std::vector<std::string> parts;
+		std::istringstream stream(rkText);
+		std::string part;
+		while (std::getline(stream, part, separator))
+		{
+			parts.push_back(part);
+		}
+		return parts;
+	}
+
+	std::vector<double> SplitDoubles(const std::string& rkText)
+	{
+		std::vector<double> values;
+		for (const std::string& rkPart : Split(rkText, ','))
+		{
+			values.push_back(std::atof(rkPart.c_str()));
+		}
+		return values;
+	}
+
+	// Writes the spans of the run when main returns, whether or not the run succeeded.
+	class TraceFiles
+	{
+	public:
+		std::string chromePath;
+		std::string binaryPath;
+
+		~TraceFiles()
+		{
+			if (chromePath.empty() && binaryPath.empty())
+			{
+				return;
+			}
+
+			try {
+				std::vector<TopologicEnergyCore::TraceRecord> records = TopologicEnergyCore::TraceRecords();
+				if (!chromePath.empty())
+				{
+					TopologicEnergyCore::WriteChromeTrace(records, chromePath);
+				}
+				if (!binaryPath.empty())
+				{
+					TopologicEnergyCore::WriteBinaryTrace(records, binaryPath);
+				}
+			}
+			catch (const std::exception& rkException)
+			{
+				std::cerr << rkException.what() << "\n";
+			}
+		}
+	};
+
+	// Writes the counts and stages of the run in the Prometheus text format when main returns.
+	class MetricsFile
+	{
+	public:
+		std::string path;
+		TopologicEnergyCore::MetricsSnapshot snapshot;
+
+		~MetricsFile()
+		{
+			if (path.empty())
+			{
+				return;
+			}
+
+			std::ofstream file(path.c_str(), std::ios::binary);
+			file << snapshot.ToPrometheusText();
+			if (!file)
+			{
+				std::cerr << "Fails to write the metrics file " << path << ".\n";
+			}
+		}
+
+		void AddModel(const TopologicEnergyCore::BuildingModel& rkModel)
+		{
+			static const char* const kTypeNames[] = { "Wall", "Floor", "RoofCeiling" };
+			static const char* const kBoundaryConditionNames[] = { "Outdoors", "Ground", "Surface" };
+
+			std::size_t surfaceCounts[3][3] = {};
+			std::size_t windowCount = 0;
+			for (const TopologicEnergyCore::ModelSurface& rkSurface : rkModel.surfaces)
+			{
+				++surfaceCounts[rkSurface.type][rkSurface.boundaryCondition];
+				windowCount += rkSurface.windows.size();
+			}
+
+			snapshot.Add("spaces", "Spaces created.", (double)rkModel.spaces.size());
+			for (int type = 0; type < 3; ++type)
+			{
+				for (int boundaryCondition = 0; boundaryCondition < 3; ++boundaryCondition)
+				{
+					if (surfaceCounts[type][boundaryCondition] > 0)
+					{
+						snapshot.Add("surfaces", "Surfaces created, by type and outside boundary condition.", (double)surfaceCounts[type][boundaryCondition],
+							{ { "type", kTypeNames[type] }, { "boundary_condition", kBoundaryConditionNames[boundaryCondition] } });
+					}
+				}
+			}
+			// The native kernels create every window once, so nothing is removed or flipped.
+			snapshot.Add("subsurfaces_created", "Subsurfaces created, including the recreated ones.", (double)windowCount);
+			snapshot.Add("shading_surfaces", "Shading surfaces created.", (double)rkModel.shadingSurfaces.size());
+		}
+	};
+
+	// Without floor levels, the building is one story from its lowest to its highest vertex.
+	std::vector<double> DefaultFloorLevels(const TopologicEnergyCore::CellBuffer& rkCells)
+	{
+		double minZ = std::numeric_limits<double>::max();
+		double maxZ = -std::numeric_limits<double>::max();
+		for (std::size_t cellIndex = 0; cellIndex < rkCells.CellCount(); ++cellIndex)
+		{
+			for (std::size_t i = 0; i < rkCells.FaceCount(cellIndex); ++i)
+			{
+				std::size_t faceId = rkCells.FaceId(cellIndex, i);
+				const double* pkCoordinates = rkCells.Coordinates(faceId);
+				for (std::size_t j = 0; j < rkCells.VertexCount(faceId); ++j)
+				{
+					minZ = std::min(minZ, pkCoordinates[j * 3 + 2]);
+					maxZ = std::max(maxZ, pkCoordinates[j * 3 + 2]);
+				}
+			}
+		}
+		return std::vector<double>{ minZ, maxZ };
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string cellsPath;
+	std::string templatePath;
+	std::string weatherPath;
+	std::string outputDirectory;
+	std::string energyPlusPath = "energyplus";
+	bool isRun = true;
+	std::vector<std::string> queries;
+	TraceFiles traceFiles;
+	MetricsFile metricsFile;
+	TopologicEnergyCore::StageMeter stageMeter;
+
+	TopologicEnergyCore::BuildingModelParameters parameters;
+	parameters.buildingName = "Building";
+	parameters.northAxis = 0.0;
+	parameters.glazingRatio = 0.0;
+	parameters.hasWindowLayout = false;
+	parameters.windowLayout.sillHeight = 0.9;
+	parameters.windowLayout.headHeight = 2.1;
+	parameters.windowLayout.windowSpacing = 3.0;
+	parameters.heatingTemp = 20.0;
+	parameters.coolingTemp = 25.0;
+	parameters.tolerance = 0.0001;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string option = argv[i];
+		if (option == "--no-run")
+		{
+			isRun = false;
+			continue;
+		}
+		if (option == "--help")
+		{
+			std::cout << Usage;
+			return 0;
+		}
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing value for " << option << ".\n" << Usage;
+			return 2;
+		}
+
+		std::string value = argv[++i];
+		if (option == "--cells") cellsPath = value;
+		else if (option == "--template") templatePath = value;
+		else if (option == "--weather") weatherPath = value;
+		else if (option == "--output") outputDirectory = value;
+		else if (option == "--energyplus") energyPlusPath = value;
+		else if (option == "--floor-levels") parameters.floorLevels = SplitDoubles(value);
+		else if (option == "--north-axis") parameters.northAxis = std::atof(value.c_str());
+		else if (option == "--glazing") parameters.glazingRatio = std::atof(value.c_str());
+		else if (option == "--heating") parameters.heatingTemp = std::atof(value.c_str());
+		else if (option == "--cooling") parameters.coolingTemp = std::atof(value.c_str());
+		else if (option == "--query") queries.push_back(value);
+		else if (option == "--trace") traceFiles.chromePath = value;
+		else if (option == "--trace-binary") traceFiles.binaryPath = value;
+		else if (option == "--metrics") metricsFile.path = value;
+		else if (option == "--window-layout")
+		{
+			std::vector<double> layout = SplitDoubles(value);
+			if (layout.size() != 3)
+			{
+				std::cerr << "The window layout is sill,head,spacing.\n";
+				return 2;
+			}
+			parameters.hasWindowLayout = true;
+			parameters.windowLayout.sillHeight = layout[0];
+			parameters.windowLayout.headHeight = layout[1];
+			parameters.windowLayout.windowSpacing = layout[2];
+		}
+		else
+		{
+			std::cerr << "Unknown option " << option << ".\n" << Usage;
+			return 2;
+		}
+	}
+
+	if (cellsPath.empty() || templatePath.empty() || outputDirectory.empty() || (isRun && weatherPath.empty()))
+	{
+		std::cerr << Usage;
+		return 2;
+	}
+
+	if (!traceFiles.chromePath.empty() || !traceFiles.binaryPath.empty())
+	{
+		TopologicEnergyCore::EnableTracing(1 << 16);
+	}
+
+	try
+	{
+		stageMeter.Begin();
+		TopologicEnergyCore::CellBuffer cells = TopologicEnergyCore::ReadObjCells(cellsPath);
+		metricsFile.snapshot.AddStage(stageMeter.End("ReadObjCells"));
+		if (parameters.floorLevels.empty())
+		{
+			parameters.floorLevels = DefaultFloorLevels(cells);
+		}
+		std::sort(parameters.floorLevels.begin(), parameters.floorLevels.end());
+
+		stageMeter.Begin();
+		TopologicEnergyCore::BuildingModel model = TopologicEnergyCore::BuildModel(cells, parameters);
+		metricsFile.snapshot.AddStage(stageMeter.End("BuildModel"));
+		metricsFile.AddModel(model);
+
+		std::string idfPath = outputDirectory + "/in.idf";
+		stageMeter.Begin();
+		TopologicEnergyCore::WriteIdf(model, templatePath, TopologicEnergyCore::IdfConstructions(), idfPath);
+		metricsFile.snapshot.AddStage(stageMeter.End("WriteIdf"));
+		std::cerr << "Wrote " << model.spaces.size() << " zones and " << model.surfaces.size() << " surfaces to " << idfPath << ".\n";
+		if (!isRun)
+		{
+			return 0;
+		}
+
+		stageMeter.Begin();
+		int exitCode = TopologicEnergyCore::RunProcess(
+			energyPlusPath,
+			TopologicEnergyCore::EnergyPlusArguments(idfPath, weatherPath, outputDirectory),
+			outputDirectory);
+		metricsFile.snapshot.AddStage(stageMeter.End("RunSimulation"));
+		if (exitCode != 0)
+		{
+			std::cerr << "EnergyPlus failed with exit code " << exitCode << ".\n";
+			return 1;
+		}
+
+		if (queries.empty())
+		{
+			return 0;
+		}
+
+		// EnergyPlus reports zone names in upper case.
+		std::vector<std::string> zoneNames;
+		for (const TopologicEnergyCore::ModelSpace& rkSpace : model.spaces)
+		{
+			std::string zoneName = rkSpace.zoneName;
+			std::transform(zoneName.begin(), zoneName.end(), zoneName.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+			zoneNames.push_back(zoneName);
+		}
+
+		stageMeter.Begin();
+		TopologicEnergyCore::SqlResultReader reader(outputDirectory + "/eplusout.sql");
+		for (const std::string& rkQuery : queries)
+		{
+			std::vector<std::string> fields = Split(rkQuery, ',');
+			if (fields.size() != 5)
+			{
+				std::cerr << "A query is report,reportFor,table,column,units.\n";
+				return 2;
+			}
+
+			std::vector<double> values = reader.TabularValues(fields[0], fields[1], fields[2], fields[3], zoneNames, fields[4]);
+			for (std::size_t i = 0; i < zoneNames.size(); ++i)
+			{
+				std::cout << zoneNames[i] << "," << values[i] << "\n";
+			}
+		}
+		metricsFile.snapshot.AddStage(stageMeter.End("Queries"));
+		metricsFile.snapshot.Add("sql_queries", "SQL queries run against the simulation results.", (double)reader.QueryCount());
+	}
+	catch (const std::exception& rkException)
+	{
+		std::cerr << rkException.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,520 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+
+// Scaling benchmark of the model pipeline over synthetic cell grids: generates grids from tens to
+// thousands of rooms, builds the energy model and writes the IDF, times every stage through its trace
+// span, and fits the exponent b of seconds = a * cells^b per stage. Fails when a stage scales worse
+// than its baseline, e.g. when a change turns a hashed lookup back into a pairwise loop.
+//
+// The grids are driven through the native kernels only: BuildModel and WriteIdf, not the managed
+// EnergyModel::ByCellComplex and EnergySimulation::Export that wrap them with OpenStudio, which do not
+// run outside Windows. To cover the managed stages, --write-obj writes every grid as an OBJ file for a
+// Windows run that builds and exports each one with PipelineMetrics and saves ExportPrometheus; the
+// saved files, passed back through --managed-metrics, are fitted and checked like the native stages.
+
+#include "BuildingModelKernels.h"
+#include "CellGridGenerator.h"
+#include "IdfExportFormat.h"
+#include "ObjCellFormat.h"
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* const Usage =
+		"Usage: topologic-energy-scaling [--grids NxMxK,...] [--courtyard ratio] [--atrium ratio] [--apertures probability]\n"
+		"  [--glazing ratio] [--seed seed] [--repeats count] [--output directory] [--csv times.csv]\n"
+		"  [--baseline exponents.txt] [--write-baseline exponents.txt] [--tolerance exponent] [--max-exponent exponent]\n"
+		"  [--write-obj directory] [--managed-metrics metrics.prom,...]\n"
+		"The courtyard and the atrium are given as a ratio of the grid, so that every size has the same shape.\n"
+		"--write-obj writes every grid as grid_NxMxK.obj. --managed-metrics reads PipelineMetrics.ExportPrometheus files,\n"
+		"one per grid, and fits the managed stages over their spaces as managed/<stage>.\n"
+		"Exits with 1 if a stage exponent exceeds its baseline by more than the tolerance, or the maximum exponent.\n";
+
+	// In pipeline order; the sub-stages of BuildModel come before it.
+	const char* const Stages[] = { "GenerateCellGrid", "ComputeCellMetrics", "FaceAdjacency", "AddSurfaces", "BuildModel", "WriteIdf" };
+	const std::size_t StageCount = sizeof(Stages) / sizeof(Stages[0]);
+
+	// Stages faster than this at a size are left out of the fit: their timings are mostly noise.
+	const double MinFitSeconds = 50e-6;
+
+	struct GridSize
+	{
+		std::size_t columns;
+		std::size_t rows;
+		std::size_t stories;
+	};
+
+	struct SizeResult
+	{
+		GridSize size;
+		std::size_t cells;
+		std::size_t surfaces;
+		std::size_t windows;
+		double seconds[StageCount];
+	};
+
+	std::vector<std::string> Split(const std::string& rkText, char separator)
+	{
+		std::vector<std::string> parts;
+		std::istringstream stream(rkText);
+		std::string part;
+		while (std::getline(stream, part, separator))
+		{
+			parts.push_back(part);
+		}
+		return parts;
+	}
+
+	std::vector<GridSize> ParseGrids(const std::string& rkText)
+	{
+		std::vector<GridSize> grids;
+		for (const std::string& rkGrid : Split(rkText, ','))
+		{
+			std::vector<std::string> counts = Split(rkGrid, 'x');
+			if (counts.size() != 3)
+			{
+				throw std::invalid_argument("A grid is NxMxK, e.g. 10x10x4.");
+			}
+			GridSize size;
+			size.columns = (std::size_t)std::strtoull(counts[0].c_str(), nullptr, 10);
+			size.rows = (std::size_t)std::strtoull(counts[1].c_str(), nullptr, 10);
+			size.stories = (std::size_t)std::strtoull(counts[2].c_str(), nullptr, 10);
+			grids.push_back(size);
+		}
+		return grids;
+	}
+
+	// The courtyard and the atrium of the grid, dropped where they would not fit
+	void ApplyRatios(TopologicEnergyCore::CellGridParameters& rParameters, double courtyardRatio, double atriumRatio)
+	{
+		rParameters.courtyardColumns = (std::size_t)(rParameters.columns * courtyardRatio);
+		rParameters.courtyardRows = (std::size_t)(rParameters.rows * courtyardRatio);
+		if (rParameters.courtyardColumns == 0 || rParameters.courtyardRows == 0 ||
+			rParameters.courtyardColumns >= rParameters.columns || rParameters.courtyardRows >= rParameters.rows)
+		{
+			rParameters.courtyardColumns = 0;
+			rParameters.courtyardRows = 0;
+		}
+
+		std::size_t bandColumns = rParameters.courtyardColumns > 0 ? (rParameters.columns - rParameters.courtyardColumns) / 2 : rParameters.columns;
+		rParameters.atriumColumns = (std::size_t)(bandColumns * atriumRatio);
+		rParameters.atriumRows = (std::size_t)(rParameters.rows * atriumRatio);
+		if (rParameters.atriumColumns == 0 || rParameters.atriumRows == 0 ||
+			rParameters.atriumColumns + 2 > bandColumns || rParameters.atriumRows + 2 > rParameters.rows)
+		{
+			rParameters.atriumColumns = 0;
+			rParameters.atriumRows = 0;
+		}
+	}
+
+	// A size and the seconds a stage took at it
+	typedef std::vector<std::pair<double, double>> StageTimes;
+
+	// Least-squares slope of log(seconds) over log(size), or NaN with fewer than two usable sizes
+	double FitExponent(const StageTimes& rkTimes)
+	{
+		std::vector<std::pair<double, double>> points;
+		for (const std::pair<double, double>& rkTime : rkTimes)
+		{
+			if (rkTime.second >= MinFitSeconds && rkTime.first > 0.0)
+			{
+				points.push_back(std::make_pair(std::log(rkTime.first), std::log(rkTime.second)));
+			}
+		}
+		if (points.size() < 2)
+		{
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+
+		double meanX = 0.0;
+		double meanY = 0.0;
+		for (const std::pair<double, double>& rkPoint : points)
+		{
+			meanX += rkPoint.first / (double)points.size();
+			meanY += rkPoint.second / (double)points.size();
+		}
+		double covariance = 0.0;
+		double variance = 0.0;
+		for (const std::pair<double, double>& rkPoint : points)
+		{
+			covariance += (rkPoint.first - meanX) * (rkPoint.second - meanY);
+			variance += (rkPoint.first - meanX) * (rkPoint.first - meanX);
+		}
+		return variance > 0.0 ? covariance / variance : std::numeric_limits<double>::quiet_NaN();
+	}
+
+	// Adds the managed stage times of a PipelineMetrics.ExportPrometheus file, sized by its spaces, as
+	// managed/<stage>. A stage that ran several times counts with its total.
+	void ReadManagedMetrics(const std::string& rkPath, std::map<std::string, StageTimes>& rTimes)
+	{
+		std::ifstream file(rkPath.c_str());
+		if (!file)
+		{
+			throw std::runtime_error("Fails to read the metrics " + rkPath + ".");
+		}
+
+		const std::string spacesName = "topologic_energy_spaces ";
+		const std::string stageName = "topologic_energy_stage_seconds{stage=\"";
+		double spaces = 0.0;
+		std::map<std::string, double> seconds;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.compare(0, spacesName.size(), spacesName) == 0)
+			{
+				spaces = std::atof(line.c_str() + spacesName.size());
+			}
+			else if (line.compare(0, stageName.size(), stageName) == 0)
+			{
+				std::string::size_type labelEnd = line.find("\"}", stageName.size());
+				if (labelEnd != std::string::npos)
+				{
+					seconds[line.substr(stageName.size(), labelEnd - stageName.size())] += std::atof(line.c_str() + labelEnd + 2);
+				}
+			}
+		}
+		if (spaces <= 0.0 || seconds.empty())
+		{
+			throw std::runtime_error("The metrics " + rkPath + " have no spaces or no stage times.");
+		}
+
+		for (const std::pair<const std::string, double>& rkStage : seconds)
+		{
+			rTimes["managed/" + rkStage.first].push_back(std::make_pair(spaces, rkStage.second));
+		}
+	}
+
+	std::map<std::string, double> ReadBaseline(const std::string& rkPath)
+	{
+		std::ifstream file(rkPath.c_str());
+		if (!file)
+		{
+			throw std::runtime_error("Fails to read the baseline " + rkPath + ".");
+		}
+
+		std::map<std::string, double> exponents;
+		std::string stage;
+		double exponent = 0.0;
+		while (file >> stage >> exponent)
+		{
+			exponents[stage] = exponent;
+		}
+		return exponents;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<GridSize> grids;
+	TopologicEnergyCore::CellGridParameters gridParameters;
+	gridParameters.roomWidth = 5.0;
+	gridParameters.roomDepth = 4.0;
+	gridParameters.storyHeight = 3.0;
+	gridParameters.apertureProbability = 0.5;
+	gridParameters.seed = 1;
+	double courtyardRatio = 0.0;
+	double atriumRatio = 0.0;
+	double glazingRatio = 0.0;
+	std::size_t repeats = 3;
+	std::string outputDirectory = ".";
+	std::string csvPath;
+	std::string baselinePath;
+	std::string writeBaselinePath;
+	double tolerance = 0.2;
+	double maxExponent = 1.5;
+	std::string objDirectory;
+	std::map<std::string, StageTimes> managedTimes;
+
+	try
+	{
+		grids = ParseGrids("5x2x1,10x5x2,10x10x4,20x10x5,20x20x10,25x20x20");
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string option = argv[i];
+			if (option == "--help")
+			{
+				std::cout << Usage;
+				return 0;
+			}
+			if (i + 1 >= argc)
+			{
+				std::cerr << "Missing value for " << option << ".\n" << Usage;
+				return 2;
+			}
+
+			std::string value = argv[++i];
+			if (option == "--grids") grids = ParseGrids(value);
+			else if (option == "--courtyard") courtyardRatio = std::atof(value.c_str());
+			else if (option == "--atrium") atriumRatio = std::atof(value.c_str());
+			else if (option == "--apertures") gridParameters.apertureProbability = std::atof(value.c_str());
+			else if (option == "--glazing") glazingRatio = std::atof(value.c_str());
+			else if (option == "--seed") gridParameters.seed = (unsigned int)std::strtoul(value.c_str(), nullptr, 10);
+			else if (option == "--repeats") repeats = std::max<std::size_t>(1, (std::size_t)std::strtoull(value.c_str(), nullptr, 10));
+			else if (option == "--output") outputDirectory = value;
+			else if (option == "--csv") csvPath = value;
+			else if (option == "--baseline") baselinePath = value;
+			else if (option == "--write-baseline") writeBaselinePath = value;
+			else if (option == "--tolerance") tolerance = std::atof(value.c_str());
+			else if (option == "--max-exponent") maxExponent = std::atof(value.c_str());
+			else if (option == "--write-obj") objDirectory = value;
+			else if (option == "--managed-metrics")
+			{
+				for (const std::string& rkPath : Split(value, ','))
+				{
+					ReadManagedMetrics(rkPath, managedTimes);
+				}
+			}
+			else
+			{
+				std::cerr << "Unknown option " << option << ".\n" << Usage;
+				return 2;
+			}
+		}
+	}
+	catch (const std::exception& rkException)
+	{
+		std::cerr << rkException.what() << "\n" << Usage;
+		return 2;
+	}
+
+	std::string templatePath = outputDirectory + "/topologic-energy-scaling-template.idf";
+	std::string idfPath = outputDirectory + "/topologic-energy-scaling.idf";
+	std::vector<SizeResult> results;
+
+	std::cout << std::setw(8) << "cells" << std::setw(10) << "surfaces" << std::setw(9) << "windows";
+	for (const char* pkStage : Stages)
+	{
+		std::cout << std::setw(20) << pkStage;
+	}
+	std::cout << "\n";
+
+	try
+	{
+		{
+			std::ofstream templateFile(templatePath.c_str());
+			templateFile << "Version,9.6;\n";
+			if (!templateFile)
+			{
+				throw std::runtime_error("Fails to write " + templatePath + ".");
+			}
+		}
+
+		for (const GridSize& rkSize : grids)
+		{
+			gridParameters.columns = rkSize.columns;
+			gridParameters.rows = rkSize.rows;
+			gridParameters.stories = rkSize.stories;
+			ApplyRatios(gridParameters, courtyardRatio, atriumRatio);
+
+			if (!objDirectory.empty())
+			{
+				std::ostringstream objPath;
+				objPath << objDirectory << "/grid_" << rkSize.columns << "x" << rkSize.rows << "x" << rkSize.stories << ".obj";
+				TopologicEnergyCore::WriteObjCells(TopologicEnergyCore::GenerateCellGrid(gridParameters).cells, objPath.str());
+			}
+
+			SizeResult result;
+			result.size = rkSize;
+			for (std::size_t stage = 0; stage < StageCount; ++stage)
+			{
+				result.seconds[stage] = std::numeric_limits<double>::max();
+			}
+
+			// The fastest of the repeats, per stage
+			for (std::size_t repeat = 0; repeat < repeats; ++repeat)
+			{
+				TopologicEnergyCore::EnableTracing(1 << 10);
+				TopologicEnergyCore::CellGrid grid = TopologicEnergyCore::GenerateCellGrid(gridParameters);
+
+				TopologicEnergyCore::BuildingModelParameters modelParameters;
+				modelParameters.buildingName = "Building";
+				modelParameters.floorLevels = grid.floorLevels;
+				modelParameters.northAxis = 0.0;
+				modelParameters.glazingRatio = glazingRatio;
+				modelParameters.hasWindowLayout = false;
+				modelParameters.windowLayout.sillHeight = 0.9;
+				modelParameters.windowLayout.headHeight = 2.1;
+				modelParameters.windowLayout.windowSpacing = 3.0;
+				modelParameters.heatingTemp = 20.0;
+				modelParameters.coolingTemp = 25.0;
+				modelParameters.tolerance = 0.0001;
+				TopologicEnergyCore::BuildingModel model = TopologicEnergyCore::BuildModel(
+					grid.cells, modelParameters, grid.apertureCoordinates, grid.apertureVertexOffsets, grid.apertureHostFaces);
+				TopologicEnergyCore::WriteIdf(model, templatePath, TopologicEnergyCore::IdfConstructions(), idfPath);
+				TopologicEnergyCore::DisableTracing();
+
+				double seconds[StageCount] = {};
+				for (const TopologicEnergyCore::TraceRecord& rkRecord : TopologicEnergyCore::TraceRecords())
+				{
+					for (std::size_t stage = 0; stage < StageCount; ++stage)
+					{
+						if (rkRecord.name == Stages[stage])
+						{
+							seconds[stage] += rkRecord.duration * 1e-9;
+						}
+					}
+				}
+				for (std::size_t stage = 0; stage < StageCount; ++stage)
+				{
+					result.seconds[stage] = std::min(result.seconds[stage], seconds[stage]);
+				}
+
+				result.cells = grid.cells.CellCount();
+				result.surfaces = model.surfaces.size();
+				result.windows = 0;
+				for (const TopologicEnergyCore::ModelSurface& rkSurface : model.surfaces)
+				{
+					result.windows += rkSurface.windows.size();
+				}
+			}
+
+			std::cout << std::setw(8) << result.cells << std::setw(10) << result.surfaces << std::setw(9) << result.windows;
+			for (std::size_t stage = 0; stage < StageCount; ++stage)
+			{
+				std::cout << std::setw(20) << std::scientific << std::setprecision(3) << result.seconds[stage];
+			}
+			std::cout << std::defaultfloat << "\n";
+			results.push_back(result);
+		}
+	}
+	catch (const std::exception& rkException)
+	{
+		std::remove(templatePath.c_str());
+		std::remove(idfPath.c_str());
+		std::cerr << rkException.what() << "\n";
+		return 1;
+	}
+	std::remove(templatePath.c_str());
+	std::remove(idfPath.c_str());
+
+	if (!csvPath.empty())
+	{
+		std::ofstream file(csvPath.c_str());
+		file << "columns,rows,stories,cells,surfaces,windows";
+		for (const char* pkStage : Stages)
+		{
+			file << "," << pkStage;
+		}
+		file << "\n" << std::setprecision(17);
+		for (const SizeResult& rkResult : results)
+		{
+			file << rkResult.size.columns << "," << rkResult.size.rows << "," << rkResult.size.stories << ","
+				<< rkResult.cells << "," << rkResult.surfaces << "," << rkResult.windows;
+			for (std::size_t stage = 0; stage < StageCount; ++stage)
+			{
+				file << "," << rkResult.seconds[stage];
+			}
+			file << "\n";
+		}
+		if (!file)
+		{
+			std::cerr << "Fails to write " << csvPath << ".\n";
+			return 1;
+		}
+	}
+
+	std::map<std::string, double> baseline;
+	if (!baselinePath.empty())
+	{
+		try {
+			baseline = ReadBaseline(baselinePath);
+		}
+		catch (const std::exception& rkException)
+		{
+			std::cerr << rkException.what() << "\n";
+			return 1;
+		}
+	}
+
+	std::vector<std::pair<std::string, StageTimes>> stageTimes;
+	for (std::size_t stage = 0; stage < StageCount; ++stage)
+	{
+		StageTimes times;
+		for (const SizeResult& rkResult : results)
+		{
+			times.push_back(std::make_pair((double)rkResult.cells, rkResult.seconds[stage]));
+		}
+		stageTimes.push_back(std::make_pair(std::string(Stages[stage]), times));
+	}
+	for (const std::pair<const std::string, StageTimes>& rkManaged : managedTimes)
+	{
+		stageTimes.push_back(rkManaged);
+	}
+
+	bool isRegression = false;
+	std::ostringstream baselineText;
+	std::cout << "\n" << std::left << std::setw(32) << "stage" << std::right << std::setw(10) << "exponent" << std::setw(10) << "baseline" << "\n";
+	for (const std::pair<std::string, StageTimes>& rkStage : stageTimes)
+	{
+		double exponent = FitExponent(rkStage.second);
+		std::cout << std::left << std::setw(32) << rkStage.first << std::right << std::fixed << std::setprecision(2) << std::setw(10) << exponent;
+		if (std::isnan(exponent))
+		{
+			std::cout << std::defaultfloat << "\n";
+			continue;
+		}
+		baselineText << rkStage.first << " " << exponent << "\n";
+
+		std::map<std::string, double>::const_iterator kBaseline = baseline.find(rkStage.first);
+		if (kBaseline != baseline.end())
+		{
+			std::cout << std::setw(10) << kBaseline->second;
+		}
+		else
+		{
+			std::cout << std::setw(10) << "-";
+		}
+
+		if (kBaseline != baseline.end() && exponent > kBaseline->second + tolerance)
+		{
+			std::cout << "  REGRESSION: scales worse than the baseline";
+			isRegression = true;
+		}
+		else if (exponent > maxExponent)
+		{
+			std::cout << "  REGRESSION: above the maximum exponent";
+			isRegression = true;
+		}
+		std::cout << std::defaultfloat << "\n";
+	}
+
+	if (!writeBaselinePath.empty())
+	{
+		std::ofstream file(writeBaselinePath.c_str());
+		file << baselineText.str();
+		if (!file)
+		{
+			std::cerr << "Fails to write " << writeBaselinePath << ".\n";
+			return 1;
+		}
+	}
+	return isRegression ? 1 : 0;
+}
@@ -0,0 +1,449 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		const char TraceMagic[8] = { 'T', 'E', 'T', 'R', 'A', 'C', 'E', '\0' };
+		const std::uint32_t TraceVersion = 1;
+
+		std::atomic<bool> s_isEnabled(false);
+		std::atomic<std::int64_t> s_epoch(0);
+		std::atomic<std::uint64_t> s_session(0);		// incremented by each EnableTracing
+		std::mutex s_mutex;
+		std::vector<TraceEvent> s_events;
+		std::uint64_t s_eventCount = 0;		// recorded since enabled, including the overwritten ones
+
+		std::int64_t SteadyNanoseconds()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		std::uint32_t CurrentThreadId()
+		{
+			return (std::uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+		}
+
+		TraceRecord ToRecord(const TraceEvent& rkEvent)
+		{
+			TraceRecord record;
+			record.name = rkEvent.pkName;
+			record.start = rkEvent.start;
+			record.duration = rkEvent.duration;
+			record.threadId = rkEvent.threadId;
+			for (std::uint32_t i = 0; i < rkEvent.attributeCount; ++i)
+			{
+				const TraceAttribute& rkAttribute = rkEvent.attributes[i];
+				if (rkAttribute.isText)
+				{
+					record.textAttributes.push_back(std::make_pair(std::string(rkAttribute.pkKey), std::string(rkAttribute.text)));
+				}
+				else
+				{
+					record.numberAttributes.push_back(std::make_pair(std::string(rkAttribute.pkKey), rkAttribute.number));
+				}
+			}
+			return record;
+		}
+
+		void WriteJsonString(std::ostream& rStream, const std::string& rkText)
+		{
+			rStream << '"';
+			for (unsigned char character : rkText)
+			{
+				switch (character)
+				{
+				case '"': rStream << "\\\""; break;
+				case '\\': rStream << "\\\\"; break;
+				case '\n': rStream << "\\n"; break;
+				case '\r': rStream << "\\r"; break;
+				case '\t': rStream << "\\t"; break;
+				default:
+					if (character < 0x20)
+					{
+						char escaped[8];
+						snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+						rStream << escaped;
+					}
+					else
+					{
+						rStream << character;
+					}
+				}
+			}
+			rStream << '"';
+		}
+
+		template <typename T>
+		void WriteValue(std::ostream& rStream, T value)
+		{
+			rStream.write((const char*)&value, sizeof(T));
+		}
+
+		template <typename T>
+		T ReadValue(std::istream& rStream)
+		{
+			T value = T();
+			if (!rStream.read((char*)&value, sizeof(T)))
+			{
+				throw std::runtime_error("The binary trace is truncated.");
+			}
+			return value;
+		}
+
+		std::uint64_t RemainingSize(std::istream& rStream, std::uint64_t size)
+		{
+			std::streamoff position = rStream.tellg();
+			return position < 0 || (std::uint64_t)position > size ? 0 : size - (std::uint64_t)position;
+		}
+	}
+
+	void EnableTracing(std::size_t capacity)
+	{
+		if (capacity == 0)
+		{
+			throw std::invalid_argument("The trace capacity must be at least 1.");
+		}
+
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_events.assign(capacity, TraceEvent());
+		s_eventCount = 0;
+		s_epoch.store(SteadyNanoseconds());
+		// Released after the epoch: a span that sees the new session also sees the new epoch.
+		s_session.fetch_add(1, std::memory_order_release);
+		s_isEnabled.store(true);
+	}
+
+	void DisableTracing()
+	{
+		// The recorded spans are kept until tracing is enabled again.
+		s_isEnabled.store(false);
+	}
+
+	bool IsTracingEnabled()
+	{
+		return s_isEnabled.load(std::memory_order_relaxed);
+	}
+
+	std::vector<TraceRecord> TraceRecords()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		std::vector<TraceRecord> records;
+		if (s_events.empty())
+		{
+			return records;
+		}
+
+		std::uint64_t first = s_eventCount > s_events.size() ? s_eventCount - s_events.size() : 0;
+		records.reserve((std::size_t)(s_eventCount - first));
+		for (std::uint64_t i = first; i < s_eventCount; ++i)
+		{
+			records.push_back(ToRecord(s_events[(std::size_t)(i % s_events.size())]));
+		}
+
+		// Spans are recorded when they end; order them by start for readers of the binary trace.
+		std::stable_sort(records.begin(), records.end(), [](const TraceRecord& rkA, const TraceRecord& rkB) { return rkA.start < rkB.start; });
+		return records;
+	}
+
+	std::uint64_t DroppedTraceEventCount()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		return s_eventCount > s_events.size() ? s_eventCount - s_events.size() : 0;
+	}
+
+	void WriteChromeTrace(const std::vector<TraceRecord>& rkRecords, const std::string& rkPath)
+	{
+		std::ofstream stream(rkPath.c_str(), std::ios::binary);
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to create the trace file " + rkPath + ".");
+		}
+
+		// Complete events ("ph": "X"), timestamps and durations in microseconds
+		char time[64];
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		for (std::size_t i = 0; i < rkRecords.size(); ++i)
+		{
+			const TraceRecord& rkRecord = rkRecords[i];
+			stream << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+			WriteJsonString(stream, rkRecord.name);
+			snprintf(time, sizeof(time), "%.3f,\"dur\":%.3f", rkRecord.start / 1000.0, rkRecord.duration / 1000.0);
+			stream << ",\"cat\":\"TopologicEnergy\",\"ph\":\"X\",\"pid\":1,\"tid\":" << rkRecord.threadId << ",\"ts\":" << time << ",\"args\":{";
+			bool isFirst = true;
+			for (const std::pair<std::string, std::string>& rkAttribute : rkRecord.textAttributes)
+			{
+				stream << (isFirst ? "" : ",");
+				WriteJsonString(stream, rkAttribute.first);
+				stream << ":";
+				WriteJsonString(stream, rkAttribute.second);
+				isFirst = false;
+			}
+			for (const std::pair<std::string, std::int64_t>& rkAttribute : rkRecord.numberAttributes)
+			{
+				stream << (isFirst ? "" : ",");
+				WriteJsonString(stream, rkAttribute.first);
+				stream << ":" << rkAttribute.second;
+				isFirst = false;
+			}
+			stream << "}}";
+		}
+		stream << "\n]}\n";
+
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to write the trace file " + rkPath + ".");
+		}
+	}
+
+	// Layout (little-endian):
+	//   magic[8], version u32, stringCount u32, recordCount u64
+	//   stringCount x (length u32, UTF-8 bytes)
+	//   recordCount x (start u64, duration u64, threadId u32, name u32, attributeCount u32,
+	//                  attributeCount x (key u32, isText u32, number or string id u64))
+	void WriteBinaryTrace(const std::vector<TraceRecord>& rkRecords, const std::string& rkPath)
+	{
+		std::vector<std::string> strings;
+		std::map<std::string, std::uint32_t> stringIds;
+		auto intern = [&strings, &stringIds](const std::string& rkString)
+		{
+			std::map<std::string, std::uint32_t>::const_iterator kIterator = stringIds.find(rkString);
+			if (kIterator != stringIds.end())
+			{
+				return kIterator->second;
+			}
+			std::uint32_t id = (std::uint32_t)strings.size();
+			strings.push_back(rkString);
+			stringIds[rkString] = id;
+			return id;
+		};
+		for (const TraceRecord& rkRecord : rkRecords)
+		{
+			intern(rkRecord.name);
+			for (const std::pair<std::string, std::string>& rkAttribute : rkRecord.textAttributes)
+			{
+				intern(rkAttribute.first);
+				intern(rkAttribute.second);
+			}
+			for (const std::pair<std::string, std::int64_t>& rkAttribute : rkRecord.numberAttributes)
+			{
+				intern(rkAttribute.first);
+			}
+		}
+
+		std::ofstream stream(rkPath.c_str(), std::ios::binary);
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to create the trace file " + rkPath + ".");
+		}
+
+		stream.write(TraceMagic, sizeof(TraceMagic));
+		WriteValue<std::uint32_t>(stream, TraceVersion);
+		WriteValue<std::uint32_t>(stream, (std::uint32_t)strings.size());
+		WriteValue<std::uint64_t>(stream, rkRecords.size());
+		for (const std::string& rkString : strings)
+		{
+			WriteValue<std::uint32_t>(stream, (std::uint32_t)rkString.size());
+			stream.write(rkString.data(), rkString.size());
+		}
+		for (const TraceRecord& rkRecord : rkRecords)
+		{
+			WriteValue<std::uint64_t>(stream, rkRecord.start);
+			WriteValue<std::uint64_t>(stream, rkRecord.duration);
+			WriteValue<std::uint32_t>(stream, rkRecord.threadId);
+			WriteValue<std::uint32_t>(stream, stringIds[rkRecord.name]);
+			WriteValue<std::uint32_t>(stream, (std::uint32_t)(rkRecord.textAttributes.size() + rkRecord.numberAttributes.size()));
+			for (const std::pair<std::string, std::string>& rkAttribute : rkRecord.textAttributes)
+			{
+				WriteValue<std::uint32_t>(stream, stringIds[rkAttribute.first]);
+				WriteValue<std::uint32_t>(stream, 1);
+				WriteValue<std::uint64_t>(stream, stringIds[rkAttribute.second]);
+			}
+			for (const std::pair<std::string, std::int64_t>& rkAttribute : rkRecord.numberAttributes)
+			{
+				WriteValue<std::uint32_t>(stream, stringIds[rkAttribute.first]);
+				WriteValue<std::uint32_t>(stream, 0);
+				WriteValue<std::int64_t>(stream, rkAttribute.second);
+			}
+		}
+
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to write the trace file " + rkPath + ".");
+		}
+	}
+
+	std::vector<TraceRecord> ReadBinaryTrace(const std::string& rkPath)
+	{
+		std::ifstream stream(rkPath.c_str(), std::ios::binary | std::ios::ate);
+		if (!stream)
+		{
+			throw std::runtime_error("Fails to open the trace file " + rkPath + ".");
+		}
+		std::uint64_t fileSize = (std::uint64_t)stream.tellg();
+		stream.seekg(0);
+
+		char magic[sizeof(TraceMagic)];
+		if (!stream.read(magic, sizeof(magic)) || memcmp(magic, TraceMagic, sizeof(TraceMagic)) != 0 ||
+			ReadValue<std::uint32_t>(stream) != TraceVersion)
+		{
+			throw std::runtime_error("The file " + rkPath + " is not a valid binary trace.");
+		}
+
+		std::uint32_t stringCount = ReadValue<std::uint32_t>(stream);
+		std::uint64_t recordCount = ReadValue<std::uint64_t>(stream);
+
+		// The counts and lengths come from the file: each string takes at least its length field, so
+		// they are checked against the rest of the file before anything is allocated for them.
+		if (stringCount > RemainingSize(stream, fileSize) / sizeof(std::uint32_t))
+		{
+			throw std::runtime_error("The binary trace is truncated.");
+		}
+		std::vector<std::string> strings(stringCount);
+		for (std::string& rString : strings)
+		{
+			std::uint32_t length = ReadValue<std::uint32_t>(stream);
+			if (length > RemainingSize(stream, fileSize))
+			{
+				throw std::runtime_error("The binary trace is truncated.");
+			}
+			rString.resize(length);
+			if (!rString.empty() && !stream.read(&rString[0], rString.size()))
+			{
+				throw std::runtime_error("The binary trace is truncated.");
+			}
+		}
+		auto lookup = [&strings](std::uint64_t id) -> const std::string&
+		{
+			if (id >= strings.size())
+			{
+				throw std::runtime_error("The binary trace has an invalid string id.");
+			}
+			return strings[(std::size_t)id];
+		};
+
+		std::vector<TraceRecord> records;
+		for (std::uint64_t i = 0; i < recordCount; ++i)
+		{
+			TraceRecord record;
+			record.start = ReadValue<std::uint64_t>(stream);
+			record.duration = ReadValue<std::uint64_t>(stream);
+			record.threadId = ReadValue<std::uint32_t>(stream);
+			record.name = lookup(ReadValue<std::uint32_t>(stream));
+			std::uint32_t attributeCount = ReadValue<std::uint32_t>(stream);
+			for (std::uint32_t j = 0; j < attributeCount; ++j)
+			{
+				const std::string& rkKey = lookup(ReadValue<std::uint32_t>(stream));
+				std::uint32_t isText = ReadValue<std::uint32_t>(stream);
+				std::uint64_t value = ReadValue<std::uint64_t>(stream);
+				if (isText != 0)
+				{
+					record.textAttributes.push_back(std::make_pair(rkKey, lookup(value)));
+				}
+				else
+				{
+					record.numberAttributes.push_back(std::make_pair(rkKey, (std::int64_t)value));
+				}
+			}
+			records.push_back(record);
+		}
+		return records;
+	}
+
+	TraceSpan::TraceSpan(const char* pkName)
+		: m_isActive(s_isEnabled.load(std::memory_order_relaxed))
+		, m_session(0)
+	{
+		if (!m_isActive)
+		{
+			return;
+		}
+
+		m_session = s_session.load(std::memory_order_acquire);
+		m_event.pkName = pkName;
+		m_event.start = (std::uint64_t)(SteadyNanoseconds() - s_epoch.load(std::memory_order_relaxed));
+		m_event.attributeCount = 0;
+	}
+
+	TraceSpan::~TraceSpan()
+	{
+		if (!m_isActive)
+		{
+			return;
+		}
+
+		std::int64_t end = SteadyNanoseconds() - s_epoch.load(std::memory_order_relaxed);
+		m_event.duration = (std::uint64_t)end - m_event.start;
+		m_event.threadId = CurrentThreadId();
+
+		std::lock_guard<std::mutex> lock(s_mutex);
+		// A span that was open when tracing was enabled again belongs to the cleared buffer.
+		if (m_session == s_session.load(std::memory_order_relaxed) && !s_events.empty())
+		{
+			s_events[(std::size_t)(s_eventCount % s_events.size())] = m_event;
+			++s_eventCount;
+		}
+	}
+
+	void TraceSpan::SetAttribute(const char* pkKey, std::int64_t value)
+	{
+		TraceAttribute* pAttribute = NextAttribute(pkKey);
+		if (pAttribute != nullptr)
+		{
+			pAttribute->isText = false;
+			pAttribute->number = value;
+		}
+	}
+
+	void TraceSpan::SetAttribute(const char* pkKey, const std::string& rkValue)
+	{
+		TraceAttribute* pAttribute = NextAttribute(pkKey);
+		if (pAttribute != nullptr)
+		{
+			pAttribute->isText = true;
+			// Long values keep their end, e.g. the file name of a path.
+			std::size_t length = std::min(rkValue.size(), MaxTraceTextLength);
+			memcpy(pAttribute->text, rkValue.data() + rkValue.size() - length, length);
+			pAttribute->text[length] = '\0';
+		}
+	}
+
+	TraceAttribute* TraceSpan::NextAttribute(const char* pkKey)
+	{
+		if (!m_isActive || m_event.attributeCount >= MaxTraceAttributes)
+		{
+			return nullptr;
+		}
+		TraceAttribute* pAttribute = &m_event.attributes[m_event.attributeCount++];
+		pAttribute->pkKey = pkKey;
+		return pAttribute;
+	}
+}
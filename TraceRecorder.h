@@ -0,0 +1,105 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Named spans with attributes, recorded into a fixed-size ring buffer of compact binary events and
+// written out as Chrome trace-event JSON (chrome://tracing, Perfetto) or as the binary buffer itself.
+//
+// Span names and attribute keys must be string literals: the hot path stores the pointers only.
+// While tracing is disabled, a span costs one relaxed atomic load; the header deliberately avoids
+// <atomic> and <mutex> so that it can be included from the C++/CLI classes.
+namespace TopologicEnergyCore
+{
+	const std::size_t MaxTraceAttributes = 2;
+	const std::size_t MaxTraceTextLength = 31;
+
+	struct TraceAttribute
+	{
+		const char* pkKey;
+		bool isText;
+		std::int64_t number;
+		char text[MaxTraceTextLength + 1];	// the end of longer values, zero-terminated
+	};
+
+	// One completed span, as stored in the ring buffer
+	struct TraceEvent
+	{
+		const char* pkName;
+		std::uint64_t start;				// nanoseconds since tracing was enabled
+		std::uint64_t duration;				// nanoseconds
+		std::uint32_t threadId;
+		std::uint32_t attributeCount;
+		TraceAttribute attributes[MaxTraceAttributes];
+	};
+
+	// A span read back from the ring buffer or from a binary trace, with owned strings
+	struct TraceRecord
+	{
+		std::string name;
+		std::uint64_t start;
+		std::uint64_t duration;
+		std::uint32_t threadId;
+		std::vector<std::pair<std::string, std::string>> textAttributes;
+		std::vector<std::pair<std::string, std::int64_t>> numberAttributes;
+	};
+
+	// Starts recording into a ring buffer of capacity events; when it is full, the oldest events
+	// are overwritten. Enabling again clears the buffer, and drops the spans open at that time.
+	void EnableTracing(std::size_t capacity);
+	void DisableTracing();
+	bool IsTracingEnabled();
+
+	// The recorded spans, oldest first. Recording may continue meanwhile.
+	std::vector<TraceRecord> TraceRecords();
+
+	// The number of spans overwritten since tracing was enabled
+	std::uint64_t DroppedTraceEventCount();
+
+	void WriteChromeTrace(const std::vector<TraceRecord>& rkRecords, const std::string& rkPath);
+	void WriteBinaryTrace(const std::vector<TraceRecord>& rkRecords, const std::string& rkPath);
+	std::vector<TraceRecord> ReadBinaryTrace(const std::string& rkPath);
+
+	// Records the time between its construction and its destruction as a span, if tracing is enabled.
+	class TraceSpan
+	{
+	public:
+		explicit TraceSpan(const char* pkName);
+		~TraceSpan();
+
+		// False while tracing is disabled; lets callers skip building attribute values.
+		bool IsActive() const { return m_isActive; }
+
+		void SetAttribute(const char* pkKey, std::int64_t value);
+		void SetAttribute(const char* pkKey, const std::string& rkValue);
+
+	private:
+		TraceSpan(const TraceSpan&);
+		TraceSpan& operator=(const TraceSpan&);
+
+		TraceAttribute* NextAttribute(const char* pkKey);
+
+		bool m_isActive;
+		std::uint64_t m_session;	// the EnableTracing call the span started under
+		TraceEvent m_event;
+	};
+}
@@ -0,0 +1,98 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+// Checks that a span left open across EnableTracing is dropped even when it ends later in the new
+// session than it started in the old one, and that a binary trace announcing more strings than it
+// holds is rejected before they are allocated.
+
+#include "TraceRecorder.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	const char* const TracePath = "trace-recorder-test.tetrace";
+
+	std::size_t CountRecords(const char* pkName)
+	{
+		std::size_t count = 0;
+		for (const TopologicEnergyCore::TraceRecord& rkRecord : TopologicEnergyCore::TraceRecords())
+		{
+			count += rkRecord.name == pkName ? 1 : 0;
+		}
+		return count;
+	}
+}
+
+int main()
+{
+	std::vector<std::string> failures;
+
+	// The span starts 20 ms into the first session and ends 40 ms into the second one.
+	TopologicEnergyCore::EnableTracing(16);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	std::unique_ptr<TopologicEnergyCore::TraceSpan> pSpan(new TopologicEnergyCore::TraceSpan("openAcrossEnable"));
+	TopologicEnergyCore::EnableTracing(16);
+	std::this_thread::sleep_for(std::chrono::milliseconds(40));
+	pSpan.reset();
+	{
+		TopologicEnergyCore::TraceSpan span("afterEnable");
+	}
+	if (CountRecords("openAcrossEnable") != 0)
+	{
+		failures.push_back("A span open across EnableTracing is recorded in the new session.");
+	}
+	if (CountRecords("afterEnable") != 1)
+	{
+		failures.push_back("A span of the new session is not recorded.");
+	}
+	TopologicEnergyCore::DisableTracing();
+
+	// A valid header announcing 2^32 - 1 strings, followed by nothing.
+	{
+		std::ofstream stream(TracePath, std::ios::binary);
+		const char magic[8] = { 'T', 'E', 'T', 'R', 'A', 'C', 'E', '\0' };
+		const std::uint32_t header[2] = { 1, 0xFFFFFFFFu };
+		const std::uint64_t recordCount = 0;
+		stream.write(magic, sizeof(magic));
+		stream.write((const char*)header, sizeof(header));
+		stream.write((const char*)&recordCount, sizeof(recordCount));
+	}
+	try
+	{
+		TopologicEnergyCore::ReadBinaryTrace(TracePath);
+		failures.push_back("A binary trace with more strings than bytes is read.");
+	}
+	catch (const std::runtime_error&)
+	{
+	}
+	std::remove(TracePath);
+
+	for (const std::string& rkFailure : failures)
+	{
+		std::cerr << rkFailure << "\n";
+	}
+	return failures.empty() ? 0 : 1;
+}
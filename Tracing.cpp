@@ -0,0 +1,106 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "Tracing.h"
+#include "NativeInterop.h"
+#include "TraceRecorder.h"
+
+#include <stdexcept>
+
+namespace TopologicEnergy
+{
+	bool Tracing::IsEnabled::get()
+	{
+		return TopologicEnergyCore::IsTracingEnabled();
+	}
+
+	void Tracing::IsEnabled::set(bool value)
+	{
+		if (value)
+		{
+			TopologicEnergyCore::EnableTracing(m_capacity);
+		}
+		else
+		{
+			TopologicEnergyCore::DisableTracing();
+		}
+	}
+
+	int Tracing::Capacity::get()
+	{
+		return m_capacity;
+	}
+
+	void Tracing::Capacity::set(int value)
+	{
+		if (value < 1)
+		{
+			throw gcnew Exception("The capacity of the trace must be at least 1.");
+		}
+		m_capacity = value;
+	}
+
+	bool Tracing::ExportChromeTrace(String^ filePath)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		try {
+			TopologicEnergyCore::WriteChromeTrace(TopologicEnergyCore::TraceRecords(), ToNativeString(filePath));
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		return true;
+	}
+
+	bool Tracing::ExportBinaryTrace(String^ filePath)
+	{
+		if (filePath == nullptr)
+		{
+			throw gcnew Exception("The input filePath must not be null.");
+		}
+
+		try {
+			TopologicEnergyCore::WriteBinaryTrace(TopologicEnergyCore::TraceRecords(), ToNativeString(filePath));
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		return true;
+	}
+
+	bool Tracing::ConvertBinaryTrace(String^ binaryFilePath, String^ chromeFilePath)
+	{
+		if (binaryFilePath == nullptr || chromeFilePath == nullptr)
+		{
+			throw gcnew Exception("The input binaryFilePath and chromeFilePath must not be null.");
+		}
+
+		try {
+			TopologicEnergyCore::WriteChromeTrace(TopologicEnergyCore::ReadBinaryTrace(ToNativeString(binaryFilePath)), ToNativeString(chromeFilePath));
+		}
+		catch (const std::exception& rkException)
+		{
+			throw gcnew Exception(ToManagedString(rkException.what()));
+		}
+		return true;
+	}
+}
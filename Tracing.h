@@ -0,0 +1,72 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+using namespace System;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// Records where the time of a run goes: template loading, building, spaces, surfaces, surface matching, shading, purging, export, the simulation and the SQL queries. Spans are kept in a fixed-size ring buffer, so tracing can be left on and exported after a slow run.
+	/// </summary>
+	public ref class Tracing abstract sealed
+	{
+	public:
+		/// <summary>
+		/// If true, spans are recorded. Enabling clears the spans recorded so far; disabling keeps them for export.
+		/// </summary>
+		static property bool IsEnabled
+		{
+			bool get();
+			void set(bool value);
+		}
+
+		/// <summary>
+		/// The maximum number of spans kept; older spans are overwritten. Applies the next time tracing is enabled.
+		/// </summary>
+		static property int Capacity
+		{
+			int get();
+			void set(int value);
+		}
+
+		/// <summary>
+		/// Exports the recorded spans as Chrome trace-event JSON, readable by chrome://tracing and Perfetto.
+		/// </summary>
+		/// <param name="filePath">The path of the JSON file</param>
+		/// <returns>True if the file is written</returns>
+		static bool ExportChromeTrace(String^ filePath);
+
+		/// <summary>
+		/// Exports the recorded spans in the compact binary format, to be converted later with ConvertBinaryTrace.
+		/// </summary>
+		/// <param name="filePath">The path of the binary trace</param>
+		/// <returns>True if the file is written</returns>
+		static bool ExportBinaryTrace(String^ filePath);
+
+		/// <summary>
+		/// Converts a binary trace to Chrome trace-event JSON.
+		/// </summary>
+		/// <param name="binaryFilePath">The path of the binary trace</param>
+		/// <param name="chromeFilePath">The path of the JSON file</param>
+		/// <returns>True if the file is written</returns>
+		static bool ConvertBinaryTrace(String^ binaryFilePath, String^ chromeFilePath);
+
+	private:
+		static int m_capacity = 65536;
+	};
+}
@@ -0,0 +1,102 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "WindowLayout.h"
+
+#include <vector>
+
+namespace TopologicEnergy
+{
+	WindowLayout^ WindowLayout::ByParameters(double sillHeight, double headHeight, double windowSpacing)
+	{
+		if (sillHeight < 0.0 || headHeight <= sillHeight)
+		{
+			throw gcnew Exception("The head height must be greater than the sill height, which must not be negative.");
+		}
+
+		if (windowSpacing <= 0.0)
+		{
+			throw gcnew Exception("The window spacing must have a positive value.");
+		}
+
+		return gcnew WindowLayout(sillHeight, headHeight, windowSpacing);
+	}
+
+	double WindowLayout::SillHeight::get()
+	{
+		return m_sillHeight;
+	}
+
+	double WindowLayout::HeadHeight::get()
+	{
+		return m_headHeight;
+	}
+
+	double WindowLayout::WindowSpacing::get()
+	{
+		return m_windowSpacing;
+	}
+
+	IList<IList<Vertex^>^>^ WindowLayout::Windows(Face^ wall, double glazingRatio)
+	{
+		// Only faces without holes: the windows must not overlap an inner boundary.
+		if (wall->InternalBoundaries->Count > 0)
+		{
+			return nullptr;
+		}
+
+		IList<Vertex^>^ vertices = wall->ExternalBoundary->Vertices;
+		std::vector<double> coordinates;
+		coordinates.reserve(vertices->Count * 3);
+		for each(Vertex^ vertex in vertices)
+		{
+			coordinates.push_back(vertex->X);
+			coordinates.push_back(vertex->Y);
+			coordinates.push_back(vertex->Z);
+		}
+
+		TopologicEnergyCore::WindowLayoutParameters parameters;
+		parameters.sillHeight = m_sillHeight;
+		parameters.headHeight = m_headHeight;
+		parameters.windowSpacing = m_windowSpacing;
+
+		std::vector<double> windowCoordinates;
+		if (!TopologicEnergyCore::LayoutWindows(coordinates.data(), vertices->Count, glazingRatio, parameters, windowCoordinates))
+		{
+			return nullptr;
+		}
+
+		List<IList<Vertex^>^>^ windows = gcnew List<IList<Vertex^>^>();
+		for (std::size_t i = 0; i < windowCoordinates.size(); i += 12)
+		{
+			List<Vertex^>^ windowVertices = gcnew List<Vertex^>();
+			for (std::size_t j = i; j < i + 12; j += 3)
+			{
+				windowVertices->Add(Vertex::ByCoordinates(windowCoordinates[j], windowCoordinates[j + 1], windowCoordinates[j + 2]));
+			}
+			windows->Add(windowVertices);
+		}
+		return windows;
+	}
+
+	WindowLayout::WindowLayout(double sillHeight, double headHeight, double windowSpacing)
+		: m_sillHeight(sillHeight)
+		, m_headHeight(headHeight)
+		, m_windowSpacing(windowSpacing)
+	{
+
+	}
+}
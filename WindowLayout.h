@@ -0,0 +1,81 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "WindowLayoutKernels.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace Topologic;
+
+namespace TopologicEnergy
+{
+	/// <summary>
+	/// Places one or a few rectangular windows per external wall instead of triangulating the scaled wall,
+	/// which reduces the number of subsurfaces EnergyPlus has to simulate.
+	/// </summary>
+	public ref class WindowLayout
+	{
+	public:
+		/// <summary>
+		/// Creates a window layout. Walls that are not vertical rectangles, or that cannot fit the windows, fall back to triangulated windows.
+		/// </summary>
+		/// <param name="sillHeight">The height of the bottom of the windows above the bottom of the wall</param>
+		/// <param name="headHeight">The height of the top of the windows above the bottom of the wall</param>
+		/// <param name="windowSpacing">The façade length per window</param>
+		/// <returns name="WindowLayout">The window layout</returns>
+		static WindowLayout^ ByParameters(
+			[Autodesk::DesignScript::Runtime::DefaultArgument("0.9")] double sillHeight,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("2.1")] double headHeight,
+			[Autodesk::DesignScript::Runtime::DefaultArgument("3.0")] double windowSpacing);
+
+		/// <summary>
+		/// Returns the height of the bottom of the windows above the bottom of the wall.
+		/// </summary>
+		property double SillHeight
+		{
+			double get();
+		}
+
+		/// <summary>
+		/// Returns the height of the top of the windows above the bottom of the wall.
+		/// </summary>
+		property double HeadHeight
+		{
+			double get();
+		}
+
+		/// <summary>
+		/// Returns the façade length per window.
+		/// </summary>
+		property double WindowSpacing
+		{
+			double get();
+		}
+
+	internal:
+		// Returns the window polygons for the wall, or nullptr if the layout does not apply to it.
+		IList<IList<Vertex^>^>^ Windows(Face^ wall, double glazingRatio);
+
+	private:
+		WindowLayout(double sillHeight, double headHeight, double windowSpacing);
+
+		double m_sillHeight;
+		double m_headHeight;
+		double m_windowSpacing;
+	};
+}
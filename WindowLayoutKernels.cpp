@@ -0,0 +1,127 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "WindowLayoutKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace TopologicEnergyCore
+{
+	namespace
+	{
+		// Distance kept between the windows and the edges of the wall, and between two windows;
+		// EnergyPlus rejects subsurfaces that touch the edges of their surface.
+		const double WindowMargin = 0.025;
+	}
+
+	bool LayoutWindows(
+		const double* pkCoordinates,
+		std::size_t vertexCount,
+		double glazingRatio,
+		const WindowLayoutParameters& rkParameters,
+		std::vector<double>& rWindows)
+	{
+		if (vertexCount < 3 || !(glazingRatio > 0.0) || !(rkParameters.windowSpacing > 0.0))
+		{
+			return false;
+		}
+
+		// 1. Newell normal; the wall must be vertical.
+		double normal[3] = { 0.0, 0.0, 0.0 };
+		for (std::size_t i = 0; i < vertexCount; ++i)
+		{
+			const double* pkCurrent = pkCoordinates + i * 3;
+			const double* pkNext = pkCoordinates + ((i + 1) % vertexCount) * 3;
+			normal[0] += (pkCurrent[1] - pkNext[1]) * (pkCurrent[2] + pkNext[2]);
+			normal[1] += (pkCurrent[2] - pkNext[2]) * (pkCurrent[0] + pkNext[0]);
+			normal[2] += (pkCurrent[0] - pkNext[0]) * (pkCurrent[1] + pkNext[1]);
+		}
+		double normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (normalLength <= 0.0 || std::abs(normal[2]) / normalLength > 0.01)
+		{
+			return false;
+		}
+
+		// 2. Horizontal axis along the wall, chosen as Z x normal so that counter-clockwise rectangles in
+		// (along, height) keep the winding of the wall.
+		double horizontalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1]);
+		double along[3] = { -normal[1] / horizontalLength, normal[0] / horizontalLength, 0.0 };
+
+		const double* pkOrigin = pkCoordinates;
+		double minAlong = std::numeric_limits<double>::max();
+		double maxAlong = -std::numeric_limits<double>::max();
+		double minHeight = std::numeric_limits<double>::max();
+		double maxHeight = -std::numeric_limits<double>::max();
+		for (std::size_t i = 0; i < vertexCount; ++i)
+		{
+			const double* pkVertex = pkCoordinates + i * 3;
+			double s = (pkVertex[0] - pkOrigin[0]) * along[0] + (pkVertex[1] - pkOrigin[1]) * along[1];
+			minAlong = std::min(minAlong, s);
+			maxAlong = std::max(maxAlong, s);
+			minHeight = std::min(minHeight, pkVertex[2]);
+			maxHeight = std::max(maxHeight, pkVertex[2]);
+		}
+
+		// The wall area is half the Newell normal length; it must fill its bounding rectangle.
+		double wallLength = maxAlong - minAlong;
+		double wallHeight = maxHeight - minHeight;
+		double wallArea = normalLength * 0.5;
+		if (wallLength <= 4.0 * WindowMargin || wallHeight <= 4.0 * WindowMargin || wallArea < 0.99 * wallLength * wallHeight)
+		{
+			return false;
+		}
+
+		// 3. Window band and widths
+		std::size_t windowCount = std::max<std::size_t>(1, (std::size_t)std::floor(wallLength / rkParameters.windowSpacing + 0.5));
+		double bayLength = wallLength / (double)windowCount;
+		double maxWindowWidth = bayLength - 2.0 * WindowMargin;
+		double windowArea = glazingRatio * wallArea / (double)windowCount;
+
+		double sill = std::max(rkParameters.sillHeight, WindowMargin);
+		double head = std::min(rkParameters.headHeight, wallHeight - WindowMargin);
+		if (!(head - sill > WindowMargin) || windowArea / (head - sill) > maxWindowWidth)
+		{
+			// The band is too narrow for the glazing ratio: use the full height of the wall.
+			sill = WindowMargin;
+			head = wallHeight - WindowMargin;
+		}
+		double windowWidth = windowArea / (head - sill);
+		if (windowWidth > maxWindowWidth)
+		{
+			return false;
+		}
+
+		// 4. One window centred in each bay
+		for (std::size_t i = 0; i < windowCount; ++i)
+		{
+			double centre = minAlong + bayLength * ((double)i + 0.5);
+			double corners[4][2] = {
+				{ centre - windowWidth * 0.5, sill },
+				{ centre + windowWidth * 0.5, sill },
+				{ centre + windowWidth * 0.5, head },
+				{ centre - windowWidth * 0.5, head } };
+			for (int j = 0; j < 4; ++j)
+			{
+				rWindows.push_back(pkOrigin[0] + corners[j][0] * along[0]);
+				rWindows.push_back(pkOrigin[1] + corners[j][0] * along[1]);
+				rWindows.push_back(minHeight + corners[j][1]);
+			}
+		}
+		return true;
+	}
+}
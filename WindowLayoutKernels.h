@@ -0,0 +1,45 @@
+// This file is part of Topologic software library.
+// Copyright(C) 2019, Cardiff University and University College London
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace TopologicEnergyCore
+{
+	struct WindowLayoutParameters
+	{
+		double sillHeight;		// above the bottom of the wall
+		double headHeight;		// above the bottom of the wall
+		double windowSpacing;	// façade length per window
+	};
+
+	// Places rectangular windows on a vertical rectangular wall so that their total area is
+	// glazingRatio x the wall area. The windows are centred in windowSpacing-wide bays, between the sill
+	// and head heights; if they do not fit, the band grows to the height of the wall. Returns false, and
+	// no windows, if the wall is not a vertical rectangle or the windows cannot fit; the caller then
+	// falls back to scaling the wall polygon.
+	//
+	// pkCoordinates holds vertexCount x 3 wall coordinates. Each window is appended to rWindows as
+	// 4 x 3 coordinates, wound in the same direction as the wall.
+	bool LayoutWindows(
+		const double* pkCoordinates,
+		std::size_t vertexCount,
+		double glazingRatio,
+		const WindowLayoutParameters& rkParameters,
+		std::vector<double>& rWindows);
+}